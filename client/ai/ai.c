@@ -39,7 +39,7 @@ static int waittime = 10;
 static gboolean silent = FALSE;
 static gboolean enable_debug = FALSE;
 static gboolean show_version = FALSE;
-static Map *map = NULL;
+static gint num_ai_players = 1;
 
 /** Randomizer only to be used for chat messages */
 GRand *chat_rand;
@@ -55,10 +55,10 @@ GRand *chat_rand;
 		} \
 	} while(0)
 
-/** Avoid multiple chat messages when more than one other player
- * must discard resources */
-gboolean discard_starting;
-
+/** The computer players that are still in a game */
+static guint running_players = 0;
+/** Quits the main loop when the last computer player is done */
+static void (*host_quit) (void);
 
 static void logbot_init(void);
 
@@ -106,6 +106,9 @@ static GOptionEntry commandline_entries[] = {
 	{"algorithm", 'a', 0, G_OPTION_ARG_STRING, &ai,
 	 /* Commandline pioneersai: algorithm */
 	 N_("Type of computer player"), "greedy"},
+	{"players", 'N', 0, G_OPTION_ARG_INT, &num_ai_players,
+	 /* Commandline pioneersai: players */
+	 N_("Number of computer players to run in this process"), "1"},
 	{"debug", '\0', 0, G_OPTION_ARG_NONE, &enable_debug,
 	 /* Commandline option of ai: enable debug logging */
 	 N_("Enable debug messages"), NULL},
@@ -146,8 +149,27 @@ static void ai_init_glib_et_al(int argc, char **argv)
 	log_set_func_default();
 }
 
+AIState *ai_state(void)
+{
+	return client_context_get_frontend_data();
+}
+
+/** Set up a computer player in the current client context */
+static void ai_start_player(const gchar * player_name)
+{
+	AIState *state = g_malloc0(sizeof(*state));
+
+	state->name = g_strdup(player_name);
+	state->sm = SM();
+	client_context_set_frontend_data(state);
+	running_players++;
+	algorithms[active_algorithm].init_func();
+}
+
 static void ai_init(void)
 {
+	gint idx;
+
 	set_enable_debug(enable_debug);
 
 	if (server == NULL)
@@ -170,28 +192,64 @@ static void ai_init(void)
 	}
 	log_message(MSG_INFO, _("Type of computer player: %s\n"),
 		    algorithms[active_algorithm].name);
-	algorithms[active_algorithm].init_func();
+
+	host_quit = callbacks.quit;
+	ai_start_player(name);
+	if (num_ai_players > 1) {
+		/* The other players share the main loop, each in its own
+		 * client context.  The first one is started by the
+		 * client. */
+		ClientContext *first = client_context_get();
+
+		for (idx = 2; idx <= num_ai_players; idx++) {
+			gchar *player_name =
+			    g_strdup_printf("%s %d", name, idx);
+
+			client_context_set(client_context_new());
+			ai_start_player(player_name);
+			g_free(player_name);
+			client_context_start();
+		}
+		client_context_set(first);
+	}
+	g_free(name);
+	name = NULL;
 }
 
 void ai_panic(const char *message)
 {
 	cb_chat(message);
-	callbacks.quit();
+	cb_disconnect();
+}
+
+/* The player has left the game, the program quits after the last one */
+static void ai_player_done(void)
+{
+	AIState *state = ai_state();
+
+	if (state->finished)
+		return;
+	state->finished = TRUE;
+	if (state->wait_source != 0) {
+		g_source_remove(state->wait_source);
+		state->wait_source = 0;
+	}
+	if (--running_players == 0)
+		host_quit();
 }
 
 static void ai_offline(void)
 {
 	gchar *style;
 
-	callbacks.offline = callbacks.quit;
-	notifying_string_set(requested_name, name);
+	callbacks.offline = &ai_player_done;
+	notifying_string_set(requested_name, ai_state()->name);
 	style =
 	    g_strdup_printf("ai %s", algorithms[active_algorithm].name);
 	notifying_string_set(requested_style, style);
 	cb_connect(server, port,
 		   !algorithms[active_algorithm].request_player);
 	g_free(style);
-	g_free(name);
 }
 
 static void ai_start_game(void)
@@ -203,9 +261,24 @@ static void ai_start_game(void)
 	}
 }
 
+static gboolean ai_wait_done(gpointer data)
+{
+	AIState *state = data;
+
+	state->wait_source = 0;
+	sm_set_use_cache(state->sm, FALSE);
+	return FALSE;
+}
+
 void ai_wait(void)
 {
-	g_usleep((gulong) waittime * 1000u);
+	AIState *state = ai_state();
+
+	if (state->wait_source != 0 || waittime <= 0)
+		return;
+	sm_set_use_cache(state->sm, TRUE);
+	state->wait_source =
+	    g_timeout_add((guint) waittime, ai_wait_done, state);
 }
 
 void ai_chat(const char *message)
@@ -216,12 +289,12 @@ void ai_chat(const char *message)
 
 static Map *ai_get_map(void)
 {
-	return map;
+	return ai_state()->map;
 }
 
 static void ai_set_map(Map * new_map)
 {
-	map = new_map;
+	ai_state()->map = new_map;
 }
 
 /* Chat messages */
@@ -338,7 +411,7 @@ static const char *chat_longestroad_other[] = {
 /* functions for chatting follow */
 static void chat_discard_start(void)
 {
-	discard_starting = TRUE;
+	ai_state()->discard_starting = TRUE;
 }
 
 void ai_chat_discard(gint player_num, G_GNUC_UNUSED gint discard_num)
@@ -346,8 +419,8 @@ void ai_chat_discard(gint player_num, G_GNUC_UNUSED gint discard_num)
 	if (player_num == my_player_num()) {
 		randchat(chat_discard_self, 10);
 	} else {
-		if (discard_starting) {
-			discard_starting = FALSE;
+		if (ai_state()->discard_starting) {
+			ai_state()->discard_starting = FALSE;
 			randchat(chat_discard_other, 10);
 		}
 	}
@@ -23,11 +23,40 @@
 
 #include <glib.h>
 #include "callback.h"
+#include "state.h"
 
 /** Filename for the chromosome of the genetic player */
 extern char *chromosomeFile;
 
+/** The state of one computer player.  A process can run several computer
+ * players, each in its own client context. */
+typedef struct {
+	/** Name to request from the server */
+	gchar *name;
+	/** The map of the game */
+	Map *map;
+	/** Avoid multiple chat messages when more than one other player
+	 * must discard resources */
+	gboolean discard_starting;
+	/** Number of the next quote during a trade */
+	int quote_num;
+	/** TRUE when the player has left the game */
+	gboolean finished;
+	/** The state machine of the client context of the player */
+	StateMachine *sm;
+	/** Timeout that sends the messages held by ai_wait, or 0 */
+	guint wait_source;
+	/** State of the algorithm, set by its init function */
+	gpointer algorithm_data;
+} AIState;
+
+/** The state of the current computer player */
+AIState *ai_state(void);
+
 void ai_panic(const char *message);
+/** Wait before the next action is sent to the server.
+ * The messages are held and sent from the main loop after the wait time,
+ * so the other computer players in the process keep running. */
 void ai_wait(void);
 void ai_chat(const char *message);
 void genetic_init(void);
@@ -30,7 +30,7 @@
  */
 
 /** default chromosome */
-struct chromosome_t thisChromosome = (struct chromosome_t) {
+static const struct chromosome_t default_chromosome = {
 	{
 	 {1.371242, 1.984368, 1.336144, 1.111876, 1.206090, 0.052862,
 	  1.506242, 1.684672},
@@ -54,8 +54,22 @@ typedef struct resource_values_s {
 	gint ports[NO_RESOURCE];
 } resource_values_t;
 
-static int quote_num;
-static gboolean default_chromosome_used = TRUE;
+/** The state of a genetic computer player */
+typedef struct {
+	/** The chromosome in use */
+	struct chromosome_t chromosome;
+	gboolean default_chromosome_used;
+} GeneticState;
+
+static GeneticState *genetic_state(void)
+{
+	return ai_state()->algorithm_data;
+}
+
+static struct chromosome_t *this_chromosome(void)
+{
+	return &genetic_state()->chromosome;
+}
 
 /* things we can buy, in the order that we want them. */
 typedef enum {
@@ -1278,7 +1292,7 @@ static void genetic_setup_house(void)
 		return;
 	}
 
-	node = best_settlement_spot(TRUE, &thisChromosome, &myGameState);
+	node = best_settlement_spot(TRUE, this_chromosome(), &myGameState);
 
 	if (node == NULL) {
 		ai_panic(N_("There is no place to setup a settlement"));
@@ -1314,7 +1328,7 @@ static void genetic_setup_road(void)
 
 	node = void_settlement();
 
-	e = best_road_to_road_spot(node, &tmp, &thisChromosome,
+	e = best_road_to_road_spot(node, &tmp, this_chromosome(),
 				   &myGameState);
 
 	/* if didn't find one just pick one randomly */
@@ -1703,8 +1717,8 @@ static void genetic_turn(void)
 	guint i;
 	strategy_t thisStrategy;
 	float turn, probability;
-	turn = thisChromosome.turn;
-	probability = thisChromosome.probability;
+	turn = this_chromosome()->turn;
+	probability = this_chromosome()->probability;
 	Node *city_node;
 	Node *sett_node;
 	Edge *road_edge;
@@ -1763,29 +1777,29 @@ static void genetic_turn(void)
 	/* Note that even though I am passing thisGameState to should_buy it does not need to access thisGameState.actionValue */
 
 	/*Best City */
-	city_node = best_city_spot(&thisChromosome, &thisGameState);
+	city_node = best_city_spot(this_chromosome(), &thisGameState);
 	if ((city_node != NULL) && (stock_num_cities())) {
 		thisGameState.actionValue[CIT] =
-		    genetic_score_node(city_node, TRUE, &thisChromosome,
+		    genetic_score_node(city_node, TRUE, this_chromosome(),
 				       &thisGameState)
-		    * (thisChromosome.resourcesValueMatrix[victoryPoints][6]);	/* The relative value of city at this point in the game */
+		    * (this_chromosome()->resourcesValueMatrix[victoryPoints][6]);	/* The relative value of city at this point in the game */
 	} else
 		thisGameState.actionValue[CIT] = 0;
 
 
 	/* Best Settlement */
 	sett_node =
-	    best_settlement_spot(FALSE, &thisChromosome, &thisGameState);
+	    best_settlement_spot(FALSE, this_chromosome(), &thisGameState);
 	if ((sett_node != NULL) && stock_num_settlements()) {
 		thisGameState.actionValue[SET] =
-		    genetic_score_node(sett_node, FALSE, &thisChromosome,
+		    genetic_score_node(sett_node, FALSE, this_chromosome(),
 				       &thisGameState);
 	} else
 		thisGameState.actionValue[SET] = 0;
 
 	/* Best Road to Settlement, that is, best destination to build a Settlement after building a Road */
 	road_edge =
-	    best_road_spot(&thisChromosome, &thisGameState,
+	    best_road_spot(this_chromosome(), &thisGameState,
 			   &destinationRoadScore);
 	if ((road_edge != NULL) && stock_num_roads()
 	    && stock_num_settlements()) {
@@ -1796,7 +1810,7 @@ static void genetic_turn(void)
 
 	/* Best Long Road to Settlement, this is, best destination to build a Settlement after building two Roads */
 	long_road_edge =
-	    best_road_to_road(&thisChromosome, &thisGameState,
+	    best_road_to_road(this_chromosome(), &thisGameState,
 			      &destinationLongRoadScore);
 	if ((long_road_edge != NULL) && (stock_num_roads() >= 2)
 	    && stock_num_settlements()) {
@@ -1809,7 +1823,7 @@ static void genetic_turn(void)
 	/* value of buying Development Card is fixed in the chromosome */
 	if (stock_num_develop() > 0)
 		thisGameState.actionValue[DEV] =
-		    thisChromosome.resourcesValueMatrix[victoryPoints][5];
+		    this_chromosome()->resourcesValueMatrix[victoryPoints][5];
 	else
 		thisGameState.actionValue[DEV] = 0;
 
@@ -1846,7 +1860,7 @@ static void genetic_turn(void)
 
 	/* Trading code should go here. Now that I know my expected profit, I can see if there is a way to improve it trading */
 	printf("Updating trading matrixes...\n");
-	updateTradingMatrix(&thisChromosome, thisStrategyProfit,
+	updateTradingMatrix(this_chromosome(), thisStrategyProfit,
 			    &thisTradingMatrixes, thisGameState, 1);
 	/* ai_wait(); */
 	if (best_maritime_trade
@@ -2164,11 +2178,11 @@ static void genetic_free_road(void)
 	 */
 	reevaluate_gameState_supply_matrix_and_resources(&myGameState);
 
-	e = best_road_spot(&thisChromosome, &myGameState,
+	e = best_road_spot(this_chromosome(), &myGameState,
 			   &destinationScore);
 
 	if (e == NULL) {
-		e = best_road_to_road(&thisChromosome, &myGameState,
+		e = best_road_to_road(this_chromosome(), &myGameState,
 				      &destinationScore);
 	}
 
@@ -2212,7 +2226,7 @@ static void genetic_year_of_plenty(const gint bank[NO_RESOURCE])
 	/* reevaluate_resources(&resval); */
 	reevaluate_gameState_supply_matrix_and_resources(&myGameState);
 
-	r1 = resource_desire(assets, &thisChromosome, &myGameState);
+	r1 = resource_desire(assets, this_chromosome(), &myGameState);
 
 	/* If we don't desire anything anymore, ask for a road.
 	 * This happens if we have at least 2 of each resource
@@ -2225,7 +2239,7 @@ static void genetic_year_of_plenty(const gint bank[NO_RESOURCE])
 	/* reevaluate_resources(&resval); */
 	reevaluate_gameState_supply_matrix_and_resources(&myGameState);
 
-	r2 = resource_desire(assets, &thisChromosome, &myGameState);
+	r2 = resource_desire(assets, this_chromosome(), &myGameState);
 
 	if (r2 == NO_RESOURCE)
 		r2 = LUMBER_RESOURCE;
@@ -2286,7 +2300,7 @@ static gint determine_monopoly_resource()
 
 	/* try to get something we need */
 	most_desired =
-	    resource_desire(assets, &thisChromosome, &myGameState);
+	    resource_desire(assets, this_chromosome(), &myGameState);
 
 	/* try to get the optimal maritime trade. */
 	most_wildcards = 0;
@@ -2503,7 +2517,7 @@ static void genetic_discard(int num)
 
 	struct gameState_t myGameState;
 
-	update_todiscard_resources(num, &thisChromosome, &myGameState,
+	update_todiscard_resources(num, this_chromosome(), &myGameState,
 				   todiscard);
 	printf("Resources:");
 	for (i = 0; i < 5; i++)
@@ -2521,12 +2535,12 @@ static void genetic_discard(int num)
  */
 static int quote_next_num(void)
 {
-	return quote_num++;
+	return ai_state()->quote_num++;
 }
 
 static void genetic_quote_start(void)
 {
-	quote_num = 0;
+	ai_state()->quote_num = 0;
 }
 
 static int trade_desired(gint assets[NO_RESOURCE], gint give, gint take,
@@ -2555,28 +2569,28 @@ static int trade_desired(gint assets[NO_RESOURCE], gint give, gint take,
 	for (n = 1; n <= 3; ++n) {
 		/* do i need something more for something? */
 		if (!should_buy
-		    (assets, BUY_CITY, &thisChromosome, &myGameState,
+		    (assets, BUY_CITY, this_chromosome(), &myGameState,
 		     need)) {
 			if ((res = which_resource(need)) == take
 			    && need[res] == n)
 				break;
 		}
 		if (!should_buy
-		    (assets, BUY_SETTLEMENT, &thisChromosome, &myGameState,
+		    (assets, BUY_SETTLEMENT, this_chromosome(), &myGameState,
 		     need)) {
 			if ((res = which_resource(need)) == take
 			    && need[res] == n)
 				break;
 		}
 		if (!should_buy
-		    (assets, BUY_ROAD, &thisChromosome, &myGameState,
+		    (assets, BUY_ROAD, this_chromosome(), &myGameState,
 		     need)) {
 			if ((res = which_resource(need)) == take
 			    && need[res] == n)
 				break;
 		}
 		if (!should_buy
-		    (assets, BUY_DEVEL_CARD, &thisChromosome, &myGameState,
+		    (assets, BUY_DEVEL_CARD, this_chromosome(), &myGameState,
 		     need)) {
 			if ((res = which_resource(need)) == take
 			    && need[res] == n)
@@ -2720,7 +2734,7 @@ static void genetic_gold_choose(gint gold_num, const gint * bank)
 			}
 		}
 
-		r1 = resource_desire(assets, &thisChromosome,
+		r1 = resource_desire(assets, this_chromosome(),
 				     &myGameState);
 		/* If we don't want anything, start emptying the bank */
 		if (r1 == NO_RESOURCE) {
@@ -2743,12 +2757,12 @@ static void outputChromosome(void)
 	for (i = 0; i <= 9; i++) {
 		for (j = 0; j <= 7; j++) {
 			printf("%.3f\t",
-			       thisChromosome.resourcesValueMatrix[i][j]);
+			       this_chromosome()->resourcesValueMatrix[i][j]);
 		}
 		printf("\n");
 	}
-	printf("%.3f\t%.3f\t%.3f\n", thisChromosome.depreciation_constant,
-	       thisChromosome.turn, thisChromosome.probability);
+	printf("%.3f\t%.3f\t%.3f\n", this_chromosome()->depreciation_constant,
+	       this_chromosome()->turn, this_chromosome()->probability);
 }
 
 static void genetic_game_over(gint player_num, G_GNUC_UNUSED gint points)
@@ -2757,7 +2771,7 @@ static void genetic_game_over(gint player_num, G_GNUC_UNUSED gint points)
 		printf
 		    ("FINAL RESULT GENETIC: I won!  (%s) with %2d points using ",
 		     my_player_name(), player_get_score(my_player_num()));
-		if (default_chromosome_used) {
+		if (genetic_state()->default_chromosome_used) {
 			printf("DEFAULT\n");
 		} else
 			printf("%s\n", chromosomeFile);
@@ -2768,7 +2782,7 @@ static void genetic_game_over(gint player_num, G_GNUC_UNUSED gint points)
 		printf
 		    ("FINAL RESULT GENETIC: I lost! (%s) with %2d points using ",
 		     my_player_name(), player_get_score(my_player_num()));
-		if (default_chromosome_used) {
+		if (genetic_state()->default_chromosome_used) {
 			printf("DEFAULT\n");
 		} else
 			printf("%s\n", chromosomeFile);
@@ -2839,17 +2853,17 @@ static void genetic_init_game(void)
 	printf("%s", line);
 	printf("Finishing reading the chromosome\n");
 	fclose(chromFilePointer);
-	default_chromosome_used = FALSE;
+	genetic_state()->default_chromosome_used = FALSE;
 	for (i = 0; i <= 9; i++) {
 		for (j = 0; j <= 7; j++) {
-			thisChromosome.resourcesValueMatrix[i][j] =
+			this_chromosome()->resourcesValueMatrix[i][j] =
 			    tempChromosome.resourcesValueMatrix[i][j];
 		}
 	}
-	thisChromosome.depreciation_constant =
+	this_chromosome()->depreciation_constant =
 	    tempChromosome.depreciation_constant;
-	thisChromosome.turn = tempChromosome.turn;
-	thisChromosome.probability = tempChromosome.probability;
+	this_chromosome()->turn = tempChromosome.turn;
+	this_chromosome()->probability = tempChromosome.probability;
 
 
 	return;
@@ -2857,6 +2871,12 @@ static void genetic_init_game(void)
 
 void genetic_init(void)
 {
+	GeneticState *state = g_malloc(sizeof(*state));
+
+	state->chromosome = default_chromosome;
+	state->default_chromosome_used = TRUE;
+	ai_state()->algorithm_data = state;
+
 	callbacks.setup = &genetic_setup;
 	callbacks.turn = &genetic_turn;
 	callbacks.robber = &genetic_place_robber;
@@ -42,8 +42,6 @@ typedef struct resource_values_s {
 	gint ports[NO_RESOURCE];
 } resource_values_t;
 
-static int quote_num;
-
 /* things we can buy, in the order that we want them. */
 typedef enum {
 	BUY_CITY,
@@ -1666,12 +1664,12 @@ static void greedy_discard(int num)
  */
 static int quote_next_num(void)
 {
-	return quote_num++;
+	return ai_state()->quote_num++;
 }
 
 static void greedy_quote_start(void)
 {
-	quote_num = 0;
+	ai_state()->quote_num = 0;
 }
 
 static int trade_desired(gint assets[NO_RESOURCE], gint give, gint take,
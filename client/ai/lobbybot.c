@@ -30,8 +30,18 @@
  * When used in other games, it will leave the game when it starts.
 */
 
-static GHashTable *players = NULL;
-static gboolean chatting = FALSE;
+/** The state of a lobbybot */
+typedef struct {
+	/** The names of the players, by number */
+	GHashTable *players;
+	/** Chat when the rules are known */
+	gboolean chatting;
+} LobbyState;
+
+static LobbyState *lobby_state(void)
+{
+	return ai_state()->algorithm_data;
+}
 
 struct _PlayerInfo {
 	/** Name of the player */
@@ -66,16 +76,18 @@ static void player_info_set_name(PlayerInfo * player_info,
 static void lobbybot_player_name_changed(gint player_num,
 					 const gchar * name)
 {
+	LobbyState *state = lobby_state();
 	PlayerInfo *info =
-	    g_hash_table_lookup(players, GINT_TO_POINTER(player_num));
+	    g_hash_table_lookup(state->players,
+				GINT_TO_POINTER(player_num));
 	if (info) {
 		player_info_set_name(info, name);
 	} else {
 		info = player_info_new(name);
-		g_hash_table_insert(players, GINT_TO_POINTER(player_num),
-				    info);
+		g_hash_table_insert(state->players,
+				    GINT_TO_POINTER(player_num), info);
 
-		if (my_player_num() != player_num && chatting)
+		if (my_player_num() != player_num && state->chatting)
 			/* Translators: don't translate '/help' */
 			ai_chat(N_("Hello, welcome to the lobby. I am a "
 				   "simple robot. Type '/help' in the chat "
@@ -86,7 +98,8 @@ static void lobbybot_player_name_changed(gint player_num,
 static void lobbybot_player_quit(gint player_num)
 {
 	gboolean did_remove =
-	    g_hash_table_remove(players, GINT_TO_POINTER(player_num));
+	    g_hash_table_remove(lobby_state()->players,
+				GINT_TO_POINTER(player_num));
 	g_return_if_fail(did_remove);
 }
 
@@ -99,7 +112,9 @@ static void lobbybot_chat_parser(gint player_num, const gchar * chat)
 		return;
 	}
 
-	info = g_hash_table_lookup(players, GINT_TO_POINTER(player_num));
+	info =
+	    g_hash_table_lookup(lobby_state()->players,
+				GINT_TO_POINTER(player_num));
 	g_assert(info != NULL);
 
 	if (!strncmp(chat, "/help", 5)) {
@@ -151,17 +166,19 @@ static void lobbybot_turn(G_GNUC_UNUSED gint player_num)
 static void lobbybot_start_game(void)
 {
 	/* The rules are known, enable chat */
-	chatting = TRUE;
+	lobby_state()->chatting = TRUE;
 }
 
 void lobbybot_init(void)
 {
-	g_assert(players == NULL);
-	players =
+	LobbyState *state = g_malloc(sizeof(*state));
+
+	state->players =
 	    g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
 				  hash_data_free);
 	/* Don't chat before the rules are known */
-	chatting = FALSE;
+	state->chatting = FALSE;
+	ai_state()->algorithm_data = state;
 
 	callbacks.spectator_name = &lobbybot_player_name_changed;
 	callbacks.player_name = &lobbybot_player_name_changed;
@@ -283,6 +283,26 @@ extern enum callback_mode callback_mode;
  * which is in common, and included by the client, not the gui. */
 extern gboolean color_chat_enabled;
 
+/* The state of a client in a game.  client_init creates the first one.  A
+ * program can run several clients in one main loop: each gets its own
+ * context, which is made current before cb_connect is called for it.  The
+ * network events of a client make its context current again.  Each client
+ * has its own callbacks, a new context starts with a copy of the callbacks
+ * of the current one. */
+typedef struct _ClientContext ClientContext;
+
+ClientContext *client_context_new(void);
+/* The context must not be the current one */
+void client_context_free(ClientContext * context);
+ClientContext *client_context_get(void);
+void client_context_set(ClientContext * context);
+/* Start the current client, like client_start does for the first one */
+void client_context_start(void);
+/* State of the front end for the current client, it is not freed by
+ * client_context_free */
+gpointer client_context_get_frontend_data(void);
+void client_context_set_frontend_data(gpointer data);
+
 /* functions for use by front ends */
 /* these functions do things for the frontends, they should be used to make
  * changes to the board, etc.  The frontend should NEVER touch any game
@@ -30,20 +30,16 @@
 #include "log.h"
 #include "buildrec.h"
 
-static GList *build_list;
-static gboolean built;		/* have we build road / settlement / city? */
-static gint num_edges, num_settlements;
-
 void build_clear(void)
 {
-	build_list = buildrec_free(build_list);
-	num_edges = num_settlements = 0;
+	client->build_list = buildrec_free(client->build_list);
+	client->built_edges = client->built_settlements = 0;
 }
 
 void build_new_turn(void)
 {
-	build_list = buildrec_free(build_list);
-	built = FALSE;
+	client->build_list = buildrec_free(client->build_list);
+	client->built = FALSE;
 }
 
 void build_remove(BuildType type, gint x, gint y, gint pos)
@@ -51,23 +47,23 @@ void build_remove(BuildType type, gint x, gint y, gint pos)
 	GList *list;
 	BuildRec *rec;
 
-	g_assert(build_list != NULL);
+	g_assert(client->build_list != NULL);
 
-	list = g_list_last(build_list);
+	list = g_list_last(client->build_list);
 	rec = list->data;
-	build_list = g_list_remove(build_list, rec);
+	client->build_list = g_list_remove(client->build_list, rec);
 	g_assert(rec->type == type
 		 && rec->x == x && rec->y == y && rec->pos == pos);
 	g_free(rec);
 
 	switch (type) {
 	case BUILD_SETTLEMENT:
-		--num_settlements;
+		--client->built_settlements;
 		break;
 	case BUILD_ROAD:
 	case BUILD_SHIP:
 	case BUILD_BRIDGE:
-		--num_edges;
+		--client->built_edges;
 		break;
 	default:
 		break;
@@ -75,8 +71,8 @@ void build_remove(BuildType type, gint x, gint y, gint pos)
 
 	/* If the build_list is now empty (no more items to undo), clear built flag
 	   so trading is reallowed with strict-trade */
-	if (build_list == NULL)
-		built = FALSE;
+	if (client->build_list == NULL)
+		client->built = FALSE;
 
 	player_build_remove(my_player_num(), type, x, y, pos);
 }
@@ -89,7 +85,7 @@ void build_move(gint sx, gint sy, gint spos, gint dx, gint dy, gint dpos,
 	BuildRec *rec;
 	if (isundo) {
 		callbacks.get_map()->has_moved_ship = FALSE;
-		list = g_list_last(build_list);
+		list = g_list_last(client->build_list);
 		rec = list->data;
 		if (rec->type != BUILD_MOVE_SHIP && rec->x != sx
 		    && rec->y != sy && rec->pos != spos) {
@@ -98,17 +94,17 @@ void build_move(gint sx, gint sy, gint spos, gint dx, gint dy, gint dpos,
 				    BUILD_MOVE_SHIP, rec->type, sx, rec->x,
 				    sy, rec->y, spos, rec->pos);
 		}
-		build_list = g_list_remove(build_list, rec);
+		client->build_list = g_list_remove(client->build_list, rec);
 		g_free(rec);
 		/* If the build_list is now empty (no more items to undo),
 		 * clear built flag so trading is reallowed with
 		 * strict-trade */
-		if (build_list == NULL)
-			built = FALSE;
+		if (client->build_list == NULL)
+			client->built = FALSE;
 	} else {
 		rec = buildrec_new(BUILD_MOVE_SHIP, sx, sy, spos);
-		build_list = g_list_append(build_list, rec);
-		built = TRUE;
+		client->build_list = g_list_append(client->build_list, rec);
+		client->built = TRUE;
 		callbacks.get_map()->has_moved_ship = TRUE;
 	}
 	player_build_move(my_player_num(), sx, sy, spos, dx, dy, dpos,
@@ -118,17 +114,17 @@ void build_move(gint sx, gint sy, gint spos, gint dx, gint dy, gint dpos,
 void build_add(BuildType type, gint x, gint y, gint pos, gboolean newbuild)
 {
 	BuildRec *rec = buildrec_new(type, x, y, pos);
-	build_list = g_list_append(build_list, rec);
-	built = TRUE;
+	client->build_list = g_list_append(client->build_list, rec);
+	client->built = TRUE;
 
 	switch (type) {
 	case BUILD_SETTLEMENT:
-		++num_settlements;
+		++client->built_settlements;
 		break;
 	case BUILD_ROAD:
 	case BUILD_SHIP:
 	case BUILD_BRIDGE:
-		++num_edges;
+		++client->built_edges;
 		break;
 	default:
 		break;
@@ -141,54 +137,57 @@ void build_add(BuildType type, gint x, gint y, gint pos, gboolean newbuild)
 
 gint build_count_edges(void)
 {
-	return num_edges;
+	return client->built_edges;
 }
 
 gint build_count_settlements(void)
 {
-	return num_settlements;
+	return client->built_settlements;
 }
 
 gint build_count(BuildType type)
 {
-	return buildrec_count_type(build_list, type);
+	return buildrec_count_type(client->build_list, type);
 }
 
 gboolean build_is_valid(void)
 {
-	return buildrec_is_valid(build_list, callbacks.get_map(),
+	return buildrec_is_valid(client->build_list, callbacks.get_map(),
 				 my_player_num());
 }
 
 gboolean build_can_undo(void)
 {
-	return build_list != NULL;
+	return client->build_list != NULL;
 }
 
 gboolean have_built(void)
 {
-	return built;
+	return client->built;
 }
 
 /* Place some restrictions on road placement during setup phase
  */
 gboolean build_can_setup_road(const Edge * edge, gboolean double_setup)
 {
-	return buildrec_can_setup_road(build_list, edge, double_setup);
+	return buildrec_can_setup_road(client->build_list, edge,
+					double_setup);
 }
 
 /* Place some restrictions on ship placement during setup phase
  */
 gboolean build_can_setup_ship(const Edge * edge, gboolean double_setup)
 {
-	return buildrec_can_setup_ship(build_list, edge, double_setup);
+	return buildrec_can_setup_ship(client->build_list, edge,
+					double_setup);
 }
 
 /* Place some restrictions on bridge placement during setup phase
  */
 gboolean build_can_setup_bridge(const Edge * edge, gboolean double_setup)
 {
-	return buildrec_can_setup_bridge(build_list, edge, double_setup);
+	return buildrec_can_setup_bridge(client->build_list, edge,
+					double_setup);
 }
 
 /* Place some restrictions on road placement during setup phase
@@ -196,6 +195,6 @@ gboolean build_can_setup_bridge(const Edge * edge, gboolean double_setup)
 gboolean build_can_setup_settlement(const Node * node,
 				    gboolean double_setup)
 {
-	return buildrec_can_setup_settlement(build_list, node,
+	return buildrec_can_setup_settlement(client->build_list, node,
 					     double_setup);
 }
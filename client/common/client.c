@@ -35,19 +35,8 @@
 #include "quoteinfo.h"
 #include "notifying-string.h"
 
-static enum callback_mode previous_mode;
 GameParams *game_params;
-static struct recovery_info_t {
-	gchar *prevstate;
-	gint turnnum;
-	gint playerturn;
-	gint numdiscards;
-	gboolean rolled_dice;
-	gint die1, die2;
-	gboolean bought_develop;
-	GList *build_list;
-	gboolean ship_moved;
-} recovery_info;
+ClientContext *client;
 
 NotifyingString *requested_name = NULL;
 NotifyingString *requested_style = NULL;
@@ -80,17 +69,112 @@ static gboolean mode_recovery_wait_start_response(StateMachine * sm,
 static void recover_from_disconnect(StateMachine * sm,
 				    struct recovery_info_t *rinfo);
 
-/* Create and/or return the client state machine.
+/* Return the state machine of the current client.
  */
 StateMachine *SM(void)
 {
-	static StateMachine *state_machine;
-	if (state_machine == NULL) {
-		state_machine = sm_new(NULL);
-		sm_global_set(state_machine, global_filter);
-		sm_unhandled_set(state_machine, global_unhandled);
+	return client->sm;
+}
+
+/* The network events of a state machine are handled by its own client.
+ */
+static void enter_context(gpointer context)
+{
+	client_context_set(context);
+}
+
+ClientContext *client_context_new(void)
+{
+	ClientContext *context = g_new0(ClientContext, 1);
+	context->sm = sm_new(NULL);
+	sm_global_set(context->sm, global_filter);
+	sm_unhandled_set(context->sm, global_unhandled);
+	sm_set_enter_func(context->sm, enter_context, context);
+	if (client != NULL)
+		context->callbacks = callbacks;
+	/* The first client gets them in client_start, when the type
+	 * system is ready */
+	if (requested_name != NULL) {
+		context->requested_name =
+		    NOTIFYING_STRING(notifying_string_new());
+		context->requested_style =
+		    NOTIFYING_STRING(notifying_string_new());
+	}
+	context->turn_player = -1;
+	context->my_player_id = -1;
+	context->num_total_players = 4;
+	return context;
+}
+
+void client_context_free(ClientContext * context)
+{
+	ClientContext *previous = client;
+
+	g_return_if_fail(context != previous);
+
+	/* The functions that clean up work on the current client */
+	client_context_set(context);
+	player_reset();
+	build_clear();
+	if (client->develop_deck != NULL)
+		deck_free(client->develop_deck, NULL);
+	if (game_params != NULL)
+		params_free(game_params);
+	game_params = NULL;
+	client_context_set(previous);
+
+	if (context->requested_name != NULL)
+		g_object_unref(context->requested_name);
+	if (context->requested_style != NULL)
+		g_object_unref(context->requested_style);
+	sm_free(context->sm);
+	g_free(context);
+}
+
+ClientContext *client_context_get(void)
+{
+	return client;
+}
+
+void client_context_set(ClientContext * context)
+{
+	if (context == client)
+		return;
+	/* The variables that the front ends use directly follow the
+	 * client */
+	if (client != NULL) {
+		client->game_params = game_params;
+		client->callback_mode = callback_mode;
+		client->callbacks = callbacks;
+		client->requested_name = requested_name;
+		client->requested_style = requested_style;
+		client->requested_spectator = requested_spectator;
+		client = context;
+		callbacks = client->callbacks;
+		requested_name = client->requested_name;
+		requested_style = client->requested_style;
+		requested_spectator = client->requested_spectator;
+	} else {
+		/* The first client takes the callbacks as they are */
+		client = context;
 	}
-	return state_machine;
+	game_params = client->game_params;
+	callback_mode = client->callback_mode;
+}
+
+void client_context_start(void)
+{
+	sm_goto(SM(), mode_offline);
+}
+
+gpointer client_context_get_frontend_data(void)
+{
+	return client->frontend_data;
+}
+
+void client_context_set_frontend_data(gpointer data)
+{
+	client->frontend_data = data;
 }
 
 /* When commands are sent to the server, front ends may want to update
@@ -421,6 +505,8 @@ static void dummy_set_map(G_GNUC_UNUSED Map * map)
  */
 void client_init(void)
 {
+	client_context_set(client_context_new());
+
 	/* first set everything to 0, so we are sure it segfaults if
 	 * someone forgets to update this when adding a new callback */
 	memset(&callbacks, 0, sizeof(callbacks));
@@ -502,7 +588,7 @@ void client_start(int argc, char **argv)
 	requested_style = NOTIFYING_STRING(notifying_string_new());
 
 	callbacks.init();
-	sm_goto(SM(), mode_offline);
+	client_context_start();
 }
 
 /*----------------------------------------------------------------------
@@ -1049,16 +1135,16 @@ static gboolean mode_load_game(StateMachine * sm, gint event)
 		stock_init();
 		develop_init();
 		/* initialize global recovery info struct */
-		recovery_info.prevstate = NULL;
-		recovery_info.turnnum = -1;
-		recovery_info.playerturn = -1;
-		recovery_info.numdiscards = -1;
-		recovery_info.rolled_dice = FALSE;
-		recovery_info.die1 = -1;
-		recovery_info.die2 = -1;
-		recovery_info.bought_develop = FALSE;
-		recovery_info.build_list = NULL;
-		recovery_info.ship_moved = FALSE;
+		client->recovery_info.prevstate = NULL;
+		client->recovery_info.turnnum = -1;
+		client->recovery_info.playerturn = -1;
+		client->recovery_info.numdiscards = -1;
+		client->recovery_info.rolled_dice = FALSE;
+		client->recovery_info.die1 = -1;
+		client->recovery_info.die2 = -1;
+		client->recovery_info.bought_develop = FALSE;
+		client->recovery_info.build_list = NULL;
+		client->recovery_info.ship_moved = FALSE;
 
 		sm_send(sm, "gameinfo\n");
 		sm_goto(sm, mode_load_gameinfo);
@@ -1130,32 +1216,32 @@ static gboolean mode_load_gameinfo(StateMachine * sm, gint event)
 			stock_use_develop();
 		return TRUE;
 	}
-	if (sm_recv(sm, "turn num %d", &recovery_info.turnnum)) {
+	if (sm_recv(sm, "turn num %d", &client->recovery_info.turnnum)) {
 		return TRUE;
 	}
-	if (sm_recv(sm, "player turn: %d", &recovery_info.playerturn)) {
+	if (sm_recv(sm, "player turn: %d", &client->recovery_info.playerturn)) {
 		return TRUE;
 	}
 	if (sm_recv
-	    (sm, "dice rolled: %d %d", &recovery_info.die1,
-	     &recovery_info.die2)) {
-		recovery_info.rolled_dice = TRUE;
+	    (sm, "dice rolled: %d %d", &client->recovery_info.die1,
+	     &client->recovery_info.die2)) {
+		client->recovery_info.rolled_dice = TRUE;
 		return TRUE;
 	}
 	if (sm_recv
-	    (sm, "dice value: %d %d", &recovery_info.die1,
-	     &recovery_info.die2)) {
+	    (sm, "dice value: %d %d", &client->recovery_info.die1,
+	     &client->recovery_info.die2)) {
 		return TRUE;
 	}
 	if (sm_recv(sm, "moved ship")) {
-		recovery_info.ship_moved = TRUE;
+		client->recovery_info.ship_moved = TRUE;
 		return TRUE;
 	}
 	if (sm_recv(sm, "bought develop")) {
-		recovery_info.bought_develop = TRUE;
+		client->recovery_info.bought_develop = TRUE;
 		return TRUE;
 	}
-	if (sm_recv(sm, "state %S", &recovery_info.prevstate)) {
+	if (sm_recv(sm, "state %S", &client->recovery_info.prevstate)) {
 		return TRUE;
 	}
 	if (sm_recv(sm, "playerinfo: resources: %R", resources)) {
@@ -1279,8 +1365,8 @@ static gboolean mode_load_gameinfo(StateMachine * sm, gint event)
 		rec->x = x;
 		rec->y = y;
 		rec->pos = pos;
-		recovery_info.build_list =
-		    g_list_append(recovery_info.build_list, rec);
+		client->recovery_info.build_list =
+		    g_list_append(client->recovery_info.build_list, rec);
 		return TRUE;
 	}
 	if (sm_recv(sm, "RO%d,%d", &x, &y)) {
@@ -1912,7 +1998,7 @@ static gboolean mode_discard(StateMachine * sm, gint event)
 	case SM_ENTER:
 		if (callback_mode != MODE_DISCARD
 		    && callback_mode != MODE_DISCARD_WAIT) {
-			previous_mode = callback_mode;
+			client->previous_mode = callback_mode;
 			callback_mode = MODE_DISCARD_WAIT;
 		}
 		callbacks.discard();
@@ -1926,7 +2012,7 @@ static gboolean mode_discard(StateMachine * sm, gint event)
 			return TRUE;
 		}
 		if (sm_recv(sm, "discard-done")) {
-			callback_mode = previous_mode;
+			callback_mode = client->previous_mode;
 			callbacks.discard_done();
 			sm_pop(sm);
 			return TRUE;
@@ -2343,7 +2429,7 @@ static gboolean check_quoting(StateMachine * sm, gint exitdepth,
 		return TRUE;
 	}
 	if (sm_recv(sm, "domestic-trade finish")) {
-		callback_mode = previous_mode;
+		callback_mode = client->previous_mode;
 		callbacks.quote_end();
 		sm_multipop(sm, exitdepth);
 		return TRUE;
@@ -2440,7 +2526,7 @@ static gboolean mode_domestic_quote(StateMachine * sm, gint event)
 	switch (event) {
 	case SM_ENTER:
 		if (callback_mode != MODE_QUOTE) {
-			previous_mode = callback_mode;
+			client->previous_mode = callback_mode;
 			callback_mode = MODE_QUOTE;
 			callbacks.quote_start();
 		}
@@ -2503,7 +2589,7 @@ static gboolean mode_recovery_wait_start_response(StateMachine * sm,
 		break;
 	case SM_RECV:
 		if (sm_recv(sm, "OK")) {
-			recover_from_disconnect(sm, &recovery_info);
+			recover_from_disconnect(sm, &client->recovery_info);
 			return TRUE;
 		}
 		return check_other_players(sm);
@@ -2648,7 +2734,7 @@ static gboolean mode_wait_resources(StateMachine * sm, gint event)
 			    &gold_num)) {
 			if (callback_mode != MODE_GOLD
 			    && callback_mode != MODE_GOLD_WAIT) {
-				previous_mode = callback_mode;
+				client->previous_mode = callback_mode;
 				callback_mode = MODE_GOLD_WAIT;
 				callbacks.gold();
 			}
@@ -2671,7 +2757,7 @@ static gboolean mode_wait_resources(StateMachine * sm, gint event)
 		if (sm_recv(sm, "done-resources")) {
 			if (callback_mode == MODE_GOLD
 			    || callback_mode == MODE_GOLD_WAIT) {
-				callback_mode = previous_mode;
+				callback_mode = client->previous_mode;
 				callbacks.gold_done();
 			}
 			sm_pop(sm);
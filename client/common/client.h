@@ -26,8 +26,78 @@
 #include "map.h"
 #include "callback.h"
 #include "notifying-string.h"
+#include "deck.h"
+
+/* information about the game which was in progress before a disconnect */
+struct recovery_info_t {
+	gchar *prevstate;
+	gint turnnum;
+	gint playerturn;
+	gint numdiscards;
+	gboolean rolled_dice;
+	gint die1, die2;
+	gboolean bought_develop;
+	GList *build_list;
+	gboolean ship_moved;
+};
+
+struct _ClientContext {
+	StateMachine *sm;
+	/* game_params, callback_mode, callbacks and the requested name,
+	 * while another client is current */
+	GameParams *game_params;
+	enum callback_mode callback_mode;
+	struct callbacks callbacks;
+	NotifyingString *requested_name;
+	NotifyingString *requested_style;
+	gboolean requested_spectator;
+	gpointer frontend_data;	/* state of the front end for this client */
+
+	/* client.c */
+	enum callback_mode previous_mode;
+	struct recovery_info_t recovery_info;
+
+	/* player.c */
+	Player players[MAX_PLAYERS];
+	GList *spectators;
+	gint turn_player;	/* whose turn is it */
+	gint my_player_id;	/* what is my player number */
+	gint num_total_players;	/* total number of players in the game */
+
+	/* resource.c */
+	gint bank[NO_RESOURCE];
+	gint my_assets[NO_RESOURCE];	/* my resources */
+
+	/* stock.c */
+	gint stock_roads;	/* number of roads available */
+	gint stock_ships;	/* number of ships available */
+	gint stock_bridges;	/* number of bridges available */
+	gint stock_settlements;	/* settlements available */
+	gint stock_cities;	/* cities available */
+	gint stock_city_walls;	/* city walls available */
+	guint stock_develop;	/* development cards left */
+
+	/* turn.c */
+	gboolean rolled_dice;	/* have we rolled the dice? */
+	gint current_turn;
+
+	/* build.c */
+	GList *build_list;
+	gboolean built;		/* have we build road / settlement / city? */
+	gint built_edges, built_settlements;
+
+	/* develop.c */
+	gboolean bought_develop;	/* have we bought a development card? */
+	guint num_playable_cards;	/* playable development cards */
+	gboolean is_unique[NUM_DEVEL_TYPES];	/* is each card unique? */
+	Deck *develop_deck;	/* our deck of development cards */
+
+	/* setup.c */
+	gboolean double_setup;
+};
 
 /* variables */
+extern ClientContext *client;	/* the current client */
 extern GameParams *game_params;
 extern NotifyingString *requested_name;
 extern NotifyingString *requested_style;
@@ -38,7 +108,7 @@ extern gboolean requested_spectator;
 void client_init(void);		/* before frontend initialization */
 void client_start(int argc, char **argv);	/* after frontend initialization */
 
-/* access the state machine (a client has only one state machine) */
+/* access the state machine of the current client */
 StateMachine *SM(void);
 
 /* state machine modes */
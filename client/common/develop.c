@@ -32,36 +32,30 @@
 #include "state.h"
 #include "callback.h"
 
-static gboolean bought_develop;	/* have we bought a development card? */
-static guint num_playable_cards;	/* number of playable development cards */
-
-static gboolean is_unique[NUM_DEVEL_TYPES];	/* is each card unique? */
-
-static Deck *develop_deck;	/* our deck of development cards */
-
 void develop_init(void)
 {
 	int idx;
-	if (develop_deck != NULL)
-		deck_free(develop_deck, NULL);
-	develop_deck = deck_new();
-	num_playable_cards = 0;
+	if (client->develop_deck != NULL)
+		deck_free(client->develop_deck, NULL);
+	client->develop_deck = deck_new();
+	client->num_playable_cards = 0;
 	for (idx = 0; idx < NUM_DEVEL_TYPES; idx++)
-		is_unique[idx] = game_params->num_develop_type[idx] == 1;
+		client->is_unique[idx] =
+		    game_params->num_develop_type[idx] == 1;
 }
 
 void develop_bought_card_turn(DevelType type, gboolean bought_this_turn)
 {
-	deck_add_guint(develop_deck, type);
+	deck_add_guint(client->develop_deck, type);
 	if (bought_this_turn) {
 		/* Cannot undo build after buying a development card
 		 */
 		build_clear();
-		bought_develop = TRUE;
+		client->bought_develop = TRUE;
 		/* Only log if the cards is bought in the current turn.
 		 * This function is also called during reconnect
 		 */
-		if (is_unique[type])
+		if (client->is_unique[type])
 			log_message(MSG_DEVCARD,
 				    /* This development card is unique */
 				    _(""
@@ -74,7 +68,7 @@ void develop_bought_card_turn(DevelType type, gboolean bought_this_turn)
 				      "You bought a %s development card.\n"),
 				    get_devel_name(type));
 	} else {
-		num_playable_cards++;
+		client->num_playable_cards++;
 	}
 	player_modify_statistic(my_player_num(), STAT_DEVELOPMENT, 1);
 	stock_use_develop();
@@ -88,14 +82,14 @@ void develop_bought_card(DevelType type)
 
 guint get_num_playable_cards(void)
 {
-	return num_playable_cards;
+	return client->num_playable_cards;
 }
 
 void develop_reset_have_played_bought(gboolean have_bought,
 				      guint number_playable_cards)
 {
-	bought_develop = have_bought;
-	num_playable_cards = number_playable_cards;
+	client->bought_develop = have_bought;
+	client->num_playable_cards = number_playable_cards;
 }
 
 void develop_bought(gint player_num)
@@ -110,13 +104,14 @@ void develop_bought(gint player_num)
 void develop_played(gint player_num, guint card_idx, DevelType type)
 {
 	if (player_num == my_player_num()) {
-		deck_card_play(develop_deck, num_playable_cards, card_idx);
+		deck_card_play(client->develop_deck,
+			       client->num_playable_cards, card_idx);
 		if (!is_victory_card(type))
-			num_playable_cards = 0;
+			client->num_playable_cards = 0;
 	}
 	callbacks.played_develop(player_num, card_idx, type);
 
-	if (is_unique[type])
+	if (client->is_unique[type])
 		log_message(MSG_DEVCARD,
 			    _("%s played the %s development card.\n"),
 			    player_name(player_num, TRUE),
@@ -198,15 +193,16 @@ void monopoly_player(gint player_num, gint victim_num, gint num,
 
 void develop_begin_turn(void)
 {
-	bought_develop = FALSE;
-	num_playable_cards = deck_count(develop_deck);
+	client->bought_develop = FALSE;
+	client->num_playable_cards = deck_count(client->develop_deck);
 }
 
 gboolean can_play_develop(guint card)
 {
-	if (!deck_card_playable(develop_deck, num_playable_cards, card))
+	if (!deck_card_playable
+	    (client->develop_deck, client->num_playable_cards, card))
 		return FALSE;
-	if (deck_get_guint(develop_deck, card) == DEVEL_ROAD_BUILDING
+	if (deck_get_guint(client->develop_deck, card) == DEVEL_ROAD_BUILDING
 	    && !road_building_can_build_road()
 	    && !road_building_can_build_ship()
 	    && !road_building_can_build_bridge())
@@ -218,7 +214,7 @@ gboolean can_play_develop(guint card)
 gboolean can_play_any_develop(void)
 {
 	guint i;
-	for (i = 0; i < deck_count(develop_deck); ++i)
+	for (i = 0; i < deck_count(client->develop_deck); ++i)
 		if (can_play_develop(i))
 			return TRUE;
 	return FALSE;
@@ -232,10 +228,10 @@ gboolean can_buy_develop(void)
 
 gboolean have_bought_develop(void)
 {
-	return bought_develop;
+	return client->bought_develop;
 }
 
 const Deck *get_devel_deck(void)
 {
-	return develop_deck;
+	return client->develop_deck;
 }
@@ -30,13 +30,6 @@
 #include "log.h"
 #include "callback.h"
 
-static Player players[MAX_PLAYERS];
-static GList *spectators;
-
-static gint turn_player = -1;	/* whose turn is it */
-static gint my_player_id = -1;	/* what is my player number */
-static gint num_total_players = 4;	/* total number of players in the game */
-
 /* this function is called when the game starts, to clean up from the
  * previous game. */
 void player_reset(void)
@@ -45,49 +38,51 @@ void player_reset(void)
 	guint idx;
 
 	/* remove all spectators */
-	while (spectators != NULL) {
-		Spectator *spectator = spectators->data;
+	while (client->spectators != NULL) {
+		Spectator *spectator = client->spectators->data;
 		g_free(spectator->name);
 		g_free(spectator->style);
-		spectators = g_list_remove(spectators, spectator);
+		client->spectators =
+		    g_list_remove(client->spectators, spectator);
 	}
 	/* free player's memory */
 	for (i = 0; i < MAX_PLAYERS; ++i) {
-		if (players[i].name != NULL) {
-			g_free(players[i].name);
-			players[i].name = NULL;
+		if (client->players[i].name != NULL) {
+			g_free(client->players[i].name);
+			client->players[i].name = NULL;
 		}
-		if (players[i].style != NULL) {
-			g_free(players[i].style);
-			players[i].style = NULL;
+		if (client->players[i].style != NULL) {
+			g_free(client->players[i].style);
+			client->players[i].style = NULL;
 		}
-		while (players[i].points != NULL) {
-			Points *points = players[i].points->data;
-			players[i].points =
-			    g_list_remove(players[i].points, points);
+		while (client->players[i].points != NULL) {
+			Points *points = client->players[i].points->data;
+			client->players[i].points =
+			    g_list_remove(client->players[i].points, points);
 			points_free(points);
 			g_free(points);
 		}
-		for (idx = 0; idx < G_N_ELEMENTS(players[i].statistics);
+		for (idx = 0; idx < G_N_ELEMENTS(client->players[i].statistics);
 		     ++idx)
-			players[i].statistics[idx] = 0;
+			client->players[i].statistics[idx] = 0;
 	}
 }
 
 Player *player_get(gint num)
 {
-	return &players[num];
+	return &client->players[num];
 }
 
 gboolean player_is_spectator(gint num)
 {
-	return num < 0 || num >= num_total_players;
+	return num < 0 || num >= client->num_total_players;
 }
 
 Spectator *spectator_get(gint num)
 {
 	GList *list;
-	for (list = spectators; list != NULL; list = g_list_next(list)) {
+	for (list = client->spectators; list != NULL;
+	     list = g_list_next(list)) {
 		Spectator *spectator = list->data;
 		if (spectator->num == num)
 			break;
@@ -104,7 +99,8 @@ Spectator *spectator_get(gint num)
 gint find_spectator_by_name(const gchar * name)
 {
 	GList *list;
-	for (list = spectators; list != NULL; list = g_list_next(list)) {
+	for (list = client->spectators; list != NULL;
+	     list = g_list_next(list)) {
 		Spectator *spectator = list->data;
 		if (!strcmp(spectator->name, name))
 			return spectator->num;
@@ -115,7 +111,7 @@ gint find_spectator_by_name(const gchar * name)
 const gchar *player_name(gint player_num, gboolean word_caps)
 {
 	static gchar buff[256];
-	if (player_num >= num_total_players) {
+	if (player_num >= client->num_total_players) {
 		/* this is about a spectator */
 		Spectator *spectator = spectator_get(player_num);
 		if (spectator != NULL)
@@ -162,17 +158,17 @@ gint player_get_score(gint player_num)
 
 gint my_player_num(void)
 {
-	return my_player_id;
+	return client->my_player_id;
 }
 
 gint num_players(void)
 {
-	return num_total_players;
+	return client->num_total_players;
 }
 
 void player_set_my_num(gint player_num)
 {
-	my_player_id = player_num;
+	client->my_player_id = player_num;
 }
 
 void player_modify_statistic(gint player_num, StatisticType type, gint num)
@@ -198,13 +194,14 @@ void player_change_name(gint player_num, const gchar * name)
 
 	if (player_num < 0)
 		return;
-	if (player_num >= num_total_players) {
+	if (player_num >= client->num_total_players) {
 		/* this is about a spectator */
 		Spectator *spectator = spectator_get(player_num);
 		if (spectator == NULL) {
 			/* there is a new spectator */
 			spectator = g_malloc0(sizeof(*spectator));
-			spectators = g_list_prepend(spectators, spectator);
+			client->spectators =
+			    g_list_prepend(client->spectators, spectator);
 			spectator->num = player_num;
 			spectator->name = NULL;
 			spectator->style = g_strdup(default_player_style);
@@ -256,13 +253,14 @@ void player_has_quit(gint player_num)
 	 * Here it is called before, so the frontend can access the
 	 * information about the quitting player/spectator */
 
-	if (player_num >= num_total_players) {
+	if (player_num >= client->num_total_players) {
 		/* a spectator has quit */
 		callbacks.spectator_quit(player_num);
 		spectator = spectator_get(player_num);
 		g_free(spectator->name);
 		g_free(spectator->style);
-		spectators = g_list_remove(spectators, spectator);
+		client->spectators =
+		    g_list_remove(client->spectators, spectator);
 		return;
 	}
 	callbacks.player_quit(player_num);
@@ -280,7 +278,7 @@ void player_largest_army(gint player_num)
 		log_message(MSG_LARGESTARMY,
 			    _("%s has the largest army.\n"),
 			    player_name(player_num, TRUE));
-	for (idx = 0; idx < num_total_players; idx++) {
+	for (idx = 0; idx < client->num_total_players; idx++) {
 		Player *player = player_get(idx);
 		if (player->statistics[STAT_LARGEST_ARMY] != 0
 		    && idx != player_num)
@@ -305,7 +303,7 @@ void player_longest_road(gint player_num)
 			    _("%s has the longest road.\n"),
 			    player_name(player_num, TRUE));
 
-	for (idx = 0; idx < num_total_players; idx++) {
+	for (idx = 0; idx < client->num_total_players; idx++) {
 		Player *player = player_get(idx);
 
 		if (player->statistics[STAT_LONGEST_ROAD] != 0
@@ -320,7 +318,7 @@ void player_longest_road(gint player_num)
 
 void player_set_current(gint player_num)
 {
-	turn_player = player_num;
+	client->turn_player = player_num;
 	if (player_num != my_player_num()) {
 		gchar *buffer;
 		buffer = g_strdup_printf(_("Waiting for %s."),
@@ -334,7 +332,7 @@ void player_set_current(gint player_num)
 
 void player_set_total_num(gint num)
 {
-	num_total_players = num;
+	client->num_total_players = num;
 }
 
 void player_stole_from(gint player_num, gint victim_num, Resource resource)
@@ -763,7 +761,7 @@ void player_take_point(gint player_num, gint id, gint old_owner)
 
 void player_set_style(gint player_num, const gchar * style)
 {
-	if (player_num >= num_total_players) {
+	if (player_num >= client->num_total_players) {
 		Spectator *spectator = spectator_get(player_num);
 		if (spectator->style)
 			g_free(spectator->style);
@@ -779,7 +777,7 @@ void player_set_style(gint player_num, const gchar * style)
 const gchar *player_get_style(gint player_num)
 {
 	const gchar *style = NULL;
-	if (player_num >= num_total_players) {
+	if (player_num >= client->num_total_players) {
 		Spectator *spectator = spectator_get(player_num);
 		style = spectator->style;
 	} else if (player_num >= 0) {
@@ -791,7 +789,7 @@ const gchar *player_get_style(gint player_num)
 
 gint current_player(void)
 {
-	return turn_player;
+	return client->turn_player;
 }
 
 const gchar *my_player_name(void)
@@ -814,13 +812,14 @@ gint find_player_by_name(const gchar * name)
 	gint i;
 	GList *list;
 
-	for (i = 0; i < num_total_players; i++) {
+	for (i = 0; i < client->num_total_players; i++) {
 		Player *player = player_get(i);
 		if (player->name && !strcmp(player->name, name))
 			return i;
 	}
 
-	for (list = spectators; list != NULL; list = g_list_next(list)) {
+	for (list = client->spectators; list != NULL;
+	     list = g_list_next(list)) {
 		Spectator *spectator = list->data;
 		if (!strcmp(spectator->name, name))
 			return spectator->num;
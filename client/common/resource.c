@@ -29,8 +29,6 @@
 #include "game.h"
 #include "map.h"
 
-static gint bank[NO_RESOURCE];
-
 static const gchar *resource_names[][2] = {
 	{N_("brick"), N_("Brick")},
 	{N_("grain"), N_("Grain")},
@@ -56,8 +54,6 @@ typedef enum {
 	RESOURCE_MULTICARD
 } ResourceListType;
 
-static gint my_assets[NO_RESOURCE];	/* my resources */
-
 static const gchar *resource_list(Resource type, ResourceListType grammar)
 {
 	return _(resource_lists[type][grammar]);
@@ -69,7 +65,7 @@ void resource_init(void)
 	gint idx;
 
 	for (idx = 0; idx < NO_RESOURCE; idx++) {
-		my_assets[idx] = 0;
+		client->my_assets[idx] = 0;
 		resource_modify(idx, 0);
 	};
 }
@@ -119,7 +115,7 @@ gint resource_count(const gint * resources)
 
 gint resource_total(void)
 {
-	return resource_count(my_assets);
+	return resource_count(client->my_assets);
 }
 
 gchar *resource_format_num(const gint * resources)
@@ -189,18 +185,18 @@ void resource_log_list(gint player_num, const gchar * action,
 
 void resource_modify(Resource type, gint num)
 {
-	my_assets[type] += num;
-	callbacks.resource_change(type, my_assets[type]);
+	client->my_assets[type] += num;
+	callbacks.resource_change(type, client->my_assets[type]);
 }
 
 gboolean can_afford(const gint * cost)
 {
-	return cost_can_afford(cost, my_assets);
+	return cost_can_afford(cost, client->my_assets);
 }
 
 gint resource_asset(Resource type)
 {
-	return my_assets[type];
+	return client->my_assets[type];
 }
 
 const gchar *resource_name(Resource type, gboolean word_caps)
@@ -259,21 +255,21 @@ void resource_format_type(gchar * str, const gint * resources)
 
 const gint *get_bank(void)
 {
-	return bank;
+	return client->bank;
 }
 
 void set_bank(const gint * new_bank)
 {
 	gint idx;
 	for (idx = 0; idx < NO_RESOURCE; ++idx)
-		bank[idx] = new_bank[idx];
-	callbacks.new_bank(bank);
+		client->bank[idx] = new_bank[idx];
+	callbacks.new_bank(client->bank);
 }
 
 void modify_bank(const gint * bank_change)
 {
 	gint idx;
 	for (idx = 0; idx < NO_RESOURCE; ++idx)
-		bank[idx] += bank_change[idx];
-	callbacks.new_bank(bank);
+		client->bank[idx] += bank_change[idx];
+	callbacks.new_bank(client->bank);
 }
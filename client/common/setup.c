@@ -29,18 +29,16 @@
 #include "log.h"
 #include "client.h"
 
-static gboolean double_setup;
-
 gboolean is_setup_double(void)
 {
-	return double_setup;
+	return client->double_setup;
 }
 
 gboolean setup_can_build_road(void)
 {
 	if (game_params->num_build_type[BUILD_ROAD] == 0)
 		return FALSE;
-	if (double_setup) {
+	if (client->double_setup) {
 		if (build_count_edges() == 2)
 			return FALSE;
 		return build_count_settlements() < 2
@@ -59,7 +57,7 @@ gboolean setup_can_build_ship(void)
 {
 	if (game_params->num_build_type[BUILD_SHIP] == 0)
 		return FALSE;
-	if (double_setup) {
+	if (client->double_setup) {
 		if (build_count_edges() == 2)
 			return FALSE;
 		return build_count_settlements() < 2
@@ -78,7 +76,7 @@ gboolean setup_can_build_bridge(void)
 {
 	if (game_params->num_build_type[BUILD_BRIDGE] == 0)
 		return FALSE;
-	if (double_setup) {
+	if (client->double_setup) {
 		if (build_count_edges() == 2)
 			return FALSE;
 		return build_count_settlements() < 2
@@ -97,7 +95,7 @@ gboolean setup_can_build_settlement(void)
 {
 	if (game_params->num_build_type[BUILD_SETTLEMENT] == 0)
 		return FALSE;
-	if (double_setup)
+	if (client->double_setup)
 		return build_count_settlements() < 2;
 	else
 		return build_count_settlements() < 1;
@@ -105,7 +103,7 @@ gboolean setup_can_build_settlement(void)
 
 gboolean setup_can_finish(void)
 {
-	if (double_setup)
+	if (client->double_setup)
 		return build_count_edges() == 2
 		    && build_count_settlements() == 2 && build_is_valid();
 	else
@@ -117,28 +115,28 @@ gboolean setup_can_finish(void)
  */
 gboolean setup_check_road(const Edge * edge)
 {
-	return build_can_setup_road(edge, double_setup);
+	return build_can_setup_road(edge, client->double_setup);
 }
 
 /* Place some restrictions on ship placement during setup phase
  */
 gboolean setup_check_ship(const Edge * edge)
 {
-	return build_can_setup_ship(edge, double_setup);
+	return build_can_setup_ship(edge, client->double_setup);
 }
 
 /* Place some restrictions on bridge placement during setup phase
  */
 gboolean setup_check_bridge(const Edge * edge)
 {
-	return build_can_setup_bridge(edge, double_setup);
+	return build_can_setup_bridge(edge, client->double_setup);
 }
 
 /* Place some restrictions on settlement placement during setup phase
  */
 gboolean setup_check_settlement(const Node * node)
 {
-	return build_can_setup_settlement(node, double_setup);
+	return build_can_setup_settlement(node, client->double_setup);
 }
 
 void setup_begin(gint player_num)
@@ -149,7 +147,7 @@ void setup_begin(gint player_num)
 	if (player_num != my_player_num())
 		return;
 
-	double_setup = FALSE;
+	client->double_setup = FALSE;
 	build_clear();
 }
 
@@ -161,6 +159,6 @@ void setup_begin_double(gint player_num)
 	if (player_num != my_player_num())
 		return;
 
-	double_setup = TRUE;
+	client->double_setup = TRUE;
 	build_clear();
 }
@@ -28,147 +28,140 @@
 #include "client.h"
 #include "callback.h"
 
-static gint num_roads;		/* number of roads available */
-static gint num_ships;		/* number of ships available */
-static gint num_bridges;	/* number of bridges available */
-static gint num_settlements;	/* settlements available */
-static gint num_cities;		/* cities available */
-static gint num_city_walls;	/* city walls available */
-static guint num_develop;	/* development cards left */
-
 void stock_init(void)
 {
 	guint idx;
 
-	num_roads = game_params->num_build_type[BUILD_ROAD];
-	num_ships = game_params->num_build_type[BUILD_SHIP];
-	num_bridges = game_params->num_build_type[BUILD_BRIDGE];
-	num_settlements = game_params->num_build_type[BUILD_SETTLEMENT];
-	num_cities = game_params->num_build_type[BUILD_CITY];
-	num_city_walls = game_params->num_build_type[BUILD_CITY_WALL];
+	client->stock_roads = game_params->num_build_type[BUILD_ROAD];
+	client->stock_ships = game_params->num_build_type[BUILD_SHIP];
+	client->stock_bridges = game_params->num_build_type[BUILD_BRIDGE];
+	client->stock_settlements =
+	    game_params->num_build_type[BUILD_SETTLEMENT];
+	client->stock_cities = game_params->num_build_type[BUILD_CITY];
+	client->stock_city_walls = game_params->num_build_type[BUILD_CITY_WALL];
 
-	num_develop = 0;
+	client->stock_develop = 0;
 	for (idx = 0; idx < G_N_ELEMENTS(game_params->num_develop_type);
 	     idx++)
-		num_develop += game_params->num_develop_type[idx];
+		client->stock_develop += game_params->num_develop_type[idx];
 }
 
 gint stock_num_roads(void)
 {
-	return num_roads;
+	return client->stock_roads;
 }
 
 void stock_use_road(void)
 {
-	num_roads--;
+	client->stock_roads--;
 	callbacks.update_stock();
 }
 
 void stock_replace_road(void)
 {
-	num_roads++;
+	client->stock_roads++;
 	callbacks.update_stock();
 }
 
 gint stock_num_ships(void)
 {
-	return num_ships;
+	return client->stock_ships;
 }
 
 void stock_use_ship(void)
 {
-	num_ships--;
+	client->stock_ships--;
 	callbacks.update_stock();
 }
 
 void stock_replace_ship(void)
 {
-	num_ships++;
+	client->stock_ships++;
 	callbacks.update_stock();
 }
 
 gint stock_num_bridges(void)
 {
-	return num_bridges;
+	return client->stock_bridges;
 }
 
 void stock_use_bridge(void)
 {
-	num_bridges--;
+	client->stock_bridges--;
 	callbacks.update_stock();
 }
 
 void stock_replace_bridge(void)
 {
-	num_bridges++;
+	client->stock_bridges++;
 	callbacks.update_stock();
 }
 
 gint stock_num_settlements(void)
 {
-	return num_settlements;
+	return client->stock_settlements;
 }
 
 void stock_use_settlement(void)
 {
-	num_settlements--;
+	client->stock_settlements--;
 	callbacks.update_stock();
 }
 
 void stock_replace_settlement(void)
 {
-	num_settlements++;
+	client->stock_settlements++;
 	callbacks.update_stock();
 }
 
 gint stock_num_cities(void)
 {
-	return num_cities;
+	return client->stock_cities;
 }
 
 void stock_use_city(void)
 {
-	num_cities--;
+	client->stock_cities--;
 	callbacks.update_stock();
 }
 
 void stock_replace_city(void)
 {
-	num_cities++;
+	client->stock_cities++;
 	callbacks.update_stock();
 }
 
 gint stock_num_city_walls(void)
 {
-	return num_city_walls;
+	return client->stock_city_walls;
 }
 
 void stock_use_city_wall(void)
 {
-	num_city_walls--;
+	client->stock_city_walls--;
 	callbacks.update_stock();
 }
 
 void stock_replace_city_wall(void)
 {
-	num_city_walls++;
+	client->stock_city_walls++;
 	callbacks.update_stock();
 }
 
 
 guint stock_num_develop(void)
 {
-	return num_develop;
+	return client->stock_develop;
 }
 
 void stock_use_develop(void)
 {
-	num_develop--;
+	client->stock_develop--;
 }
 
 /** Do not count the next development card.
 */
 void stock_dont_count_develop(void)
 {
-	num_develop++;
+	client->stock_develop++;
 }
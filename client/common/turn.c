@@ -26,9 +26,6 @@
 #include "client.h"
 #include "callback.h"
 
-static gboolean rolled_dice;	/* have we rolled the dice? */
-static gint current_turn;
-
 void turn_rolled_dice(gint player_num, gint die1, gint die2)
 {
 	int roll;
@@ -38,7 +35,7 @@ void turn_rolled_dice(gint player_num, gint die1, gint die2)
 		    player_name(player_num, TRUE), roll);
 
 	if (player_num == my_player_num()) {
-		rolled_dice = TRUE;
+		client->rolled_dice = TRUE;
 		callbacks.get_map()->has_moved_ship = FALSE;
 	}
 	callbacks.rolled_dice(die1, die2, player_num);
@@ -46,10 +43,10 @@ void turn_rolled_dice(gint player_num, gint die1, gint die2)
 
 void turn_begin(gint player_num, gint num)
 {
-	current_turn = num;
+	client->current_turn = num;
 	log_message(MSG_DICE, _("Begin turn %d for %s.\n"),
 		    num, player_name(player_num, FALSE));
-	rolled_dice = FALSE;
+	client->rolled_dice = FALSE;
 	player_set_current(player_num);
 	develop_begin_turn();
 	build_clear();
@@ -58,10 +55,10 @@ void turn_begin(gint player_num, gint num)
 
 gint turn_num(void)
 {
-	return current_turn;
+	return client->current_turn;
 }
 
 gboolean have_rolled_dice(void)
 {
-	return rolled_dice;
+	return client->rolled_dice;
 }
@@ -28,7 +28,7 @@
 static void frontend_network_status(const gchar * description)
 {
 	gui_set_net_status(description);
-	frontend_gui_update();
+	frontend_gui_update_facets(0);
 }
 
 static void frontend_instructions(const gchar * message)
@@ -40,7 +40,7 @@ static void frontend_instructions(const gchar * message)
 static void frontend_network_wait(gboolean is_waiting)
 {
 	frontend_waiting_for_network = is_waiting;
-	frontend_gui_update();
+	frontend_gui_update_facets(0);
 }
 
 static void frontend_start_game(void)
@@ -57,7 +57,7 @@ static void frontend_start_game(void)
 static void frontend_draw_edge(Edge * edge)
 {
 	gui_draw_edge(edge);
-	frontend_gui_update();
+	frontend_gui_update_facets(GUI_FACET_MAP);
 
 	ogreb_map_edge_updates(edge);
 }
@@ -65,7 +65,7 @@ static void frontend_draw_edge(Edge * edge)
 static void frontend_draw_node(Node * node)
 {
 	gui_draw_node(node);
-	frontend_gui_update();
+	frontend_gui_update_facets(GUI_FACET_MAP);
 
 	ogreb_map_node_updates(node);
 }
@@ -73,13 +73,13 @@ static void frontend_draw_node(Node * node)
 static void frontend_draw_hex(Hex * hex)
 {
 	gui_draw_hex(hex);
-	frontend_gui_update();
+	frontend_gui_update_facets(GUI_FACET_MAP);
 }
 
 static void frontend_update_stock(void)
 {
 	identity_draw();
-	frontend_gui_update();
+	frontend_gui_update_facets(GUI_FACET_HAND);
 }
 
 static void frontend_player_turn(gint player)
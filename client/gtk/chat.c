@@ -227,7 +227,7 @@ static void beep_player(gint beeping_player, const gchar * name)
 	if (beeped_player != -1) {
 		if (beeped_player == my_player_num()) {
 			play_sound(SOUND_BEEP);
-			frontend_gui_update();
+			frontend_gui_update_facets(0);
 			if (beeping_player == my_player_num())
 				log_message(MSG_BEEP, _("Beeper test.\n"));
 			else
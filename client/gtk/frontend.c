@@ -24,9 +24,30 @@
 
 static const int MAX_NUMBER_OF_WIDGETS_PER_EVENT = 2;
 
+/* The results of the rules passed to frontend_gui_rule */
+#define MAX_CACHED_RULES 32
+
+typedef struct {
+	GuiRuleFunc rule;
+	GuiFacet facets;	/* the facets the result depends on */
+	gboolean valid;
+	gboolean value;
+} CachedRule;
+
 GHashTable *frontend_widgets;
 gboolean frontend_waiting_for_network;
 
+static guint update_source;
+static GuiFacet dirty_facets;
+static CachedRule cached_rules[MAX_CACHED_RULES];
+static guint num_cached_rules;
+
+/* Statistics for the debug log */
+static guint num_evaluations;
+static guint num_cache_hits;
+static guint num_updates;
+static gint64 stats_start;
+
 static void set_sensitive(G_GNUC_UNUSED void *key, GuiWidgetState * gui,
 			  G_GNUC_UNUSED void *user_data)
 {
@@ -81,14 +102,77 @@ void frontend_gui_register_init(void)
 	frontend_widgets = g_hash_table_new(NULL, NULL);
 }
 
-void frontend_gui_update(void)
+static void report_statistics(void)
+{
+	gint64 now = g_get_monotonic_time();
+	gint64 elapsed;
+
+	if (stats_start == 0)
+		stats_start = now;
+	elapsed = now - stats_start;
+	if (elapsed < G_USEC_PER_SEC)
+		return;
+
+	debug("GUI update: %.1f updates, %.1f rule evaluations, "
+	      "%.1f cached results per second",
+	      (gdouble) num_updates * G_USEC_PER_SEC / elapsed,
+	      (gdouble) num_evaluations * G_USEC_PER_SEC / elapsed,
+	      (gdouble) num_cache_hits * G_USEC_PER_SEC / elapsed);
+	num_updates = 0;
+	num_evaluations = 0;
+	num_cache_hits = 0;
+	stats_start = now;
+}
+
+static void do_update(void)
 {
+	guint idx;
+
+	/* Forget the results that depend on what has changed */
+	for (idx = 0; idx < num_cached_rules; idx++)
+		if (cached_rules[idx].facets & dirty_facets)
+			cached_rules[idx].valid = FALSE;
+	dirty_facets = 0;
+
 	route_gui_event(GUI_UPDATE);
 	g_hash_table_foreach(frontend_widgets, (GHFunc) set_sensitive,
 			     NULL);
+
+	num_updates++;
+	report_statistics();
 }
 
-void frontend_gui_check(GuiEvent event, gboolean sensitive)
+static gboolean update_cb(G_GNUC_UNUSED gpointer user_data)
+{
+	update_source = 0;
+	do_update();
+	return FALSE;
+}
+
+void frontend_gui_update_facets(GuiFacet changed)
+{
+	dirty_facets |= changed;
+	if (update_source == 0)
+		update_source =
+		    g_idle_add_full(G_PRIORITY_HIGH_IDLE, update_cb, NULL,
+				    NULL);
+}
+
+void frontend_gui_update(void)
+{
+	frontend_gui_update_facets(GUI_FACET_ALL);
+}
+
+void frontend_gui_flush(void)
+{
+	if (update_source != 0) {
+		g_source_remove(update_source);
+		update_source = 0;
+		do_update();
+	}
+}
+
+static void set_next(GuiEvent event, gboolean sensitive)
 {
 	GuiWidgetState *gui;
 	gint i;
@@ -103,12 +187,51 @@ void frontend_gui_check(GuiEvent event, gboolean sensitive)
 	}
 }
 
+void frontend_gui_check(GuiEvent event, gboolean sensitive)
+{
+	num_evaluations++;
+	set_next(event, sensitive);
+}
+
+void frontend_gui_rule(GuiEvent event, GuiFacet facets, GuiRuleFunc rule)
+{
+	CachedRule *cached = NULL;
+	guint idx;
+
+	for (idx = 0; idx < num_cached_rules; idx++)
+		if (cached_rules[idx].rule == rule) {
+			cached = &cached_rules[idx];
+			break;
+		}
+	if (cached == NULL) {
+		if (num_cached_rules == MAX_CACHED_RULES) {
+			frontend_gui_check(event, rule());
+			return;
+		}
+		cached = &cached_rules[num_cached_rules++];
+		cached->rule = rule;
+		cached->valid = FALSE;
+	}
+	cached->facets = facets;
+
+	if (cached->valid) {
+		num_cache_hits++;
+	} else {
+		num_evaluations++;
+		cached->value = rule();
+		cached->valid = TRUE;
+	}
+	set_next(event, cached->value);
+}
+
 gboolean frontend_gui_get_sensitive(GuiEvent event)
 {
 	GuiWidgetState *gui;
 	gint i;
 	gint key = event * MAX_NUMBER_OF_WIDGETS_PER_EVENT;
 
+	frontend_gui_flush();
+
 	/* Look at all related widgets */
 	for (i = 0; i < MAX_NUMBER_OF_WIDGETS_PER_EVENT; ++i) {
 		gui = g_hash_table_lookup(frontend_widgets,
@@ -157,6 +280,7 @@ static void gui_free(GuiWidgetState * gui)
 
 static void route_event(G_GNUC_UNUSED void *widget, GuiWidgetState * gui)
 {
+	frontend_gui_flush();
 	route_gui_event(gui->id);
 }
 
@@ -215,6 +339,7 @@ gint hotkeys_handler(G_GNUC_UNUSED GtkWidget * w, GdkEvent * e,
 	default:
 		return 0;	/* not handled */
 	}
+	frontend_gui_flush();
 	gui = g_hash_table_lookup(frontend_widgets,
 				  GINT_TO_POINTER(arg *
 						  MAX_NUMBER_OF_WIDGETS_PER_EVENT));
@@ -74,15 +74,46 @@ typedef struct {
 	gboolean next;		/* should widget be sensitive? */
 } GuiWidgetState;
 
+/* The parts of the game state that a sensitivity rule depends on */
+typedef enum {
+	GUI_FACET_MAP = 1 << 0,	/* the hexes and pieces on the map */
+	GUI_FACET_HAND = 1 << 1,	/* resources, cards and stock */
+	GUI_FACET_TURN = 1 << 2,	/* the turn, the builds and the state */
+	GUI_FACET_ALL = GUI_FACET_MAP | GUI_FACET_HAND | GUI_FACET_TURN
+} GuiFacet;
+
+typedef gboolean(*GuiRuleFunc) (void);
+
 /** all widgets are inactive while waiting for network. */
 extern gboolean frontend_waiting_for_network;
 
-/** set all widgets to their programmed state. */
+/** set all widgets to their programmed state.
+ * The update is done when the main loop is idle, many calls in a row
+ * result in a single update.
+ */
 void frontend_gui_update(void);
 
+/** set all widgets to their programmed state, only the rules that
+ * depend on the changed facets are evaluated again.
+ * @param changed The facets that have changed, 0 when only
+ *                the waiting for network state has changed
+ */
+void frontend_gui_update_facets(GuiFacet changed);
+
+/** do a pending update now. */
+void frontend_gui_flush(void);
+
 /** program the state of a widget for when frontend_gui_update is called. */
 void frontend_gui_check(GuiEvent event, gboolean sensitive);
 
+/** program the state of a widget with the result of a rule.
+ * The result is reused until one of the facets has changed.
+ * @param event The GuiEvent
+ * @param facets The facets the rule depends on
+ * @param rule The rule
+ */
+void frontend_gui_rule(GuiEvent event, GuiFacet facets, GuiRuleFunc rule);
+
 /** are the widgets sensitive?
  * @param event The GuiEvent.
  * @return TRUE when the GuiEvent has widgets associated that are sensitive.
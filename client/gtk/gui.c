@@ -633,8 +633,9 @@ static void gui_theme_changed(void)
 {
 	g_assert(legend_page != NULL);
 	gtk_widget_queue_draw(legend_page);
-	gtk_widget_queue_draw_area(gmap->area, 0, 0, gmap->width,
-				   gmap->height);
+	/* The tiles have changed, draw the layers again */
+	guimap_discard_layers(gmap);
+	gtk_widget_queue_draw(gmap->area);
 }
 
 void gui_show_legend_page(gboolean show)
@@ -920,10 +921,7 @@ static void theme_change_cb(GtkWidget * widget, G_GNUC_UNUSED void *data)
 	if (theme != theme_get_current()) {
 		config_set_string("settings/theme", theme->name);
 		theme_set_current(theme);
-		if (gmap->surface != NULL) {
-			cairo_surface_destroy(gmap->surface);
-			gmap->surface = NULL;
-		}
+		guimap_discard_layers(gmap);
 		theme_rescale(2 * gmap->x_point);
 	}
 
@@ -328,16 +328,22 @@ static void frontend_state_turn(GuiEvent event)
 	case GUI_UPDATE:
 		frontend_gui_check(GUI_ROLL, !have_rolled_dice());
 		frontend_gui_check(GUI_UNDO, can_undo());
-		frontend_gui_check(GUI_ROAD, turn_can_build_road());
-		frontend_gui_check(GUI_SHIP, turn_can_build_ship());
-		frontend_gui_check(GUI_MOVE_SHIP, turn_can_move_ship());
-		frontend_gui_check(GUI_BRIDGE, turn_can_build_bridge());
-		frontend_gui_check(GUI_SETTLEMENT,
-				   turn_can_build_settlement());
-		frontend_gui_check(GUI_CITY, turn_can_build_city());
-		frontend_gui_check(GUI_CITY_WALL,
-				   turn_can_build_city_wall());
-		frontend_gui_check(GUI_TRADE, turn_can_trade());
+		frontend_gui_rule(GUI_ROAD, GUI_FACET_ALL,
+				  turn_can_build_road);
+		frontend_gui_rule(GUI_SHIP, GUI_FACET_ALL,
+				  turn_can_build_ship);
+		frontend_gui_rule(GUI_MOVE_SHIP,
+				  GUI_FACET_MAP | GUI_FACET_TURN,
+				  turn_can_move_ship);
+		frontend_gui_rule(GUI_BRIDGE, GUI_FACET_ALL,
+				  turn_can_build_bridge);
+		frontend_gui_rule(GUI_SETTLEMENT, GUI_FACET_ALL,
+				  turn_can_build_settlement);
+		frontend_gui_rule(GUI_CITY, GUI_FACET_ALL,
+				  turn_can_build_city);
+		frontend_gui_rule(GUI_CITY_WALL, GUI_FACET_ALL,
+				  turn_can_build_city_wall);
+		frontend_gui_rule(GUI_TRADE, GUI_FACET_ALL, turn_can_trade);
 		frontend_gui_check(GUI_PLAY_DEVELOP,
 				   can_play_develop(develop_current_idx
 						    ()));
@@ -439,13 +445,14 @@ static void frontend_state_roadbuilding(GuiEvent event)
 	switch (event) {
 	case GUI_UPDATE:
 		frontend_gui_check(GUI_UNDO, can_undo());
-		frontend_gui_check(GUI_ROAD,
-				   road_building_can_build_road());
-		frontend_gui_check(GUI_SHIP,
-				   road_building_can_build_ship());
-		frontend_gui_check(GUI_BRIDGE,
-				   road_building_can_build_bridge());
-		frontend_gui_check(GUI_FINISH, road_building_can_finish());
+		frontend_gui_rule(GUI_ROAD, GUI_FACET_ALL,
+				  road_building_can_build_road);
+		frontend_gui_rule(GUI_SHIP, GUI_FACET_ALL,
+				  road_building_can_build_ship);
+		frontend_gui_rule(GUI_BRIDGE, GUI_FACET_ALL,
+				  road_building_can_build_bridge);
+		frontend_gui_rule(GUI_FINISH, GUI_FACET_ALL,
+				  road_building_can_finish);
 		guimap_single_click_set_functions(check_road,
 						  build_road_cb,
 						  check_ship,
@@ -850,9 +857,13 @@ static void frontend_mode_setup(GuiEvent event)
 	switch (event) {
 	case GUI_UPDATE:
 		frontend_gui_check(GUI_UNDO, can_undo());
-		frontend_gui_check(GUI_ROAD, setup_can_build_road());
-		frontend_gui_check(GUI_BRIDGE, setup_can_build_bridge());
-		frontend_gui_check(GUI_SHIP, setup_can_build_ship());
+		frontend_gui_rule(GUI_ROAD, GUI_FACET_MAP | GUI_FACET_TURN,
+				  setup_can_build_road);
+		frontend_gui_rule(GUI_BRIDGE,
+				  GUI_FACET_MAP | GUI_FACET_TURN,
+				  setup_can_build_bridge);
+		frontend_gui_rule(GUI_SHIP, GUI_FACET_MAP | GUI_FACET_TURN,
+				  setup_can_build_ship);
 		frontend_gui_check(GUI_SETTLEMENT,
 				   setup_can_build_settlement());
 		frontend_gui_check(GUI_FINISH, setup_can_finish());
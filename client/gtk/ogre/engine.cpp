@@ -1,8 +1,15 @@
 #include "engine.h"
+#include "frame_scheduler.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace pogre {
+	// The scene has changed and must be drawn again
+	static void sceneChanged() {
+		if (frameScheduler) frameScheduler->requestFrame();
+	}
+
 	bool CameraControls :: isValidCoordinate(const Ogre::Vector3& v) const {
 		return (v.z > 0.01) && (Ogre::Vector3::ZERO.distance(v) < MAP_SIZE * 0.1);
 	}
@@ -30,6 +37,7 @@ namespace pogre {
 		//tiltMatrix
 		targetTiltPYR.x = ratioY * 1;
 		targetTiltPYR.y = -ratioX * 1;
+		moving = true;
 
 		if (rightGrabbed) {
 	    	auto newLocation = Ogre::Vector3(-evt.xrel, evt.yrel, 0) * 0.0005 + location->getPosition();
@@ -52,7 +60,10 @@ namespace pogre {
 
     bool CameraControls :: frameRenderingQueued(const Ogre::FrameEvent& evt)  {
     	auto mixFactor = pow(0.3, evt.timeSinceLastFrame);
-    	tiltPYR = mixFactor * tiltPYR + (1 - mixFactor) * (targetTiltPYR - tiltPYR);
+    	auto newTiltPYR = mixFactor * tiltPYR + (1 - mixFactor) * (targetTiltPYR - tiltPYR);
+    	// Stop drawing frames once the change is below a thousandth of a degree
+    	moving = (newTiltPYR - tiltPYR).squaredLength() > 1e-6;
+    	tiltPYR = newTiltPYR;
 
     	Ogre::Quaternion pitch, yaw;
     	pitch.FromAngleAxis(Ogre::Degree(tiltPYR.x), Ogre::Vector3::UNIT_X);
@@ -64,6 +75,7 @@ namespace pogre {
 
 	CameraControls :: CameraControls() {
 		rightGrabbed = false;
+		moving = false;
 
 		tiltPYR = Ogre::Vector3::ZERO;
 		targetTiltPYR = Ogre::Vector3::ZERO;
@@ -127,50 +139,98 @@ namespace pogre {
 
 			player->sceneNode->setPosition(pos);
 			player->sceneNode->setOrientation(rot);
+			player->markPiecesChanged();
 
 			player->applyNewMap(mapRenderer);
 		}
 	}
 
-	void Engine :: render(float stepSeconds) {
+	bool Engine :: render(float stepSeconds) {
+		// Frames keep the background queue going, the frame after the
+		// resources are ready shows the board
+		const bool loading = !resourceLoader->isReady();
+		const bool piecesMoving = animator->update(stepSeconds);
+
+		for (auto player : players) {
+			player->updatePieceGeometry();
+		}
+
+		profiler->beginFrame();
 		root->renderOneFrame(stepSeconds);
+		profiler->endFrame();
 
 		if (enableLightMovement) {
 			Ogre::Quaternion lightRotation(Ogre::Degree(30 * stepSeconds), Ogre::Vector3::UNIT_Z);
 			spotLightNode->setPosition(lightRotation * spotLightNode->getPosition());
 		}
+
+		return loading || piecesMoving || enableLightMovement || (cameraControls && cameraControls->isMoving());
 	}
 
 	void Engine :: startNewGame() {
+		if (!resourceLoader->isReady()) {
+			hasPendingGame = true;
+			return;
+		}
 		std::cout << "Ogre backend - starting new game" << std::endl;
 
 		int playerNumber = 0;
+		size_t pieces = 0;
 		players.clear();
 		for (gint playerId = 0; playerId < num_players(); playerId++) {
 			if (!player_is_spectator(playerId)) {
 				auto player = Player::Ptr(new Player(playerId, playerNumber++));
 				players.push_back(player);
+				pieces += player->villages.size() + player->cities.size() + player->roads.size();
 			}
 		}
+		// Every piece can move at the same time without growing the list
+		animator->reserve(pieces);
 
 		placePlayers();
+		sceneChanged();
 	}
 
 	void Engine :: loadNewMap(Map* map) {
+		if (!resourceLoader->isReady()) {
+			hasPendingMap = true;
+			pendingMap = map;
+			return;
+		}
 		robber->remove();
 		mapRenderer.reset();
 		if (map) {
+			// Building the board includes baking it into static geometry
+			const gint64 start = g_get_monotonic_time();
 			mapRenderer = MapRenderer::Ptr(new pogre::MapRenderer(map));
+			profiler->mapLoaded((g_get_monotonic_time() - start) / 1000.0);
 			placePlayers();
 			if (map->robber_hex) {
 				auto tile = mapRenderer->getTile(map->robber_hex);
 				robber->setTile(tile);
 			}
 		}
+		sceneChanged();
+	}
+
+	void Engine :: resourcesReady() {
+		robber = std::shared_ptr<Robber>(new Robber());
+
+		// The map first, the players are placed next to it
+		if (hasPendingMap) {
+			hasPendingMap = false;
+			loadNewMap(pendingMap);
+		}
+		if (hasPendingGame) {
+			hasPendingGame = false;
+			startNewGame();
+		}
+		sceneChanged();
 	}
 
 	void Engine :: updateNode(Node* node) {
 		if (!mapRenderer || !players.size()) return;
+		sceneChanged();
 
 		auto sloc = mapRenderer->getSettlementLocation(node);
 		if (!sloc) {
@@ -196,7 +256,7 @@ namespace pogre {
 				}
 			}
 			auto newOwner = players[node->owner];
-			auto newPiece = newOwner->getStockObject(node->type);
+			auto newPiece = newOwner->takeStockObject(node->type);
 			if (!newPiece) {
 				LOGIC_ERROR(std::string(__FUNCTION__) + ": Cannot place a piece that is not in stock");
 				return;
@@ -207,6 +267,7 @@ namespace pogre {
 
 	void Engine :: updateEdge(Edge* edge) {
 		if (!mapRenderer || !players.size()) return;
+		sceneChanged();
 
 		auto rloc = mapRenderer->getRoadLocation(edge);
 		if (!rloc) {
@@ -231,7 +292,7 @@ namespace pogre {
 				}
 			}
 			auto newOwner = players[edge->owner];
-			auto newPiece = newOwner->getStockObject(edge->type);
+			auto newPiece = newOwner->takeStockObject(edge->type);
 			if (!newPiece) {
 				LOGIC_ERROR(std::string(__FUNCTION__) + ": Cannot place a piece that is not in stock");
 				return;
@@ -244,6 +305,7 @@ namespace pogre {
     bool Engine :: mouseMoved(const OgreBites::MouseMotionEvent& evt) {
     	if (cameraControls) {
     		cameraControls->mouseMoved(evt);
+    		sceneChanged();
     	}
     	return true;
     }
@@ -251,6 +313,7 @@ namespace pogre {
     bool Engine :: mouseWheelRolled(const OgreBites::MouseWheelEvent& evt) {
     	if (cameraControls) {
     		cameraControls->mouseWheelRolled(evt);
+    		sceneChanged();
     	}
     	return true;
     }
@@ -258,6 +321,7 @@ namespace pogre {
     bool Engine :: mousePressed(const OgreBites::MouseButtonEvent& evt) {
     	if (cameraControls) {
     		cameraControls->mousePressed(evt);
+    		sceneChanged();
     	}
     	return true;
     }
@@ -265,6 +329,7 @@ namespace pogre {
     bool Engine :: mouseReleased(const OgreBites::MouseButtonEvent& evt) {
     	if (cameraControls) {
     		cameraControls->mouseReleased(evt);
+    		sceneChanged();
     	}
     	return true;
     }
@@ -272,15 +337,38 @@ namespace pogre {
     bool Engine :: keyPressed(const OgreBites::KeyboardEvent& evt) {
     	if (evt.keysym.sym == OgreBites::SDLK_F1) {
     		enableLightMovement = !enableLightMovement;
+    		sceneChanged();
+    	} else if (evt.keysym.sym == OgreBites::SDLK_F5) {
+    		profiler->setHudVisible(!profiler->isHudVisible());
+    		sceneChanged();
     	}
     	return true;
     }
 
 	void Engine :: updateWindowSize(int width, int height) {
-		mainEngine->window->resize(width, height);
+		resizeWindow(width, height);
+		sceneChanged();
+	}
+
+	// The compiled programs only fit the render system they were made for
+	static std::string programCacheFile(Ogre::RenderSystem* renderSystem) {
+		gchar* directory = g_build_filename(g_get_user_cache_dir(), "pioneers", NULL);
+		if (g_mkdir_with_parents(directory, 0755) != 0) {
+			g_free(directory);
+			return std::string();
+		}
+
+		std::string name = "programs-" + renderSystem->getName() + ".cache";
+		std::replace(name.begin(), name.end(), ' ', '_');
+		gchar* filename = g_build_filename(directory, name.c_str(), NULL);
+		std::string result(filename);
+		g_free(filename);
+		g_free(directory);
+		return result;
 	}
 
-	Engine :: Engine(std::string windowName) : enableLightMovement(false) {
+	Engine :: Engine(std::string windowName) : enableLightMovement(false),
+			hasPendingGame(false), hasPendingMap(false), pendingMap(nullptr) {
 		mainEngine = this;
 		root = OgreRootPtr(new Ogre::Root());
 
@@ -307,6 +395,16 @@ namespace pogre {
 		resgrpman->addResourceLocation("ogre_resources/textures/", "FileSystem", "map");
 		resgrpman->addResourceLocation("ogre_resources/meshes/", "FileSystem", "map");
 		resgrpman->addResourceLocation("ogre_resources/shaders/", "FileSystem", "map");
+
+		resourceLoader = ResourceLoader::Ptr(new ResourceLoader("map",
+				programCacheFile(root->getRenderSystem()),
+				[this](float progress) {
+					if (onLoadProgress) onLoadProgress(progress);
+				},
+				[this]() {
+					resourcesReady();
+				}));
+		resourceLoader->declareResources();
 		resgrpman->initialiseAllResourceGroups();
 
 
@@ -332,15 +430,26 @@ namespace pogre {
 		auto rtshare = Ogre::RTShader::ShaderGenerator::getSingletonPtr();
 		rtshare->addSceneManager(mainScene);
 
-		// Create standard entities
-		robber = std::shared_ptr<Robber>(new Robber());
+		animator = PieceAnimator::Ptr(new PieceAnimator());
+
+		// Set PIONEERS_3D_PROFILE to show the frame times, and
+		// PIONEERS_3D_PROFILE_CSV to the name of a file to record them in
+		const gchar* csvFile = g_getenv("PIONEERS_3D_PROFILE_CSV");
+		profiler = Profiler::Ptr(new Profiler(mainScene, window, csvFile ? csvFile : ""));
+		if (g_getenv("PIONEERS_3D_PROFILE")) profiler->setHudVisible(true);
+
+		// The standard entities are created when the resources are loaded
+		resourceLoader->start();
 	}
 
 	Engine :: ~Engine() {
 		robber.reset();
 		players.clear();
+		animator.reset();
 		mapRenderer.reset();
 		cameraControls.reset();
+		profiler.reset();
+		resourceLoader.reset();
 		root.reset();
 		if (mainEngine == this) mainEngine = nullptr;
 	}
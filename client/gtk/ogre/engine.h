@@ -21,6 +21,8 @@ extern "C" {
 #include "player.h"
 #include "map_entities.h"
 #include "map_renderer.h"
+#include "profiler.h"
+#include "resource_loader.h"
 
 namespace pogre {
 	class Engine;
@@ -36,11 +38,15 @@ namespace pogre {
 		Ogre::Vector3 tiltPYR, targetTiltPYR;
 
 		bool rightGrabbed;
+		bool moving;
 
 		bool isValidCoordinate(const Ogre::Vector3& v) const;
 	public:
 		typedef std::shared_ptr<CameraControls> Ptr;
 
+		// Is the camera still turning towards the mouse?
+		bool isMoving() const { return moving; }
+
 		virtual bool mousePressed(const OgreBites::MouseButtonEvent& evt) override;
 		virtual bool mouseReleased(const OgreBites::MouseButtonEvent& evt) override;
 		virtual bool mouseMoved(const OgreBites::MouseMotionEvent& evt) override;
@@ -62,6 +68,17 @@ namespace pogre {
 		Ogre::SceneNode* spotLightNode;
 		Ogre::Light* spotLight;
 
+		ResourceLoader::Ptr resourceLoader;
+		PieceAnimator::Ptr animator;
+		Profiler::Ptr profiler;
+
+		// Shown when the resources are loaded
+		bool hasPendingGame;
+		bool hasPendingMap;
+		Map* pendingMap;
+
+		void resourcesReady();
+
 		float getBoardWidth();
 		float getBoardHeight();
 
@@ -70,7 +87,10 @@ namespace pogre {
 		CameraControls::Ptr cameraControls;
 		MapRenderer::Ptr mapRenderer;
 
-		virtual void render(float stepSeconds) override;
+		// Called while the resources are loaded, with the part that is done
+		ResourceLoader::ProgressFunction onLoadProgress;
+
+		virtual bool render(float stepSeconds) override;
 
 		virtual void startNewGame() override;
 		virtual void loadNewMap(Map* map) override;
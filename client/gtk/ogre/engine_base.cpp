@@ -2,4 +2,13 @@
 
 namespace pogre {
 	EngineBase* mainEngine;
+
+	void EngineBase :: resizeWindow(int width, int height) {
+		if (width <= 0 || height <= 0) return;
+
+		if (window->getWidth() != (unsigned int) width || window->getHeight() != (unsigned int) height) {
+			window->resize(width, height);
+			window->windowMovedOrResized();
+		}
+	}
 }
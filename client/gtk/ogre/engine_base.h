@@ -39,7 +39,8 @@ namespace pogre {
 		Ogre::SceneManager* mainScene;
 		Ogre::RenderWindow* window;
 
-		virtual void render(float stepSeconds) = 0;
+		// Returns true while something moves and more frames are needed
+		virtual bool render(float stepSeconds) = 0;
 
 		virtual void startNewGame() = 0;
 		virtual void loadNewMap(Map* map) = 0;
@@ -48,6 +49,10 @@ namespace pogre {
 		virtual void updateEdge(Edge* edge) = 0;
 
 		virtual void updateWindowSize(int width, int height) = 0;
+	protected:
+		// Resize the render target in place, the viewports follow it and
+		// the cameras take the aspect ratio of their viewport
+		void resizeWindow(int width, int height);
 	};
 
 	extern EngineBase* mainEngine;
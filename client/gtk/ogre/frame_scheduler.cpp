@@ -0,0 +1,104 @@
+#include "frame_scheduler.h"
+
+#include <ctime>
+#include <iostream>
+
+namespace pogre {
+	FrameScheduler* frameScheduler;
+
+	// Drawn on request after GTK has painted the window
+	static const gint FRAME_PRIORITY = GDK_PRIORITY_REDRAW + 10;
+
+	double FrameScheduler :: threadCpuSeconds() {
+		struct timespec ts;
+		if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+			return 0;
+		}
+		return ts.tv_sec + ts.tv_nsec / 1e9;
+	}
+
+	void FrameScheduler :: renderFrame(gint64 now) {
+		float seconds = lastFrameTime ? (now - lastFrameTime) / 1e6f : 0;
+		if (seconds < 0) seconds = 0;
+		if (seconds > MAX_STEP_SECONDS) seconds = MAX_STEP_SECONDS;
+		lastFrameTime = now;
+
+		const double cpuStart = threadCpuSeconds();
+		const bool moving = renderFunction(seconds);
+		cpuSeconds += threadCpuSeconds() - cpuStart;
+		framesRendered++;
+
+		if (moving) {
+			startAnimation();
+		} else {
+			animating = false;
+		}
+	}
+
+	void FrameScheduler :: startAnimation() {
+		animating = true;
+		if (frameSource) {
+			g_source_remove(frameSource);
+			frameSource = 0;
+		}
+		if (!tickCallback) {
+			tickCallback = gtk_widget_add_tick_callback(widget, &FrameScheduler::onTick, this, nullptr);
+		}
+	}
+
+	gboolean FrameScheduler :: onFrameSource(gpointer data) {
+		FrameScheduler* self = static_cast<FrameScheduler*>(data);
+		self->frameSource = 0;
+		self->renderFrame(g_get_monotonic_time());
+		return G_SOURCE_REMOVE;
+	}
+
+	gboolean FrameScheduler :: onTick(GtkWidget* widget, GdkFrameClock* clock, gpointer data) {
+		FrameScheduler* self = static_cast<FrameScheduler*>(data);
+		self->renderFrame(gdk_frame_clock_get_frame_time(clock));
+		if (self->animating) {
+			return G_SOURCE_CONTINUE;
+		}
+		self->tickCallback = 0;
+		return G_SOURCE_REMOVE;
+	}
+
+	void FrameScheduler :: requestFrame() {
+		// A frame is already on its way
+		if (animating || frameSource) return;
+
+		const gint64 delay = lastFrameTime + MIN_FRAME_INTERVAL_US - g_get_monotonic_time();
+		if (delay <= 0) {
+			frameSource = g_idle_add_full(FRAME_PRIORITY, &FrameScheduler::onFrameSource, this, nullptr);
+		} else {
+			frameSource = g_timeout_add_full(FRAME_PRIORITY, (delay + 999) / 1000,
+					&FrameScheduler::onFrameSource, this, nullptr);
+		}
+	}
+
+	void FrameScheduler :: printStatistics() const {
+		std::cout << "Frames rendered: " << framesRendered
+				<< ", CPU time: " << cpuSeconds << " s";
+		if (framesRendered) {
+			std::cout << " (" << cpuSeconds * 1000 / framesRendered << " ms per frame)";
+		}
+		std::cout << std::endl;
+	}
+
+	FrameScheduler :: FrameScheduler(GtkWidget* widget, RenderFunction renderFunction) :
+			widget(widget), renderFunction(renderFunction),
+			frameSource(0), tickCallback(0), animating(false),
+			lastFrameTime(0), framesRendered(0), cpuSeconds(0) {
+		frameScheduler = this;
+	}
+
+	FrameScheduler :: ~FrameScheduler() {
+		if (frameSource) {
+			g_source_remove(frameSource);
+		}
+		if (tickCallback) {
+			gtk_widget_remove_tick_callback(widget, tickCallback);
+		}
+		if (frameScheduler == this) frameScheduler = nullptr;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+
+#include <gtk/gtk.h>
+
+namespace pogre {
+	/*
+	 * Decides when the 3D window is drawn. Nothing is drawn while the scene
+	 * does not change. A change requests a single frame, several requests are
+	 * drawn as one frame. While something moves, the frames follow the frame
+	 * clock of the window, which is paced by the display.
+	 */
+	class FrameScheduler {
+	public:
+		// Draws a frame and returns true while something still moves
+		typedef std::function<bool(float stepSeconds)> RenderFunction;
+
+		// Shortest time between two frames that are drawn on request
+		static const gint64 MIN_FRAME_INTERVAL_US = G_USEC_PER_SEC / 60;
+		// Longest step of the animations, after the window was idle
+		static constexpr float MAX_STEP_SECONDS = 0.1f;
+
+	private:
+		GtkWidget* widget;
+		RenderFunction renderFunction;
+
+		guint frameSource;
+		guint tickCallback;
+		bool animating;
+
+		gint64 lastFrameTime;
+
+		guint64 framesRendered;
+		double cpuSeconds;
+
+		void renderFrame(gint64 now);
+		void startAnimation();
+
+		static gboolean onFrameSource(gpointer data);
+		static gboolean onTick(GtkWidget* widget, GdkFrameClock* clock, gpointer data);
+	public:
+		FrameScheduler(const FrameScheduler&) = delete;
+		FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+		// Something in the scene changed, draw it once
+		void requestFrame();
+
+		bool isAnimating() const { return animating; }
+
+		guint64 getFramesRendered() const { return framesRendered; }
+		// Processor time used to draw the frames
+		double getCpuSeconds() const { return cpuSeconds; }
+
+		void printStatistics() const;
+
+		// Processor time used by the calling thread
+		static double threadCpuSeconds();
+
+		FrameScheduler(GtkWidget* widget, RenderFunction renderFunction);
+		virtual ~FrameScheduler();
+	};
+
+	extern FrameScheduler* frameScheduler;
+}
@@ -0,0 +1,93 @@
+#include "headless_engine.h"
+
+namespace pogre {
+	bool HeadlessEngine :: render(float stepSeconds) {
+		root->renderOneFrame(stepSeconds);
+		return false;
+	}
+
+	void HeadlessEngine :: loadNewMap(Map* map) {
+		mapRenderer.reset();
+		if (map) {
+			mapRenderer = MapRenderer::Ptr(new pogre::MapRenderer(map));
+		}
+	}
+
+	void HeadlessEngine :: updateWindowSize(int width, int height) {
+		resizeWindow(width, height);
+	}
+
+	HeadlessEngine :: HeadlessEngine(int width, int height) : camera(nullptr) {
+		// Only warnings and errors, and no Ogre.log in the working directory
+		logManager = std::unique_ptr<Ogre::LogManager>(new Ogre::LogManager());
+		logManager->createLog("headless", true, false, true)->setLogDetail(Ogre::LL_LOW);
+
+		// No plugins.cfg and no ogre.cfg, the render system is chosen here
+		root = OgreRootPtr(new Ogre::Root("", "", ""));
+		try {
+			setUp(width, height);
+		} catch (...) {
+			// Ogre logs while it shuts down
+			root.reset();
+			if (mainEngine == this) mainEngine = nullptr;
+			throw;
+		}
+	}
+
+	void HeadlessEngine :: setUp(int width, int height) {
+		const gchar* plugin = g_getenv("PIONEERS_3D_RENDER_SYSTEM");
+		root->loadPlugin(std::string(P3D_OGRE_PLUGIN_DIR) + "/" + (plugin ? plugin : "RenderSystem_GL"));
+
+		const Ogre::RenderSystemList& renderers = root->getAvailableRenderers();
+		if (renderers.empty()) {
+			OGRE_EXCEPT(Ogre::Exception::ERR_RENDERINGAPI_ERROR, "No render system", __FUNCTION__);
+		}
+		root->setRenderSystem(renderers.front());
+		root->initialise(false);
+
+		Ogre::NameValuePairList params;
+		params["hidden"] = "true";
+		window = root->createRenderWindow("headless", width, height, false, &params);
+		mainEngine = this;
+
+		auto resgrpman = Ogre::ResourceGroupManager::getSingletonPtr();
+		const std::string resources = P3D_RESOURCE_DIR;
+		resgrpman->createResourceGroup("map", false);
+		resgrpman->addResourceLocation(resources, "FileSystem", "map");
+		resgrpman->addResourceLocation(resources + "/textures", "FileSystem", "map");
+		resgrpman->addResourceLocation(resources + "/meshes", "FileSystem", "map");
+		resgrpman->addResourceLocation(resources + "/shaders", "FileSystem", "map");
+		resgrpman->initialiseResourceGroup("map");
+		resgrpman->loadResourceGroup("map");
+
+		mainScene = root->createSceneManager(
+				Ogre::DefaultSceneManagerFactory::FACTORY_TYPE_NAME,
+				"Main Scene");
+		mainScene->setAmbientLight(Ogre::ColourValue(0.1, 0.1, 0.1));
+
+		// The view of the board at the start of a game
+		camera = mainScene->createCamera("camera");
+		camera->setAutoAspectRatio(true);
+		camera->setNearClipDistance(.01);
+		camera->setFarClipDistance(10);
+		auto cameraNode = mainScene->getRootSceneNode()->createChildSceneNode("camera location");
+		cameraNode->setPosition(0, -.5, 1);
+		cameraNode->lookAt(Ogre::Vector3(0, 0, 0), Ogre::Node::TransformSpace::TS_WORLD);
+		cameraNode->attachObject(camera);
+
+		auto viewport = window->addViewport(camera);
+		viewport->setBackgroundColour(Ogre::ColourValue::Black);
+
+		auto light = mainScene->createLight("spot-light");
+		light->setDiffuseColour(1, 0.9, 0.9);
+		mainScene->getRootSceneNode()->createChildSceneNode(
+				"spot-light-location", Ogre::Vector3(0.4, 0, 0.4))->attachObject(light);
+	}
+
+	HeadlessEngine :: ~HeadlessEngine() {
+		mapRenderer.reset();
+		root.reset();
+		logManager.reset();
+		if (mainEngine == this) mainEngine = nullptr;
+	}
+}
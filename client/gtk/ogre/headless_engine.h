@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <Ogre.h>
+
+extern "C" {
+	#include <client.h>
+}
+
+#include "engine_base.h"
+#include "map_renderer.h"
+
+namespace pogre {
+	/*
+	 * An engine without GTK and without a game, for the benchmarks and the
+	 * tests. It draws into a hidden window of its own and loads the
+	 * resources of the board at once. The render system plugin is taken
+	 * from PIONEERS_3D_RENDER_SYSTEM, by default RenderSystem_GL. With
+	 * LIBGL_ALWAYS_SOFTWARE=1 Mesa draws it without a graphics card.
+	 */
+	class HeadlessEngine : public EngineBase {
+	private:
+		std::unique_ptr<Ogre::LogManager> logManager;
+		Ogre::Camera* camera;
+
+		void setUp(int width, int height);
+	public:
+		MapRenderer::Ptr mapRenderer;
+
+		virtual bool render(float stepSeconds) override;
+
+		virtual void startNewGame() override {}
+		virtual void loadNewMap(Map* map) override;
+		virtual void updateNode(Node* node) override {}
+		virtual void updateEdge(Edge* edge) override {}
+
+		virtual void updateWindowSize(int width, int height) override;
+
+		// Throws an Ogre::Exception when no window can be drawn
+		HeadlessEngine(int width, int height);
+		virtual ~HeadlessEngine();
+	};
+}
@@ -1,6 +1,7 @@
 #include "main.h"
 
 #include "engine.h"
+#include "frame_scheduler.h"
 
 #include <iostream>
 #include <vector>
@@ -13,9 +14,23 @@ extern "C" {
 	static GtkWindow* gtk_window;
 	static Window gtk_window_xid;
 
-	static float deferredResize;
+	static bool renderingEnabled;
+	static bool resizePending;
 	static int newWidth, newHeight;
 
+	static const char* WINDOW_TITLE = "Pioneers 3D Game Window";
+
+	// The resources are loaded after the window is shown
+	static void _ogreb_load_progress(float progress) {
+		if (progress < 1.0f) {
+			gchar* title = g_strdup_printf("%s - Loading %d%%", WINDOW_TITLE, (int) (progress * 100));
+			gtk_window_set_title(gtk_window, title);
+			g_free(title);
+		} else {
+			gtk_window_set_title(gtk_window, WINDOW_TITLE);
+		}
+	}
+
 	static void _ogreb_init_ogre() {
 		using namespace pogre;
 
@@ -28,40 +43,50 @@ extern "C" {
 		snprintf(windowDesc, 128 - 1, "%llu:%u:%lu", (unsigned long long) disp, screen, gtk_window_xid);
 
 		std::cout << "Window id: " << windowDesc << std::endl;
-		new Engine(windowDesc);
+		auto engine = new Engine(windowDesc);
+		engine->onLoadProgress = &_ogreb_load_progress;
 	}
 
-	static gint64 animationTimerValue;
-	static gboolean _ogreb_render_handler() {
-		using namespace pogre;
-
-		gint64 now = g_get_real_time();
+	static bool _ogreb_render_handler(float seconds) {
 		if (!pogre::mainEngine) {
 			_ogreb_init_ogre();
-			animationTimerValue = now;
 		}
-
-		const Ogre::Real seconds = (now - animationTimerValue) / 1000000.0;
-		animationTimerValue = now;
 		if (pogre::mainEngine) {
-			if (deferredResize >= 0) {
-				deferredResize -= seconds;
-				if (deferredResize < 0) {
-					pogre::mainEngine->updateWindowSize(newWidth, newHeight);
-				}
+			if (resizePending) {
+				resizePending = false;
+				pogre::mainEngine->updateWindowSize(newWidth, newHeight);
 			}
-			pogre::mainEngine->render(seconds);
+			return pogre::mainEngine->render(seconds);
 		}
-
-		return TRUE;
+		return false;
 	}
 
+	// Resizing is cheap, it is done before the next frame
 	static void	_ogreb_resize(GtkWidget* widget,
 			GdkRectangle* allocation,
 			gpointer user_data) {
-		deferredResize = .1;
+		resizePending = true;
 		newWidth = allocation->width;
 		newHeight = allocation->height;
+		if (pogre::frameScheduler) {
+			pogre::frameScheduler->requestFrame();
+		}
+	}
+
+	// GTK has painted the window, draw the scene over it again
+	static gboolean _ogreb_on_draw(GtkWidget* widget, cairo_t* cr, gpointer user_data) {
+		if (pogre::frameScheduler) {
+			pogre::frameScheduler->requestFrame();
+		}
+		return false;
+	}
+
+	static void _ogreb_start_rendering() {
+		if (!renderingEnabled || !gtk_window || pogre::frameScheduler) return;
+
+		new pogre::FrameScheduler((GtkWidget*) gtk_window, &_ogreb_render_handler);
+		// The first frame creates the engine
+		pogre::frameScheduler->requestFrame();
 	}
 
 	static bool mapGDKtoOgreKeycode(guint modifier, guint keyval, OgreBites::Keysym& keysym) {
@@ -193,12 +218,12 @@ extern "C" {
 	}
 
 	void ogreb_init() {
-		deferredResize = -1;
+		resizePending = false;
 
 		// Gtk bits
 		GtkWidget* winwid = gtk_window_new(GTK_WINDOW_TOPLEVEL);
 		gtk_window = reinterpret_cast<GtkWindow*>(winwid);
-		gtk_window_set_title(gtk_window, "Pioneers 3D Game Window");
+		gtk_window_set_title(gtk_window, WINDOW_TITLE);
 		gtk_window_set_default_size(gtk_window, 600, 400);
 
 		gtk_widget_show_all(winwid);
@@ -222,22 +247,25 @@ extern "C" {
 		g_signal_connect(G_OBJECT(winwid), "button-press-event", G_CALLBACK(_ogreb_on_mouse_button_pressed), NULL);
 		g_signal_connect(G_OBJECT(winwid), "button-release-event", G_CALLBACK(_ogreb_on_mouse_button_released), NULL);
 		g_signal_connect(G_OBJECT(winwid), "scroll-event", G_CALLBACK(_ogreb_on_mouse_scroll), NULL);
+		g_signal_connect_after(G_OBJECT(winwid), "draw", G_CALLBACK(_ogreb_on_draw), NULL);
 
 		std::cout << "Registered it all!" << std::endl;
-	}
 
-	static gboolean	animate(gpointer user_data) {
-		_ogreb_render_handler();
-		return G_SOURCE_CONTINUE;
+		_ogreb_start_rendering();
 	}
 
 	VoidFunction pogre_setup_gtk_mainloop(VoidFunction old) {
-		g_timeout_add(20, &animate, NULL);
+		renderingEnabled = true;
+		_ogreb_start_rendering();
 		return old;
 	}
 
 	void ogreb_cleanup() {
 		using namespace pogre;
+		if (frameScheduler) {
+			if (g_getenv("PIONEERS_3D_PROFILE")) frameScheduler->printStatistics();
+			delete frameScheduler;
+		}
 		if (mainEngine) delete mainEngine;
 	}
 
@@ -0,0 +1,250 @@
+/*
+ * Benchmark of the 3D board: build the board of game files, draw it, and
+ * look up the scene nodes of the nodes, edges and hexes as the client does
+ * for every change. It uses the headless engine, so it runs with a software
+ * renderer and without GTK.
+ *
+ * With --replay, the builds and moves of a recorded game are looked up in
+ * the order they were received. The log has the same format as for
+ * pioneers-guimap-bench: the lines the client received from the server,
+ * as shown by 'pioneers --debug' or as plain lines.
+ */
+#include "headless_engine.h"
+
+#include <cstdarg>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+	using namespace pogre;
+
+	gint rounds = 100;
+	gint frames = 50;
+	gchar* replayFile = nullptr;
+	gchar** gameFiles = nullptr;
+	gchar** replayLines = nullptr;
+
+	GOptionEntry commandlineEntries[] = {
+		{"rounds", 'n', 0, G_OPTION_ARG_INT, &rounds,
+		 "Number of times to look up everything", "100"},
+		{"frames", 'f', 0, G_OPTION_ARG_INT, &frames,
+		 "Number of frames to draw", "50"},
+		{"replay", 'r', 0, G_OPTION_ARG_FILENAME, &replayFile,
+		 "Look up the changes of a recorded game", "LOGFILE"},
+		{G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY,
+		 &gameFiles, nullptr, "GAMEFILE..."},
+		{nullptr, '\0', 0, G_OPTION_ARG_NONE, nullptr, nullptr, nullptr}
+	};
+
+	// What the client looks up for one change of the map
+	struct Change {
+		Node* node;
+		Edge* edge;
+		Hex* hex;
+	};
+
+	struct MapElements {
+		std::vector<Node*> nodes;
+		std::vector<Edge*> edges;
+		std::vector<Hex*> hexes;
+	};
+
+	// Collect each node and edge once, from the hex that owns it
+	gboolean collectElements(Hex* hex, gpointer closure) {
+		MapElements* elements = static_cast<MapElements*>(closure);
+
+		elements->hexes.push_back(hex);
+		for (Node* node : hex->nodes) {
+			if (node && node->x == hex->x && node->y == hex->y) elements->nodes.push_back(node);
+		}
+		for (Edge* edge : hex->edges) {
+			if (edge && edge->x == hex->x && edge->y == hex->y) elements->edges.push_back(edge);
+		}
+		return FALSE;
+	}
+
+	void report(const std::string& title, const char* what, size_t count, gint64 usec) {
+		std::cout << title << ": " << what << " " << (count ? usec * 1000.0 / count : 0)
+				<< " ns each, " << count << " in " << usec / 1000.0 << " ms" << std::endl;
+	}
+
+	// Parse the whole line
+	bool replayScan(const gchar* line, const gchar* fmt, ...) {
+		va_list ap;
+		va_start(ap, fmt);
+		ssize_t offset = game_vscanf(line, fmt, ap);
+		va_end(ap);
+		return offset >= 0 && line[offset] == '\0';
+	}
+
+	// Apply one line of the log to the map, and remember what changed
+	void replayLine(Map* map, const gchar* line, std::vector<Change>& changes) {
+		BuildType type;
+		gint playerNum;
+		gint x, y, pos;
+		gint dx, dy, dpos;
+
+		const gchar* received = strstr(line, "<-- ");
+		if (received) line = received + 4;
+
+		ssize_t offset = game_scanf(line, "player %d ", &playerNum);
+		if (offset < 0) return;
+		line += offset;
+
+		bool removed = false;
+		if (replayScan(line, "built %B %d %d %d", &type, &x, &y, &pos)
+				|| (removed = replayScan(line, "remove %B %d %d %d", &type, &x, &y, &pos))) {
+			if (type == BUILD_ROAD || type == BUILD_SHIP || type == BUILD_BRIDGE) {
+				Edge* edge = map_edge(map, x, y, pos);
+				if (!edge) return;
+				edge->owner = removed ? -1 : playerNum;
+				edge->type = removed ? BUILD_NONE : type;
+				changes.push_back({nullptr, edge, nullptr});
+			} else if (type == BUILD_SETTLEMENT || type == BUILD_CITY) {
+				Node* node = map_node(map, x, y, pos);
+				if (!node) return;
+				if (!removed) node->type = type;
+				else node->type = type == BUILD_CITY ? BUILD_SETTLEMENT : BUILD_NONE;
+				node->owner = node->type == BUILD_NONE ? -1 : playerNum;
+				changes.push_back({node, nullptr, nullptr});
+			}
+		} else if (replayScan(line, "move %d %d %d %d %d %d", &x, &y, &pos, &dx, &dy, &dpos)
+				|| replayScan(line, "move-back %d %d %d %d %d %d", &x, &y, &pos, &dx, &dy, &dpos)) {
+			Edge* from = map_edge(map, x, y, pos);
+			Edge* to = map_edge(map, dx, dy, dpos);
+			if (!from || !to) return;
+			from->owner = -1;
+			from->type = BUILD_NONE;
+			to->owner = playerNum;
+			to->type = BUILD_SHIP;
+			changes.push_back({nullptr, from, nullptr});
+			changes.push_back({nullptr, to, nullptr});
+		} else if (replayScan(line, "moved-robber %d %d", &x, &y)
+				|| replayScan(line, "moved-pirate %d %d", &x, &y)) {
+			Hex* hex = map_hex(map, x, y);
+			if (hex) changes.push_back({nullptr, nullptr, hex});
+		}
+	}
+
+	// Returns the number of locations that were found
+	size_t lookUp(MapRenderer* renderer, const std::vector<Change>& changes) {
+		size_t found = 0;
+		for (const Change& change : changes) {
+			if (change.node && renderer->getSettlementLocation(change.node)) found++;
+			if (change.edge && renderer->getRoadLocation(change.edge)) found++;
+			if (change.hex && renderer->getTile(change.hex)) found++;
+		}
+		return found;
+	}
+
+	void benchLookup(MapRenderer* renderer, const std::vector<Change>& changes,
+			const std::string& title, const char* what) {
+		if (changes.empty()) return;
+
+		size_t found = 0;
+		const gint64 start = g_get_monotonic_time();
+		for (gint round = 0; round < rounds; round++) {
+			found += lookUp(renderer, changes);
+		}
+		report(title, what, changes.size() * rounds, g_get_monotonic_time() - start);
+		if (found == 0) {
+			std::cerr << title << ": no " << what << " location was found" << std::endl;
+		}
+	}
+
+	bool benchGame(HeadlessEngine& engine, const gchar* filename) {
+		GameParams* params = params_load_file(filename);
+		if (!params || !params->map) {
+			std::cerr << filename << ": cannot load the map" << std::endl;
+			if (params) params_free(params);
+			return false;
+		}
+		const std::string title(params->title ? params->title : filename);
+		Map* map = map_copy(params->map);
+		params_free(params);
+
+		// Building the board includes baking it into static geometry
+		gint64 start = g_get_monotonic_time();
+		engine.loadNewMap(map);
+		std::cout << title << ": load " << (g_get_monotonic_time() - start) / 1000.0 << " ms" << std::endl;
+
+		if (frames > 0) {
+			engine.render(0);
+			start = g_get_monotonic_time();
+			for (gint frame = 0; frame < frames; frame++) {
+				engine.render(0);
+			}
+			const gint64 usec = g_get_monotonic_time() - start;
+			std::cout << title << ": frame " << usec / 1000.0 / frames << " ms each, "
+					<< engine.window->getStatistics().batchCount << " batches" << std::endl;
+		}
+
+		MapElements elements;
+		map_traverse(map, collectElements, &elements);
+		std::vector<Change> all;
+		for (Node* node : elements.nodes) all.push_back({node, nullptr, nullptr});
+		for (Edge* edge : elements.edges) all.push_back({nullptr, edge, nullptr});
+		for (Hex* hex : elements.hexes) all.push_back({nullptr, nullptr, hex});
+		benchLookup(engine.mapRenderer.get(), all, title, "lookup");
+
+		if (replayLines) {
+			std::vector<Change> changes;
+			for (gint idx = 0; replayLines[idx]; idx++) {
+				replayLine(map, replayLines[idx], changes);
+			}
+			if (changes.empty()) {
+				std::cerr << title << ": no map changes in " << replayFile << std::endl;
+			}
+			benchLookup(engine.mapRenderer.get(), changes, title, "replay");
+		}
+
+		engine.loadNewMap(nullptr);
+		map_free(map);
+		return true;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	GError* error = nullptr;
+
+	GOptionContext* context = g_option_context_new("- Time the 3D board");
+	g_option_context_add_main_entries(context, commandlineEntries, nullptr);
+	g_option_context_parse(context, &argc, &argv, &error);
+	g_option_context_free(context);
+	if (error) {
+		std::cerr << error->message << std::endl;
+		g_error_free(error);
+		return 1;
+	}
+	if (!gameFiles) {
+		std::cerr << "No game file given" << std::endl;
+		return 1;
+	}
+	if (replayFile) {
+		gchar* contents;
+		if (!g_file_get_contents(replayFile, &contents, nullptr, &error)) {
+			std::cerr << error->message << std::endl;
+			g_error_free(error);
+			return 1;
+		}
+		replayLines = g_strsplit(contents, "\n", -1);
+		g_free(contents);
+	}
+
+	bool ok = true;
+	try {
+		HeadlessEngine engine(800, 600);
+		for (gint idx = 0; gameFiles[idx]; idx++) {
+			ok = benchGame(engine, gameFiles[idx]) && ok;
+		}
+	} catch (Ogre::Exception& e) {
+		std::cerr << "Cannot draw: " << e.getDescription() << std::endl;
+		ok = false;
+	}
+
+	g_strfreev(replayLines);
+	g_strfreev(gameFiles);
+	g_free(replayFile);
+	return ok ? 0 : 1;
+}
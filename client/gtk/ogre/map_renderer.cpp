@@ -1,5 +1,6 @@
 #include "map_renderer.h"
 
+#include <cstring>
 #include <iostream>
 
 #include "engine_base.h"
@@ -106,6 +107,20 @@ namespace pogre {
 		location = HexLocation::Ptr(new HexLocation(sceneNode, hex));
 	}
 
+	void MapTile :: addToStaticGeometry(Ogre::StaticGeometry* geometry) {
+		if (entity) {
+			geometry->addEntity(entity, entityNode->_getDerivedPosition(),
+					entityNode->_getDerivedOrientation(), entityNode->_getDerivedScale());
+			entity->setVisible(false);
+		}
+		if (numberChip && numberChip->entity) {
+			Ogre::SceneNode* node = numberChip->node;
+			geometry->addEntity(numberChip->entity, node->_getDerivedPosition(),
+					node->_getDerivedOrientation(), node->_getDerivedScale());
+			numberChip->entity->setVisible(false);
+		}
+	}
+
 	MapTile :: ~MapTile() {
 		if (numberChip) {
 			delete numberChip;
@@ -126,48 +141,90 @@ namespace pogre {
 	}
 
 
-	MapTile* MapRenderer :: getTile(Hex* hex) const {
-		for (int i = 0; i < MAP_SIZE; i++) {
-			for (int j = 0; j < MAP_SIZE; j++) {
-				MapTile* p = tiles[i][j].get();
-				if (p) {
-					if (p->getHex() == hex) {
-						return p;
+	static bool isOnGrid(gint x, gint y, gint pos) {
+		return x >= 0 && x < MAP_SIZE && y >= 0 && y < MAP_SIZE && pos >= 0 && pos < 6;
+	}
+
+	void MapRenderer :: buildIndex() {
+		memset(settlementIndex, 0, sizeof(settlementIndex));
+		memset(roadIndex, 0, sizeof(roadIndex));
+
+		for (int y = 0; y < MAP_SIZE; y++) {
+			for (int x = 0; x < MAP_SIZE; x++) {
+				MapTile* tile = tiles[y][x].get();
+				if (!tile) continue;
+
+				for (auto sl : tile->settlementLocations) {
+					Node* node = sl->node;
+					if (isOnGrid(node->x, node->y, node->pos)) {
+						settlementIndex[node->y][node->x][node->pos] = sl.get();
+					}
+				}
+				for (auto rl : tile->roadLocations) {
+					Edge* edge = rl->edge;
+					if (isOnGrid(edge->x, edge->y, edge->pos)) {
+						roadIndex[edge->y][edge->x][edge->pos] = rl.get();
 					}
 				}
 			}
 		}
+	}
+
+	void MapRenderer :: buildBoardGeometry() {
+		// The positions are final, update the transforms of the whole board
+		tableNode->_update(true, true);
+
+		boardGeometry = mainEngine->mainScene->createStaticGeometry("board");
+		for (int y = 0; y < MAP_SIZE; y++) {
+			for (int x = 0; x < MAP_SIZE; x++) {
+				if (tiles[y][x]) {
+					tiles[y][x]->addToStaticGeometry(boardGeometry);
+				}
+			}
+		}
+		if (tableEntity) {
+			boardGeometry->addEntity(tableEntity, tableNode->_getDerivedPosition(),
+					tableNode->_getDerivedOrientation(), tableNode->_getDerivedScale());
+			tableEntity->setVisible(false);
+		}
+		boardGeometry->build();
+	}
+
+	MapTile* MapRenderer :: getTile(Hex* hex) const {
+		if (!hex || !isOnGrid(hex->x, hex->y, 0)) return nullptr;
+
+		MapTile* p = tiles[hex->y][hex->x].get();
+		if (p && p->getHex() == hex) {
+			return p;
+		}
 		return nullptr;
 	}
 
 	SettlementLocation* MapRenderer :: getSettlementLocation(Node* node) {
-		Hex* hex = node->map->grid[node->y][node->x];
-		MapTile* mtile = getTile(hex);
-		if (!mtile) return nullptr;
+		if (!isOnGrid(node->x, node->y, node->pos)) return nullptr;
 
-		for (auto sl : mtile->settlementLocations) {
-			if (sl->node == node) {
-				return sl.get();
-			}
+		SettlementLocation* sl = settlementIndex[node->y][node->x][node->pos];
+		if (sl && sl->node == node) {
+			return sl;
 		}
 		return nullptr;
 	}
 
 	RoadLocation* MapRenderer :: getRoadLocation(Edge* edge) {
-		Hex* hex = edge->map->grid[edge->y][edge->x];
-		MapTile* mtile = getTile(hex);
-		if (!mtile) return nullptr;
+		if (!isOnGrid(edge->x, edge->y, edge->pos)) return nullptr;
 
-		for (auto rl : mtile->roadLocations) {
-			if (rl->edge == edge) {
-				return rl.get();
-			}
+		RoadLocation* rl = roadIndex[edge->y][edge->x][edge->pos];
+		if (rl && rl->edge == edge) {
+			return rl;
 		}
 		return nullptr;
 	}
 
 	MapRenderer :: MapRenderer(::Map* _map) : theMap(_map) {
 		tableEntity = nullptr;
+		boardGeometry = nullptr;
+		memset(settlementIndex, 0, sizeof(settlementIndex));
+		memset(roadIndex, 0, sizeof(roadIndex));
 
 		width = 1;
 		height = 1;
@@ -191,6 +248,8 @@ namespace pogre {
 				}
 			}
 
+			buildIndex();
+
 			Ogre::Vector3 center = minPos.midPoint(maxPos);
 			origin->setPosition(origin->getPosition() - center);
 
@@ -205,12 +264,17 @@ namespace pogre {
 			tableEntity = mainEngine->mainScene->createEntity(tableMesh);
 			tableEntity->setMaterialName("wooden_base", "map");
 			tableNode->attachObject(tableEntity);
-		}
 
-		tableNode->setVisible(true, true);
+			// Show everything before baking, the baked entities are hidden again
+			tableNode->setVisible(true, true);
+			buildBoardGeometry();
+		}
 	}
 
 	MapRenderer :: ~MapRenderer() {
+		if (boardGeometry) {
+			mainEngine->mainScene->destroyStaticGeometry(boardGeometry);
+		}
 		origin->removeAllChildren();
 		if (tableEntity) {
 			tableNode->detachObject(tableEntity);
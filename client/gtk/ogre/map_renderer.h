@@ -142,8 +142,8 @@ namespace pogre {
 	class NumberChip {
 	private:
 		const MapTile* mapTile;
-		Ogre::Entity* entity;
 	public:
+		Ogre::Entity* entity;
 		Ogre::SceneNode* node;
 
 		NumberChip(MapTile* mapTile);
@@ -168,6 +168,9 @@ namespace pogre {
 
 		Hex* getHex() const { return hex; }
 
+		// Move the tile and its chip into static geometry, they do not move
+		void addToStaticGeometry(Ogre::StaticGeometry* geometry);
+
 		MapTile(const Ogre::Vector2& hexPos, Ogre::SceneNode* parent, Hex* hex);
 		virtual ~MapTile();
 	};
@@ -179,8 +182,18 @@ namespace pogre {
 		Ogre::SceneNode* tableNode;
 		Ogre::Entity* tableEntity;
 
+		// The table, tiles and chips, batched by material
+		Ogre::StaticGeometry* boardGeometry;
+
 		::Map* theMap;
 		MapTile::Ptr tiles[MAP_SIZE][MAP_SIZE];
+
+		// Direct lookup by the position of the owner hex and the pos of the node or edge
+		SettlementLocation* settlementIndex[MAP_SIZE][MAP_SIZE][6];
+		RoadLocation* roadIndex[MAP_SIZE][MAP_SIZE][6];
+
+		void buildIndex();
+		void buildBoardGeometry();
 	public:
 		typedef std::shared_ptr<MapRenderer> Ptr;
 
@@ -1,45 +1,120 @@
 #include "player.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <string>
 
 namespace pogre {
-	bool PlayerPiece :: inStock() {
-		Ogre::Node* node = sceneNode;
-		while (node) {
-			if (node == owner->sceneNode) {
-				return true;
+	PieceAnimator* pieceAnimator;
+
+	// How high a piece is lifted halfway a move
+	static const float MOVE_LIFT = HEX_DIAMETER * 0.3;
+
+	void PieceAnimator :: reserve(size_t pieces) {
+		moving.reserve(pieces);
+	}
+
+	void PieceAnimator :: start(PlayerPiece* piece) {
+		piece->move.elapsed = 0;
+		if (piece->move.index < 0) {
+			piece->move.index = moving.size();
+			moving.push_back(piece);
+		}
+	}
+
+	void PieceAnimator :: remove(PlayerPiece* piece) {
+		// The last one takes the place of the removed one
+		PlayerPiece* last = moving.back();
+		moving[piece->move.index] = last;
+		last->move.index = piece->move.index;
+		moving.pop_back();
+		piece->move.index = -1;
+	}
+
+	void PieceAnimator :: stop(PlayerPiece* piece) {
+		if (piece->move.index >= 0) {
+			remove(piece);
+		}
+	}
+
+	bool PieceAnimator :: update(float stepSeconds) {
+		size_t i = 0;
+		while (i < moving.size()) {
+			PlayerPiece* piece = moving[i];
+			auto& move = piece->move;
+
+			move.elapsed += stepSeconds;
+			const float t = std::min(move.elapsed / MOVE_SECONDS, 1.0f);
+			const float eased = t * t * (3 - 2 * t);
+
+			Ogre::Vector3 position = move.fromPosition + (move.toPosition - move.fromPosition) * eased;
+			position.z += MOVE_LIFT * std::sin(Ogre::Math::PI * t);
+			piece->sceneNode->setPosition(position);
+			piece->sceneNode->setOrientation(
+					Ogre::Quaternion::Slerp(eased, move.fromOrientation, move.toOrientation, true));
+
+			if (t < 1) {
+				i++;
+			} else {
+				// The next piece is moved into this place of the list
+				remove(piece);
+				piece->updateBatch();
 			}
-			node = node->getParent();
 		}
-		return false;
+		return !moving.empty();
 	}
 
-	void PlayerPiece :: returnToStock() {
-		if (!inStock()) {
-			this->moveSubPosition(
-					owner->sceneNode,
-					owner->getObjectPosition(
-							pieceType,
-							owner->getNextObjectSlotIndex(pieceType, false)));
+	PieceAnimator :: PieceAnimator() {
+		pieceAnimator = this;
+	}
+
+	PieceAnimator :: ~PieceAnimator() {
+		for (auto piece : moving) {
+			piece->move.index = -1;
+		}
+		if (pieceAnimator == this) pieceAnimator = nullptr;
+	}
+
+
+	void PlayerPiece :: returnToStock(bool animate) {
+		if (inStock()) return;
+
+		stockSlot = owner->putInStock(this);
+		const auto position = owner->getObjectPosition(pieceType, stockSlot);
+		if (animate) {
+			moveSubPosition(owner->sceneNode, position);
+		} else {
+			setSubPosition(owner->sceneNode, position);
 		}
+		setRotation(owner->getObjectRotation(pieceType, stockSlot));
 	}
 
 	void PlayerPiece :: setRotation(float degrees) {
 		Ogre::Quaternion q;
 		q.FromAngleAxis(Ogre::Degree(degrees), Ogre::Vector3::UNIT_Z);
-		sceneNode->setOrientation(q);
+		if (isMoving()) {
+			move.toOrientation = q;
+		} else {
+			sceneNode->setOrientation(q);
+			owner->markPiecesChanged();
+		}
 	}
 
 	void PlayerPiece :: setGlobalPosition(Ogre::Vector3 position) {
+		if (pieceAnimator) pieceAnimator->stop(this);
+
 		auto parent = sceneNode->getParentSceneNode();
 		if (parent) parent->removeChild(sceneNode);
 
 		mainEngine->mainScene->getRootSceneNode()->addChild(sceneNode);
 		sceneNode->setPosition(position);
+		updateBatch();
 	}
 
 	void PlayerPiece :: setSubPosition(Ogre::SceneNode* node, Ogre::Vector3 position) {
+		if (pieceAnimator) pieceAnimator->stop(this);
+
 		auto parent = sceneNode->getParentSceneNode();
 		if (parent) parent->removeChild(sceneNode);
 
@@ -47,14 +122,42 @@ namespace pogre {
 			node->addChild(sceneNode);
 			sceneNode->setPosition(position);
 		}
+		updateBatch();
+	}
+
+	void PlayerPiece :: updateBatch() {
+		// Pieces that arrived in the stock or on the board are drawn by the
+		// static geometry of the owner
+		sceneNode->setVisible(isMoving());
+		owner->markPiecesChanged();
 	}
 
 	void PlayerPiece :: moveGlobalPosition(Ogre::Vector3 position) {
-		setGlobalPosition(position);
+		moveSubPosition(mainEngine->mainScene->getRootSceneNode(), position);
 	}
 
 	void PlayerPiece :: moveSubPosition(Ogre::SceneNode* node, Ogre::Vector3 position) {
-		setSubPosition(node, position);
+		auto parent = sceneNode->getParentSceneNode();
+		if (!node || !parent || !pieceAnimator) {
+			setSubPosition(node, position);
+			return;
+		}
+
+		// Start where the piece is now, seen from the new parent
+		const Ogre::Vector3 worldPosition = sceneNode->_getDerivedPosition();
+		const Ogre::Quaternion worldOrientation = sceneNode->_getDerivedOrientation();
+		parent->removeChild(sceneNode);
+		node->addChild(sceneNode);
+
+		move.fromPosition = node->convertWorldToLocalPosition(worldPosition);
+		move.fromOrientation = node->convertWorldToLocalOrientation(worldOrientation);
+		move.toPosition = position;
+		move.toOrientation = isMoving() ? move.toOrientation : sceneNode->getOrientation();
+		sceneNode->setPosition(move.fromPosition);
+		sceneNode->setOrientation(move.fromOrientation);
+
+		pieceAnimator->start(this);
+		updateBatch();
 	}
 
 	PlayerPiece& PlayerPiece :: postInit() {
@@ -62,21 +165,17 @@ namespace pogre {
 		return *this;
 	}
 
-	PlayerPiece :: PlayerPiece(const Player* owner, const int pieceType) :
-			entity(nullptr), moveAnimation(nullptr), material(nullptr), sceneNode(nullptr),
+	PlayerPiece :: PlayerPiece(Player* owner, const int pieceType) :
+			entity(nullptr), stockSlot(-1), material(nullptr), sceneNode(nullptr),
 			owner(owner), id(owner->countObjects(pieceType)), pieceType(pieceType) {
+		move.elapsed = 0;
+		move.index = -1;
 		sceneNode = mainEngine->mainScene->createSceneNode();
 		sceneNode->getUserObjectBindings().setUserAny("playerpiece", Ogre::Any((PlayerPiece*) this));
-		moveAnimation = mainEngine->mainScene->createAnimation(
-				"animate_piece_" + std::to_string(pieceType) + "_p"
-				+ std::to_string(owner->playerId) + "_" + std::to_string(id), 1.0);
 	}
 
 	PlayerPiece :: ~PlayerPiece() {
-		if (moveAnimation) {
-			moveAnimation->destroyAllTracks();
-			mainEngine->mainScene->destroyAnimation(moveAnimation->getName());
-		}
+		if (pieceAnimator) pieceAnimator->stop(this);
 		if (sceneNode) {
 			sceneNode->detachAllObjects();
 			mainEngine->mainScene->destroySceneNode(sceneNode);
@@ -84,10 +183,6 @@ namespace pogre {
 		if (entity) {
 			mainEngine->mainScene->destroyEntity(entity);
 		}
-		if (material) {
-			auto matman = Ogre::MaterialManager::getSingletonPtr();
-			matman->remove(material);
-		}
 	}
 
 
@@ -97,17 +192,7 @@ namespace pogre {
 		auto hmesh = mainEngine->root->getMeshManager()->prepare("village.mesh", "map");
 		entity = mainEngine->mainScene->createEntity(hmesh);
 
-		auto matman = Ogre::MaterialManager::getSingletonPtr();
-		auto baseMaterial = matman->getByName("village_material", "map");
-
-		material = baseMaterial->clone("player_village_material_" + std::to_string((long long) this));
-		for (auto techique : material->getTechniques()) {
-			for (auto pass : techique->getPasses()) {
-				pass->setDiffuse(owner->colour);
-				pass->setAmbient(owner->colour);
-				pass->setEmissive(owner->colour * .2);
-			}
-		}
+		material = owner->getMaterial("village_material");
 
 		entity->setMaterial(material);
 
@@ -115,7 +200,7 @@ namespace pogre {
 		sceneNode->setScale(Ogre::Vector3::UNIT_SCALE * 0.01);
 	}
 
-	Village :: Village(const Player* owner) : PlayerPiece(owner, Village::STATIC_TYPE) {
+	Village :: Village(Player* owner) : PlayerPiece(owner, Village::STATIC_TYPE) {
 	}
 
 	Village :: ~Village() {
@@ -128,17 +213,7 @@ namespace pogre {
 		auto hmesh = mainEngine->root->getMeshManager()->prepare("city.mesh", "map");
 		entity = mainEngine->mainScene->createEntity(hmesh);
 
-		auto matman = Ogre::MaterialManager::getSingletonPtr();
-		auto baseMaterial = matman->getByName("village_material", "map");
-
-		material = baseMaterial->clone("player_village_material_" + std::to_string((long long) this));
-		for (auto techique : material->getTechniques()) {
-			for (auto pass : techique->getPasses()) {
-				pass->setDiffuse(owner->colour);
-				pass->setAmbient(owner->colour);
-				pass->setEmissive(owner->colour * .2);
-			}
-		}
+		material = owner->getMaterial("village_material");
 
 		entity->setMaterial(material);
 
@@ -146,7 +221,7 @@ namespace pogre {
 		sceneNode->setScale(Ogre::Vector3::UNIT_SCALE * 0.01);
 	}
 
-	City :: City(const Player* owner) : PlayerPiece(owner, City::STATIC_TYPE) {
+	City :: City(Player* owner) : PlayerPiece(owner, City::STATIC_TYPE) {
 	}
 
 	City :: ~City() {
@@ -160,22 +235,7 @@ namespace pogre {
 		auto meshMan = mainEngine->root->getMeshManager();
 		auto mesh = meshMan->prepare("simpleroad.mesh", "map");
 
-		auto matman = Ogre::MaterialManager::getSingletonPtr();
-
-		std::string materialName = "player_road_material_" + std::to_string(owner->playerId);
-		Ogre::MaterialPtr material = matman->getByName(materialName, "map");
-		if (!material) {
-			auto baseMaterial = matman->getByName("road", "map");
-			material = baseMaterial->clone(materialName);
-
-			for (auto techique : material->getTechniques()) {
-				for (auto pass : techique->getPasses()) {
-					pass->setDiffuse(owner->colour);
-					pass->setAmbient(owner->colour);
-					pass->setEmissive(owner->colour * .2);
-				}
-			}
-		}
+		material = owner->getMaterial("road");
 
 		entity = mainEngine->mainScene->createEntity(mesh);
 		entity->setMaterial(material);
@@ -184,7 +244,7 @@ namespace pogre {
 		sceneNode->setScale(Ogre::Vector3::UNIT_SCALE * HEX_DIAMETER / 2);
 	}
 
-	Road :: Road(const Player* owner) : PlayerPiece(owner, Road::STATIC_TYPE) {
+	Road :: Road(Player* owner) : PlayerPiece(owner, Road::STATIC_TYPE) {
 	}
 
 	Road :: ~Road() {
@@ -192,44 +252,95 @@ namespace pogre {
 
 
 
-	template <typename T>
-	static int searchSlot(const T& v, bool filled) {
-		int start = filled ? 0 : v.size() - 1;
-		int end = filled ? v.size() : -1;
-		for (int i = start; i != end; i += (end >= start ? 1 : -1)) {
-			if (filled == (bool) v[i]->inStock()) {
-				return i;
+	Ogre::MaterialPtr Player :: getMaterial(const std::string& baseMaterialName) const {
+		auto it = materials.find(baseMaterialName);
+		if (it != materials.end()) {
+			return it->second;
+		}
+
+		auto matman = Ogre::MaterialManager::getSingletonPtr();
+		auto baseMaterial = matman->getByName(baseMaterialName, "map");
+		if (!baseMaterial) {
+			LOGIC_ERROR("Material " + baseMaterialName + " cannot be loaded");
+			return baseMaterial;
+		}
+
+		auto material = baseMaterial->clone("player_" + std::to_string(playerId) + "_" + baseMaterialName);
+		for (auto techique : material->getTechniques()) {
+			for (auto pass : techique->getPasses()) {
+				pass->setDiffuse(colour);
+				pass->setAmbient(colour);
+				pass->setEmissive(colour * .2);
 			}
 		}
-		return -1;
+		materials[baseMaterialName] = material;
+		return material;
 	}
 
-	int Player :: getNextObjectSlotIndex(int type, bool filled) const {
-		int i = -1;
-		if (typedPlayerPieceList.find(type) != typedPlayerPieceList.end()) {
-			i = searchSlot(typedPlayerPieceList.at(type), filled);
-			if (i >= 0) return i;
+	Ogre::StaticGeometry* Player :: buildGeometry(Ogre::StaticGeometry* geometry,
+			const std::string& name, bool stock) {
+		if (!geometry) {
+			geometry = mainEngine->mainScene->createStaticGeometry(
+					name + "_" + std::to_string(playerId));
+		}
+		geometry->reset();
+
+		bool empty = true;
+		for (const auto& i : typedPlayerPieceList) {
+			for (const auto& item : i.second) {
+				if (item->inStock() == stock && !item->isMoving()
+						&& item->sceneNode->isInSceneGraph()) {
+					geometry->addSceneNode(item->sceneNode);
+					empty = false;
+				}
+			}
 		}
+		if (!empty) {
+			geometry->build();
+		}
+		return geometry;
+	}
+
+	void Player :: updatePieceGeometry() {
+		if (!piecesChanged) return;
+		piecesChanged = false;
 
-		LOGIC_ERROR("getNextObjectSlotIndex could not find a valid index");
-		return -1;
+		stockGeometry = buildGeometry(stockGeometry, "player_stock", true);
+		boardGeometry = buildGeometry(boardGeometry, "player_board", false);
 	}
 
-	PlayerPiece::Ptr Player :: getStockObject(int type) const {
-		int i = getNextObjectSlotIndex(type, true);
-		if (i < 0) {
+	PlayerPiece::Ptr Player :: takeStockObject(int type) {
+		if (type < 0 || type >= NUM_BUILD_TYPES || stocks[type].pieces.empty()) {
 			LOGIC_ERROR(std::string(__FUNCTION__) + " could not find stock object " + std::to_string(type));
 			return nullptr;
 		}
 
-		return typedPlayerPieceList.at(type)[i];
+		auto& stock = stocks[type];
+		auto piece = typedPlayerPieceList.at(type)[stock.pieces.back()];
+		stock.pieces.pop_back();
+		stock.freeSlots.push_back(piece->stockSlot);
+		piece->stockSlot = -1;
+		return piece;
+	}
+
+	int Player :: putInStock(PlayerPiece* piece) {
+		auto& stock = stocks[piece->pieceType];
+		if (stock.freeSlots.empty()) {
+			LOGIC_ERROR(std::string(__FUNCTION__) + " has no free slot for " + std::to_string(piece->pieceType));
+			return 0;
+		}
+
+		const int slot = stock.freeSlots.back();
+		stock.freeSlots.pop_back();
+		stock.pieces.push_back(piece->id);
+		return slot;
 	}
 
 	void Player :: applyNewMap(MapRenderer::Ptr mapRenderer) {
 		// RESET OBJECTS
 		for (auto i : typedPlayerPieceList) {
 			for (auto item : i.second) {
-				item->returnToStock();
+				item->returnToStock(false);
 			}
 		}
 
@@ -246,7 +357,7 @@ namespace pogre {
 
 					if (node->owner == playerId) {
 						auto setLoc = mapRenderer->getSettlementLocation(node);
-						auto nodeObject = getStockObject(node->type);
+						auto nodeObject = takeStockObject(node->type);
 						if (!nodeObject) {
 							LOGIC_ERROR("Could not find a required node object");
 							return;
@@ -262,7 +373,7 @@ namespace pogre {
 
 					if (edge->owner == playerId) {
 						auto setLoc = mapRenderer->getRoadLocation(edge);
-						auto edgeObject = getStockObject(edge->type);
+						auto edgeObject = takeStockObject(edge->type);
 						if (!edgeObject) {
 							LOGIC_ERROR("Could not find a required edge object");
 							return;
@@ -308,18 +419,29 @@ namespace pogre {
 	}
 
 	template <typename T>
-	static void initPlayerObjects(Player& player, int count, std::vector<typename T::Ptr>& v) {
+	void Player :: initPlayerObjects(int count, std::vector<typename T::Ptr>& v) {
+		auto& stock = stocks[T::STATIC_TYPE];
+		stock.pieces.reserve(count);
+		stock.freeSlots.reserve(count);
+
 		for (int i = 0; i < count; i++) {
-			typename T::Ptr newItem = typename T::Ptr(new T(&player));
+			typename T::Ptr newItem = typename T::Ptr(new T(this));
 			newItem->postInit();
-			newItem->setSubPosition(player.sceneNode, player.getObjectPosition(T::STATIC_TYPE, i));
-			newItem->setRotation(player.getObjectRotation(T::STATIC_TYPE, i));
+			newItem->stockSlot = i;
+			newItem->setSubPosition(sceneNode, getObjectPosition(T::STATIC_TYPE, i));
+			newItem->setRotation(getObjectRotation(T::STATIC_TYPE, i));
 			v.push_back(newItem);
-			player.typedPlayerPieceList[T::STATIC_TYPE].push_back(newItem);
+			typedPlayerPieceList[T::STATIC_TYPE].push_back(newItem);
+		}
+		// The first piece is taken first
+		for (int i = count - 1; i >= 0; i--) {
+			stock.pieces.push_back(i);
 		}
 	}
 
-	Player :: Player(gint _playerId, int playerNumber) : playerId(_playerId), sceneNode(nullptr) {
+	Player :: Player(gint _playerId, int playerNumber) :
+			stockGeometry(nullptr), boardGeometry(nullptr), piecesChanged(true),
+			playerId(_playerId), sceneNode(nullptr) {
 		::Player* player = player_get(_playerId);
 
 		const static Ogre::ColourValue COLOR_ROTATION[8] = {
@@ -339,21 +461,35 @@ namespace pogre {
 
 		std::cout << "Player id = " << playerId << std::endl;
 
-		auto gameParams = get_game_params();
+		// Before the pieces are added, the batched pieces stay hidden
+		sceneNode->setVisible(true, true);
 
-		initPlayerObjects<Village>(*this, gameParams->num_build_type[BUILD_SETTLEMENT], villages);
-		initPlayerObjects<City>(*this, gameParams->num_build_type[BUILD_CITY], cities);
-		initPlayerObjects<Road>(*this, gameParams->num_build_type[BUILD_ROAD], roads);
+		auto gameParams = get_game_params();
 
-		sceneNode->setVisible(true, true);
+		initPlayerObjects<Village>(gameParams->num_build_type[BUILD_SETTLEMENT], villages);
+		initPlayerObjects<City>(gameParams->num_build_type[BUILD_CITY], cities);
+		initPlayerObjects<Road>(gameParams->num_build_type[BUILD_ROAD], roads);
 	}
 
 	Player :: ~Player() {
 		villages.clear();
+		cities.clear();
 		roads.clear();
+		typedPlayerPieceList.clear();
 
+		if (stockGeometry) {
+			mainEngine->mainScene->destroyStaticGeometry(stockGeometry);
+		}
+		if (boardGeometry) {
+			mainEngine->mainScene->destroyStaticGeometry(boardGeometry);
+		}
 		if (sceneNode) {
 			mainEngine->mainScene->destroySceneNode(sceneNode);
 		}
+
+		auto matman = Ogre::MaterialManager::getSingletonPtr();
+		for (const auto& i : materials) {
+			matman->remove(i.second);
+		}
 	}
 }
@@ -13,23 +13,43 @@ extern "C" {
 
 namespace pogre {
 	class Player;
+	class PieceAnimator;
 
 	class PlayerPiece {
 	private:
 		PlayerPiece(PlayerPiece const &) = delete;
 		void operator=(PlayerPiece const &x) = delete;
+
+		friend class Player;
+		friend class PieceAnimator;
 	protected:
+		// A move from where the piece was to its new place, in the space of
+		// its new parent. It is part of the piece, a move allocates nothing.
+		struct MoveState {
+			Ogre::Vector3 fromPosition, toPosition;
+			Ogre::Quaternion fromOrientation, toOrientation;
+			float elapsed;
+			// In the list of the animator, -1 when the piece does not move
+			int index;
+		};
+
 		Ogre::Entity* entity;
-		Ogre::Animation* moveAnimation;
+		MoveState move;
+
+		// The place in the stock of the owner, -1 when on the board
+		int stockSlot;
 
 		Ogre::MaterialPtr material;
 
 		virtual void loadEntity() = 0;
+
+		void updateBatch();
 	public:
 		typedef std::shared_ptr<PlayerPiece> Ptr;
 
-		virtual bool inStock();
-		virtual void returnToStock();
+		bool inStock() const { return stockSlot >= 0; }
+		bool isMoving() const { return move.index >= 0; }
+		virtual void returnToStock(bool animate = true);
 
 		virtual void setRotation(float degrees);
 
@@ -45,12 +65,40 @@ namespace pogre {
 
 		const int id;
 		const int pieceType;
-		const Player* owner;
+		Player* owner;
 
-		PlayerPiece(const Player* owner, int pieceType);
+		PlayerPiece(Player* owner, int pieceType);
 		virtual ~PlayerPiece();
 	};
 
+	/*
+	 * Moves the pieces that are on their way, all in one pass each frame.
+	 */
+	class PieceAnimator {
+	private:
+		std::vector<PlayerPiece*> moving;
+
+		void remove(PlayerPiece* piece);
+	public:
+		typedef std::shared_ptr<PieceAnimator> Ptr;
+
+		static constexpr float MOVE_SECONDS = 0.4f;
+
+		// Room for this many moves at the same time
+		void reserve(size_t pieces);
+
+		void start(PlayerPiece* piece);
+		void stop(PlayerPiece* piece);
+
+		// Returns true while pieces are moving
+		bool update(float stepSeconds);
+
+		PieceAnimator();
+		virtual ~PieceAnimator();
+	};
+
+	extern PieceAnimator* pieceAnimator;
+
 	class Road : public PlayerPiece {
 	protected:
 		virtual void loadEntity() override;
@@ -60,7 +108,7 @@ namespace pogre {
 
 		typedef std::shared_ptr<Road> Ptr;
 
-		Road(const Player* owner);
+		Road(Player* owner);
 		virtual ~Road();
 	};
 
@@ -72,7 +120,7 @@ namespace pogre {
 
 		typedef std::shared_ptr<Village> Ptr;
 
-		Village(const Player* owner);
+		Village(Player* owner);
 		virtual ~Village();
 	};
 
@@ -84,12 +132,34 @@ namespace pogre {
 
 		typedef std::shared_ptr<City> Ptr;
 
-		City(const Player* owner);
+		City(Player* owner);
 		virtual ~City();
 	};
 
 	class Player {
 	private:
+		// The pieces in stock that can be taken, the next one last, and
+		// the slots that are free
+		struct Stock {
+			std::vector<int> pieces;
+			std::vector<int> freeSlots;
+		};
+		Stock stocks[NUM_BUILD_TYPES];
+
+		template <typename T>
+		void initPlayerObjects(int count, std::vector<typename T::Ptr>& v);
+
+		// One material for each base material, shared by all pieces of the player
+		mutable std::map<std::string, Ogre::MaterialPtr> materials;
+
+		// The pieces that do not move are drawn as static geometry, one
+		// for the stock and one for the pieces on the board
+		Ogre::StaticGeometry* stockGeometry;
+		Ogre::StaticGeometry* boardGeometry;
+		mutable bool piecesChanged;
+
+		Ogre::StaticGeometry* buildGeometry(Ogre::StaticGeometry* geometry,
+				const std::string& name, bool stock);
 	public:
 		typedef std::shared_ptr<Player> Ptr;
 		typedef std::map<int, std::vector<PlayerPiece::Ptr>> TPPList;
@@ -105,12 +175,19 @@ namespace pogre {
 
 		Ogre::ColourValue colour;
 
-		int getNextObjectSlotIndex(int type, bool filled) const;
 		Ogre::Vector3 getObjectPosition(int type, int no) const;
 		float getObjectRotation(int type, int no) const;
 		int countObjects(int type) const;
 
-		PlayerPiece::Ptr getStockObject(int type) const;
+		// Takes a piece out of the stock, the caller places it
+		PlayerPiece::Ptr takeStockObject(int type);
+		// Returns the slot the piece is placed in
+		int putInStock(PlayerPiece* piece);
+
+		Ogre::MaterialPtr getMaterial(const std::string& baseMaterialName) const;
+
+		void markPiecesChanged() const { piecesChanged = true; }
+		void updatePieceGeometry();
 
 		void applyNewMap(MapRenderer::Ptr mapRenderer);
 
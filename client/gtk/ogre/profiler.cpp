@@ -0,0 +1,173 @@
+#include "profiler.h"
+#include "frame_scheduler.h"
+
+#include <iostream>
+
+namespace pogre {
+	size_t Profiler :: countNodes(Ogre::Node* node) {
+		size_t count = 1;
+		for (unsigned short i = 0; i < node->numChildren(); i++) {
+			count += countNodes(node->getChild(i));
+		}
+		return count;
+	}
+
+	void Profiler :: beginFrame() {
+		const gint64 now = g_get_monotonic_time();
+		frameStartCpu = FrameScheduler::threadCpuSeconds();
+
+		last.interval = last.frame ? (now - frameStart) / 1000.0 : 0;
+		last.mainLoopCpu = last.frame ? (frameStartCpu - lastFrameEndCpu) * 1000 : 0;
+		last.time = (now - startTime) / 1000.0;
+		last.mapLoad = pendingMapLoad;
+		pendingMapLoad = 0;
+		last.frame++;
+		frameStart = now;
+	}
+
+	void Profiler :: mapLoaded(double milliseconds) {
+		pendingMapLoad += milliseconds;
+		lastMapLoad = milliseconds;
+	}
+
+	void Profiler :: endFrame() {
+		lastFrameEndCpu = FrameScheduler::threadCpuSeconds();
+		last.renderTime = (g_get_monotonic_time() - frameStart) / 1000.0;
+		last.ogreCpu = (lastFrameEndCpu - frameStartCpu) * 1000;
+
+		// The HUD itself is one of the batches when it is shown
+		auto& stats = window->getStatistics();
+		last.batches = stats.batchCount;
+		last.triangles = stats.triangleCount;
+		last.animating = frameScheduler && frameScheduler->isAnimating();
+
+		if (!hudVisible && !csv.is_open()) return;
+		last.sceneNodes = countNodes(scene->getRootSceneNode());
+
+		if (csv.is_open()) writeSample();
+		if (hudVisible) updateHud();
+	}
+
+	void Profiler :: writeSample() {
+		csv << last.frame << ',' << last.time << ',' << last.interval << ','
+				<< last.renderTime << ',' << last.mainLoopCpu << ',' << last.ogreCpu << ','
+				<< last.batches << ',' << last.triangles << ',' << last.sceneNodes << ','
+				<< (last.animating ? 1 : 0) << ',' << last.mapLoad << '\n';
+	}
+
+	void Profiler :: createHud() {
+		surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, HUD_WIDTH, HUD_HEIGHT);
+
+		// Cairo and Ogre both store a pixel as a native 32 bit ARGB value
+		texture = Ogre::TextureManager::getSingleton().createManual("profiler hud", "map",
+				Ogre::TEX_TYPE_2D, HUD_WIDTH, HUD_HEIGHT, 0, Ogre::PF_A8R8G8B8,
+				Ogre::TU_DYNAMIC_WRITE_ONLY_DISCARDABLE);
+
+		// A fixed function pass, which every render system can draw
+		material = Ogre::MaterialManager::getSingleton().create("profiler hud", "map");
+		auto pass = material->getTechnique(0)->getPass(0);
+		pass->setLightingEnabled(false);
+		pass->setDepthCheckEnabled(false);
+		pass->setDepthWriteEnabled(false);
+		// Cairo multiplies the colours with the alpha
+		pass->setSceneBlending(Ogre::SBF_ONE, Ogre::SBF_ONE_MINUS_SOURCE_ALPHA);
+		auto unit = pass->createTextureUnitState();
+		unit->setTexture(texture);
+		unit->setTextureFiltering(Ogre::TFO_NONE);
+
+		rectangle = new Ogre::Rectangle2D(true);
+		rectangle->setMaterial(material);
+		rectangle->setRenderQueueGroup(Ogre::RENDER_QUEUE_OVERLAY);
+		rectangle->setBoundingBox(Ogre::AxisAlignedBox::BOX_INFINITE);
+
+		node = scene->getRootSceneNode()->createChildSceneNode("profiler hud");
+		node->attachObject(rectangle);
+	}
+
+	void Profiler :: updateHud() {
+		// The frames drawn since the start and their average processor time
+		guint64 scheduled = frameScheduler ? frameScheduler->getFramesRendered() : 0;
+		double scheduledCpu = scheduled ? frameScheduler->getCpuSeconds() * 1000 / scheduled : 0;
+
+		gchar* lines[] = {
+			g_strdup_printf("Frame       %" G_GUINT64_FORMAT, last.frame),
+			g_strdup_printf("Interval    %7.2f ms", last.interval),
+			g_strdup_printf("Ogre        %7.2f ms", last.renderTime),
+			g_strdup_printf("CPU GTK     %7.2f ms", last.mainLoopCpu),
+			g_strdup_printf("CPU Ogre    %7.2f ms", last.ogreCpu),
+			g_strdup_printf("Batches %zu, triangles %zu", last.batches, last.triangles),
+			g_strdup_printf("Scene nodes %zu", last.sceneNodes),
+			g_strdup_printf("Scheduler   %s", last.animating ? "animating" : "on request"),
+			g_strdup_printf("Drawn %" G_GUINT64_FORMAT ", %.2f ms CPU each", scheduled, scheduledCpu),
+			g_strdup_printf("Map load    %7.2f ms", lastMapLoad)
+		};
+
+		cairo_t* cr = cairo_create(surface);
+		cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+		cairo_set_source_rgba(cr, 0, 0, 0, 0.6);
+		cairo_paint(cr);
+
+		cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+		cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+		cairo_set_font_size(cr, 12);
+		cairo_set_source_rgb(cr, 1, 1, 1);
+		for (size_t i = 0; i < G_N_ELEMENTS(lines); i++) {
+			cairo_move_to(cr, 8, 15 * (i + 1));
+			cairo_show_text(cr, lines[i]);
+			g_free(lines[i]);
+		}
+		cairo_destroy(cr);
+		cairo_surface_flush(surface);
+
+		Ogre::PixelBox box(HUD_WIDTH, HUD_HEIGHT, 1, Ogre::PF_A8R8G8B8,
+				cairo_image_surface_get_data(surface));
+		texture->getBuffer()->blitFromMemory(box);
+
+		// The same size in pixels, whatever the size of the window
+		rectangle->setCorners(-1, 1,
+				-1 + 2.0f * HUD_WIDTH / window->getWidth(),
+				1 - 2.0f * HUD_HEIGHT / window->getHeight());
+	}
+
+	void Profiler :: setHudVisible(bool visible) {
+		if (visible && !node) {
+			createHud();
+		}
+		hudVisible = visible;
+		if (node) {
+			node->setVisible(visible);
+		}
+		if (visible) {
+			updateHud();
+		}
+	}
+
+	Profiler :: Profiler(Ogre::SceneManager* scene, Ogre::RenderWindow* window, const std::string& csvFile) :
+			scene(scene), window(window),
+			startTime(g_get_monotonic_time()), frameStart(0),
+			frameStartCpu(0), lastFrameEndCpu(0), last(),
+			pendingMapLoad(0), lastMapLoad(0),
+			hudVisible(false), surface(nullptr), rectangle(nullptr), node(nullptr) {
+		if (!csvFile.empty()) {
+			csv.open(csvFile);
+			if (csv.is_open()) {
+				csv << "frame,time_ms,interval_ms,render_ms,gtk_cpu_ms,ogre_cpu_ms,"
+						<< "batches,triangles,scene_nodes,animating,map_load_ms" << '\n';
+				std::cout << "Writing frame times to " << csvFile << std::endl;
+			} else {
+				std::cerr << "Cannot write frame times to " << csvFile << std::endl;
+			}
+		}
+	}
+
+	Profiler :: ~Profiler() {
+		if (node) {
+			node->detachAllObjects();
+			scene->destroySceneNode(node);
+			delete rectangle;
+			Ogre::MaterialManager::getSingleton().remove(material);
+			Ogre::TextureManager::getSingleton().remove(texture);
+			cairo_surface_destroy(surface);
+		}
+	}
+}
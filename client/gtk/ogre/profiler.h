@@ -0,0 +1,95 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <cairo.h>
+#include <glib.h>
+
+#include <Ogre.h>
+
+namespace pogre {
+	/*
+	 * Measures every frame: the time between frames, the time spent in
+	 * Ogre, the processor time of the main loop between frames (GTK events
+	 * and the client) and in Ogre, what was drawn, and whether the frame
+	 * scheduler is animating. The time to build the board of a new map is
+	 * added to the first frame after it. The numbers can be
+	 * shown in the corner of the window and written to a CSV file.
+	 * Only the processor and the statistics of the render target are used,
+	 * so it works the same with a software renderer.
+	 */
+	class Profiler {
+	public:
+		typedef std::shared_ptr<Profiler> Ptr;
+
+		struct FrameSample {
+			guint64 frame;
+			// Milliseconds since the profiler was created
+			double time;
+			double interval;
+			double renderTime;
+			double mainLoopCpu;
+			double ogreCpu;
+			size_t batches;
+			size_t triangles;
+			size_t sceneNodes;
+			bool animating;
+			// Building the board of a map since the previous frame, or 0
+			double mapLoad;
+		};
+
+		static const int HUD_WIDTH = 256;
+		static const int HUD_HEIGHT = 157;
+
+	private:
+		Ogre::SceneManager* scene;
+		Ogre::RenderWindow* window;
+
+		std::ofstream csv;
+
+		gint64 startTime;
+		gint64 frameStart;
+		double frameStartCpu;
+		double lastFrameEndCpu;
+		FrameSample last;
+
+		double pendingMapLoad;
+		double lastMapLoad;
+
+		// The HUD is drawn by cairo into a texture on a rectangle in front
+		bool hudVisible;
+		cairo_surface_t* surface;
+		Ogre::TexturePtr texture;
+		Ogre::MaterialPtr material;
+		Ogre::Rectangle2D* rectangle;
+		Ogre::SceneNode* node;
+
+		static size_t countNodes(Ogre::Node* node);
+		void createHud();
+		void updateHud();
+		void writeSample();
+	public:
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+		// Around Root::renderOneFrame
+		void beginFrame();
+		void endFrame();
+
+		const FrameSample& getLastFrame() const { return last; }
+
+		// A map was loaded in the given number of milliseconds
+		void mapLoaded(double milliseconds);
+
+		bool isHudVisible() const { return hudVisible; }
+		void setHudVisible(bool visible);
+
+		bool isRecording() const { return csv.is_open(); }
+
+		// An empty csvFile does not record the frames
+		Profiler(Ogre::SceneManager* scene, Ogre::RenderWindow* window, const std::string& csvFile);
+		virtual ~Profiler();
+	};
+}
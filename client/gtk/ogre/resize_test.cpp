@@ -0,0 +1,103 @@
+/*
+ * Resizes the window of the 3D board 1000 times and checks that neither the
+ * memory nor the time of a resize grows with the number of resizes. It uses
+ * the headless engine, which resizes as the client does, so it runs with a
+ * software renderer and without GTK.
+ *
+ * Usage: pioneers-3d-resize-test [GAMEFILE]
+ * Exits with 77, the code for a skipped test, when nothing can be drawn.
+ */
+#include "headless_engine.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+	using namespace pogre;
+
+	const int RESIZES = 1000;
+	const int WARM_UP = 100;
+	const int BATCH = 100;
+	// Allowed growth of the resident memory over all resizes
+	const long MAX_GROWTH = 8 * 1024 * 1024;
+
+	// The resident memory in bytes, or -1 when it is not known
+	long residentBytes() {
+		long size, resident;
+		FILE* statm = fopen("/proc/self/statm", "r");
+		if (!statm) return -1;
+		int read = fscanf(statm, "%ld %ld", &size, &resident);
+		fclose(statm);
+		return read == 2 ? resident * sysconf(_SC_PAGESIZE) : -1;
+	}
+
+	// Sizes that differ from one resize to the next
+	void resize(HeadlessEngine& engine, int count) {
+		engine.updateWindowSize(400 + (count * 37) % 400, 300 + (count * 53) % 300);
+		engine.render(0);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Map* map = nullptr;
+	if (argc > 1) {
+		GameParams* params = params_load_file(argv[1]);
+		if (!params || !params->map) {
+			std::cerr << argv[1] << ": cannot load the map" << std::endl;
+			if (params) params_free(params);
+			return 1;
+		}
+		map = map_copy(params->map);
+		params_free(params);
+	}
+
+	bool ok = true;
+	try {
+		HeadlessEngine engine(600, 400);
+		engine.loadNewMap(map);
+		engine.render(0);
+
+		// The first resizes fill the caches of the driver
+		for (int count = 0; count < WARM_UP; count++) {
+			resize(engine, count);
+		}
+
+		const long startMemory = residentBytes();
+		double firstBatch = 0, lastBatch = 0;
+		for (int count = 0; count < RESIZES; count += BATCH) {
+			const gint64 start = g_get_monotonic_time();
+			for (int idx = 0; idx < BATCH; idx++) {
+				resize(engine, count + idx);
+			}
+			lastBatch = (g_get_monotonic_time() - start) / 1000.0 / BATCH;
+			if (count == 0) firstBatch = lastBatch;
+		}
+		const long endMemory = residentBytes();
+
+		std::cout << RESIZES << " resizes: " << firstBatch << " ms each at first, "
+				<< lastBatch << " ms each at last" << std::endl;
+		if (startMemory >= 0 && endMemory >= 0) {
+			std::cout << "Resident memory grew by " << (endMemory - startMemory) / 1024
+					<< " KiB" << std::endl;
+			if (endMemory - startMemory > MAX_GROWTH) {
+				std::cerr << "The memory grows with the resizes" << std::endl;
+				ok = false;
+			}
+		}
+		// A resize may take a little longer by chance, not twice as long
+		if (lastBatch > 2 * firstBatch + 1) {
+			std::cerr << "The resizes get slower" << std::endl;
+			ok = false;
+		}
+		engine.loadNewMap(nullptr);
+	} catch (Ogre::Exception& e) {
+		std::cerr << "Cannot draw: " << e.getDescription() << std::endl;
+		if (map) map_free(map);
+		return 77;
+	}
+
+	if (map) map_free(map);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "resource_loader.h"
+
+#include <iostream>
+#include <set>
+
+namespace pogre {
+	void ResourceLoader :: declareResources() {
+		loadProgramCache();
+
+		auto resgrpman = Ogre::ResourceGroupManager::getSingletonPtr();
+		auto meshes = resgrpman->findResourceNames(group, "*.mesh");
+		for (auto name : *meshes) {
+			resgrpman->declareResource(name, "Mesh", group);
+		}
+	}
+
+	void ResourceLoader :: addResource(Ogre::ResourceManager* manager, const std::string& name) {
+		auto resource = manager->createOrRetrieve(name, group).first;
+		if (!resource->isLoaded()) {
+			resources.push_back(resource);
+		}
+	}
+
+	void ResourceLoader :: start() {
+		startTime = g_get_monotonic_time();
+
+		// The meshes were declared, the textures are the ones the materials use
+		auto meshman = Ogre::MeshManager::getSingletonPtr();
+		auto meshes = Ogre::ResourceGroupManager::getSingleton().findResourceNames(group, "*.mesh");
+		for (auto name : *meshes) {
+			addResource(meshman, name);
+		}
+
+		std::set<std::string> textureNames;
+		auto materials = Ogre::MaterialManager::getSingleton().getResourceIterator();
+		while (materials.hasMoreElements()) {
+			auto material = Ogre::static_pointer_cast<Ogre::Material>(materials.getNext());
+			if (material->getGroup() != group) continue;
+			for (auto technique : material->getTechniques()) {
+				for (auto pass : technique->getPasses()) {
+					for (auto unit : pass->getTextureUnitStates()) {
+						if (!unit->getTextureName().empty()) {
+							textureNames.insert(unit->getTextureName());
+						}
+					}
+				}
+			}
+		}
+		auto texman = Ogre::TextureManager::getSingletonPtr();
+		for (auto name : textureNames) {
+			addResource(texman, name);
+		}
+
+		// All resources are known before the first one completes, the queue
+		// may complete them right away when Ogre has no threads
+		auto queue = Ogre::ResourceBackgroundQueue::getSingletonPtr();
+		for (auto resource : resources) {
+			tickets.push_back(queue->prepare(resource->getCreator()->getResourceType(),
+					resource->getName(), group, false, nullptr, nullptr, this));
+		}
+
+		if (resources.empty()) {
+			finish();
+		}
+	}
+
+	void ResourceLoader :: loadPrepared(bool all) {
+		for (auto resource : resources) {
+			auto state = resource->getLoadingState();
+			if (state == Ogre::Resource::LOADSTATE_PREPARED ||
+					(all && state == Ogre::Resource::LOADSTATE_UNLOADED)) {
+				resource->load();
+				loaded++;
+			}
+		}
+	}
+
+	void ResourceLoader :: reportProgress() {
+		if (progressFunction) {
+			// The materials are the last step
+			progressFunction(ready ? 1.0f : (float) loaded / (resources.size() + 1));
+		}
+	}
+
+	void ResourceLoader :: operationCompleted(Ogre::BackgroundProcessTicket ticket,
+			const Ogre::BackgroundProcessResult& result) {
+		if (result.error) {
+			// It is loaded in the main thread at the end
+			std::cout << "Could not prepare a resource: " << result.message << std::endl;
+		}
+		completed++;
+
+		if (completed < resources.size()) {
+			loadPrepared(false);
+			reportProgress();
+		} else if (!ready) {
+			loadPrepared(true);
+			finish();
+		}
+	}
+
+	void ResourceLoader :: warmMaterials() {
+		auto materials = Ogre::MaterialManager::getSingleton().getResourceIterator();
+		while (materials.hasMoreElements()) {
+			auto material = materials.getNext();
+			if (material->getGroup() == group) {
+				material->load();
+			}
+		}
+	}
+
+	void ResourceLoader :: finish() {
+		warmMaterials();
+		saveProgramCache();
+		tickets.clear();
+
+		ready = true;
+		std::cout << "Loaded " << resources.size() << " resources in "
+				<< (g_get_monotonic_time() - startTime) / 1000.0 << " ms" << std::endl;
+		reportProgress();
+		if (readyFunction) readyFunction();
+	}
+
+	void ResourceLoader :: loadProgramCache() {
+		auto programs = Ogre::GpuProgramManager::getSingletonPtr();
+		programs->setSaveMicrocodesToCache(true);
+
+		if (programCacheFile.empty() ||
+				!g_file_test(programCacheFile.c_str(), G_FILE_TEST_IS_REGULAR)) {
+			return;
+		}
+		programs->loadMicrocodeCache(Ogre::Root::openFileStream(programCacheFile));
+		std::cout << "Shader programs read from " << programCacheFile << std::endl;
+	}
+
+	void ResourceLoader :: saveProgramCache() {
+		auto programs = Ogre::GpuProgramManager::getSingletonPtr();
+		if (!programs || programCacheFile.empty() || !programs->isCacheDirty()) return;
+
+		programs->saveMicrocodeCache(
+				Ogre::Root::createFileStream(programCacheFile, Ogre::RGN_DEFAULT, true));
+		std::cout << "Shader programs written to " << programCacheFile << std::endl;
+	}
+
+	ResourceLoader :: ResourceLoader(const std::string& group, const std::string& programCacheFile,
+			ProgressFunction progressFunction, ReadyFunction readyFunction) :
+			group(group), programCacheFile(programCacheFile),
+			progressFunction(progressFunction), readyFunction(readyFunction),
+			completed(0), loaded(0), ready(false), startTime(0) {
+	}
+
+	ResourceLoader :: ~ResourceLoader() {
+		// The queue must not call back into a deleted listener
+		auto queue = Ogre::ResourceBackgroundQueue::getSingletonPtr();
+		if (queue) {
+			for (auto ticket : tickets) {
+				queue->abortRequest(ticket);
+			}
+		}
+		saveProgramCache();
+	}
+}
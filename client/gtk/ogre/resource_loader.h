@@ -0,0 +1,74 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include <Ogre.h>
+#include <OgreResourceBackgroundQueue.h>
+
+namespace pogre {
+	/*
+	 * Loads the meshes, textures and materials of a resource group before
+	 * they are needed, so placing the first piece does not stall the window.
+	 * The files are read and decoded by the background queue of Ogre, the
+	 * upload to the graphics card is done between frames, because only the
+	 * main thread may use the render system.
+	 * The compiled shader programs are kept in a cache file, the next start
+	 * does not need to compile them again.
+	 */
+	class ResourceLoader : public Ogre::ResourceBackgroundQueue::Listener {
+	public:
+		typedef std::shared_ptr<ResourceLoader> Ptr;
+
+		// Called with the part of the resources that is loaded, from 0 to 1
+		typedef std::function<void(float progress)> ProgressFunction;
+		// Called once when everything is loaded
+		typedef std::function<void()> ReadyFunction;
+
+	private:
+		std::string group;
+		std::string programCacheFile;
+
+		ProgressFunction progressFunction;
+		ReadyFunction readyFunction;
+
+		// Resources that are prepared in the background
+		std::vector<Ogre::ResourcePtr> resources;
+		std::vector<Ogre::BackgroundProcessTicket> tickets;
+		size_t completed;
+		size_t loaded;
+		bool ready;
+		gint64 startTime;
+
+		void addResource(Ogre::ResourceManager* manager, const std::string& name);
+		void loadPrepared(bool all);
+		void reportProgress();
+		void warmMaterials();
+		void finish();
+		void loadProgramCache();
+	public:
+		ResourceLoader(const ResourceLoader&) = delete;
+		ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+		// Must be called before the resource group is initialised
+		void declareResources();
+		// Must be called after the resource group is initialised
+		void start();
+
+		bool isReady() const { return ready; }
+
+		// Writes the compiled programs to the cache, when there are new ones
+		void saveProgramCache();
+
+		virtual void operationCompleted(Ogre::BackgroundProcessTicket ticket,
+				const Ogre::BackgroundProcessResult& result) override;
+
+		ResourceLoader(const std::string& group, const std::string& programCacheFile,
+				ProgressFunction progressFunction, ReadyFunction readyFunction);
+		virtual ~ResourceLoader();
+	};
+}
@@ -339,7 +339,7 @@ void frontend_new_statistics(gint player_num, StatisticType type,
 				   SUMMARY_COLUMN_SCORE, points, -1);
 		g_free(desc);
 	}
-	frontend_gui_update();
+	frontend_gui_update_facets(0);
 }
 
 void frontend_new_points(gint player_num, Points * points, gboolean added)
@@ -360,7 +360,7 @@ void frontend_new_points(gint player_num, Points * points, gboolean added)
 		if (pp.result != FIND_MATCH_EXACT)
 			g_error("cannot remove point");
 		gtk_list_store_remove(summary_store, &pp.iter);
-		frontend_gui_update();
+		frontend_gui_update_facets(0);
 		return;
 	}
 
@@ -387,7 +387,7 @@ void frontend_new_points(gint player_num, Points * points, gboolean added)
 			   SUMMARY_COLUMN_STATISTIC, 0,
 			   SUMMARY_COLUMN_POINTS_ID, points->id,
 			   SUMMARY_COLUMN_SCORE, score, -1);
-	frontend_gui_update();
+	frontend_gui_update_facets(0);
 }
 
 static void player_create_find_player(gint player_num, GtkTreeIter * iter)
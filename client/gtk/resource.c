@@ -119,5 +119,5 @@ void frontend_resource_change(Resource type, G_GNUC_UNUSED gint new_amount)
 					    (asset_total_label)));
 		rebuild_single_resource(type);
 	}
-	frontend_gui_update();
+	frontend_gui_update_facets(GUI_FACET_HAND);
 }
@@ -21,37 +21,229 @@
 
 #include "config.h"
 #include <glib.h>
+#include <glib/gstdio.h>
 #include "game-list.h"
 #include "log.h"
 #include "network.h"
 
-static GSList *_game_list = NULL;	/* The list of GameParams, ordered by title */
+/* Version of the layout of the catalogue cache */
+#define GAME_CACHE_VERSION 2
+#define GAME_CACHE_TYPE "(ua(sxtsb))"
+
+typedef struct {
+	gchar *filename;
+	gchar *title;		/* title in the list, can differ from the file */
+	gboolean is_unstartable;	/* see params_game_is_unstartable */
+	GameParams *params;	/* NULL until the game is needed */
+} GameListItem;
+
+typedef struct {
+	gint64 mtime;
+	guint64 size;
+	gchar *title;
+	gboolean is_unstartable;
+} GameCacheEntry;
+
+static GSList *_game_list = NULL;	/* The list of GameListItem, ordered by title */
+
+/* Titles of the game files, by filename, to avoid parsing unused games.
+ * The entries are only used while the size and mtime of the file match.
+ * Entries are moved from game_cache to game_cache_seen when the file
+ * is found, only the files that still exist are saved. */
+static GHashTable *game_cache = NULL;
+static GHashTable *game_cache_seen = NULL;
+static gboolean game_cache_changed;
 
 static gint sort_function(gconstpointer a, gconstpointer b)
 {
-	return (strcmp(((const GameParams *) a)->title,
-		       ((const GameParams *) b)->title));
+	return (g_strcmp0(((const GameListItem *) a)->title,
+			  ((const GameListItem *) b)->title));
+}
+
+static void game_cache_entry_free(GameCacheEntry * entry)
+{
+	g_free(entry->title);
+	g_free(entry);
+}
+
+static gchar *game_cache_filename(void)
+{
+	if (g_getenv("PIONEERS_NO_GAME_CACHE") != NULL)
+		return NULL;
+	return g_build_filename(g_get_user_cache_dir(), "pioneers",
+				"games.cache", NULL);
 }
 
-static gboolean game_list_add_item(GameParams * item)
+static void game_cache_load(void)
 {
+	gchar *filename;
+	gchar *contents;
+	gsize length;
+	GVariant *cache;
+	GVariantIter *iter;
+	guint version;
+	const gchar *game_filename;
+	const gchar *title;
+	gint64 mtime;
+	guint64 size;
+	gboolean is_unstartable;
+
+	game_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					   (GDestroyNotify)
+					   game_cache_entry_free);
+	game_cache_seen =
+	    g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+				  (GDestroyNotify) game_cache_entry_free);
+	game_cache_changed = FALSE;
+
+	filename = game_cache_filename();
+	if (filename == NULL)
+		return;
+	if (!g_file_get_contents(filename, &contents, &length, NULL)) {
+		g_free(filename);
+		return;
+	}
+	g_free(filename);
+
+	/* Untrusted data: GVariant checks the serialisation on access */
+	cache =
+	    g_variant_new_from_data(G_VARIANT_TYPE(GAME_CACHE_TYPE),
+				    contents, length, FALSE, g_free,
+				    contents);
+	g_variant_get(cache, GAME_CACHE_TYPE, &version, &iter);
+	if (version == GAME_CACHE_VERSION) {
+		while (g_variant_iter_next
+		       (iter, "(&sxt&sb)", &game_filename, &mtime, &size,
+			&title, &is_unstartable)) {
+			GameCacheEntry *entry = g_malloc(sizeof(*entry));
+			entry->mtime = mtime;
+			entry->size = size;
+			entry->title = g_strdup(title);
+			entry->is_unstartable = is_unstartable;
+			g_hash_table_insert(game_cache,
+					    g_strdup(game_filename), entry);
+		}
+	}
+	g_variant_iter_free(iter);
+	g_variant_unref(cache);
+}
+
+static void game_cache_save(void)
+{
+	gchar *filename;
+	GVariantBuilder builder;
+	GVariant *cache;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	/* Forget the files that were removed */
+	if (g_hash_table_size(game_cache) > 0)
+		game_cache_changed = TRUE;
+
+	filename = game_cache_filename();
+	if (filename != NULL && game_cache_changed) {
+		gchar *directory = g_path_get_dirname(filename);
+
+		g_variant_builder_init(&builder,
+				       G_VARIANT_TYPE("a(sxtsb)"));
+		g_hash_table_iter_init(&iter, game_cache_seen);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			GameCacheEntry *entry = value;
+			g_variant_builder_add(&builder, "(sxtsb)", key,
+					      entry->mtime, entry->size,
+					      entry->title,
+					      entry->is_unstartable);
+		}
+		cache =
+		    g_variant_ref_sink(g_variant_new
+				       (GAME_CACHE_TYPE, GAME_CACHE_VERSION,
+					&builder));
+		/* The cache is optional, ignore errors */
+		if (g_mkdir_with_parents(directory, 0755) == 0)
+			g_file_set_contents(filename,
+					    g_variant_get_data(cache),
+					    (gssize)
+					    g_variant_get_size(cache),
+					    NULL);
+		g_variant_unref(cache);
+		g_free(directory);
+	}
+	g_free(filename);
+	g_hash_table_destroy(game_cache);
+	game_cache = NULL;
+	g_hash_table_destroy(game_cache_seen);
+	game_cache_seen = NULL;
+}
+
+/** Load the game of the item, when it was not loaded yet.
+ * @return The game, or NULL if it can not be loaded (anymore)
+ */
+static GameParams *game_list_item_load(GameListItem * item)
+{
+	if (item->params == NULL) {
+		item->params = params_load_file(item->filename);
+		if (item->params == NULL) {
+			log_message(MSG_ERROR,
+				    _("Unable to load game: '%s'\n"),
+				    item->filename);
+			return NULL;
+		}
+		if (g_strcmp0(item->params->title, item->title) != 0) {
+			/* The title was made unique */
+			g_free(item->params->title);
+			item->params->title = g_strdup(item->title);
+		}
+	}
+	return item->params;
+}
+
+static void game_list_item_free(GameListItem * item)
+{
+	params_free(item->params);
+	g_free(item->filename);
+	g_free(item->title);
+	g_free(item);
+}
+
+static GameListItem *game_list_find(const gchar * title)
+{
+	GSList *list;
+
+	for (list = _game_list; list != NULL; list = g_slist_next(list)) {
+		GameListItem *item = list->data;
+		if (g_strcmp0(item->title, title) == 0)
+			return item;
+	}
+	return NULL;
+}
+
+static gboolean game_list_add_item(GameListItem * item)
+{
+	GameListItem *other;
+
 	/* check for name collisions */
-	if (item->title && game_list_find_item(item->title)) {
+	if (item->title && (other = game_list_find(item->title)) != NULL) {
 
 		gchar *nt;
 		gint i;
+		const GameParams *params = game_list_item_load(item);
+		const GameParams *other_params =
+		    game_list_item_load(other);
 
-		if (params_is_equal
-		    (item, game_list_find_item(item->title))) {
+		if (params == NULL || other_params == NULL
+		    || params_is_equal(params, other_params)) {
 			return FALSE;
 		}
 
 		/* append a number */
 		for (i = 1; i <= INT_MAX; i++) {
 			nt = g_strdup_printf("%s%d", item->title, i);
-			if (!game_list_find_item(nt)) {
+			if (!game_list_find(nt)) {
 				g_free(item->title);
 				item->title = nt;
+				g_free(item->params->title);
+				item->params->title = g_strdup(nt);
 				break;
 			}
 			g_free(nt);
@@ -74,31 +266,40 @@ gboolean game_list_is_empty(void)
 	return _game_list == NULL;
 }
 
-static gint game_list_locate(gconstpointer param, gconstpointer argument)
-{
-	const GameParams *data = param;
-	const gchar *title = argument;
-	return strcmp(data->title, title);
-}
-
 const GameParams *game_list_find_item(const gchar * title)
 {
-	GSList *result;
-	if (!_game_list) {
-		return NULL;
-	}
+	GameListItem *item = game_list_find(title);
 
-	result = g_slist_find_custom(_game_list, title, game_list_locate);
-	if (result)
-		return result->data;
-	else
+	if (item == NULL)
 		return NULL;
+	return game_list_item_load(item);
 }
 
 void game_list_foreach(GFunc func, gpointer user_data)
 {
-	if (_game_list) {
-		g_slist_foreach(_game_list, func, user_data);
+	GSList *list;
+
+	for (list = _game_list; list != NULL; list = g_slist_next(list)) {
+		GameParams *params = game_list_item_load(list->data);
+		if (params != NULL)
+			func(params, user_data);
+	}
+}
+
+/** Call func with the title of each game, without loading the games.
+ * @param func Called with the title and user_data
+ * @param startable_only Skip the games that can not be started
+ * @param user_data Passed to func
+ */
+void game_list_foreach_title(GFunc func, gboolean startable_only,
+			     gpointer user_data)
+{
+	GSList *list;
+
+	for (list = _game_list; list != NULL; list = g_slist_next(list)) {
+		GameListItem *item = list->data;
+		if (!startable_only || !item->is_unstartable)
+			func(item->title, user_data);
 	}
 }
 
@@ -116,22 +317,63 @@ static void game_list_prepare_directory(const gchar * directory)
 	}
 
 	while ((fname = g_dir_read_name(dir))) {
-		GameParams *params;
+		GameListItem *item;
+		GameCacheEntry *entry;
+		gpointer key;
+		gpointer value;
+		GStatBuf info;
 		size_t len = strlen(fname);
 
 		if (len < 6 || strcmp(fname + len - 5, ".game") != 0)
 			continue;
 		fullname = g_build_filename(directory, fname, NULL);
-		params = params_load_file(fullname);
-		if (params) {
-			if (!game_list_add_item(params))
-				params_free(params);
-		} else {
+		if (g_stat(fullname, &info) != 0) {
 			log_message(MSG_ERROR,
 				    _("Unable to load game: '%s'\n"),
 				    fullname);
+			g_free(fullname);
+			continue;
+		}
+
+		item = g_malloc0(sizeof(*item));
+		item->filename = fullname;
+		if (g_hash_table_lookup_extended
+		    (game_cache, fullname, &key, &value)
+		    && ((GameCacheEntry *) value)->mtime ==
+		    (gint64) info.st_mtime
+		    && ((GameCacheEntry *) value)->size ==
+		    (guint64) info.st_size) {
+			entry = value;
+			item->title = g_strdup(entry->title);
+			item->is_unstartable = entry->is_unstartable;
+			g_hash_table_steal(game_cache, key);
+			g_hash_table_insert(game_cache_seen, key, entry);
+		} else {
+			item->params = params_load_file(fullname);
+			if (item->params == NULL) {
+				log_message(MSG_ERROR,
+					    _("Unable to load game: '%s'\n"),
+					    fullname);
+				game_list_item_free(item);
+				continue;
+			}
+			item->title = g_strdup(item->params->title);
+			item->is_unstartable =
+			    params_game_is_unstartable(item->params);
+			if (item->title != NULL) {
+				entry = g_malloc(sizeof(*entry));
+				entry->mtime = (gint64) info.st_mtime;
+				entry->size = (guint64) info.st_size;
+				entry->title = g_strdup(item->title);
+				entry->is_unstartable = item->is_unstartable;
+				g_hash_table_insert(game_cache_seen,
+						    g_strdup(fullname),
+						    entry);
+				game_cache_changed = TRUE;
+			}
 		}
-		g_free(fullname);
+		if (!game_list_add_item(item))
+			game_list_item_free(item);
 	}
 	g_dir_close(dir);
 }
@@ -140,6 +382,8 @@ void game_list_prepare(void)
 {
 	gchar *directory;
 
+	game_cache_load();
+
 	directory =
 	    g_build_filename(g_get_user_data_dir(), "pioneers", NULL);
 	game_list_prepare_directory(directory);
@@ -147,6 +391,8 @@ void game_list_prepare(void)
 
 	game_list_prepare_directory(get_pioneers_dir());
 
+	game_cache_save();
+
 	if (game_list_is_empty())
 		log_message(MSG_ERROR, _("No games available\n"));
 }
@@ -155,8 +401,9 @@ void game_list_cleanup(void)
 {
 	GSList *games = _game_list;
 	while (games) {
-		params_free(games->data);
+		game_list_item_free(games->data);
 		games = g_slist_next(games);
 	}
 	g_slist_free(_game_list);
+	_game_list = NULL;
 }
@@ -27,6 +27,8 @@
 void game_list_prepare(void);
 const GameParams *game_list_find_item(const gchar * title);
 void game_list_foreach(GFunc func, gpointer user_data);
+void game_list_foreach_title(GFunc func, gboolean startable_only,
+			     gpointer user_data);
 void game_list_cleanup(void);
 gboolean game_list_is_empty(void);
 
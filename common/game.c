@@ -167,6 +167,48 @@ static gboolean match_word(const gchar ** str, const gchar * word)
 	return FALSE;
 }
 
+/** Find the parameter at the start of the line.
+ * @retval str The line, on success set to the text after the keyword
+ * @return The parameter, or NULL
+ */
+static const Param *find_param(const gchar ** str)
+{
+	static GHashTable *param_index = NULL;	/* name -> Param */
+	gchar name[32];
+	const gchar *end;
+	const Param *param;
+	guint idx;
+
+	if (g_once_init_enter(&param_index)) {
+		GHashTable *table = g_hash_table_new(g_str_hash,
+						     g_str_equal);
+		for (idx = 0; idx < G_N_ELEMENTS(game_params); idx++)
+			g_hash_table_insert(table,
+					    (gpointer) game_params[idx].name,
+					    game_params + idx);
+		g_once_init_leave(&param_index, table);
+	}
+
+	end = *str;
+	while (*end != '\0' && !isspace(*end))
+		end++;
+	if ((size_t) (end - *str) < sizeof(name)) {
+		memcpy(name, *str, (size_t) (end - *str));
+		name[end - *str] = '\0';
+		param = g_hash_table_lookup(param_index, name);
+		if (param != NULL) {
+			*str = skip_space(end);
+			return param;
+		}
+	}
+
+	/* The keyword is not followed by a space, e.g. #comment */
+	for (idx = 0; idx < G_N_ELEMENTS(game_params); idx++)
+		if (match_word(str, game_params[idx].name))
+			return game_params + idx;
+	return NULL;
+}
+
 GArray *build_int_list(const gchar * str)
 {
 	GArray *array = g_array_new(FALSE, FALSE, sizeof(gint));
@@ -410,7 +452,7 @@ void params_write_lines(const GameParams * params,
 
 gboolean params_load_line(GameParams * params, const gchar * line)
 {
-	guint idx;
+	const Param *param;
 
 	if (params->map == NULL)
 		params->map = map_new();
@@ -460,13 +502,11 @@ gboolean params_load_line(GameParams * params, const gchar * line)
 		return TRUE;
 	}
 
-	for (idx = 0; idx < G_N_ELEMENTS(game_params); idx++) {
-		Param *param = game_params + idx;
+	param = find_param(&line);
+	if (param != NULL) {
 		gchar *str;
 		GArray *array;
 
-		if (!match_word(&line, param->name))
-			continue;
 		switch (param->type) {
 		case PARAM_SINGLE_LINE:
 			str =
@@ -541,50 +581,57 @@ gboolean params_load_line(GameParams * params, const gchar * line)
 gboolean read_line_from_file(gchar ** line, FILE * f)
 {
 	gchar part[512];
-	size_t len;
+	GString *str;
 
 	if (fgets(part, sizeof(part), f) == NULL)
 		return FALSE;
 
-	len = strlen(part);
-	g_assert(len > 0);
-	*line = g_strdup(part);
-	while ((*line)[len - 1] != '\n') {
-		gchar *oldline;
-		if (fgets(part, sizeof(part), f) == NULL)
-			break;
-		oldline = *line;
-		*line = g_strdup_printf("%s%s", *line, part);
-		g_free(oldline);
-		len = strlen(*line);
-	}
+	str = g_string_new(part);
+	g_assert(str->len > 0);
+	while (str->str[str->len - 1] != '\n'
+	       && fgets(part, sizeof(part), f) != NULL)
+		g_string_append(str, part);
 	/* In case of error or EOF, just return the part we have.
 	 * Otherwise, strip the newline.  */
-	if ((*line)[len - 1] == '\n')
-		(*line)[len - 1] = '\0';
+	if (str->str[str->len - 1] == '\n')
+		g_string_truncate(str, str->len - 1);
+	*line = g_string_free(str, FALSE);
 	return TRUE;
 }
 
 GameParams *params_load_file(const gchar * fname)
 {
-	FILE *fp;
+	gchar *contents;
+	gsize length;
 	gchar *line;
 	GameParams *params;
 
-	if ((fp = fopen(fname, "r")) == NULL) {
+	/* Read the whole file at once, and parse the lines in place */
+	if (!g_file_get_contents(fname, &contents, &length, NULL)) {
 		g_warning("could not open '%s'", fname);
 		return NULL;
 	}
 
 	params = params_new();
-	while (read_line_from_file(&line, fp) && params) {
+	line = contents;
+	while (line < contents + length && params) {
+		gchar *end = memchr(line, '\n',
+				    (size_t) (contents + length - line));
+		gchar *next;
+
+		if (end != NULL) {
+			*end = '\0';
+			next = end + 1;
+		} else {
+			next = contents + length;
+		}
 		if (!params_load_line(params, line)) {
 			params_free(params);
 			params = NULL;
 		}
-		g_free(line);
+		line = next;
 	}
-	fclose(fp);
+	g_free(contents);
 	if (params && !params_load_finish(params)) {
 		params_free(params);
 		return NULL;
@@ -596,7 +643,7 @@ GameParams *params_copy(const GameParams * params)
 {
 	GameParams *copy;
 	guint idx;
-	gchar *buff;
+	const GArray *array;
 
 	if (params == NULL)
 		return NULL;
@@ -626,17 +673,20 @@ GameParams *params_copy(const GameParams * params)
 						    param->offset);
 			break;
 		case PARAM_INTLIST:
-			buff =
-			    format_int_list("",
-					    G_STRUCT_MEMBER_CONST(GArray *,
-								  params,
-								  param->
-								  offset));
-			if (buff != NULL) {
+			array =
+			    G_STRUCT_MEMBER_CONST(GArray *, params,
+						  param->offset);
+			if (array != NULL && array->len > 0) {
+				GArray *array_copy =
+				    g_array_sized_new(FALSE, FALSE,
+						      sizeof(gint),
+						      array->len);
+				g_array_append_vals(array_copy,
+						    array->data,
+						    array->len);
 				G_STRUCT_MEMBER(GArray *, copy,
 						param->offset) =
-				    build_int_list(buff);
-				g_free(buff);
+				    array_copy;
 			}
 			break;
 		case PARAM_OBSOLETE_DATA:
@@ -647,6 +697,7 @@ GameParams *params_copy(const GameParams * params)
 
 	copy->quit_when_done = params->quit_when_done;
 	copy->tournament_time = params->tournament_time;
+	copy->balanced_terrain = params->balanced_terrain;
 	return copy;
 }
 
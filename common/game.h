@@ -108,6 +108,7 @@ typedef struct {
 	gboolean parsing_map;	/* currently parsing map? *//* Not in game_params[] */
 	guint tournament_time;	/* time to start tournament time in minutes *//* Not in game_params[] */
 	gboolean quit_when_done;	/* server quits after someone wins *//* Not in game_params[] */
+	gboolean balanced_terrain;	/* choose the fairest shuffle? *//* Not in game_params[] */
 	gboolean use_pirate;	/* is there a pirate in this game? */
 	GArray *island_discovery_bonus;	/* list of VPs for discovering an island */
 	gchar *comments;	/* information regarding the map */
@@ -31,6 +31,51 @@ static GtkWidget *message_txt;
 static GtkWidget *message_container;
 static gboolean msg_colors = TRUE;
 
+/* At most this many lines are kept in the message window,
+ * the oldest lines are removed first */
+#define MESSAGE_MAX_LINES 2000
+
+/* A message that is not in the message window yet */
+typedef struct {
+	gint msg_type;
+	gchar *text;
+} PendingMessage;
+
+static GQueue pending_messages = G_QUEUE_INIT;
+static guint flush_source;
+
+/* The message types that can be hidden together */
+static const gint chat_types[] = {
+	MSG_CHAT, MSG_SPECTATOR_CHAT, MSG_BEEP, MSG_PLAYER1, MSG_PLAYER2,
+	MSG_PLAYER3, MSG_PLAYER4, MSG_PLAYER5, MSG_PLAYER6, MSG_PLAYER7,
+	MSG_PLAYER8, 0
+};
+static const gint dice_types[] = { MSG_DICE, 0 };
+static const gint resource_types[] = { MSG_RESOURCE, 0 };
+static const gint build_types[] = { MSG_BUILD, 0 };
+static const gint trade_types[] = { MSG_TRADE, 0 };
+static const gint card_types[] = {
+	MSG_DEVCARD, MSG_STEAL, MSG_LARGESTARMY, MSG_LONGESTROAD, 0
+};
+
+static const struct {
+	const gchar *label;
+	const gint *types;
+} message_filters[] = {
+	/* Filter in the message window */
+	{N_("Show chat"), chat_types},
+	/* Filter in the message window */
+	{N_("Show dice rolls"), dice_types},
+	/* Filter in the message window */
+	{N_("Show resources"), resource_types},
+	/* Filter in the message window */
+	{N_("Show buildings"), build_types},
+	/* Filter in the message window */
+	{N_("Show trades"), trade_types},
+	/* Filter in the message window */
+	{N_("Show cards and robberies"), card_types}
+};
+
 /* Local function prototypes */
 static void gtk_event_cleanup(void);
 static void message_window_log_message_string(gint msg_type,
@@ -47,111 +92,152 @@ void log_set_func_message_color_enable(gboolean enable)
 	msg_colors = enable;
 }
 
-/* Write a message string to the console, setting its color based on its
- *   type.
- */
-void message_window_log_message_string(gint msg_type, const gchar * text)
+/* The name of the tag with the color of a message type */
+static const gchar *message_color_tag(gint msg_type)
 {
-	GtkTextBuffer *buffer;
-	GtkTextIter iter;
-	GtkTextMark *end_mark;
-	const gchar *tagname;
-
-	if (message_txt == NULL)
-		return;		/* No widget set */
-
 	/* First determine if the requested color is for chat.
 	 * Chat colors are separately turned on/off
 	 */
 	switch (msg_type) {
 	case MSG_PLAYER1:
-		tagname = "player1";
-		break;
+		return "player1";
 	case MSG_PLAYER2:
-		tagname = "player2";
-		break;
+		return "player2";
 	case MSG_PLAYER3:
-		tagname = "player3";
-		break;
+		return "player3";
 	case MSG_PLAYER4:
-		tagname = "player4";
-		break;
+		return "player4";
 	case MSG_PLAYER5:
-		tagname = "player5";
-		break;
+		return "player5";
 	case MSG_PLAYER6:
-		tagname = "player6";
-		break;
+		return "player6";
 	case MSG_PLAYER7:
-		tagname = "player7";
-		break;
+		return "player7";
 	case MSG_PLAYER8:
-		tagname = "player8";
-		break;
+		return "player8";
 	default:
-		/* Not chat related, check whether other messages
-		 * use color
-		 */
-		if (!msg_colors)
-			tagname = "black";
-		else
-			switch (msg_type) {
-			case MSG_ERROR:
-				tagname = "red";
-				break;
-			case MSG_TIMESTAMP:
-			case MSG_INFO:
-				tagname = "info";
-				break;
-			case MSG_CHAT:
-				tagname = "chat";
-				break;
-			case MSG_SPECTATOR_CHAT:
-				tagname = "chat";
-				break;
-			case MSG_RESOURCE:
-				tagname = "resource";
-				break;
-			case MSG_BUILD:
-				tagname = "build";
-				break;
-			case MSG_DICE:
-				tagname = "dice";
-				break;
-			case MSG_STEAL:
-				tagname = "steal";
-				break;
-			case MSG_TRADE:
-				tagname = "trade";
-				break;
-			case MSG_DEVCARD:
-				tagname = "devcard";
-				break;
-			case MSG_LARGESTARMY:
-				tagname = "largest";
-				break;
-			case MSG_LONGESTROAD:
-				tagname = "longest";
-				break;
-			case MSG_BEEP:
-				tagname = "beep";
-				break;
-			default:
-				tagname = "green";
-			};
 		break;
 	}
 
-	if (message_container != NULL) {
-		gtk_widget_show(message_container);
+	/* Not chat related, check whether other messages use color */
+	if (!msg_colors)
+		return "black";
+	switch (msg_type) {
+	case MSG_ERROR:
+		return "red";
+	case MSG_TIMESTAMP:
+	case MSG_INFO:
+		return "info";
+	case MSG_CHAT:
+		return "chat";
+	case MSG_SPECTATOR_CHAT:
+		return "chat";
+	case MSG_RESOURCE:
+		return "resource";
+	case MSG_BUILD:
+		return "build";
+	case MSG_DICE:
+		return "dice";
+	case MSG_STEAL:
+		return "steal";
+	case MSG_TRADE:
+		return "trade";
+	case MSG_DEVCARD:
+		return "devcard";
+	case MSG_LARGESTARMY:
+		return "largest";
+	case MSG_LONGESTROAD:
+		return "longest";
+	case MSG_BEEP:
+		return "beep";
+	default:
+		return "green";
 	}
+}
+
+/* The tag that marks the lines of a message type.
+ * Hiding the lines of a type only changes this tag.
+ */
+static GtkTextTag *message_type_tag(GtkTextBuffer * buffer, gint msg_type)
+{
+	GtkTextTag *tag;
+	gchar name[16];
+
+	g_snprintf(name, sizeof(name), "type%d", msg_type);
+	tag = gtk_text_tag_table_lookup(gtk_text_buffer_get_tag_table
+					(buffer), name);
+	if (tag == NULL)
+		tag = gtk_text_buffer_create_tag(buffer, name, NULL);
+	return tag;
+}
+
+/* Add the pending messages to the message window, at most once
+ * per frame. The parts of a line (timestamp, player name, chat) are
+ * shown or hidden together, with the type of the last part.
+ */
+static gboolean message_window_flush(G_GNUC_UNUSED gpointer user_data)
+{
+	GtkTextBuffer *buffer;
+	GtkTextTagTable *table;
+	GtkTextIter iter;
+	GtkTextMark *end_mark;
+	GList *line_start;
+	GList *list;
+	gint lines;
+
+	flush_source = 0;
+	if (message_txt == NULL)
+		return FALSE;
 
 	buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(message_txt));
+	table = gtk_text_buffer_get_tag_table(buffer);
 
 	/* insert text at the end */
 	gtk_text_buffer_get_end_iter(buffer, &iter);
-	gtk_text_buffer_insert_with_tags_by_name(buffer, &iter, text, -1,
-						 tagname, NULL);
+	line_start = pending_messages.head;
+	for (list = pending_messages.head; list != NULL;
+	     list = g_list_next(list)) {
+		PendingMessage *msg = list->data;
+		GtkTextTag *type_tag;
+		GList *part;
+
+		if (list->next != NULL && !g_str_has_suffix(msg->text, "\n"))
+			continue;
+
+		type_tag = message_type_tag(buffer, msg->msg_type);
+		for (part = line_start; part != list->next;
+		     part = g_list_next(part)) {
+			PendingMessage *part_msg = part->data;
+
+			gtk_text_buffer_insert_with_tags(buffer, &iter,
+							 part_msg->text, -1,
+							 gtk_text_tag_table_lookup
+							 (table,
+							  message_color_tag
+							  (part_msg->msg_type)),
+							 type_tag, NULL);
+		}
+		line_start = list->next;
+	}
+
+	while (!g_queue_is_empty(&pending_messages)) {
+		PendingMessage *msg = g_queue_pop_head(&pending_messages);
+		g_free(msg->text);
+		g_free(msg);
+	}
+
+	/* remove the oldest lines */
+	lines = gtk_text_buffer_get_line_count(buffer);
+	if (lines > MESSAGE_MAX_LINES + 1) {
+		GtkTextIter start;
+		GtkTextIter end;
+
+		gtk_text_buffer_get_start_iter(buffer, &start);
+		gtk_text_buffer_get_iter_at_line(buffer, &end,
+						 lines - MESSAGE_MAX_LINES -
+						 1);
+		gtk_text_buffer_delete(buffer, &start, &end);
+	}
 
 	/* move cursor to the end */
 	gtk_text_buffer_get_end_iter(buffer, &iter);
@@ -161,6 +247,99 @@ void message_window_log_message_string(gint msg_type, const gchar * text)
 	g_assert(end_mark != NULL);
 	gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(message_txt), end_mark,
 				     0.0, FALSE, 0.0, 0.0);
+	return FALSE;
+}
+
+/* Write a message string to the console, setting its color based on its
+ *   type. The message is shown before the next frame is drawn.
+ */
+void message_window_log_message_string(gint msg_type, const gchar * text)
+{
+	PendingMessage *msg;
+
+	if (message_txt == NULL)
+		return;		/* No widget set */
+
+	if (message_container != NULL) {
+		gtk_widget_show(message_container);
+	}
+
+	msg = g_malloc(sizeof(*msg));
+	msg->msg_type = msg_type;
+	msg->text = g_strdup(text);
+	g_queue_push_tail(&pending_messages, msg);
+
+	/* GTK draws at G_PRIORITY_HIGH_IDLE + 20 */
+	if (flush_source == 0)
+		flush_source =
+		    g_idle_add_full(G_PRIORITY_HIGH_IDLE + 10,
+				    message_window_flush, NULL, NULL);
+}
+
+void message_window_set_visible(gint msg_type, gboolean visible)
+{
+	GtkTextBuffer *buffer;
+
+	g_return_if_fail(message_txt != NULL);
+
+	buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(message_txt));
+	g_object_set(message_type_tag(buffer, msg_type), "invisible",
+		     !visible, NULL);
+}
+
+gboolean message_window_get_visible(gint msg_type)
+{
+	GtkTextBuffer *buffer;
+	gboolean invisible;
+
+	g_return_val_if_fail(message_txt != NULL, TRUE);
+
+	buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(message_txt));
+	g_object_get(message_type_tag(buffer, msg_type), "invisible",
+		     &invisible, NULL);
+	return !invisible;
+}
+
+static void message_filter_toggled_cb(GtkCheckMenuItem * item,
+				      gpointer user_data)
+{
+	const gint *types = user_data;
+	gboolean visible = gtk_check_menu_item_get_active(item);
+
+	for (; *types != 0; types++)
+		message_window_set_visible(*types, visible);
+}
+
+/* Add the filters to the context menu of the message window */
+static void message_populate_popup_cb(G_GNUC_UNUSED GtkTextView * view,
+				      GtkWidget * popup,
+				      G_GNUC_UNUSED gpointer user_data)
+{
+	GtkWidget *item;
+	guint idx;
+
+	if (!GTK_IS_MENU(popup))
+		return;
+
+	item = gtk_separator_menu_item_new();
+	gtk_widget_show(item);
+	gtk_menu_shell_append(GTK_MENU_SHELL(popup), item);
+
+	for (idx = 0; idx < G_N_ELEMENTS(message_filters); idx++) {
+		item =
+		    gtk_check_menu_item_new_with_label(_
+						       (message_filters
+							[idx].label));
+		gtk_check_menu_item_set_active(GTK_CHECK_MENU_ITEM(item),
+					       message_window_get_visible
+					       (message_filters[idx].types
+						[0]));
+		g_signal_connect(G_OBJECT(item), "toggled",
+				 G_CALLBACK(message_filter_toggled_cb),
+				 (gpointer) message_filters[idx].types);
+		gtk_widget_show(item);
+		gtk_menu_shell_append(GTK_MENU_SHELL(popup), item);
+	}
 }
 
 /* set the text widget. */
@@ -171,6 +350,8 @@ void message_window_set_text(GtkWidget * textWidget, GtkWidget * container)
 
 	message_txt = textWidget;
 	message_container = container;
+	g_signal_connect(G_OBJECT(message_txt), "populate-popup",
+			 G_CALLBACK(message_populate_popup_cb), NULL);
 
 	/* Prepare all tags */
 	buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(message_txt));
@@ -35,6 +35,13 @@ void log_set_func_message_color_enable(gboolean enable);
 void message_window_set_text(GtkWidget * textWidget,
 			     GtkWidget * container);
 
+/* Show or hide the lines of a message type in the message window.
+ * The lines stay in the buffer, so they can be shown again. */
+void message_window_set_visible(gint msg_type, gboolean visible);
+
+/* Check whether the lines of a message type are shown */
+gboolean message_window_get_visible(gint msg_type);
+
 enum TFindResult {
 	FIND_MATCH_EXACT,
 	FIND_MATCH_INSERT_BEFORE,
@@ -0,0 +1,563 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Rendering benchmark: draw maps of game files without a display.
+ * The map is rendered into image surfaces, so no X server or GPU is
+ * needed. The themes are searched in the installed theme directory and
+ * in $XDG_DATA_HOME/pioneers/themes.
+ *
+ * With --replay, the changes to the map of a recorded game are drawn
+ * again, as the client would draw them.  The log contains the lines the
+ * client received from the server, one per line, as shown by
+ * 'pioneers --debug' (the "<-- " prefix is skipped) or as plain lines.
+ */
+#include "config.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gtk/gtk.h>
+#ifdef __GLIBC__
+#include <pthread.h>
+#endif
+
+#include "game.h"
+#include "map.h"
+#include "colors.h"
+#include "config-gnome.h"
+#include "guimap.h"
+#include "theme.h"
+
+static gint width = 800;
+static gint height = 600;
+static gint frames = 50;
+static gchar *theme_name = NULL;
+static gchar *replay_file = NULL;
+static gchar **game_files = NULL;
+static gchar **replay_lines = NULL;
+
+static GOptionEntry commandline_entries[] = {
+	{"width", 'W', 0, G_OPTION_ARG_INT, &width,
+	 "Width of the image", "800"},
+	{"height", 'H', 0, G_OPTION_ARG_INT, &height,
+	 "Height of the image", "600"},
+	{"frames", 'n', 0, G_OPTION_ARG_INT, &frames,
+	 "Number of full redraws to time", "50"},
+	{"theme", 't', 0, G_OPTION_ARG_STRING, &theme_name,
+	 "Theme to use", "Tiny"},
+	{"replay", 'r', 0, G_OPTION_ARG_FILENAME, &replay_file,
+	 "Replay the map changes of a recorded game", "LOGFILE"},
+	{G_OPTION_REMAINING, '\0', 0, G_OPTION_ARG_FILENAME_ARRAY,
+	 &game_files, NULL, "GAMEFILE..."},
+	{NULL, '\0', 0, 0, NULL, NULL, NULL}
+};
+
+#ifdef __GLIBC__
+/* Count the allocations of the benchmark thread by wrapping the
+ * allocator of the C library. The allocations of the thread that
+ * rescales the theme in the background are not counted. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static pthread_t bench_thread;
+static gboolean counting;
+static guint64 num_allocations;
+
+static void count_allocation(void)
+{
+	if (counting && pthread_equal(pthread_self(), bench_thread))
+		num_allocations++;
+}
+
+void *malloc(size_t size)
+{
+	count_allocation();
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	count_allocation();
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	count_allocation();
+	return __libc_realloc(ptr, size);
+}
+
+static void allocations_start(void)
+{
+	bench_thread = pthread_self();
+	num_allocations = 0;
+	counting = TRUE;
+}
+
+static guint64 allocations_stop(void)
+{
+	counting = FALSE;
+	return num_allocations;
+}
+
+#define HAVE_ALLOCATION_COUNT 1
+#else
+static void allocations_start(void)
+{
+}
+
+static guint64 allocations_stop(void)
+{
+	return 0;
+}
+
+#define HAVE_ALLOCATION_COUNT 0
+#endif
+
+typedef struct {
+	GPtrArray *nodes;
+	GPtrArray *edges;
+} MapElements;
+
+/* Collect each node and edge once, from the hex that owns it */
+static gboolean collect_elements(Hex * hex, gpointer closure)
+{
+	MapElements *elements = closure;
+	guint idx;
+
+	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++) {
+		Node *node = hex->nodes[idx];
+		if (node != NULL && node->x == hex->x && node->y == hex->y)
+			g_ptr_array_add(elements->nodes, node);
+	}
+	for (idx = 0; idx < G_N_ELEMENTS(hex->edges); idx++) {
+		Edge *edge = hex->edges[idx];
+		if (edge != NULL && edge->x == hex->x && edge->y == hex->y)
+			g_ptr_array_add(elements->edges, edge);
+	}
+	return FALSE;
+}
+
+static void report(const gchar * title, const gchar * what, guint count,
+		   gint64 usec, guint64 allocations)
+{
+	gdouble seconds = MAX(usec, 1) / (gdouble) G_USEC_PER_SEC;
+
+	if (HAVE_ALLOCATION_COUNT)
+		g_print("%s: %-14s %10.1f per second, "
+			"%8.1f allocations each\n", title, what,
+			count / seconds, (gdouble) allocations / count);
+	else
+		g_print("%s: %-14s %10.1f per second\n", title, what,
+			count / seconds);
+}
+
+static void bench_display(GuiMap * gmap, cairo_t * cr, const gchar * title)
+{
+	gint64 start;
+	gint frame;
+
+	allocations_start();
+	start = g_get_monotonic_time();
+	for (frame = 0; frame < frames; frame++) {
+		guimap_display(gmap);
+		guimap_paint(gmap, cr);
+	}
+	report(title, "display", (guint) frames,
+	       g_get_monotonic_time() - start, allocations_stop());
+}
+
+static void bench_nodes(GuiMap * gmap, GPtrArray * nodes,
+			const gchar * title)
+{
+	gint64 start;
+	guint idx;
+
+	if (nodes->len == 0)
+		return;
+
+	allocations_start();
+	start = g_get_monotonic_time();
+	/* Build settlements, upgrade them to cities and remove them */
+	for (idx = 0; idx < nodes->len; idx++) {
+		Node *node = g_ptr_array_index(nodes, idx);
+		node->owner = (gint) (idx % MAX_PLAYERS);
+		node->type = BUILD_SETTLEMENT;
+		guimap_draw_node(gmap, node);
+	}
+	for (idx = 0; idx < nodes->len; idx++) {
+		Node *node = g_ptr_array_index(nodes, idx);
+		node->type = BUILD_CITY;
+		guimap_draw_node(gmap, node);
+	}
+	for (idx = 0; idx < nodes->len; idx++) {
+		Node *node = g_ptr_array_index(nodes, idx);
+		node->owner = -1;
+		node->type = BUILD_NONE;
+		guimap_draw_node(gmap, node);
+	}
+	report(title, "draw_node", nodes->len * 3,
+	       g_get_monotonic_time() - start, allocations_stop());
+}
+
+static void bench_edges(GuiMap * gmap, GPtrArray * edges,
+			const gchar * title)
+{
+	gint64 start;
+	guint idx;
+
+	if (edges->len == 0)
+		return;
+
+	allocations_start();
+	start = g_get_monotonic_time();
+	/* Build roads and remove them */
+	for (idx = 0; idx < edges->len; idx++) {
+		Edge *edge = g_ptr_array_index(edges, idx);
+		edge->owner = (gint) (idx % MAX_PLAYERS);
+		edge->type = BUILD_ROAD;
+		guimap_draw_edge(gmap, edge);
+	}
+	for (idx = 0; idx < edges->len; idx++) {
+		Edge *edge = g_ptr_array_index(edges, idx);
+		edge->owner = -1;
+		edge->type = BUILD_NONE;
+		guimap_draw_edge(gmap, edge);
+	}
+	report(title, "draw_edge", edges->len * 2,
+	       g_get_monotonic_time() - start, allocations_stop());
+}
+
+static void bench_highlight(GuiMap * gmap, const gchar * title)
+{
+	gint64 start;
+	gint frame;
+	gint roll;
+
+	allocations_start();
+	start = g_get_monotonic_time();
+	for (frame = 0; frame < frames; frame++)
+		for (roll = 2; roll <= 12; roll++)
+			guimap_highlight_chits(gmap, roll);
+	guimap_highlight_chits(gmap, -1);
+	report(title, "highlight", (guint) frames * 11 + 1,
+	       g_get_monotonic_time() - start, allocations_stop());
+}
+
+static void bench_cursor(GuiMap * gmap, const gchar * title)
+{
+	gint64 start;
+	guint count = 0;
+	gint x;
+	gint y;
+
+	allocations_start();
+	start = g_get_monotonic_time();
+	/* Find the hex, node and edge under each pixel */
+	for (y = 0; y < height; y++)
+		for (x = 0; x < width; x++) {
+			gmap->last_x = x;
+			gmap->last_y = y;
+			guimap_get_current_hex(gmap);
+			guimap_get_current_node(gmap);
+			guimap_get_current_edge(gmap);
+			count++;
+		}
+	report(title, "cursor", count, g_get_monotonic_time() - start,
+	       allocations_stop());
+}
+
+/* Skip the prefix of a line that was logged by the client */
+static const gchar *replay_command(const gchar * line)
+{
+	const gchar *received = strstr(line, "<-- ");
+
+	return received != NULL ? received + 4 : line;
+}
+
+/* Parse the whole line */
+static gboolean replay_scan(const gchar * line, const gchar * fmt, ...)
+{
+	va_list ap;
+	ssize_t offset;
+
+	va_start(ap, fmt);
+	offset = game_vscanf(line, fmt, ap);
+	va_end(ap);
+	return offset >= 0 && line[offset] == '\0';
+}
+
+static gboolean replay_build(GuiMap * gmap, gint player_num,
+			     BuildType type, gint x, gint y, gint pos,
+			     gboolean remove)
+{
+	Node *node;
+	Edge *edge;
+
+	switch (type) {
+	case BUILD_ROAD:
+	case BUILD_SHIP:
+	case BUILD_BRIDGE:
+		edge = map_edge(gmap->map, x, y, pos);
+		if (edge == NULL)
+			return FALSE;
+		edge->owner = remove ? -1 : player_num;
+		edge->type = remove ? BUILD_NONE : type;
+		guimap_draw_edge(gmap, edge);
+		return TRUE;
+	case BUILD_SETTLEMENT:
+	case BUILD_CITY:
+	case BUILD_CITY_WALL:
+		node = map_node(gmap->map, x, y, pos);
+		if (node == NULL)
+			return FALSE;
+		if (type == BUILD_CITY_WALL)
+			node->city_wall = !remove;
+		else if (!remove)
+			node->type = type;
+		else if (type == BUILD_CITY)
+			node->type = BUILD_SETTLEMENT;
+		else
+			node->type = BUILD_NONE;
+		node->owner =
+		    node->type == BUILD_NONE ? -1 : player_num;
+		guimap_draw_node(gmap, node);
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
+static gboolean replay_move_ship(GuiMap * gmap, gint player_num,
+				 gint sx, gint sy, gint spos,
+				 gint dx, gint dy, gint dpos)
+{
+	Edge *from = map_edge(gmap->map, sx, sy, spos);
+	Edge *to = map_edge(gmap->map, dx, dy, dpos);
+
+	if (from == NULL || to == NULL)
+		return FALSE;
+	from->owner = -1;
+	from->type = BUILD_NONE;
+	guimap_draw_edge(gmap, from);
+	to->owner = player_num;
+	to->type = BUILD_SHIP;
+	guimap_draw_edge(gmap, to);
+	return TRUE;
+}
+
+static gboolean replay_move_robber(GuiMap * gmap, gint x, gint y,
+				   gboolean pirate)
+{
+	Hex *hex = map_hex(gmap->map, x, y);
+	Hex *old;
+
+	if (hex == NULL)
+		return FALSE;
+	if (pirate) {
+		old = map_pirate_hex(gmap->map);
+		map_move_pirate(gmap->map, x, y);
+	} else {
+		old = map_robber_hex(gmap->map);
+		map_move_robber(gmap->map, x, y);
+	}
+	if (old != NULL)
+		guimap_draw_hex(gmap, old);
+	guimap_draw_hex(gmap, hex);
+	return TRUE;
+}
+
+/** Apply one line of the log to the map.
+ * @return TRUE if the map was changed
+ */
+static gboolean replay_line(GuiMap * gmap, const gchar * line)
+{
+	BuildType type;
+	gint player_num;
+	gint x, y, pos;
+	gint dx, dy, dpos;
+	ssize_t offset;
+
+	offset = game_scanf(line, "player %d ", &player_num);
+	if (offset < 0)
+		return FALSE;
+	line += offset;
+
+	if (replay_scan(line, "built %B %d %d %d", &type, &x, &y, &pos))
+		return replay_build(gmap, player_num, type, x, y, pos,
+				    FALSE);
+	if (replay_scan(line, "remove %B %d %d %d", &type, &x, &y, &pos))
+		return replay_build(gmap, player_num, type, x, y, pos,
+				    TRUE);
+	if (replay_scan(line, "move %d %d %d %d %d %d", &x, &y, &pos,
+			&dx, &dy, &dpos)
+	    || replay_scan(line, "move-back %d %d %d %d %d %d", &x, &y,
+			   &pos, &dx, &dy, &dpos))
+		return replay_move_ship(gmap, player_num, x, y, pos, dx,
+					dy, dpos);
+	if (replay_scan(line, "moved-robber %d %d", &x, &y)
+	    || replay_scan(line, "unmoved-robber %d %d", &x, &y))
+		return replay_move_robber(gmap, x, y, FALSE);
+	if (replay_scan(line, "moved-pirate %d %d", &x, &y)
+	    || replay_scan(line, "unmoved-pirate %d %d", &x, &y))
+		return replay_move_robber(gmap, x, y, TRUE);
+	return FALSE;
+}
+
+static void bench_replay(GuiMap * gmap, cairo_t * cr, const gchar * title)
+{
+	gint64 start;
+	guint count = 0;
+	guint idx;
+
+	allocations_start();
+	start = g_get_monotonic_time();
+	/* Each change is shown before the next one is received */
+	for (idx = 0; replay_lines[idx] != NULL; idx++) {
+		if (replay_line(gmap, replay_command(replay_lines[idx]))) {
+			guimap_paint(gmap, cr);
+			count++;
+		}
+	}
+	if (count == 0) {
+		allocations_stop();
+		g_printerr("%s: no map changes in %s\n", title,
+			   replay_file);
+		return;
+	}
+	report(title, "replay", count, g_get_monotonic_time() - start,
+	       allocations_stop());
+}
+
+static gboolean bench_game(const gchar * filename)
+{
+	GameParams *params;
+	GuiMap *gmap;
+	MapElements elements;
+	cairo_surface_t *surface;
+	cairo_t *cr;
+	gchar *title;
+
+	params = params_load_file(filename);
+	if (params == NULL || params->map == NULL) {
+		g_printerr("%s: cannot load the map\n", filename);
+		if (params != NULL)
+			params_free(params);
+		return FALSE;
+	}
+	title = g_strdup(params->title != NULL ? params->title : filename);
+
+	gmap = guimap_new();
+	gmap->map = map_copy(params->map);
+	params_free(params);
+
+	/* The first render creates the layers and the font */
+	surface = guimap_render(gmap, width, height);
+	cr = cairo_create(surface);
+
+	elements.nodes = g_ptr_array_new();
+	elements.edges = g_ptr_array_new();
+	map_traverse(gmap->map, collect_elements, &elements);
+
+	bench_display(gmap, cr, title);
+	bench_nodes(gmap, elements.nodes, title);
+	bench_edges(gmap, elements.edges, title);
+	bench_highlight(gmap, title);
+	bench_cursor(gmap, title);
+	if (replay_lines != NULL)
+		bench_replay(gmap, cr, title);
+
+	g_ptr_array_free(elements.nodes, TRUE);
+	g_ptr_array_free(elements.edges, TRUE);
+	cairo_destroy(cr);
+	cairo_surface_destroy(surface);
+	guimap_delete(gmap);
+	g_free(title);
+	return TRUE;
+}
+
+int main(int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	gboolean ok;
+	gint idx;
+
+	context = g_option_context_new("- Time the drawing of maps");
+	g_option_context_add_main_entries(context, commandline_entries,
+					  NULL);
+	g_option_context_parse(context, &argc, &argv, &error);
+	g_option_context_free(context);
+	if (error != NULL) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		return 1;
+	}
+	if (game_files == NULL) {
+		g_printerr("No game file given\n");
+		return 1;
+	}
+	if (replay_file != NULL) {
+		gchar *contents;
+
+		if (!g_file_get_contents(replay_file, &contents, NULL,
+					 &error)) {
+			g_printerr("%s\n", error->message);
+			g_error_free(error);
+			return 1;
+		}
+		g_strdelimit(contents, "\r", '\n');
+		replay_lines = g_strsplit(contents, "\n", -1);
+		g_free(contents);
+	}
+	width = MAX(width, 16);
+	height = MAX(height, 16);
+	frames = MAX(frames, 1);
+
+	config_init("pioneers");
+	themes_init();
+	colors_init();
+	if (theme_name != NULL) {
+		GList *list;
+
+		for (list = theme_get_list(); list != NULL;
+		     list = g_list_next(list)) {
+			MapTheme *theme = list->data;
+			if (strcmp(theme->name, theme_name) == 0) {
+				theme_set_current(theme);
+				break;
+			}
+		}
+		if (list == NULL)
+			g_printerr("Theme %s not found, using %s\n",
+				   theme_name, theme_get_current()->name);
+	}
+
+	ok = TRUE;
+	for (idx = 0; game_files[idx] != NULL; idx++)
+		ok = bench_game(game_files[idx]) && ok;
+
+	themes_cleanup();
+	config_finish();
+	g_strfreev(game_files);
+	g_strfreev(replay_lines);
+	g_free(replay_file);
+	g_free(theme_name);
+	return ok ? 0 : 1;
+}
@@ -28,6 +28,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <gtk/gtk.h>
 
 #include "game.h"
@@ -38,6 +39,8 @@
 #include "theme.h"
 
 #define ZOOM_AMOUNT 3
+/* Milliseconds without scroll events before a zoom is finished */
+#define ZOOM_SETTLE_TIME 200
 
 static gboolean single_click_build_active = FALSE;
 
@@ -55,6 +58,9 @@ static void calc_hex_poly(const GuiMap * gmap, const Hex * hex,
 			  const Polygon * shape, Polygon * poly,
 			  double scale_factor, gint x_shift);
 static void guimap_cursor_move(GuiMap * gmap, MapElement * element);
+static void erase_cursor(GuiMap * gmap);
+static void scale_geometry(GuiMap * gmap, gint radius);
+static void geometry_free(GuiMapGeometry * geometry);
 
 /* Square */
 static gint sqr(gint a)
@@ -85,13 +91,23 @@ void guimap_delete(GuiMap * gmap)
 		g_object_unref(gmap->area);
 		gmap->area = NULL;
 	}
-	if (gmap->surface != NULL) {
-		cairo_surface_destroy(gmap->surface);
-		gmap->surface = NULL;
+	if (gmap->settle_id != 0) {
+		g_source_remove(gmap->settle_id);
+		gmap->settle_id = 0;
 	}
-	if (gmap->cr != NULL) {
-		cairo_destroy(gmap->cr);
-		gmap->cr = NULL;
+	guimap_discard_layers(gmap);
+	if (gmap->geometry != NULL) {
+		geometry_free(gmap->geometry);
+		gmap->geometry = NULL;
+	}
+	if (gmap->tiles != NULL) {
+		guint idx;
+
+		for (idx = 0; idx < TERRAIN_TILE_MAX; idx++)
+			if (gmap->tiles[idx] != NULL)
+				g_object_unref(gmap->tiles[idx]);
+		g_free(gmap->tiles);
+		gmap->tiles = NULL;
 	}
 	if (gmap->layout) {
 		/* Restore the font size */
@@ -118,12 +134,215 @@ void guimap_delete(GuiMap * gmap)
 }
 
 
+/** Lets the map scale its own copy of the tiles of a theme, instead of
+ * the tiles of the current theme. The map can then be drawn in another
+ * thread, and drawing it does not change the tiles of the main map.
+ * @param gmap The GuiMap, without a drawing area.
+ * @param theme The theme to draw with, taken in the main thread
+ */
+void guimap_use_own_tiles(GuiMap * gmap, const MapTheme * theme)
+{
+	g_return_if_fail(gmap->area == NULL);
+
+	gmap->theme = theme;
+	if (gmap->tiles == NULL)
+		gmap->tiles = g_new0(GdkPixbuf *, TERRAIN_TILE_MAX);
+}
+
+/* The theme to draw the map with */
+static const MapTheme *guimap_theme(const GuiMap * gmap)
+{
+	if (gmap->theme != NULL)
+		return gmap->theme;
+	return theme_get_current();
+}
+
 void guimap_reset(GuiMap * gmap)
 {
 	gmap->highlight_chit = -1;
 	gmap->player_num = -1;
 }
 
+static cairo_t *create_layer(GuiMap * gmap, cairo_format_t format,
+			     gint width, gint height,
+			     cairo_surface_t ** surface)
+{
+	GdkWindow *window = NULL;
+
+	if (gmap->area != NULL)
+		window = gtk_widget_get_window(gmap->area);
+	if (window != NULL)
+		*surface =
+		    gdk_window_create_similar_image_surface(window, format,
+							    width, height,
+							    0);
+	else
+		*surface = cairo_image_surface_create(format, width, height);
+	return cairo_create(*surface);
+}
+
+static void destroy_layer(cairo_surface_t ** surface, cairo_t ** cr)
+{
+	if (*cr != NULL) {
+		cairo_destroy(*cr);
+		*cr = NULL;
+	}
+	if (*surface != NULL) {
+		cairo_surface_destroy(*surface);
+		*surface = NULL;
+	}
+}
+
+/** Allocates the layers of the map.
+ * The map is kept in three image surfaces: a static layer with the
+ * board, the tiles, the chits and the ports, a layer with the pieces and
+ * a layer with the cursor. A change redraws only the affected area of
+ * one layer, so the cost of a redraw does not grow during the game.
+ * The layers are drawn by guimap_display.
+ * @param gmap The GuiMap.
+ * @param width The width of the layers.
+ * @param height The height of the layers.
+ */
+void guimap_create_layers(GuiMap * gmap, gint width, gint height)
+{
+	guimap_discard_layers(gmap);
+
+	width = MAX(width, 1);
+	height = MAX(height, 1);
+	gmap->cr = create_layer(gmap, CAIRO_FORMAT_RGB24, width, height,
+				&gmap->surface);
+	gmap->pieces_cr =
+	    create_layer(gmap, CAIRO_FORMAT_ARGB32, width, height,
+			 &gmap->pieces);
+	gmap->overlay_cr =
+	    create_layer(gmap, CAIRO_FORMAT_ARGB32, width, height,
+			 &gmap->overlay);
+	gmap->cursor_rect.width = 0;
+	gmap->cursor_rect.height = 0;
+}
+
+/** Frees the layers of the map.
+ * They will be created again at the next draw.
+ * @param gmap The GuiMap.
+ */
+void guimap_discard_layers(GuiMap * gmap)
+{
+	destroy_layer(&gmap->surface, &gmap->cr);
+	destroy_layer(&gmap->pieces, &gmap->pieces_cr);
+	destroy_layer(&gmap->overlay, &gmap->overlay_cr);
+	gmap->cursor_rect.width = 0;
+	gmap->cursor_rect.height = 0;
+}
+
+/* While the map is panned or zoomed, the layers are not drawn again.
+ * They are shown moved and scaled until the gesture is finished. */
+static gboolean layers_transformed(const GuiMap * gmap)
+{
+	return gmap->layer_width > 0 && gmap->layer_height > 0
+	    && (gmap->x_margin != gmap->layer_x_margin
+		|| gmap->y_margin != gmap->layer_y_margin
+		|| gmap->width != gmap->layer_width
+		|| gmap->height != gmap->layer_height);
+}
+
+/* The tile of a terrain, from the own tiles of the map if it has them */
+static GdkPixbuf *terrain_pixbuf(const GuiMap * gmap, gint terrain)
+{
+	if (gmap->tiles != NULL)
+		return gmap->tiles[terrain];
+	return guimap_theme(gmap)->terrain_tiles[terrain];
+}
+
+/** Composites the layers of the map.
+ * Only the part inside the clip region of cr is painted.
+ * @param gmap The GuiMap.
+ * @param cr The target.
+ */
+void guimap_paint(const GuiMap * gmap, cairo_t * cr)
+{
+	g_return_if_fail(gmap->surface != NULL);
+
+	if (layers_transformed(gmap)) {
+		gdouble x_scale = (gdouble) gmap->width / gmap->layer_width;
+		gdouble y_scale =
+		    (gdouble) gmap->height / gmap->layer_height;
+
+		/* The area that is not covered by the layers shows
+		 * the board */
+		gdk_cairo_set_source_pixbuf(cr,
+					    terrain_pixbuf(gmap, BOARD_TILE),
+					    0, 0);
+		cairo_pattern_set_extend(cairo_get_source(cr),
+					 CAIRO_EXTEND_REPEAT);
+		cairo_paint(cr);
+
+		cairo_save(cr);
+		cairo_translate(cr,
+				gmap->x_margin -
+				gmap->layer_x_margin * x_scale,
+				gmap->y_margin -
+				gmap->layer_y_margin * y_scale);
+		cairo_scale(cr, x_scale, y_scale);
+		cairo_set_source_surface(cr, gmap->surface, 0.0, 0.0);
+		cairo_paint(cr);
+		cairo_set_source_surface(cr, gmap->pieces, 0.0, 0.0);
+		cairo_paint(cr);
+		cairo_restore(cr);
+		return;
+	}
+
+	cairo_set_source_surface(cr, gmap->surface, 0.0, 0.0);
+	cairo_paint(cr);
+	cairo_set_source_surface(cr, gmap->pieces, 0.0, 0.0);
+	cairo_paint(cr);
+	if (gmap->cursor_rect.width > 0) {
+		cairo_set_source_surface(cr, gmap->overlay, 0.0, 0.0);
+		gdk_cairo_rectangle(cr, &gmap->cursor_rect);
+		cairo_fill(cr);
+	}
+}
+
+/** Renders the map into a new image surface.
+ * No drawing area or display is needed, the text is laid out with
+ * the default font when the map has no drawing area.
+ * @param gmap The GuiMap, with a map.
+ * @param width The width of the image.
+ * @param height The height of the image.
+ * @return The image, free it with cairo_surface_destroy.
+ */
+cairo_surface_t *guimap_render(GuiMap * gmap, gint width, gint height)
+{
+	cairo_surface_t *surface;
+	cairo_t *cr;
+
+	g_return_val_if_fail(gmap->map != NULL, NULL);
+
+	if (gmap->surface == NULL
+	    || cairo_image_surface_get_width(gmap->surface) != width
+	    || cairo_image_surface_get_height(gmap->surface) != height)
+		guimap_create_layers(gmap, width, height);
+	guimap_scale_to_size(gmap, width, height);
+	guimap_display(gmap);
+
+	surface =
+	    cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+	cr = cairo_create(surface);
+	guimap_paint(gmap, cr);
+	cairo_destroy(cr);
+	return surface;
+}
+
+static void invalidate_rect(GuiMap * gmap, const GdkRectangle * rect)
+{
+	GdkWindow *window;
+
+	if (gmap->area == NULL)
+		return;
+	window = gtk_widget_get_window(gmap->area);
+	if (window != NULL)
+		gdk_window_invalidate_rect(window, rect, FALSE);
+}
+
 static gboolean draw_map_cb(GtkWidget * area, cairo_t * cr,
 			    gpointer user_data)
 {
@@ -134,20 +353,15 @@ static gboolean draw_map_cb(GtkWidget * area, cairo_t * cr,
 		return FALSE;
 	}
 
-	gtk_widget_get_allocation(area, &allocation);
 	if (gmap->surface == NULL) {
-		cairo_rectangle_t extent =
-		    { 0.0, 0.0, allocation.width, allocation.height };
-		gmap->surface =
-		    cairo_recording_surface_create
-		    (CAIRO_CONTENT_COLOR_ALPHA, &extent);
+		gtk_widget_get_allocation(area, &allocation);
+		guimap_create_layers(gmap, allocation.width,
+				     allocation.height);
 		guimap_display(gmap);
 	}
 
-
-	cairo_set_source_surface(cr, gmap->surface, 0.0, 0.0);
-	cairo_rectangle(cr, 0.0, 0.0, allocation.width, allocation.height);
-	cairo_fill(cr);
+	/* The clip region of cr is the invalidated area */
+	guimap_paint(gmap, cr);
 
 	return FALSE;
 }
@@ -160,16 +374,49 @@ static gint configure_map_cb(GtkWidget * area,
 	if (gtk_widget_get_window(area) == NULL || gmap->map == NULL)
 		return FALSE;
 
-	if (gmap->surface != NULL) {
-		cairo_surface_destroy(gmap->surface);
-		gmap->surface = NULL;
-	}
+	guimap_discard_layers(gmap);
 	guimap_scale_to_size(gmap, event->width, event->height);
 
 	gtk_widget_queue_draw(area);
 	return FALSE;
 }
 
+/* Draw the layers for the current position and scale of the map */
+static void settle_view(GuiMap * gmap)
+{
+	if (gmap->settle_id != 0) {
+		g_source_remove(gmap->settle_id);
+		gmap->settle_id = 0;
+	}
+	if (gmap->map == NULL)
+		return;
+
+	theme_rescale(2 * gmap->x_point);
+	guimap_display(gmap);
+	gtk_widget_queue_draw(gmap->area);
+}
+
+static gboolean settle_view_cb(gpointer user_data)
+{
+	GuiMap *gmap = user_data;
+
+	gmap->settle_id = 0;
+	settle_view(gmap);
+	return FALSE;
+}
+
+static gboolean button_release_map_cb(G_GNUC_UNUSED GtkWidget * area,
+				      GdkEventButton * event,
+				      gpointer user_data)
+{
+	GuiMap *gmap = user_data;
+
+	/* Panning is finished */
+	if (event->button == 2 && layers_transformed(gmap))
+		settle_view(gmap);
+	return FALSE;
+}
+
 static gboolean motion_notify_map_cb(GtkWidget * area,
 				     GdkEventMotion * event,
 				     gpointer user_data)
@@ -192,13 +439,23 @@ static gboolean motion_notify_map_cb(GtkWidget * area,
 		gmap->is_custom_view = TRUE;
 		gmap->x_margin += x - gmap->last_x;
 		gmap->y_margin += y - gmap->last_y;
+		gmap->last_x = x;
+		gmap->last_y = y;
 
-		guimap_display(gmap);
+		/* Only move the layers, they are drawn again when
+		 * the button is released */
+		erase_cursor(gmap);
+		gmap->cursor.pointer = NULL;
 		gtk_widget_queue_draw(gmap->area);
+		return FALSE;
 	}
 	gmap->last_x = x;
 	gmap->last_y = y;
 
+	/* The release of the button was missed */
+	if (gmap->settle_id == 0 && layers_transformed(gmap))
+		settle_view(gmap);
+
 	dummyElement.pointer = NULL;
 	guimap_cursor_move(gmap, &dummyElement);
 
@@ -230,7 +487,7 @@ static gboolean zoom_map_cb(GtkWidget * area, GdkEventScroll * event,
 			radius = MIN_HEX_RADIUS;
 	}
 
-	guimap_scale_with_radius(gmap, radius);
+	scale_geometry(gmap, radius);
 
 	gmap->x_margin =
 	    event->x - (event->x -
@@ -241,7 +498,14 @@ static gboolean zoom_map_cb(GtkWidget * area, GdkEventScroll * event,
 			gmap->y_margin) / old_height *
 	    (gdouble) gmap->height;
 
-	guimap_display(gmap);
+	/* Show the scaled layers, the theme is rescaled and the layers
+	 * are drawn again when the zooming stops */
+	erase_cursor(gmap);
+	gmap->cursor.pointer = NULL;
+	if (gmap->settle_id != 0)
+		g_source_remove(gmap->settle_id);
+	gmap->settle_id =
+	    g_timeout_add(ZOOM_SETTLE_TIME, settle_view_cb, gmap);
 	gtk_widget_queue_draw(gmap->area);
 	return FALSE;
 }
@@ -260,6 +524,7 @@ GtkWidget *guimap_build_drawingarea(GuiMap * gmap, gint width, gint height)
 	gtk_widget_set_events(gmap->area, GDK_EXPOSURE_MASK
 			      | GDK_POINTER_MOTION_MASK
 			      | GDK_POINTER_MOTION_HINT_MASK
+			      | GDK_BUTTON_RELEASE_MASK
 			      | GDK_SCROLL_MASK);
 
 	gtk_widget_set_size_request(gmap->area, width, height);
@@ -272,6 +537,8 @@ GtkWidget *guimap_build_drawingarea(GuiMap * gmap, gint width, gint height)
 			 G_CALLBACK(motion_notify_map_cb), gmap);
 	g_signal_connect(G_OBJECT(gmap->area), "scroll_event",
 			 G_CALLBACK(zoom_map_cb), gmap);
+	g_signal_connect(G_OBJECT(gmap->area), "button_release_event",
+			 G_CALLBACK(button_release_map_cb), gmap);
 
 	gtk_widget_show(gmap->area);
 
@@ -501,35 +768,118 @@ static void get_hex_polygon(const GuiMap * gmap, Polygon * poly)
 	points[5].y = gmap->y_point;
 }
 
-static void calc_edge_poly(const GuiMap * gmap, const Edge * edge,
-			   const Polygon * shape, Polygon * poly)
+/* A shape, scaled (and rotated) for the current size of the hexes */
+typedef struct {
+	const Polygon *shape;
+	gint variant;		/* rotation of edges, 0 otherwise */
+	gdouble scale_factor;
+	gint x_shift;
+	GdkPoint *points;
+} ScaledShape;
+
+/* The geometry that only depends on the size of the hexes.
+ * It is built when the size changes, the shapes are added when they
+ * are first drawn at that size. */
+struct _GuiMapGeometry {
+	gint hex_radius;	/* the size the geometry is for */
+	gdouble edge_x[6];	/* centre of the edges, relative to the hex */
+	gdouble edge_y[6];
+	gdouble node_x[6];	/* the nodes, relative to the hex */
+	gdouble node_y[6];
+	GArray *shapes;		/* ScaledShape */
+};
+
+/* Rotation of shapes on edges: 0, 60 or 120 degrees CCW,
+ * or 90 degrees CCW for shapes without an edge */
+#define EDGE_VARIANT_NONE 3
+
+static void geometry_clear_shapes(GuiMapGeometry * geometry)
+{
+	guint idx;
+
+	for (idx = 0; idx < geometry->shapes->len; idx++)
+		g_free(g_array_index(geometry->shapes, ScaledShape, idx).
+		       points);
+	g_array_set_size(geometry->shapes, 0);
+}
+
+static void geometry_free(GuiMapGeometry * geometry)
+{
+	geometry_clear_shapes(geometry);
+	g_array_free(geometry->shapes, TRUE);
+	g_free(geometry);
+}
+
+/* Build the geometry for the size of the hexes */
+static void geometry_build(GuiMap * gmap)
 {
+	GuiMapGeometry *geometry = gmap->geometry;
 	gint idx;
-	GdkPoint *poly_point, *shape_point;
+
+	if (geometry == NULL) {
+		geometry = g_malloc0(sizeof(*geometry));
+		geometry->shapes =
+		    g_array_new(FALSE, FALSE, sizeof(ScaledShape));
+		geometry->hex_radius = -1;
+		gmap->geometry = geometry;
+	}
+	if (geometry->hex_radius == gmap->hex_radius)
+		return;
+
+	geometry_clear_shapes(geometry);
+	geometry->hex_radius = gmap->hex_radius;
+	for (idx = 0; idx < 6; idx++) {
+		double theta;
+
+		theta = 2 * M_PI * (1 - idx / 6.0);
+		geometry->edge_x[idx] = gmap->x_point * cos(theta);
+		geometry->edge_y[idx] = gmap->x_point * sin(theta);
+
+		theta = 2 * M_PI / 6.0 * idx + M_PI / 6.0;
+		theta = 2 * M_PI - theta;
+		geometry->node_x[idx] = gmap->hex_radius * cos(theta);
+		geometry->node_y[idx] = gmap->hex_radius * sin(theta);
+	}
+}
+
+/* The geometry, or NULL when it is not for the current size */
+static GuiMapGeometry *geometry_get(const GuiMap * gmap)
+{
+	if (gmap->geometry == NULL
+	    || gmap->geometry->hex_radius != gmap->hex_radius)
+		return NULL;
+	return gmap->geometry;
+}
+
+/* Scale and rotate a shape around (0, 0).
+ * The variant is the rotation of shapes on edges (see calc_edge_poly),
+ * 0 for shapes on nodes and hexes.
+ */
+static void scale_shape(const GuiMap * gmap, const Polygon * shape,
+			gint variant, double scale_factor, gint x_shift,
+			GdkPoint * points)
+{
+	gint idx;
+	GdkPoint *poly_point;
+	const GdkPoint *shape_point;
 	double theta, cos_theta, sin_theta, scale;
+	gint x_offset;
 
-	g_assert(poly->num_points >= shape->num_points);
-	poly->num_points = shape->num_points;
+	scale = (2 * gmap->y_point) / scale_factor;
+	x_offset = rint(scale * x_shift);
 
-	/* Determine the angle for the polygon:
-	 * Polygons on edges are rotated 0, 60 or 120 degrees CCW
-	 * Polygons without edges are rotated 90 degrees CCW
-	 */
-	theta =
-	    2 * M_PI * (edge != NULL ? 1 - (edge->pos % 3) / 6.0 : -0.25);
+	theta = 2 * M_PI * (variant != EDGE_VARIANT_NONE ?
+			    1 - variant / 6.0 : -0.25);
 	cos_theta = cos(theta);
 	sin_theta = sin(theta);
-	scale = (2 * gmap->y_point) / 120.0;
 
-	/* Rotate / scale all points
-	 */
-	poly_point = poly->points;
+	poly_point = points;
 	shape_point = shape->points;
 	for (idx = 0; idx < shape->num_points;
 	     idx++, shape_point++, poly_point++) {
-		poly_point->x = rint(scale * shape_point->x);
+		poly_point->x = x_offset + rint(scale * shape_point->x);
 		poly_point->y = rint(scale * shape_point->y);
-		if (edge == NULL || edge->pos % 3 > 0) {
+		if (variant > 0) {
 			gint x = poly_point->x;
 			gint y = poly_point->y;
 			poly_point->x =
@@ -538,20 +888,104 @@ static void calc_edge_poly(const GuiMap * gmap, const Edge * edge,
 			    rint(x * sin_theta + y * cos_theta);
 		}
 	}
+}
+
+/* Copy the scaled shape into the polygon */
+static void get_scaled_shape(const GuiMap * gmap, const Polygon * shape,
+			     gint variant, double scale_factor,
+			     gint x_shift, Polygon * poly)
+{
+	GuiMapGeometry *geometry = geometry_get(gmap);
+	ScaledShape scaled;
+	guint idx;
+
+	g_assert(poly->num_points >= shape->num_points);
+	poly->num_points = shape->num_points;
+
+	if (geometry == NULL) {
+		scale_shape(gmap, shape, variant, scale_factor, x_shift,
+			    poly->points);
+		return;
+	}
+
+	for (idx = 0; idx < geometry->shapes->len; idx++) {
+		const ScaledShape *cached =
+		    &g_array_index(geometry->shapes, ScaledShape, idx);
+		if (cached->shape == shape && cached->variant == variant
+		    && cached->scale_factor == scale_factor
+		    && cached->x_shift == x_shift) {
+			memcpy(poly->points, cached->points,
+			       shape->num_points * sizeof(GdkPoint));
+			return;
+		}
+	}
+
+	scaled.shape = shape;
+	scaled.variant = variant;
+	scaled.scale_factor = scale_factor;
+	scaled.x_shift = x_shift;
+	scaled.points = g_new(GdkPoint, shape->num_points);
+	scale_shape(gmap, shape, variant, scale_factor, x_shift,
+		    scaled.points);
+	g_array_append_val(geometry->shapes, scaled);
+	memcpy(poly->points, scaled.points,
+	       shape->num_points * sizeof(GdkPoint));
+}
+
+/* The position of the centre of an edge */
+static void calc_edge_pos(const GuiMap * gmap, const Edge * edge,
+			  gint * x_offset, gint * y_offset)
+{
+	const GuiMapGeometry *geometry = geometry_get(gmap);
+
+	calc_hex_pos(gmap, edge->x, edge->y, x_offset, y_offset);
+	if (geometry != NULL) {
+		*x_offset += geometry->edge_x[edge->pos];
+		*y_offset += geometry->edge_y[edge->pos];
+	} else {
+		double theta = 2 * M_PI * (1 - edge->pos / 6.0);
+
+		*x_offset += gmap->x_point * cos(theta);
+		*y_offset += gmap->x_point * sin(theta);
+	}
+}
+
+/* The position of a node */
+static void calc_node_pos(const GuiMap * gmap, const Node * node,
+			  gint * x_offset, gint * y_offset)
+{
+	const GuiMapGeometry *geometry = geometry_get(gmap);
+
+	calc_hex_pos(gmap, node->x, node->y, x_offset, y_offset);
+	if (geometry != NULL) {
+		*x_offset += geometry->node_x[node->pos];
+		*y_offset += geometry->node_y[node->pos];
+	} else {
+		double theta;
+
+		theta = 2 * M_PI / 6.0 * node->pos + M_PI / 6.0;
+		theta = 2 * M_PI - theta;
+		*x_offset += gmap->hex_radius * cos(theta);
+		*y_offset += gmap->hex_radius * sin(theta);
+	}
+}
+
+static void calc_edge_poly(const GuiMap * gmap, const Edge * edge,
+			   const Polygon * shape, Polygon * poly)
+{
+	/* Polygons on edges are rotated 0, 60 or 120 degrees CCW
+	 * Polygons without edges are rotated 90 degrees CCW
+	 */
+	get_scaled_shape(gmap, shape,
+			 edge != NULL ? edge->pos % 3 : EDGE_VARIANT_NONE,
+			 120.0, 0, poly);
 
 	/* Offset shape to hex & edge
 	 */
 	if (edge != NULL) {
 		gint x_offset, y_offset;
 
-		/* Recalculate the angle for the position of the edge */
-		theta = 2 * M_PI * (1 - edge->pos / 6.0);
-		cos_theta = cos(theta);
-		sin_theta = sin(theta);
-
-		calc_hex_pos(gmap, edge->x, edge->y, &x_offset, &y_offset);
-		x_offset += gmap->x_point * cos_theta;
-		y_offset += gmap->x_point * sin_theta;
+		calc_edge_pos(gmap, edge, &x_offset, &y_offset);
 		poly_offset(poly, x_offset, y_offset);
 	}
 }
@@ -559,36 +993,14 @@ static void calc_edge_poly(const GuiMap * gmap, const Edge * edge,
 static void calc_node_poly(const GuiMap * gmap, const Node * node,
 			   const Polygon * shape, Polygon * poly)
 {
-	gint idx;
-	GdkPoint *poly_point, *shape_point;
-	double scale;
-
-	g_assert(poly->num_points >= shape->num_points);
-	poly->num_points = shape->num_points;
-
-	scale = (2 * gmap->y_point) / 120.0;
-
-	/* Scale all points
-	 */
-	poly_point = poly->points;
-	shape_point = shape->points;
-	for (idx = 0; idx < shape->num_points;
-	     idx++, shape_point++, poly_point++) {
-		poly_point->x = rint(scale * shape_point->x);
-		poly_point->y = rint(scale * shape_point->y);
-	}
+	get_scaled_shape(gmap, shape, 0, 120.0, 0, poly);
 
 	/* Offset shape to hex & node
 	 */
 	if (node != NULL) {
 		gint x_offset, y_offset;
-		double theta;
 
-		calc_hex_pos(gmap, node->x, node->y, &x_offset, &y_offset);
-		theta = 2 * M_PI / 6.0 * node->pos + M_PI / 6.0;
-		theta = 2 * M_PI - theta;
-		x_offset += gmap->hex_radius * cos(theta);
-		y_offset += gmap->hex_radius * sin(theta);
+		calc_node_pos(gmap, node, &x_offset, &y_offset);
 		poly_offset(poly, x_offset, y_offset);
 	}
 }
@@ -597,32 +1009,28 @@ static void calc_hex_poly(const GuiMap * gmap, const Hex * hex,
 			  const Polygon * shape, Polygon * poly,
 			  double scale_factor, gint x_shift)
 {
-	GdkPoint *poly_point, *shape_point;
-	double scale;
-	gint x_offset, y_offset;
-	gint idx;
-
-	g_assert(poly->num_points >= shape->num_points);
-	poly->num_points = shape->num_points;
-	scale = (2 * gmap->y_point) / scale_factor;
+	/* Shapes without a hex are not shifted */
+	get_scaled_shape(gmap, shape, 0, scale_factor,
+			 hex != NULL ? x_shift : 0, poly);
 
 	if (hex != NULL) {
-		calc_hex_pos(gmap, hex->x, hex->y, &x_offset, &y_offset);
-		x_offset += rint(scale * x_shift);
-	} else
-		x_offset = y_offset = 0;
+		gint x_offset, y_offset;
 
-	/* Scale all points, offset to right
-	 */
-	poly_point = poly->points;
-	shape_point = shape->points;
-	for (idx = 0; idx < shape->num_points;
-	     idx++, shape_point++, poly_point++) {
-		poly_point->x = x_offset + rint(scale * shape_point->x);
-		poly_point->y = y_offset + rint(scale * shape_point->y);
+		calc_hex_pos(gmap, hex->x, hex->y, &x_offset, &y_offset);
+		poly_offset(poly, x_offset, y_offset);
 	}
 }
 
+void guimap_hex_polygon(const GuiMap * gmap, const Hex * hex,
+			Polygon * poly)
+{
+	gint x_offset, y_offset;
+
+	get_hex_polygon(gmap, poly);
+	calc_hex_pos(gmap, hex->x, hex->y, &x_offset, &y_offset);
+	poly_offset(poly, x_offset, y_offset);
+}
+
 void guimap_road_polygon(const GuiMap * gmap, const Edge * edge,
 			 Polygon * poly)
 {
@@ -677,12 +1085,11 @@ static void guimap_pirate_polygon(const GuiMap * gmap, const Hex * hex,
 	calc_hex_poly(gmap, hex, &pirate_poly, poly, 80.0, 0);
 }
 
-void draw_port_indicator(PangoLayout * layout, cairo_t * cr,
-			 gdouble x_offset, gdouble y_offset,
-			 gdouble chit_radius, gint resource)
+static void draw_port_indicator_theme(const MapTheme * theme,
+				      PangoLayout * layout, cairo_t * cr,
+				      gdouble x_offset, gdouble y_offset,
+				      gdouble chit_radius, gint resource)
 {
-	MapTheme *theme = theme_get_current();
-
 	if (resource != NO_RESOURCE && chit_radius > 0) {
 		const gchar *str = "";
 		gint width, height;
@@ -781,9 +1188,19 @@ void draw_port_indicator(PangoLayout * layout, cairo_t * cr,
 	}
 }
 
-void draw_dice_roll(PangoLayout * layout, cairo_t * cr,
-		    gdouble x_offset, gdouble y_offset, gdouble radius,
-		    gint n, gint terrain, gboolean highlight)
+void draw_port_indicator(PangoLayout * layout, cairo_t * cr,
+			 gdouble x_offset, gdouble y_offset,
+			 gdouble chit_radius, gint resource)
+{
+	draw_port_indicator_theme(theme_get_current(), layout, cr,
+				  x_offset, y_offset, chit_radius, resource);
+}
+
+static void draw_dice_roll_theme(const MapTheme * theme,
+				 PangoLayout * layout, cairo_t * cr,
+				 gdouble x_offset, gdouble y_offset,
+				 gdouble radius, gint n, gint terrain,
+				 gboolean highlight)
 {
 	gchar num[10];
 	gint height;
@@ -791,9 +1208,8 @@ void draw_dice_roll(PangoLayout * layout, cairo_t * cr,
 	gdouble x;
 	gdouble y;
 	gint idx;
-	MapTheme *theme = theme_get_current();
 	THEME_COLOR col;
-	TColor *tcol;
+	const TColor *tcol;
 	gint width_sqr;
 
 #define col_or_ovr(ter,cno)												\
@@ -843,14 +1259,22 @@ void draw_dice_roll(PangoLayout * layout, cairo_t * cr,
 	}
 }
 
-static gboolean display_hex(const Hex * hex, gpointer closure)
+void draw_dice_roll(PangoLayout * layout, cairo_t * cr,
+		    gdouble x_offset, gdouble y_offset, gdouble radius,
+		    gint n, gint terrain, gboolean highlight)
+{
+	draw_dice_roll_theme(theme_get_current(), layout, cr, x_offset,
+			     y_offset, radius, n, terrain, highlight);
+}
+
+/* Draw the hex in the static layer */
+static gboolean display_hex_terrain(const Hex * hex, gpointer closure)
 {
 	gint x_offset, y_offset;
 	GdkPoint points[MAX_POINTS];
 	Polygon poly;
-	guint idx;
-	const MapTheme *theme = theme_get_current();
 	const GuiMap *gmap = closure;
+	const MapTheme *theme = guimap_theme(gmap);
 
 	calc_hex_pos(gmap, hex->x, hex->y, &x_offset, &y_offset);
 	cairo_set_line_width(gmap->cr, 1.0);
@@ -863,7 +1287,7 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 
 	/* Draw the hex */
 	gdk_cairo_set_source_pixbuf(gmap->cr,
-				    theme_get_terrain_pixbuf(hex->terrain),
+				    terrain_pixbuf(gmap, hex->terrain),
 				    x_offset - gmap->x_point,
 				    y_offset - gmap->hex_radius);
 	cairo_pattern_set_extend(cairo_get_source(gmap->cr),
@@ -880,11 +1304,11 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 	/* Draw the dice roll */
 	if (hex->roll > 0 && gmap->chit_radius > 0) {
 		g_assert(gmap->layout);
-		draw_dice_roll(gmap->layout, gmap->cr,
-			       x_offset, y_offset, gmap->chit_radius,
-			       hex->roll, hex->terrain,
-			       !hex->robber
-			       && hex->roll == gmap->highlight_chit);
+		draw_dice_roll_theme(theme, gmap->layout, gmap->cr,
+				     x_offset, y_offset, gmap->chit_radius,
+				     hex->roll, hex->terrain,
+				     !hex->robber
+				     && hex->roll == gmap->highlight_chit);
 	}
 
 	/* Draw ports */
@@ -904,12 +1328,27 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 		cairo_stroke(gmap->cr);
 		cairo_set_dash(gmap->cr, NULL, 0, 0.0);
 
-		draw_port_indicator(gmap->layout, gmap->cr,
-				    x_offset, y_offset, gmap->chit_radius,
-				    hex->resource);
+		draw_port_indicator_theme(theme, gmap->layout, gmap->cr,
+					  x_offset, y_offset,
+					  gmap->chit_radius, hex->resource);
 	}
 
-	cairo_set_line_width(gmap->cr, 1.0);
+	return FALSE;
+}
+
+/* Draw the pieces on the edges and nodes of the hex, and the robber
+ * and the pirate, in the pieces layer */
+static gboolean display_hex_pieces(const Hex * hex, gpointer closure)
+{
+	GdkPoint points[MAX_POINTS];
+	Polygon poly;
+	guint idx;
+	const GuiMap *gmap = closure;
+	const MapTheme *theme = guimap_theme(gmap);
+	cairo_t *cr = gmap->pieces_cr;
+
+	poly.points = points;
+	cairo_set_line_width(cr, 1.0);
 	/* Draw all roads and ships */
 	for (idx = 0; idx < G_N_ELEMENTS(hex->edges); idx++) {
 		const Edge *edge = hex->edges[idx];
@@ -931,9 +1370,8 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 			g_assert_not_reached();
 			break;
 		}
-		gdk_cairo_set_source_rgba(gmap->cr,
-					  colors_get_player(edge->owner));
-		poly_draw_with_border(gmap->cr, &black, &poly);
+		gdk_cairo_set_source_rgba(cr, colors_get_player(edge->owner));
+		poly_draw_with_border(cr, &black, &poly);
 	}
 
 	/* Draw all buildings */
@@ -958,9 +1396,8 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 				poly.num_points = G_N_ELEMENTS(points);
 				guimap_city_wall_polygon(gmap, node,
 							 &poly);
-				gdk_cairo_set_source_rgba(gmap->cr, color);
-				poly_draw_with_border(gmap->cr, &black,
-						      &poly);
+				gdk_cairo_set_source_rgba(cr, color);
+				poly_draw_with_border(cr, &black, &poly);
 			}
 			/* Draw the building */
 			color = colors_get_player(node->owner);
@@ -971,26 +1408,26 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 				guimap_settlement_polygon(gmap, node,
 							  &poly);
 		}
-		gdk_cairo_set_source_rgba(gmap->cr, color);
-		poly_draw_with_border(gmap->cr, &black, &poly);
+		gdk_cairo_set_source_rgba(cr, color);
+		poly_draw_with_border(cr, &black, &poly);
 	}
 
 	/* Draw the robber */
 	if (hex->robber) {
 		poly.num_points = G_N_ELEMENTS(points);
 		guimap_robber_polygon(gmap, hex, &poly);
-		cairo_set_line_width(gmap->cr, 1.0);
+		cairo_set_line_width(cr, 1.0);
 		if (!theme->colors[TC_ROBBER_FG].transparent) {
-			gdk_cairo_set_source_rgba(gmap->cr,
+			gdk_cairo_set_source_rgba(cr,
 						  &theme->colors
 						  [TC_ROBBER_FG].color);
-			poly_draw(gmap->cr, TRUE, &poly);
+			poly_draw(cr, TRUE, &poly);
 		}
 		if (!theme->colors[TC_ROBBER_BD].transparent) {
-			gdk_cairo_set_source_rgba(gmap->cr,
+			gdk_cairo_set_source_rgba(cr,
 						  &theme->colors
 						  [TC_ROBBER_BD].color);
-			poly_draw(gmap->cr, FALSE, &poly);
+			poly_draw(cr, FALSE, &poly);
 		}
 	}
 
@@ -998,25 +1435,26 @@ static gboolean display_hex(const Hex * hex, gpointer closure)
 	if (hex == hex->map->pirate_hex) {
 		poly.num_points = G_N_ELEMENTS(points);
 		guimap_pirate_polygon(gmap, hex, &poly);
-		cairo_set_line_width(gmap->cr, 1.0);
+		cairo_set_line_width(cr, 1.0);
 		if (!theme->colors[TC_ROBBER_FG].transparent) {
-			gdk_cairo_set_source_rgba(gmap->cr,
+			gdk_cairo_set_source_rgba(cr,
 						  &theme->colors
 						  [TC_ROBBER_FG].color);
-			poly_draw(gmap->cr, TRUE, &poly);
+			poly_draw(cr, TRUE, &poly);
 		}
 		if (!theme->colors[TC_ROBBER_BD].transparent) {
-			gdk_cairo_set_source_rgba(gmap->cr,
+			gdk_cairo_set_source_rgba(cr,
 						  &theme->colors
 						  [TC_ROBBER_BD].color);
-			poly_draw(gmap->cr, FALSE, &poly);
+			poly_draw(cr, FALSE, &poly);
 		}
 	}
 
 	return FALSE;
 }
 
-void guimap_scale_with_radius(GuiMap * gmap, gint radius)
+/* Set the size of the hexes, without rescaling the theme */
+static void scale_geometry(GuiMap * gmap, gint radius)
 {
 	if (radius < MIN_HEX_RADIUS)
 		radius = MIN_HEX_RADIUS;
@@ -1024,6 +1462,7 @@ void guimap_scale_with_radius(GuiMap * gmap, gint radius)
 	gmap->hex_radius = radius;
 	gmap->x_point = radius * cos(M_PI / 6.0);
 	gmap->y_point = radius * sin(M_PI / 6.0);
+	geometry_build(gmap);
 
 	if (gmap->map == NULL)
 		return;
@@ -1039,14 +1478,17 @@ void guimap_scale_with_radius(GuiMap * gmap, gint radius)
 	if (gmap->map->shrink_right)
 		gmap->width -= gmap->x_point;
 
-	if (gmap->cr != NULL) {
-		cairo_destroy(gmap->cr);
-		gmap->cr = NULL;
-	}
-
 	gmap->chit_radius = 15;
+}
 
-	theme_rescale(2 * gmap->x_point);
+void guimap_scale_with_radius(GuiMap * gmap, gint radius)
+{
+	scale_geometry(gmap, radius);
+	if (gmap->tiles != NULL)
+		theme_scale_tiles(guimap_theme(gmap), 2 * gmap->x_point,
+				  gmap->tiles);
+	else if (gmap->map != NULL)
+		theme_rescale(2 * gmap->x_point);
 }
 
 void guimap_scale_to_size(GuiMap * gmap, gint width, gint height)
@@ -1112,29 +1554,22 @@ void guimap_display(GuiMap * gmap)
 	PangoContext *pc;
 	PangoFontDescription *pfd;
 	gint font_size;
-	cairo_rectangle_t extents;
 
 	if (gmap->surface == NULL)
 		return;
 
-	if (gmap->cr != NULL) {
-		cairo_destroy(gmap->cr);
-	}
-
-	gmap->cr = cairo_create(gmap->surface);
-
 	gdk_cairo_set_source_pixbuf(gmap->cr,
-				    theme_get_current()->terrain_tiles
-				    [BOARD_TILE], 0, 0);
+				    terrain_pixbuf(gmap, BOARD_TILE), 0, 0);
 	cairo_pattern_set_extend(cairo_get_source(gmap->cr),
 				 CAIRO_EXTEND_REPEAT);
-	cairo_recording_surface_get_extents(gmap->surface, &extents);
-	cairo_rectangle(gmap->cr, 0, 0, extents.width, extents.height);
-	cairo_fill(gmap->cr);
+	cairo_paint(gmap->cr);
 
 	if (gmap->layout != NULL)
 		g_object_unref(gmap->layout);
-	gmap->layout = gtk_widget_create_pango_layout(gmap->area, "");
+	if (gmap->area != NULL)
+		gmap->layout = gtk_widget_create_pango_layout(gmap->area, "");
+	else
+		gmap->layout = pango_cairo_create_layout(gmap->cr);
 
 	/* Manipulate the font size */
 	pc = pango_layout_get_context(gmap->layout);
@@ -1174,7 +1609,21 @@ void guimap_display(GuiMap * gmap)
 		gmap->chit_radius = size_for_text;
 	}
 
-	map_traverse_const(gmap->map, display_hex, gmap);
+	map_traverse_const(gmap->map, display_hex_terrain, gmap);
+
+	cairo_set_operator(gmap->pieces_cr, CAIRO_OPERATOR_CLEAR);
+	cairo_paint(gmap->pieces_cr);
+	cairo_set_operator(gmap->pieces_cr, CAIRO_OPERATOR_OVER);
+	map_traverse_const(gmap->map, display_hex_pieces, gmap);
+
+	gmap->layer_x_margin = gmap->x_margin;
+	gmap->layer_y_margin = gmap->y_margin;
+	gmap->layer_width = gmap->width;
+	gmap->layer_height = gmap->height;
+
+	/* The cursor is drawn again at the next move of the mouse */
+	erase_cursor(gmap);
+	gmap->cursor.pointer = NULL;
 }
 
 void guimap_zoom_normal(GuiMap * gmap)
@@ -1200,6 +1649,30 @@ void guimap_zoom_center_map(GuiMap * gmap)
 	gtk_widget_queue_draw(gmap->area);
 }
 
+/* The index of the offset that is closest to (x, y).
+ * The closest edge or node of a hex lies in the same sector as the
+ * point, so this gives the same result as the angle of the point.
+ */
+static gint closest_offset(const gdouble * offset_x,
+			   const gdouble * offset_y, gdouble x, gdouble y)
+{
+	gdouble best = G_MAXDOUBLE;
+	gint best_idx = 0;
+	gint idx;
+
+	for (idx = 0; idx < 6; idx++) {
+		gdouble dx = x - offset_x[idx];
+		gdouble dy = y - offset_y[idx];
+		gdouble distance = dx * dx + dy * dy;
+
+		if (distance < best) {
+			best = distance;
+			best_idx = idx;
+		}
+	}
+	return best_idx;
+}
+
 /** Finds the closest edge to the last known cursor position.
  * @param gmap The GuiMap containing the edge.
  * @return The closest edge.
@@ -1215,6 +1688,14 @@ Edge *guimap_get_current_edge(GuiMap * gmap)
 
 		calc_hex_pos(gmap, hex->x, hex->y, &center_x, &center_y);
 
+		if (geometry_get(gmap) != NULL) {
+			idx = closest_offset(gmap->geometry->edge_x,
+					     gmap->geometry->edge_y,
+					     gmap->last_x - center_x,
+					     gmap->last_y - center_y);
+			return hex->edges[idx];
+		}
+
 		angle =
 		    atan2(gmap->last_y - center_y,
 			  gmap->last_x - center_x);
@@ -1250,6 +1731,14 @@ Node *guimap_get_current_node(GuiMap * gmap)
 
 		calc_hex_pos(gmap, hex->x, hex->y, &center_x, &center_y);
 
+		if (geometry_get(gmap) != NULL) {
+			idx = closest_offset(gmap->geometry->node_x,
+					     gmap->geometry->node_y,
+					     gmap->last_x - center_x,
+					     gmap->last_y - center_y);
+			return hex->nodes[idx];
+		}
+
 		angle =
 		    atan2(gmap->last_y - center_y,
 			  gmap->last_x - center_x);
@@ -1291,10 +1780,111 @@ static void find_hex(GuiMap * gmap, MapElement * element)
 	element->hex = guimap_get_current_hex(gmap);
 }
 
+typedef struct {
+	GuiMap *gmap;
+	GdkRectangle rect;
+} RedrawInfo;
+
+/* Draw the pieces of the hex, when they can overlap the area */
+static gboolean redraw_hex_pieces(const Hex * hex, gpointer closure)
+{
+	RedrawInfo *info = closure;
+	GuiMap *gmap = info->gmap;
+	GdkRectangle hex_rect;
+	gint x_offset, y_offset;
+
+	/* All pieces of a hex are within two radii of its centre */
+	calc_hex_pos(gmap, hex->x, hex->y, &x_offset, &y_offset);
+	hex_rect.x = x_offset - 2 * gmap->hex_radius;
+	hex_rect.y = y_offset - 2 * gmap->hex_radius;
+	hex_rect.width = 4 * gmap->hex_radius;
+	hex_rect.height = 4 * gmap->hex_radius;
+	if (gdk_rectangle_intersect(&hex_rect, &info->rect, NULL))
+		display_hex_pieces(hex, gmap);
+	return FALSE;
+}
+
+/** Draws the pieces of the hexes near an area, in the order of
+ * map_traverse_const. Only the hexes whose centre is within two radii of
+ * the area are looked at, they are found from the inverse of
+ * calc_hex_pos.
+ * @param info The GuiMap and the area
+ */
+static void redraw_pieces_near(RedrawInfo * info)
+{
+	const GuiMap *gmap = info->gmap;
+	const Map *map = gmap->map;
+	gint margin = 2 * gmap->hex_radius;
+	gint row_height = gmap->hex_radius + gmap->y_point;
+	gdouble left;
+	gint x_min, x_max, y_min, y_max;
+	gint x, y;
+
+	if (gmap->x_point <= 0 || row_height <= 0) {
+		map_traverse_const(map, redraw_hex_pieces, info);
+		return;
+	}
+
+	/* The centre of hex (x, y) is at left + 2 * x * x_point, one more
+	 * x_point on odd rows, and at y_margin + hex_radius + y * row_height
+	 */
+	left = gmap->x_margin + gmap->x_point;
+	if (map->shrink_left)
+		left -= gmap->x_point;
+	x_min = (gint) floor((info->rect.x - margin - gmap->x_point - left)
+			     / (2 * gmap->x_point));
+	x_max = (gint) ceil((info->rect.x + info->rect.width + margin - left)
+			    / (2 * gmap->x_point));
+	y_min = (gint) floor((info->rect.y - margin - gmap->y_margin
+			      - gmap->hex_radius) / row_height);
+	y_max = (gint) ceil((info->rect.y + info->rect.height + margin
+			     - gmap->y_margin - gmap->hex_radius)
+			    / row_height);
+
+	/* One more on each side for the rounding of calc_hex_pos */
+	x_min = MAX(x_min - 1, 0);
+	x_max = MIN(x_max + 1, map->x_size - 1);
+	y_min = MAX(y_min - 1, 0);
+	y_max = MIN(y_max + 1, map->y_size - 1);
+	for (x = x_min; x <= x_max; x++)
+		for (y = y_min; y <= y_max; y++) {
+			const Hex *hex = map_hex_const(map, x, y);
+
+			if (hex != NULL)
+				redraw_hex_pieces(hex, info);
+		}
+}
+
+/** Redraws an area of the pieces layer.
+ * @param gmap The GuiMap.
+ * @param rect The area to redraw.
+ */
+static void redraw_pieces(GuiMap * gmap, const GdkRectangle * rect)
+{
+	RedrawInfo info;
+
+	/* Everything is drawn again when the gesture is finished */
+	if (layers_transformed(gmap))
+		return;
+
+	info.gmap = gmap;
+	info.rect = *rect;
+
+	cairo_save(gmap->pieces_cr);
+	gdk_cairo_rectangle(gmap->pieces_cr, rect);
+	cairo_clip(gmap->pieces_cr);
+	cairo_set_operator(gmap->pieces_cr, CAIRO_OPERATOR_CLEAR);
+	cairo_paint(gmap->pieces_cr);
+	cairo_set_operator(gmap->pieces_cr, CAIRO_OPERATOR_OVER);
+	redraw_pieces_near(&info);
+	cairo_restore(gmap->pieces_cr);
+
+	invalidate_rect(gmap, rect);
+}
+
 void guimap_draw_edge(GuiMap * gmap, const Edge * edge)
 {
 	GdkRectangle rect;
-	guint idx;
 	Polygon poly;
 	GdkPoint points[MAX_POINTS];
 
@@ -1306,41 +1896,55 @@ void guimap_draw_edge(GuiMap * gmap, const Edge * edge)
 	calc_edge_poly(gmap, edge, &largest_edge_poly, &poly);
 	poly_bound_rect(&poly, 1, &rect);
 
-	gdk_cairo_set_source_pixbuf(gmap->cr,
-				    theme_get_current()->terrain_tiles
-				    [BOARD_TILE], 0, 0);
-	cairo_pattern_set_extend(cairo_get_source(gmap->cr),
-				 CAIRO_EXTEND_REPEAT);
-	cairo_rectangle(gmap->cr, rect.x, rect.y, rect.width, rect.height);
-	cairo_fill(gmap->cr);
+	redraw_pieces(gmap, &rect);
+}
 
-	for (idx = 0; idx < G_N_ELEMENTS(edge->hexes); idx++)
-		if (edge->hexes[idx] != NULL)
-			display_hex(edge->hexes[idx], gmap);
+/* Add the area of a polygon to the area of the cursor */
+static void add_cursor_rect(GuiMap * gmap, const Polygon * poly)
+{
+	GdkRectangle rect;
 
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
+	poly_bound_rect(poly, 2, &rect);
+	if (gmap->cursor_rect.width > 0)
+		gdk_rectangle_union(&gmap->cursor_rect, &rect,
+				    &gmap->cursor_rect);
+	else
+		gmap->cursor_rect = rect;
+	invalidate_rect(gmap, &rect);
 }
 
 static void draw_cursor(GuiMap * gmap, gint owner, const Polygon * poly)
 {
-	GdkRectangle rect;
-
 	g_return_if_fail(gmap->cursor.pointer != NULL);
 
-	cairo_set_line_width(gmap->cr, 3.0);
-	gdk_cairo_set_source_rgba(gmap->cr, colors_get_player(owner));
-	poly_draw_with_border(gmap->cr, &green, poly);
+	if (gmap->overlay_cr == NULL || layers_transformed(gmap))
+		return;
+
+	cairo_set_line_width(gmap->overlay_cr, 3.0);
+	gdk_cairo_set_source_rgba(gmap->overlay_cr,
+				  colors_get_player(owner));
+	poly_draw_with_border(gmap->overlay_cr, &green, poly);
 
-	poly_bound_rect(poly, 1, &rect);
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
+	add_cursor_rect(gmap, poly);
 }
 
-static void erase_edge_cursor(GuiMap * gmap)
+/* Clear the cursor layer, the layers below it show through */
+static void erase_cursor(GuiMap * gmap)
 {
-	g_return_if_fail(gmap->cursor.pointer != NULL);
-	guimap_draw_edge(gmap, gmap->cursor.edge);
+	if (gmap->cursor_rect.width <= 0)
+		return;
+
+	if (gmap->overlay_cr != NULL) {
+		cairo_save(gmap->overlay_cr);
+		gdk_cairo_rectangle(gmap->overlay_cr, &gmap->cursor_rect);
+		cairo_clip(gmap->overlay_cr);
+		cairo_set_operator(gmap->overlay_cr, CAIRO_OPERATOR_CLEAR);
+		cairo_paint(gmap->overlay_cr);
+		cairo_restore(gmap->overlay_cr);
+		invalidate_rect(gmap, &gmap->cursor_rect);
+	}
+	gmap->cursor_rect.width = 0;
+	gmap->cursor_rect.height = 0;
 }
 
 static void draw_road_cursor(GuiMap * gmap)
@@ -1385,7 +1989,6 @@ static void draw_bridge_cursor(GuiMap * gmap)
 void guimap_draw_node(GuiMap * gmap, const Node * node)
 {
 	GdkRectangle rect;
-	guint idx;
 	Polygon poly;
 	GdkPoint points[MAX_POINTS];
 
@@ -1397,26 +2000,7 @@ void guimap_draw_node(GuiMap * gmap, const Node * node)
 	calc_node_poly(gmap, node, &largest_node_poly, &poly);
 	poly_bound_rect(&poly, 1, &rect);
 
-	gdk_cairo_set_source_pixbuf(gmap->cr,
-				    theme_get_current()->terrain_tiles
-				    [BOARD_TILE], 0, 0);
-	cairo_pattern_set_extend(cairo_get_source(gmap->cr),
-				 CAIRO_EXTEND_REPEAT);
-	cairo_rectangle(gmap->cr, rect.x, rect.y, rect.width, rect.height);
-	cairo_fill(gmap->cr);
-
-	for (idx = 0; idx < G_N_ELEMENTS(node->hexes); idx++)
-		if (node->hexes[idx] != NULL)
-			display_hex(node->hexes[idx], gmap);
-
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
-}
-
-static void erase_node_cursor(GuiMap * gmap)
-{
-	g_return_if_fail(gmap->cursor.pointer != NULL);
-	guimap_draw_node(gmap, gmap->cursor.node);
+	redraw_pieces(gmap, &rect);
 }
 
 static void draw_settlement_cursor(GuiMap * gmap)
@@ -1511,38 +2095,14 @@ static void draw_steal_ship_cursor(GuiMap * gmap)
 	}
 }
 
-static void erase_robber_cursor(GuiMap * gmap)
-{
-	const Hex *hex = gmap->cursor.hex;
-	GdkPoint points[MAX_POINTS];
-	Polygon poly;
-	GdkRectangle rect;
-
-	if (hex == NULL)
-		return;
-
-	poly.points = points;
-	poly.num_points = G_N_ELEMENTS(points);
-	if (hex->terrain == SEA_TERRAIN)
-		guimap_pirate_polygon(gmap, hex, &poly);
-	else
-		guimap_robber_polygon(gmap, hex, &poly);
-	poly_bound_rect(&poly, 1, &rect);
-
-	display_hex(hex, gmap);
-
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
-}
-
 static void draw_robber_cursor(GuiMap * gmap)
 {
 	const Hex *hex = gmap->cursor.hex;
 	GdkPoint points[MAX_POINTS];
 	Polygon poly;
-	GdkRectangle rect;
 
-	if (hex == NULL)
+	if (hex == NULL || gmap->overlay_cr == NULL
+	    || layers_transformed(gmap))
 		return;
 
 	poly.points = points;
@@ -1551,14 +2111,12 @@ static void draw_robber_cursor(GuiMap * gmap)
 		guimap_pirate_polygon(gmap, hex, &poly);
 	else
 		guimap_robber_polygon(gmap, hex, &poly);
-	poly_bound_rect(&poly, 1, &rect);
 
-	cairo_set_line_width(gmap->cr, 2.0);
-	gdk_cairo_set_source_rgba(gmap->cr, &green);
-	poly_draw(gmap->cr, FALSE, &poly);
+	cairo_set_line_width(gmap->overlay_cr, 2.0);
+	gdk_cairo_set_source_rgba(gmap->overlay_cr, &green);
+	poly_draw(gmap->overlay_cr, FALSE, &poly);
 
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
+	add_cursor_rect(gmap, &poly);
 }
 
 static gboolean highlight_chits(const Hex * hex, gpointer closure)
@@ -1574,7 +2132,8 @@ static gboolean highlight_chits(const Hex * hex, gpointer closure)
 	    && hex->roll != gmap->highlight_chit)
 		return FALSE;
 
-	display_hex(hex, gmap);
+	/* The chits are in the static layer */
+	display_hex_terrain(hex, gmap);
 
 	poly.points = points;
 	poly.num_points = G_N_ELEMENTS(points);
@@ -1583,8 +2142,7 @@ static gboolean highlight_chits(const Hex * hex, gpointer closure)
 	poly_offset(&poly, x_offset, y_offset);
 	poly_bound_rect(&poly, 1, &rect);
 
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
+	invalidate_rect(gmap, &rect);
 	return FALSE;
 }
 
@@ -1597,7 +2155,7 @@ void guimap_highlight_chits(GuiMap * gmap, gint roll)
 	closure.gmap = gmap;
 	closure.old_highlight = gmap->highlight_chit;
 	gmap->highlight_chit = roll;
-	if (gmap->surface != NULL)
+	if (gmap->surface != NULL && !layers_transformed(gmap))
 		map_traverse_const(gmap->map, highlight_chits, &closure);
 }
 
@@ -1608,10 +2166,11 @@ void guimap_draw_hex(GuiMap * gmap, const Hex * hex)
 	GdkRectangle rect;
 	gint x_offset, y_offset;
 
-	if (hex == NULL)
+	if (hex == NULL || gmap->surface == NULL
+	    || layers_transformed(gmap))
 		return;
 
-	display_hex(hex, gmap);
+	display_hex_terrain(hex, gmap);
 
 	poly.points = points;
 	poly.num_points = G_N_ELEMENTS(points);
@@ -1620,28 +2179,26 @@ void guimap_draw_hex(GuiMap * gmap, const Hex * hex)
 	poly_offset(&poly, x_offset, y_offset);
 	poly_bound_rect(&poly, 1, &rect);
 
-	gdk_window_invalidate_rect(gtk_widget_get_window(gmap->area),
-				   &rect, FALSE);
+	redraw_pieces(gmap, &rect);
 }
 
 typedef struct {
 	void (*find) (GuiMap * gmap, MapElement * element);
-	void (*erase_cursor) (GuiMap * gmap);
 	void (*draw_cursor) (GuiMap * gmap);
 } ModeCursor;
 
 /* This array must follow the enum CursorType */
 static ModeCursor cursors[] = {
-	{NULL, NULL, NULL},	/* NO_CURSOR */
-	{find_edge, erase_edge_cursor, draw_road_cursor},	/* ROAD_CURSOR */
-	{find_edge, erase_edge_cursor, draw_ship_cursor},	/* SHIP_CURSOR */
-	{find_edge, erase_edge_cursor, draw_bridge_cursor},	/* BRIDGE_CURSOR */
-	{find_node, erase_node_cursor, draw_settlement_cursor},	/* SETTLEMENT_CURSOR */
-	{find_node, erase_node_cursor, draw_city_cursor},	/* CITY_CURSOR */
-	{find_node, erase_node_cursor, draw_city_wall_cursor},	/* CITY_WALL_CURSOR */
-	{find_node, erase_node_cursor, draw_steal_building_cursor},	/* STEAL_BUILDING_CURSOR */
-	{find_edge, erase_edge_cursor, draw_steal_ship_cursor},	/* STEAL_SHIP_CURSOR */
-	{find_hex, erase_robber_cursor, draw_robber_cursor}	/* ROBBER_CURSOR */
+	{NULL, NULL},		/* NO_CURSOR */
+	{find_edge, draw_road_cursor},	/* ROAD_CURSOR */
+	{find_edge, draw_ship_cursor},	/* SHIP_CURSOR */
+	{find_edge, draw_bridge_cursor},	/* BRIDGE_CURSOR */
+	{find_node, draw_settlement_cursor},	/* SETTLEMENT_CURSOR */
+	{find_node, draw_city_cursor},	/* CITY_CURSOR */
+	{find_node, draw_city_wall_cursor},	/* CITY_WALL_CURSOR */
+	{find_node, draw_steal_building_cursor},	/* STEAL_BUILDING_CURSOR */
+	{find_edge, draw_steal_ship_cursor},	/* STEAL_SHIP_CURSOR */
+	{find_hex, draw_robber_cursor}	/* ROBBER_CURSOR */
 };
 
 gboolean roadM, shipM, bridgeM, settlementM, cityM, cityWallM, shipMoveM;
@@ -1660,27 +2217,22 @@ gint guimap_distance_cursor(const GuiMap * gmap,
 			    const MapElement * element,
 			    MapElementType type)
 {
-	static GdkPoint single_point = { 0, 0 };
-	static const Polygon simple_poly = { &single_point, 1 };
-	GdkPoint translated_point;
-	Polygon poly;
-	poly.num_points = 1;
-	poly.points = &translated_point;
+	gint x = 0;
+	gint y = 0;
+
 	switch (type) {
 	case MAP_EDGE:
-		calc_edge_poly(gmap, element->edge, &simple_poly, &poly);
+		calc_edge_pos(gmap, element->edge, &x, &y);
 		break;
 	case MAP_NODE:
-		calc_node_poly(gmap, element->node, &simple_poly, &poly);
+		calc_node_pos(gmap, element->node, &x, &y);
 		break;
 	case MAP_HEX:
-		calc_hex_poly(gmap, element->hex, &simple_poly, &poly,
-			      120.0, 0);
+		calc_hex_pos(gmap, element->hex->x, element->hex->y, &x,
+			     &y);
 		break;
 	}
-	return sqr(gmap->last_x - poly.points[0].x) + sqr(gmap->last_y -
-							  poly.
-							  points[0].y);
+	return sqr(gmap->last_x - x) + sqr(gmap->last_y - y);
 }
 
 void guimap_cursor_move(GuiMap * gmap, MapElement * element)
@@ -1867,7 +2419,7 @@ void guimap_cursor_move(GuiMap * gmap, MapElement * element)
 	mode->find(gmap, element);
 	if (element->pointer != gmap->cursor.pointer) {
 		if (gmap->cursor.pointer != NULL)
-			mode->erase_cursor(gmap);
+			erase_cursor(gmap);
 		if (gmap->check_func == NULL
 		    || (element->pointer != NULL
 			&& gmap->check_func(*element, gmap->cursor_owner,
@@ -1905,7 +2457,7 @@ void guimap_cursor_select(GuiMap * gmap)
 		user_data.pointer = gmap->user_data.pointer;
 
 		if (gmap->cursor.pointer != NULL)
-			cursors[gmap->cursor_type].erase_cursor(gmap);
+			erase_cursor(gmap);
 		gmap->cursor_owner = -1;
 		gmap->check_func = NULL;
 		gmap->cursor_type = NO_CURSOR;
@@ -1941,7 +2493,7 @@ void guimap_cursor_set(GuiMap * gmap, CursorType cursor_type, gint owner,
 
 	if (gmap->cursor.pointer != NULL) {
 		g_assert(gmap->cursor_type != NO_CURSOR);
-		cursors[gmap->cursor_type].erase_cursor(gmap);
+		erase_cursor(gmap);
 	}
 	gmap->cursor_type = cursor_type;
 	gmap->cursor.pointer = NULL;
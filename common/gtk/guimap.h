@@ -63,10 +63,16 @@ typedef void (*SelectFunc) (const MapElement obj,
 typedef void (*CancelFunc) (void);
 
 typedef struct _Mode Mode;
+typedef struct _GuiMapGeometry GuiMapGeometry;
 typedef struct {
 	GtkWidget *area;	   /**< render map in this drawing area */
-	cairo_surface_t *surface;  /**< off screen surface for drawing */
-	cairo_t *cr;		   /**< cairo for map drawing */
+	cairo_surface_t *surface;  /**< static layer: tiles, chits and ports */
+	cairo_t *cr;		   /**< cairo for the static layer */
+	cairo_surface_t *pieces;   /**< layer with the pieces and the robber */
+	cairo_t *pieces_cr;	   /**< cairo for the pieces layer */
+	cairo_surface_t *overlay;  /**< layer with the cursor */
+	cairo_t *overlay_cr;	   /**< cairo for the cursor layer */
+	GdkRectangle cursor_rect;  /**< area of the cursor in the overlay */
 	PangoLayout *layout;	   /**< layout object for rendering text */
 	gint initial_font_size;	   /**< initial font size */
 
@@ -96,6 +102,15 @@ typedef struct {
 	gint width;		   /**< pixel width of map */
 	gint height;		   /**< pixel height of map */
 	gint player_num;	   /**< player displaying this map */
+
+	gdouble layer_x_margin;	   /**< x_margin when the layers were drawn */
+	gdouble layer_y_margin;	   /**< y_margin when the layers were drawn */
+	gint layer_width;	   /**< width when the layers were drawn */
+	gint layer_height;	   /**< height when the layers were drawn */
+	guint settle_id;	   /**< draw the layers when zooming stops */
+	GdkPixbuf **tiles;	   /**< own terrain tiles, or NULL */
+	const struct _MapTheme *theme;	/**< theme of own tiles, or NULL */
+	GuiMapGeometry *geometry;  /**< shapes scaled for hex_radius */
 } GuiMap;
 
 GuiMap *guimap_new(void);
@@ -104,6 +119,8 @@ void guimap_reset(GuiMap * gmap);
 GtkWidget *guimap_build_drawingarea(GuiMap * gmap, gint width,
 				    gint height);
 
+void guimap_hex_polygon(const GuiMap * gmap, const Hex * hex,
+			Polygon * poly);
 void guimap_road_polygon(const GuiMap * gmap, const Edge * edge,
 			 Polygon * poly);
 void guimap_ship_polygon(const GuiMap * gmap, const Edge * edge,
@@ -125,6 +142,12 @@ void draw_dice_roll(PangoLayout * layout, cairo_t * cr, gdouble x_offset,
 		    gdouble y_offset, gdouble radius, gint n, gint terrain,
 		    gboolean highlight);
 
+void guimap_use_own_tiles(GuiMap * gmap, const struct _MapTheme *theme);
+void guimap_create_layers(GuiMap * gmap, gint width, gint height);
+void guimap_discard_layers(GuiMap * gmap);
+void guimap_paint(const GuiMap * gmap, cairo_t * cr);
+cairo_surface_t *guimap_render(GuiMap * gmap, gint width, gint height);
+
 void guimap_scale_with_radius(GuiMap * gmap, gint radius);
 void guimap_scale_to_size(GuiMap * gmap, gint width, gint height);
 void guimap_display(GuiMap * gmap);
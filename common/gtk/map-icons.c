@@ -42,9 +42,7 @@ static gboolean draw_terrain_cb(GtkWidget * widget, cairo_t * cr,
 
 	gtk_widget_get_allocation(widget, &allocation);
 	height = allocation.width / theme->scaledata[terrain].aspect;
-	p = gdk_pixbuf_scale_simple(theme->scaledata[terrain].native_image,
-				    allocation.width, height,
-				    GDK_INTERP_BILINEAR);
+	p = theme_scale_tile(theme, terrain, allocation.width, height);
 
 	gdk_cairo_set_source_pixbuf(cr, p, 0, 0);
 	cairo_rectangle(cr, 0, 0, allocation.width, height);
@@ -10,8 +10,10 @@
 #include "config.h"
 #include "game.h"
 #include <gtk/gtk.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #include "guimap.h"
+#include "theme.h"
 #include "common_gtk.h"
 
 #include "select-game.h"
@@ -187,37 +189,6 @@ void select_game_add(SelectGame * sg, const gchar * game_title)
 	select_game_add_internal(sg, game_title, &iter);
 }
 
-/** Render the map.
- * @param base_widget Base widget
- * @param map The map
- * @return A GdkPixbuf with ref count = 1
- */
-static GdkPixbuf *render_map(GtkWidget * base_widget, const Map * map)
-{
-	GdkPixbuf *pixbuf;
-	GuiMap *gmap;
-
-	gmap = guimap_new();
-	cairo_rectangle_t extent = { 0.0, 0.0, MAP_WIDTH, MAP_HEIGHT };
-	gmap->surface =
-	    cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA,
-					   &extent);
-	gmap->width = MAP_WIDTH;
-	gmap->height = MAP_HEIGHT;
-	gmap->area = base_widget;
-	g_object_ref(gmap->area);
-	gmap->map = map_copy(map);
-	guimap_scale_to_size(gmap, MAP_WIDTH, MAP_HEIGHT);
-	guimap_display(gmap);
-
-	pixbuf =
-	    gdk_pixbuf_get_from_surface(gmap->surface, 0, 0, MAP_WIDTH,
-					MAP_HEIGHT);
-	guimap_delete(gmap);
-
-	return pixbuf;
-}
-
 static void select_game_item_changed(G_GNUC_UNUSED GtkWidget * widget,
 				     SelectGame * sg)
 {
@@ -258,38 +229,230 @@ static gboolean select_game_locate_title(SelectGame * sg,
 	return found;
 }
 
-struct TMapRenderer {
+/* The version of the previews, change it when the drawing changes */
+#define PREVIEW_VERSION "1"
+
+/* The number of previews kept on disk, the least recently used go first */
+#define PREVIEW_DISK_MAX 256
+
+#if GLIB_CHECK_VERSION(2, 32, 0)
+/* Render the previews in a worker thread */
+#define PREVIEW_ASYNC
+#endif
+
+/* The previews of all games that were shown: key -> GdkPixbuf */
+static GHashTable *preview_cache;
+
+#ifdef PREVIEW_ASYNC
+static GThreadPool *preview_pool;
+#endif
+
+typedef struct {
 	SelectGame *sg;
-	GameParams *params;
-};
+	gchar *title;
+	Map *map;
+	const MapTheme *theme;
+	gchar *key;
+	GdkPixbuf *pixbuf;
+} PreviewJob;
 
-/** Render a map during the idle loop.
- * @param user_data Information about the map to render
- * @return FALSE to automatically remove the GSource.
+static void checksum_line(gpointer user_data, const gchar * line)
+{
+	g_checksum_update(user_data, (const guchar *) line, -1);
+	g_checksum_update(user_data, (const guchar *) "\n", 1);
+}
+
+/** The key of the preview of a game.
+ * It changes when the game, the theme or the size changes.
+ * @param params The game
+ * @param theme The theme the preview is drawn with
+ * @return The key, free it with g_free
  */
-static gboolean select_game_render_map(gpointer user_data)
+static gchar *preview_key(const GameParams * params,
+			  const MapTheme * theme)
+{
+	GChecksum *checksum;
+	gchar *key;
+	gchar *extra;
+
+	checksum = g_checksum_new(G_CHECKSUM_SHA1);
+	params_write_lines(params, LATEST_VERSION, TRUE, checksum_line,
+			   checksum);
+	extra =
+	    g_strdup_printf("%s %s %dx%d", PREVIEW_VERSION,
+			    theme->name, MAP_WIDTH,
+			    MAP_HEIGHT);
+	checksum_line(checksum, extra);
+	g_free(extra);
+	key = g_strdup(g_checksum_get_string(checksum));
+	g_checksum_free(checksum);
+	return key;
+}
+
+/** Render the map.
+ * The map is drawn with its own tiles, so this can be called
+ * from any thread.
+ * @param map The map, it is freed
+ * @param theme The theme to draw with
+ * @return A GdkPixbuf with ref count = 1
+ */
+static GdkPixbuf *render_map(Map * map, const MapTheme * theme)
 {
-	GtkTreeIter iter;
-	struct TMapRenderer *map_render_data;
-	SelectGame *sg;
 	GdkPixbuf *pixbuf;
+	GuiMap *gmap;
+	cairo_surface_t *surface;
+
+	gmap = guimap_new();
+	guimap_use_own_tiles(gmap, theme);
+	gmap->map = map;
+	surface = guimap_render(gmap, MAP_WIDTH, MAP_HEIGHT);
+	pixbuf =
+	    gdk_pixbuf_get_from_surface(surface, 0, 0, MAP_WIDTH,
+					MAP_HEIGHT);
+	cairo_surface_destroy(surface);
+	guimap_delete(gmap);
+
+	return pixbuf;
+}
 
-	map_render_data = user_data;
-	sg = map_render_data->sg;
-	g_return_val_if_fail(select_game_locate_title
-			     (sg, map_render_data->params->title, &iter),
-			     FALSE);
+typedef struct {
+	gchar *filename;
+	time_t used;
+} PreviewFile;
 
-	pixbuf = render_map(sg->combo_box, map_render_data->params->map);
-	gtk_list_store_set(sg->data, &iter, 1, pixbuf, -1);
-	g_object_unref(pixbuf);
+static gint preview_file_compare(gconstpointer a, gconstpointer b)
+{
+	const PreviewFile *file_a = a;
+	const PreviewFile *file_b = b;
 
-	g_free(map_render_data);
+	if (file_a->used != file_b->used)
+		return file_a->used > file_b->used ? -1 : 1;
+	return 0;
+}
+
+/** Remove the least recently used previews from the disk cache,
+ * until at most PREVIEW_DISK_MAX are left.
+ * @param dir The directory of the disk cache
+ */
+static void preview_prune(const gchar * dir)
+{
+	GDir *gdir;
+	const gchar *name;
+	GList *files = NULL;
+	GList *list;
+	guint count = 0;
+
+	gdir = g_dir_open(dir, 0, NULL);
+	if (gdir == NULL)
+		return;
+	while ((name = g_dir_read_name(gdir)) != NULL) {
+		PreviewFile *file;
+		GStatBuf buf;
+
+		if (!g_str_has_suffix(name, ".png"))
+			continue;
+		file = g_malloc(sizeof(*file));
+		file->filename = g_build_filename(dir, name, NULL);
+		file->used = g_stat(file->filename, &buf) == 0 ?
+		    buf.st_mtime : 0;
+		files = g_list_prepend(files, file);
+	}
+	g_dir_close(gdir);
 
+	files = g_list_sort(files, preview_file_compare);
+	for (list = files; list != NULL; list = g_list_next(list)) {
+		PreviewFile *file = list->data;
+
+		if (++count > PREVIEW_DISK_MAX)
+			g_unlink(file->filename);
+		g_free(file->filename);
+		g_free(file);
+	}
+	g_list_free(files);
+}
+
+/** Load the preview from the disk cache, or render and store it. */
+static void preview_load_or_render(PreviewJob * job)
+{
+	/* Only used by the thread of the previews */
+	static gboolean pruned = FALSE;
+	gchar *filename;
+	gchar *name;
+	gchar *dir;
+
+	dir =
+	    g_build_filename(g_get_user_cache_dir(), "pioneers",
+			     "previews", NULL);
+	if (!pruned) {
+		preview_prune(dir);
+		pruned = TRUE;
+	}
+	name = g_strconcat(job->key, ".png", NULL);
+	filename = g_build_filename(dir, name, NULL);
+	g_free(name);
+
+	job->pixbuf = gdk_pixbuf_new_from_file(filename, NULL);
+	if (job->pixbuf != NULL
+	    && (gdk_pixbuf_get_width(job->pixbuf) != MAP_WIDTH
+		|| gdk_pixbuf_get_height(job->pixbuf) != MAP_HEIGHT)) {
+		g_object_unref(job->pixbuf);
+		job->pixbuf = NULL;
+	}
+	if (job->pixbuf != NULL) {
+		/* Mark it as recently used */
+		g_utime(filename, NULL);
+	} else {
+		job->pixbuf = render_map(job->map, job->theme);
+		job->map = NULL;
+
+		/* The disk cache is an optimization, ignore errors */
+		if (g_mkdir_with_parents(dir, 0700) == 0)
+			gdk_pixbuf_save(job->pixbuf, filename, "png", NULL,
+					NULL);
+	}
+	g_free(filename);
+	g_free(dir);
+}
+
+/** Show the preview, in the main thread.
+ * @param user_data The PreviewJob
+ * @return FALSE to automatically remove the GSource.
+ */
+static gboolean preview_done(gpointer user_data)
+{
+	PreviewJob *job = user_data;
+	GtkTreeIter iter;
+
+	g_hash_table_replace(preview_cache, job->key, job->pixbuf);
+	if (select_game_locate_title(job->sg, job->title, &iter))
+		gtk_list_store_set(job->sg->data, &iter, 1, job->pixbuf, -1);
+
+	if (job->map != NULL)
+		map_free(job->map);
+	g_object_unref(job->sg);
+	g_free(job->title);
+	g_free(job);
 	return FALSE;
 }
 
+#ifdef PREVIEW_ASYNC
+static void preview_worker(gpointer data, G_GNUC_UNUSED gpointer user_data)
+{
+	preview_load_or_render(data);
+	g_idle_add(preview_done, data);
+}
+#else
+/* Render a preview during the idle loop */
+static gboolean preview_idle(gpointer user_data)
+{
+	preview_load_or_render(user_data);
+	return preview_done(user_data);
+}
+#endif
+
 /** Add a detailed entry.
+ * The preview is taken from the cache, or it is rendered in the
+ * background and shown when it is ready.
  * @param sg SelectGame
  * @param params The full parameters of the game
  */
@@ -297,37 +460,58 @@ void select_game_add_details(SelectGame * sg, const GameParams * params)
 {
 	GtkTreeIter iter;
 	gboolean found;
-	struct TMapRenderer *map_render_data;
+	GdkPixbuf *pixbuf;
+	gchar *key;
+	/* Taken here, the thread of the previews may not ask for it */
+	const MapTheme *theme = theme_get_current();
 
 	found = select_game_locate_title(sg, params->title, &iter);
 	if (!found) {
 		select_game_add_internal(sg, params->title, &iter);
 	}
 
-	map_render_data = g_malloc(sizeof(*map_render_data));
-	map_render_data->sg = sg;
-	map_render_data->params = params_copy(params);
+	if (preview_cache == NULL)
+		preview_cache =
+		    g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					  g_object_unref);
 
-	if (strcmp(select_game_get_active_title(sg), params->title)) {
-		/* Inactive item */
-		GdkPixbuf *pixbuf;
+	key = preview_key(params, theme);
+	pixbuf = g_hash_table_lookup(preview_cache, key);
+	if (pixbuf != NULL) {
+		g_object_ref(pixbuf);
+		g_free(key);
+	} else {
+		PreviewJob *job;
 
 		/* Create a placeholder of the right size */
 		pixbuf =
 		    gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, MAP_WIDTH,
 				   MAP_HEIGHT);
-		gtk_list_store_set(sg->data, &iter, 1, pixbuf, 2,
-				   map_render_data->params, -1);
-		g_object_unref(pixbuf);
+		gdk_pixbuf_fill(pixbuf, 0);
+
+		job = g_malloc0(sizeof(*job));
+		job->sg = g_object_ref(sg);
+		job->title = g_strdup(params->title);
+		job->map = map_copy(params->map);
+		job->theme = theme;
+		job->key = key;
+#ifdef PREVIEW_ASYNC
+		if (preview_pool == NULL)
+			preview_pool =
+			    g_thread_pool_new(preview_worker, NULL, 1, FALSE,
+					      NULL);
+		g_thread_pool_push(preview_pool, job, NULL);
+#else
+		g_idle_add(preview_idle, job);
+#endif
+	}
+	gtk_list_store_set(sg->data, &iter, 1, pixbuf, 2, params_copy(params),
+			   -1);
+	g_object_unref(pixbuf);
 
-		/* Render later */
-		g_idle_add(select_game_render_map, map_render_data);
-	} else {
+	if (!strcmp(select_game_get_active_title(sg), params->title)) {
 		/* Send an update when the details are known for
 		 * the active item */
-		gtk_list_store_set(sg->data, &iter, 2,
-				   map_render_data->params, -1);
-		select_game_render_map(map_render_data);
 		select_game_item_changed(NULL, sg);
 	}
 }
@@ -85,6 +85,22 @@
 
 #define TCOL_INIT(r,g,b)	{ TRUE, FALSE, { r, g, b, 1.0 } }
 
+/* Mip levels are not made smaller than this width */
+#define THEME_MIP_MIN_WIDTH 16
+/* Number of rescaled sets of tiles that are kept per theme */
+#define THEME_CACHE_SIZE 4
+
+/* GThreadPool can be used without g_thread_init() since GLib 2.32 */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+#define THEME_ASYNC
+#endif
+
+/* The terrain tiles rescaled to one width */
+typedef struct {
+	gint width;
+	GdkPixbuf *tiles[TERRAIN_TILE_MAX];	/* NULL for the board tile */
+} ScaledTiles;
+
 static TColor default_colors[] = {
 	TCOL_INIT(1.00, 0.85, 0.72),
 	TCOL_INIT(0.00, 0.00, 0.00),
@@ -164,8 +180,13 @@ static struct tvars {
 static GList *theme_list = NULL;
 static MapTheme *current_theme = NULL;
 static GList *callback_list = NULL;
+#ifdef THEME_ASYNC
+static GThreadPool *rescale_pool = NULL;
+#endif
 
 static gboolean theme_initialize(MapTheme * t);
+static void theme_build_mips(TScaleData * data);
+static void scaled_tiles_free(ScaledTiles * scaled, gpointer user_data);
 static void theme_cleanup(MapTheme * t);
 static void theme_scan_dir(const gchar * themes_path);
 static gint getvar(gchar ** p, const gchar * filename, gint lno);
@@ -235,12 +256,22 @@ void themes_init(void)
 void themes_cleanup(void)
 {
 	GList *list = theme_list;
+
+#ifdef THEME_ASYNC
+	/* Wait for the rescales that are running */
+	if (rescale_pool != NULL) {
+		g_thread_pool_free(rescale_pool, TRUE, TRUE);
+		rescale_pool = NULL;
+	}
+#endif
 	while (list) {
 		theme_cleanup(list->data);
 		list = g_list_next(list);
 	}
 	g_list_free(theme_list);
+	theme_list = NULL;
 	g_list_free(callback_list);
+	callback_list = NULL;
 }
 
 void theme_scan_dir(const gchar * themes_path)
@@ -279,16 +310,21 @@ void theme_scan_dir(const gchar * themes_path)
 
 }
 
-void theme_set_current(MapTheme * t)
+static void theme_notify(void)
 {
 	GList *list = callback_list;
-	current_theme = t;
 	while (list) {
 		G_CALLBACK(list->data) ();
 		list = g_list_next(list);
 	}
 }
 
+void theme_set_current(MapTheme * t)
+{
+	current_theme = t;
+	theme_notify();
+}
+
 MapTheme *theme_get_current(void)
 {
 	return current_theme;
@@ -333,6 +369,62 @@ gboolean theme_load_pixbuf(const gchar * file, const gchar * themename,
 	return TRUE;
 }
 
+/** Build the mip chain of a tile.
+ *  Each level is half the size of the previous one, the first level
+ *  is the native image.
+ */
+static void theme_build_mips(TScaleData * data)
+{
+	guint level;
+
+	data->mips[0] = g_object_ref(data->native_image);
+	for (level = 1; level < G_N_ELEMENTS(data->mips); level++) {
+		const GdkPixbuf *previous = data->mips[level - 1];
+		gint width = gdk_pixbuf_get_width(previous) / 2;
+		gint height = gdk_pixbuf_get_height(previous) / 2;
+
+		if (width < THEME_MIP_MIN_WIDTH || height <= 0)
+			break;
+		data->mips[level] =
+		    gdk_pixbuf_scale_simple(previous, width, height,
+					    GDK_INTERP_BILINEAR);
+	}
+}
+
+/** Scale a tile from the smallest mip level that is not smaller than
+ *  the requested size.
+ *  @return A new pixbuf
+ */
+static GdkPixbuf *scale_from_mip(const TScaleData * data, gint width,
+				 gint height, GdkInterpType interp)
+{
+	guint level = 0;
+
+	while (level + 1 < G_N_ELEMENTS(data->mips)
+	       && data->mips[level + 1] != NULL
+	       && gdk_pixbuf_get_width(data->mips[level + 1]) >= width
+	       && gdk_pixbuf_get_height(data->mips[level + 1]) >= height)
+		level++;
+	return gdk_pixbuf_scale_simple(data->mips[level], width, height,
+				       interp);
+}
+
+/** Scale a terrain tile, e.g. for an icon.
+ *  @param theme The theme
+ *  @param tile The tile
+ *  @param width The width
+ *  @param height The height
+ *  @return A new pixbuf, call g_object_unref() when done
+ */
+GdkPixbuf *theme_scale_tile(const MapTheme * theme, TERRAIN_TILES tile,
+			    gint width, gint height)
+{
+	g_return_val_if_fail(tile < TERRAIN_TILE_MAX, NULL);
+
+	return scale_from_mip(&theme->scaledata[tile], MAX(width, 1),
+			      MAX(height, 1), GDK_INTERP_BILINEAR);
+}
+
 /** Initialize the theme.
  *  @return TRUE if successful
  */
@@ -360,6 +452,7 @@ static gboolean theme_initialize(MapTheme * t)
 		t->scaledata[i].aspect = 1.0 *
 		    gdk_pixbuf_get_width(pixbuf) /
 		    gdk_pixbuf_get_height(pixbuf);
+		theme_build_mips(&t->scaledata[i]);
 	}
 
 	/* load port tiles */
@@ -395,9 +488,17 @@ static void theme_cleanup(MapTheme * t)
 
 	/* terrain tiles */
 	for (i = 0; i < G_N_ELEMENTS(t->terrain_tiles); ++i) {
+		guint level;
+
 		g_object_unref(t->terrain_tiles[i]);
 		g_object_unref(t->scaledata[i].native_image);
+		for (level = 0; level < THEME_MIP_LEVELS; level++)
+			if (t->scaledata[i].mips[level] != NULL)
+				g_object_unref(t->scaledata[i].mips
+					       [level]);
 	}
+	g_list_foreach(t->scaled_tiles, (GFunc) scaled_tiles_free, NULL);
+	g_list_free(t->scaled_tiles);
 	/* port tiles */
 	for (i = 0; i < G_N_ELEMENTS(t->port_tiles); ++i) {
 		if (t->port_tiles[i] != NULL) {
@@ -418,24 +519,139 @@ static void theme_cleanup(MapTheme * t)
 	g_free(t);
 }
 
-void theme_rescale(int new_width)
+static gint tile_height(const MapTheme * t, guint tile, gint width)
+{
+	gint height = width / t->scaledata[tile].aspect;
+
+	/* gdk_pixbuf_scale_simple cannot handle 0 height */
+	return MAX(height, 1);
+}
+
+static void scaled_tiles_free(ScaledTiles * scaled,
+			      G_GNUC_UNUSED gpointer user_data)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(scaled->tiles); ++i)
+		if (scaled->tiles[i] != NULL)
+			g_object_unref(scaled->tiles[i]);
+	g_free(scaled);
+}
+
+/** Find the tiles for a width, and mark them as the most recently used.
+ *  @return The tiles, or NULL if they are not in the cache
+ */
+static ScaledTiles *theme_cache_lookup(MapTheme * t, gint width)
+{
+	GList *list;
+
+	for (list = t->scaled_tiles; list != NULL; list = g_list_next(list)) {
+		ScaledTiles *scaled = list->data;
+		if (scaled->width == width) {
+			t->scaled_tiles =
+			    g_list_remove_link(t->scaled_tiles, list);
+			t->scaled_tiles =
+			    g_list_concat(list, t->scaled_tiles);
+			return scaled;
+		}
+	}
+	return NULL;
+}
+
+/** Add tiles to the cache, remove the least recently used tiles */
+static void theme_cache_insert(MapTheme * t, ScaledTiles * scaled)
+{
+	t->scaled_tiles = g_list_prepend(t->scaled_tiles, scaled);
+	while (g_list_length(t->scaled_tiles) > THEME_CACHE_SIZE) {
+		GList *last = g_list_last(t->scaled_tiles);
+		scaled_tiles_free(last->data, NULL);
+		t->scaled_tiles = g_list_delete_link(t->scaled_tiles, last);
+	}
+}
+
+/** Use the tiles for drawing. The board tile is never scaled. */
+static void theme_use_tiles(MapTheme * t, const ScaledTiles * scaled)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(t->terrain_tiles); ++i) {
+		if (i == BOARD_TILE)
+			continue;
+		g_object_ref(scaled->tiles[i]);
+		g_object_unref(t->terrain_tiles[i]);
+		t->terrain_tiles[i] = scaled->tiles[i];
+	}
+}
+
+#ifdef THEME_ASYNC
+typedef struct {
+	MapTheme *theme;
+	ScaledTiles *scaled;
+	gboolean skipped;	/* a newer size was requested */
+} RescaleJob;
+
+/* Runs in the main thread when the worker is done */
+static gboolean rescale_done(gpointer data)
+{
+	RescaleJob *job = data;
+	MapTheme *t = job->theme;
+
+	if (job->skipped || g_list_find(theme_list, t) == NULL) {
+		scaled_tiles_free(job->scaled, NULL);
+	} else {
+		theme_cache_insert(t, job->scaled);
+		if (t->current_width == job->scaled->width) {
+			theme_use_tiles(t, job->scaled);
+			if (t == current_theme)
+				theme_notify();
+		}
+	}
+	g_free(job);
+	return FALSE;
+}
+
+/* Runs in the worker thread. The native images are never changed. */
+static void rescale_worker(gpointer data, G_GNUC_UNUSED gpointer user_data)
 {
+	RescaleJob *job = data;
+	MapTheme *t = job->theme;
+	gint width = job->scaled->width;
 	guint i;
 
-	switch (current_theme->scaling) {
+	/* Skip the sizes that were passed while resizing */
+	job->skipped = g_atomic_int_get(&t->current_width) != width;
+	if (!job->skipped) {
+		for (i = 0; i < G_N_ELEMENTS(t->terrain_tiles); ++i) {
+			if (i == BOARD_TILE)
+				continue;
+			job->scaled->tiles[i] =
+			    gdk_pixbuf_scale_simple(t->scaledata[i].
+						    native_image, width,
+						    tile_height(t, i, width),
+						    GDK_INTERP_HYPER);
+		}
+	}
+	g_idle_add(rescale_done, job);
+}
+#endif
+
+/** The width of the tiles after applying the scaling mode.
+ *  @return The width, or 0 when the theme is never scaled
+ */
+static gint theme_scaled_width(const MapTheme * t, gint new_width)
+{
+	switch (t->scaling) {
 	case NEVER:
-		return;
+		return 0;
 
 	case ONLY_DOWNSCALE:
-		if (new_width > current_theme->scaledata[0].native_width)
-			new_width =
-			    current_theme->scaledata[0].native_width;
+		if (new_width > t->scaledata[0].native_width)
+			new_width = t->scaledata[0].native_width;
 		break;
 
 	case ONLY_UPSCALE:
-		if (new_width < current_theme->scaledata[0].native_width)
-			new_width =
-			    current_theme->scaledata[0].native_width;
+		if (new_width < t->scaledata[0].native_width)
+			new_width = t->scaledata[0].native_width;
 		break;
 
 	case ALWAYS:
@@ -443,32 +659,90 @@ void theme_rescale(int new_width)
 	}
 
 	/* if the size is 0, gdk_pixbuf_scale_simple fails */
-	if (new_width <= 0)
-		new_width = 1;
+	return MAX(new_width, 1);
+}
+
+/** Scale all terrain tiles of a theme, without changing the tiles
+ *  that are used for the main map. Only the images that are never
+ *  changed after loading are read, so this can be called from any thread.
+ *  @param theme The theme
+ *  @param new_width The width of the tiles
+ *  @param[in,out] tiles TERRAIN_TILE_MAX tiles, the old tiles are released
+ */
+void theme_scale_tiles(const MapTheme * theme, gint new_width,
+		       GdkPixbuf ** tiles)
+{
+	gint width = theme_scaled_width(theme, new_width);
+	guint i;
+
+	for (i = 0; i < TERRAIN_TILE_MAX; ++i) {
+		if (tiles[i] != NULL)
+			g_object_unref(tiles[i]);
+		if (i == BOARD_TILE || width == 0)
+			tiles[i] =
+			    g_object_ref(theme->scaledata[i].native_image);
+		else
+			tiles[i] =
+			    scale_from_mip(&theme->scaledata[i], width,
+					   tile_height(theme, i, width),
+					   GDK_INTERP_BILINEAR);
+	}
+}
+
+void theme_rescale(int new_width)
+{
+	guint i;
+	ScaledTiles *scaled;
+
+	new_width = theme_scaled_width(current_theme, new_width);
+	if (new_width == 0)
+		return;
 
 	/* no need to scale again */
 	if (new_width == current_theme->current_width) {
 		return;
 	}
-	current_theme->current_width = new_width;
+	g_atomic_int_set(&current_theme->current_width, new_width);
+
+	scaled = theme_cache_lookup(current_theme, new_width);
+	if (scaled != NULL) {
+		theme_use_tiles(current_theme, scaled);
+		return;
+	}
 
+	/* Scaling from the nearest mip level is fast */
+	scaled = g_malloc0(sizeof(*scaled));
+	scaled->width = new_width;
 	for (i = 0; i < G_N_ELEMENTS(current_theme->terrain_tiles); ++i) {
-		int new_height;
 		if (i == BOARD_TILE)
-			continue;	/* Don't scale the board-tile */
-		new_height =
-		    new_width / current_theme->scaledata[i].aspect;
-		/* gdk_pixbuf_scale_simple cannot handle 0 height */
-		if (new_height <= 0)
-			new_height = 1;
-		/* rescale the pixbuf */
-		g_object_unref(current_theme->terrain_tiles[i]);
-		current_theme->terrain_tiles[i] =
-		    gdk_pixbuf_scale_simple(current_theme->scaledata[i].
-					    native_image, new_width,
-					    new_height,
-					    GDK_INTERP_BILINEAR);
+			continue;
+		scaled->tiles[i] =
+		    scale_from_mip(&current_theme->scaledata[i], new_width,
+				   tile_height(current_theme, i, new_width),
+				   GDK_INTERP_BILINEAR);
+	}
+	theme_use_tiles(current_theme, scaled);
+
+#ifdef THEME_ASYNC
+	{
+		/* Show these tiles until the high quality version,
+		 * made by the worker from the native images, is ready */
+		RescaleJob *job;
+
+		scaled_tiles_free(scaled, NULL);
+		if (rescale_pool == NULL)
+			rescale_pool =
+			    g_thread_pool_new(rescale_worker, NULL, 1,
+					      FALSE, NULL);
+		job = g_malloc0(sizeof(*job));
+		job->theme = current_theme;
+		job->scaled = g_malloc0(sizeof(*job->scaled));
+		job->scaled->width = new_width;
+		g_thread_pool_push(rescale_pool, job, NULL);
 	}
+#else
+	theme_cache_insert(current_theme, scaled);
+#endif
 }
 
 #define ERR1(formatstring, argument) \
@@ -30,10 +30,14 @@ typedef struct {
 	GdkRGBA color;
 } TColor;
 
+/* Number of mip levels of a tile: the native image and its halvings */
+#define THEME_MIP_LEVELS 6
+
 typedef struct {
 	GdkPixbuf *native_image;
 	gint native_width;
 	gdouble aspect;
+	GdkPixbuf *mips[THEME_MIP_LEVELS];	/* NULL when too small */
 } TScaleData;
 
 typedef enum {
@@ -99,6 +103,7 @@ typedef struct _MapTheme {
 	TScaleData scaledata[TERRAIN_TILE_MAX];
 	TColor colors[TC_MAX];
 	TColor ovr_colors[TC_MAX_OVRTILE][TC_MAX_OVERRIDE];
+	GList *scaled_tiles;	/* recently used sizes, newest first */
 } MapTheme;
 
 void theme_rescale(int radius);
@@ -110,5 +115,9 @@ void theme_register_callback(GCallback callback);
 void themes_cleanup(void);
 
 GdkPixbuf *theme_get_terrain_pixbuf(Terrain terrain);
+GdkPixbuf *theme_scale_tile(const MapTheme * theme, TERRAIN_TILES tile,
+			    gint width, gint height);
+void theme_scale_tiles(const MapTheme * theme, gint new_width,
+		       GdkPixbuf ** tiles);
 
 #endif
@@ -0,0 +1,139 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that the asynchronous log keeps the order of the messages of a
+ * thread, and that it drops and counts the messages that do not fit in
+ * the ring while the writer is busy.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "driver.h"
+#include "log.h"
+
+/* Exit status that tells automake the test was skipped */
+#define EXIT_SKIP 77
+
+/* Messages sent while the writer is blocked */
+#define NUM_MESSAGES (3 * LOG_RING_SIZE)
+
+static GMutex mutex;
+static GCond cond;
+static gboolean writer_blocked;
+static gboolean writer_released;
+
+static gint next_expected;
+static gint received;
+static guint reported_dropped;
+static gboolean failed;
+
+/* Runs in the writer thread */
+static void test_log_write(gint msg_type, const gchar * text)
+{
+	gint num;
+	guint dropped;
+
+	if (msg_type == MSG_TIMESTAMP)
+		return;
+
+	if (msg_type == MSG_ERROR
+	    && sscanf(text, "%u log messages were dropped", &dropped) == 1) {
+		reported_dropped += dropped;
+		return;
+	}
+
+	if (sscanf(text, "message %d", &num) != 1) {
+		fprintf(stderr, "Unexpected message: %s", text);
+		failed = TRUE;
+		return;
+	}
+	if (num != next_expected) {
+		fprintf(stderr, "Expected message %d, got %d\n",
+			next_expected, num);
+		failed = TRUE;
+	}
+	next_expected = num + 1;
+	received++;
+
+	/* Hold the writer at the first message, so the ring fills up */
+	if (num == 0) {
+		g_mutex_lock(&mutex);
+		writer_blocked = TRUE;
+		g_cond_signal(&cond);
+		while (!writer_released)
+			g_cond_wait(&cond, &mutex);
+		g_mutex_unlock(&mutex);
+	}
+}
+
+static UIDriver test_driver = {
+	NULL,			/* event queue */
+	test_log_write,		/* log_write */
+	NULL,			/* player added */
+	NULL,			/* player renamed */
+	NULL,			/* player removed */
+	NULL			/* player change */
+};
+
+int main(G_GNUC_UNUSED int argc, G_GNUC_UNUSED char *argv[])
+{
+	gint idx;
+
+	set_ui_driver(&test_driver);
+	if (!log_start_async(LOG_FORMAT_TEXT)) {
+		fprintf(stderr, "The asynchronous log is not available\n");
+		return EXIT_SKIP;
+	}
+
+	log_message(MSG_INFO, "message %d\n", 0);
+	g_mutex_lock(&mutex);
+	while (!writer_blocked)
+		g_cond_wait(&cond, &mutex);
+	g_mutex_unlock(&mutex);
+
+	/* The first message still holds its slot in the ring */
+	for (idx = 1; idx < NUM_MESSAGES; idx++)
+		log_message(MSG_INFO, "message %d\n", idx);
+
+	g_mutex_lock(&mutex);
+	writer_released = TRUE;
+	g_cond_signal(&cond);
+	g_mutex_unlock(&mutex);
+
+	log_stop_async();
+
+	if (received != LOG_RING_SIZE) {
+		fprintf(stderr, "Received %d messages, expected %d\n",
+			received, LOG_RING_SIZE);
+		failed = TRUE;
+	}
+	if (log_get_dropped() != NUM_MESSAGES - LOG_RING_SIZE) {
+		fprintf(stderr, "Dropped %u messages, expected %d\n",
+			log_get_dropped(), NUM_MESSAGES - LOG_RING_SIZE);
+		failed = TRUE;
+	}
+	if (reported_dropped != log_get_dropped()) {
+		fprintf(stderr, "Reported %u dropped messages, counted %u\n",
+			reported_dropped, log_get_dropped());
+		failed = TRUE;
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
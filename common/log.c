@@ -30,6 +30,49 @@
 
 static gboolean debug_enabled = FALSE;
 
+/* The asynchronous log needs the thread API of GLib 2.32 */
+#if GLIB_CHECK_VERSION(2, 32, 0)
+#define LOG_ASYNC
+#endif
+
+/* Message type of debug() in the asynchronous log */
+#define LOG_TYPE_DEBUG 0
+
+#ifdef LOG_ASYNC
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+
+typedef struct {
+	gint64 time;		/* real time in microseconds */
+	gint msg_type;
+	gint player_num;
+	gchar game[16];
+	gchar *text;
+} LogRecord;
+
+/* A single producer, single consumer ring.
+ * The producing thread only writes head, the writer only writes tail. */
+typedef struct {
+	LogRecord records[LOG_RING_SIZE];
+	gint head;
+	gint tail;
+	guint dropped;		/* not yet reported */
+	const gchar *game;	/* context of the producing thread */
+	gint player_num;
+} LogRing;
+
+static gboolean async_enabled;
+static LogFormat async_format;
+static LogFunc async_sink;
+static GThread *async_writer;
+static gint async_running;
+static guint async_dropped_total;
+static GPrivate async_ring_key;
+static GMutex async_rings_mutex;
+static GSList *async_rings;	/* all rings, they are never freed */
+
+static void log_push(gint msg_type, gchar * text);
+#endif
+
 /* The default function to use to write messages, when nothing else has been
  * specified.
  */
@@ -204,6 +247,13 @@ void log_message_chat(const gchar * player_name,
 		      const gchar * joining_text, gint msg_type,
 		      const gchar * chat)
 {
+#ifdef LOG_ASYNC
+	if (async_enabled) {
+		log_message(msg_type, "%s%s%s\n", player_name,
+			    joining_text, chat);
+		return;
+	}
+#endif
 	if (driver->log_write && driver->log_write != LOG_FUNC_DEFAULT) {
 		log_message(MSG_INFO, "%s%s", player_name, joining_text);
 		debug("[%s] %s", debug_type(msg_type), chat);
@@ -231,6 +281,13 @@ void log_message(gint msg_type, const gchar * fmt, ...)
 
 	debug("[%s] %s", debug_type(msg_type), text);
 
+#ifdef LOG_ASYNC
+	if (async_enabled) {
+		log_push(msg_type, text);
+		return;
+	}
+#endif
+
 	t = time(NULL);
 	alpha = localtime(&t);
 
@@ -268,6 +325,13 @@ void debug(const gchar * fmt, ...)
 	buff = g_strdup_vprintf(fmt, ap);
 	va_end(ap);
 
+#ifdef LOG_ASYNC
+	if (async_enabled) {
+		log_push(LOG_TYPE_DEBUG, buff);
+		return;
+	}
+#endif
+
 	t = time(NULL);
 	alpha = localtime(&t);
 
@@ -296,3 +360,306 @@ void debug(const gchar * fmt, ...)
 	g_print("\n");
 	g_free(buff);
 }
+
+gboolean log_format_from_name(const gchar * name, LogFormat * format)
+{
+	if (!g_ascii_strcasecmp(name, "text"))
+		*format = LOG_FORMAT_TEXT;
+	else if (!g_ascii_strcasecmp(name, "json"))
+		*format = LOG_FORMAT_JSON;
+	else
+		return FALSE;
+	return TRUE;
+}
+
+#ifdef LOG_ASYNC
+static LogRing *log_ring_get(void)
+{
+	LogRing *ring = g_private_get(&async_ring_key);
+
+	if (ring == NULL) {
+		ring = g_malloc0(sizeof(*ring));
+		ring->player_num = -1;
+		g_private_set(&async_ring_key, ring);
+		g_mutex_lock(&async_rings_mutex);
+		async_rings = g_slist_prepend(async_rings, ring);
+		g_mutex_unlock(&async_rings_mutex);
+	}
+	return ring;
+}
+
+/* Queue a message, the text is owned by the log */
+static void log_push(gint msg_type, gchar * text)
+{
+	LogRing *ring = log_ring_get();
+	gint head = ring->head;
+	LogRecord *record;
+
+	if ((guint) (head - g_atomic_int_get(&ring->tail)) >= LOG_RING_SIZE) {
+		g_atomic_int_inc((gint *) & ring->dropped);
+		g_atomic_int_inc((gint *) & async_dropped_total);
+		g_free(text);
+		return;
+	}
+
+	record = &ring->records[head & LOG_RING_MASK];
+	record->time = g_get_real_time();
+	record->msg_type = msg_type;
+	record->player_num = ring->player_num;
+	if (ring->game != NULL)
+		g_strlcpy(record->game, ring->game, sizeof(record->game));
+	else
+		record->game[0] = '\0';
+	record->text = text;
+	/* Publish the record */
+	g_atomic_int_set(&ring->head, head + 1);
+}
+
+static void append_json_string(GString * str, const gchar * text)
+{
+	const gchar *c;
+
+	g_string_append_c(str, '"');
+	for (c = text; *c != '\0'; c++) {
+		switch (*c) {
+		case '"':
+			g_string_append(str, "\\\"");
+			break;
+		case '\\':
+			g_string_append(str, "\\\\");
+			break;
+		case '\n':
+			/* The trailing newline of a message is not part
+			 * of the message */
+			if (c[1] != '\0')
+				g_string_append(str, "\\n");
+			break;
+		case '\r':
+			g_string_append(str, "\\r");
+			break;
+		case '\t':
+			g_string_append(str, "\\t");
+			break;
+		default:
+			if ((guchar) * c < 0x20)
+				g_string_append_printf(str, "\\u%04x",
+						       (guint) (guchar) * c);
+			else
+				g_string_append_c(str, *c);
+		}
+	}
+	g_string_append_c(str, '"');
+}
+
+static void append_json_header(GString * str, gint64 time,
+			       const gchar * type)
+{
+	gchar buff[G_ASCII_DTOSTR_BUF_SIZE];
+
+	g_string_append(str, "{\"time\":");
+	g_string_append(str,
+			g_ascii_formatd(buff, sizeof(buff), "%.6f",
+					(gdouble) time / G_USEC_PER_SEC));
+	g_string_append(str, ",\"type\":\"");
+	g_string_append(str, type);
+	g_string_append_c(str, '"');
+}
+
+/* Escape the unprintable characters, like debug() does */
+static void append_debug_text(GString * str, const gchar * text)
+{
+	const gchar *c;
+
+	for (c = text; *c != '\0'; c++) {
+		if (isprint(*c))
+			g_string_append_c(str, *c);
+		else
+			switch (*c) {
+			case '\n':
+				g_string_append(str, "\\n");
+				break;
+			case '\r':
+				g_string_append(str, "\\r");
+				break;
+			case '\t':
+				g_string_append(str, "\\t");
+				break;
+			default:
+				g_string_append_printf(str, "\\x%02x",
+						       (*c & 0xff));
+				break;
+			}
+	}
+}
+
+static void log_write_record(GString * str, const LogRecord * record)
+{
+	const gchar *type = record->msg_type == LOG_TYPE_DEBUG ? "DEBUG"
+	    : debug_type(record->msg_type);
+
+	if (async_format == LOG_FORMAT_JSON) {
+		append_json_header(str, record->time, type);
+		if (record->game[0] != '\0') {
+			g_string_append(str, ",\"game\":");
+			append_json_string(str, record->game);
+		}
+		if (record->player_num >= 0)
+			g_string_append_printf(str, ",\"player\":%d",
+					       record->player_num);
+		g_string_append(str, ",\"text\":");
+		append_json_string(str, record->text);
+		g_string_append(str, "}\n");
+	} else {
+		GDateTime *date;
+		gchar *timestamp;
+
+		date =
+		    g_date_time_new_from_unix_local(record->time /
+						    G_USEC_PER_SEC);
+		timestamp = g_date_time_format(date, "%H:%M:%S ");
+		g_date_time_unref(date);
+		if (record->msg_type == LOG_TYPE_DEBUG) {
+			g_string_append(str, timestamp);
+			append_debug_text(str, record->text);
+			g_string_append_c(str, '\n');
+		} else {
+			async_sink(MSG_TIMESTAMP, timestamp);
+			async_sink(record->msg_type, record->text);
+		}
+		g_free(timestamp);
+	}
+}
+
+/* Write all queued records.
+ * @return TRUE if something was written */
+static gboolean log_drain(void)
+{
+	GString *str = g_string_new(NULL);
+	gboolean written = FALSE;
+	GSList *rings;
+	GSList *list;
+
+	g_mutex_lock(&async_rings_mutex);
+	rings = g_slist_copy(async_rings);
+	g_mutex_unlock(&async_rings_mutex);
+
+	for (list = rings; list != NULL; list = g_slist_next(list)) {
+		LogRing *ring = list->data;
+		gint tail = ring->tail;
+		gint head = g_atomic_int_get(&ring->head);
+		guint dropped;
+
+		while (tail != head) {
+			LogRecord *record =
+			    &ring->records[tail & LOG_RING_MASK];
+			log_write_record(str, record);
+			g_free(record->text);
+			record->text = NULL;
+			tail++;
+			written = TRUE;
+		}
+		/* Release the records */
+		g_atomic_int_set(&ring->tail, tail);
+
+		dropped = g_atomic_int_and(&ring->dropped, 0);
+		if (dropped > 0) {
+			if (async_format == LOG_FORMAT_JSON) {
+				append_json_header(str, g_get_real_time(),
+						   "DROPPED");
+				g_string_append_printf(str,
+						       ",\"count\":%u}\n",
+						       dropped);
+			} else {
+				gchar *text =
+				    g_strdup_printf
+				    ("%u log messages were dropped\n",
+				     dropped);
+				async_sink(MSG_ERROR, text);
+				g_free(text);
+			}
+			written = TRUE;
+		}
+	}
+	g_slist_free(rings);
+
+	if (str->len > 0) {
+		fwrite(str->str, 1, str->len,
+		       async_format == LOG_FORMAT_JSON ? stderr : stdout);
+		fflush(async_format == LOG_FORMAT_JSON ? stderr : stdout);
+	}
+	g_string_free(str, TRUE);
+	return written;
+}
+
+static gpointer log_writer(G_GNUC_UNUSED gpointer data)
+{
+	gulong idle = 1000;
+
+	while (g_atomic_int_get(&async_running)) {
+		if (log_drain()) {
+			idle = 1000;
+		} else {
+			/* Back off up to 50 ms when there is nothing to do */
+			g_usleep(idle);
+			idle = MIN(idle * 2, 50000);
+		}
+	}
+	log_drain();
+	return NULL;
+}
+#endif
+
+gboolean log_start_async(LogFormat format)
+{
+#ifdef LOG_ASYNC
+	if (async_enabled)
+		return TRUE;
+	async_format = format;
+	async_sink = driver->log_write ? driver->log_write :
+	    LOG_FUNC_DEFAULT;
+	g_atomic_int_set(&async_running, TRUE);
+	async_writer = g_thread_new("log-writer", log_writer, NULL);
+	async_enabled = TRUE;
+	return TRUE;
+#else
+	(void) format;
+	return FALSE;
+#endif
+}
+
+void log_stop_async(void)
+{
+#ifdef LOG_ASYNC
+	if (!async_enabled)
+		return;
+	async_enabled = FALSE;
+	g_atomic_int_set(&async_running, FALSE);
+	g_thread_join(async_writer);
+	async_writer = NULL;
+#endif
+}
+
+guint log_get_dropped(void)
+{
+#ifdef LOG_ASYNC
+	return (guint) g_atomic_int_get((gint *) & async_dropped_total);
+#else
+	return 0;
+#endif
+}
+
+void log_set_context(const gchar * game, gint player_num)
+{
+#ifdef LOG_ASYNC
+	LogRing *ring;
+
+	if (!async_enabled)
+		return;
+	ring = log_ring_get();
+	ring->game = game;
+	ring->player_num = player_num;
+#else
+	(void) game;
+	(void) player_num;
+#endif
+}
@@ -80,4 +80,44 @@ void log_message_chat(const gchar * player_name,
 void set_enable_debug(gboolean enabled);
 void debug(const gchar * fmt, ...);
 
+/** Number of messages a thread can queue in the asynchronous log,
+ *  a power of two */
+#define LOG_RING_SIZE 1024
+
+/** Output formats of the asynchronous log */
+typedef enum {
+	LOG_FORMAT_TEXT,	/**< Through the logging function */
+	LOG_FORMAT_JSON		/**< One JSON object per line on stderr */
+} LogFormat;
+
+/** Parse the name of a log format.
+ * @param name text or json
+ * @retval format The format
+ * @return TRUE if the name is known
+ */
+gboolean log_format_from_name(const gchar * name, LogFormat * format);
+
+/** Write the log from a background thread.
+ * Messages are queued in a ring buffer of the calling thread, when the
+ * ring is full messages are dropped and counted instead of blocking.
+ * In the text format the logging function that is set at this moment
+ * is called from the background thread, so it must be thread safe.
+ * @param format The output format
+ * @return FALSE if threads are not available, the log stays synchronous
+ */
+gboolean log_start_async(LogFormat format);
+
+/** Write all queued messages and return to synchronous logging */
+void log_stop_async(void);
+
+/** The number of messages that were dropped by the asynchronous log */
+guint log_get_dropped(void);
+
+/** Set the fields that are added to the messages of this thread
+ *  in the JSON format.
+ * @param game The identifier of the game, or NULL
+ * @param player_num The player number, or -1
+ */
+void log_set_context(const gchar * game, gint player_num);
+
 #endif				/* __log_h */
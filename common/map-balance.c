@@ -0,0 +1,552 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+
+#include "random.h"
+#include "map-balance.h"
+
+/* The candidates are not built as maps. The map is reduced once to
+ * arrays of land hexes, nodes, neighbours and ports, and a candidate
+ * only holds the terrain, the port types and the rolls. */
+
+#define NO_SLOT -1
+
+/* The weights of the parts of the score */
+#define WEIGHT_NODE 1.0		/* standard deviation of the node pips */
+#define WEIGHT_HOT_PAIR 4.0	/* neighbours that both have a 6 or 8 */
+#define WEIGHT_SAME_ROLL 2.0	/* neighbours with the same number */
+#define WEIGHT_RESOURCE 0.5	/* pips a resource has too many or few */
+#define WEIGHT_CLUSTER 1.0	/* neighbours with the same terrain */
+#define WEIGHT_PORT 0.25	/* own resource pips next to 2:1 ports */
+
+/* Use more threads only for at least this many candidates each */
+#define MIN_CANDIDATES_PER_WORKER 500
+#define MAX_WORKERS 8
+
+#if GLIB_CHECK_VERSION(2, 36, 0)
+#define BALANCE_THREADS
+#endif
+
+/* The land slots next to a node, next to an edge and next to a port */
+typedef gint NodeSlots[3];
+typedef gint PairSlots[2];
+typedef gint PortSlots[4];
+
+/* The value of a roll, the same weights as dice_prob() of the
+ * computer player */
+static const gint pips[13] = { 0, 0, 3, 6, 8, 11, 14, 0, 14, 11, 8, 6, 3 };
+
+typedef struct {
+	/* Land hexes, indexed by slot */
+	guint num_land;
+	Hex **land;
+	Terrain *terrain;	/* the terrain on the map */
+	gint *roll;		/* the rolls of hexes without chit_pos */
+	guint num_shuffle_land;
+	guint *shuffle_land;	/* the slots that are shuffled */
+
+	/* Ports */
+	guint num_ports;
+	Hex **ports;
+	Resource *port_resource;	/* the ports on the map */
+	PortSlots *port_land;	/* the land slots next to the port */
+	guint num_shuffle_ports;
+	guint *shuffle_ports;	/* the ports that are shuffled */
+
+	/* Nodes next to land, with the slots of their land hexes */
+	guint num_nodes;
+	NodeSlots *nodes;
+
+	/* Neighbouring land slots */
+	guint num_pairs;
+	PairSlots *pairs;
+
+	/* The chit layout sequence, a land slot or NO_SLOT for sea */
+	guint num_sequence;
+	gint *sequence;
+	guint num_chits;
+	const gint *chits;
+} BalanceTemplate;
+
+typedef struct {
+	Terrain *terrain;	/* for each land slot */
+	gint *roll;		/* for each land slot */
+	Resource *port;		/* for each port */
+	gdouble score;
+} Candidate;
+
+typedef struct {
+	const BalanceTemplate *template;
+	guint count;
+	guint32 seed;
+	Candidate best;
+} BalanceWorker;
+
+static void template_free(BalanceTemplate * t)
+{
+	g_free(t->land);
+	g_free(t->terrain);
+	g_free(t->roll);
+	g_free(t->shuffle_land);
+	g_free(t->ports);
+	g_free(t->port_resource);
+	g_free(t->port_land);
+	g_free(t->shuffle_ports);
+	g_free(t->nodes);
+	g_free(t->pairs);
+	g_free(t->sequence);
+}
+
+static gint land_slot(gint slots[MAP_SIZE][MAP_SIZE], const Hex * hex)
+{
+	if (hex == NULL)
+		return NO_SLOT;
+	return slots[hex->y][hex->x];
+}
+
+/* Add a slot to a list of slots without duplicates */
+static void add_slot(gint * list, guint size, gint slot)
+{
+	guint idx;
+
+	if (slot == NO_SLOT)
+		return;
+	for (idx = 0; idx < size; idx++) {
+		if (list[idx] == slot)
+			return;
+		if (list[idx] == NO_SLOT) {
+			list[idx] = slot;
+			return;
+		}
+	}
+}
+
+/** Reduce the map to the arrays that are needed to score a layout.
+ * @return FALSE if the chits cannot be laid out
+ */
+static gboolean template_build(BalanceTemplate * t, const Map * map)
+{
+	gint slots[MAP_SIZE][MAP_SIZE];
+	GArray *nodes;
+	GArray *pairs;
+	gint x, y;
+	guint idx;
+	guint num_deserts;
+
+	memset(t, 0, sizeof(*t));
+	if (map->chits == NULL || map->chits->len == 0)
+		return FALSE;
+	t->chits = (const gint *) map->chits->data;
+	t->num_chits = map->chits->len;
+
+	/* Number the hexes */
+	for (y = 0; y < MAP_SIZE; y++)
+		for (x = 0; x < MAP_SIZE; x++)
+			slots[y][x] = NO_SLOT;
+	for (y = 0; y < map->y_size; y++)
+		for (x = 0; x < map->x_size; x++) {
+			const Hex *hex = map->grid[y][x];
+			if (hex == NULL)
+				continue;
+			if (hex->terrain != SEA_TERRAIN)
+				slots[y][x] = (gint) t->num_land++;
+			else if (hex->resource != NO_RESOURCE)
+				t->num_ports++;
+			if (hex->chit_pos >= (gint) t->num_sequence)
+				t->num_sequence = (guint) hex->chit_pos + 1;
+		}
+
+	t->land = g_new(Hex *, t->num_land);
+	t->terrain = g_new(Terrain, t->num_land);
+	t->roll = g_new(gint, t->num_land);
+	t->shuffle_land = g_new(guint, t->num_land);
+	t->ports = g_new(Hex *, t->num_ports);
+	t->port_resource = g_new(Resource, t->num_ports);
+	t->port_land = g_new(PortSlots, t->num_ports);
+	t->shuffle_ports = g_new(guint, t->num_ports);
+	t->sequence = g_new(gint, t->num_sequence);
+	for (idx = 0; idx < t->num_sequence; idx++)
+		t->sequence[idx] = G_MININT;
+
+	nodes = g_array_new(FALSE, FALSE, sizeof(NodeSlots));
+	pairs = g_array_new(FALSE, FALSE, sizeof(PairSlots));
+	num_deserts = 0;
+	t->num_ports = 0;
+	for (y = 0; y < map->y_size; y++)
+		for (x = 0; x < map->x_size; x++) {
+			Hex *hex = map->grid[y][x];
+			gint slot;
+
+			if (hex == NULL)
+				continue;
+			slot = slots[y][x];
+			if (hex->chit_pos >= 0) {
+				if (t->sequence[hex->chit_pos] != G_MININT)
+					goto error;
+				t->sequence[hex->chit_pos] = slot;
+			}
+			if (slot != NO_SLOT) {
+				t->land[slot] = hex;
+				t->terrain[slot] = hex->terrain;
+				t->roll[slot] = hex->roll;
+				if (hex->shuffle)
+					t->shuffle_land
+					    [t->num_shuffle_land++] =
+					    (guint) slot;
+				if (hex->terrain == DESERT_TERRAIN)
+					num_deserts++;
+			} else if (hex->resource != NO_RESOURCE) {
+				gint *port_land = t->port_land[t->num_ports];
+				const Node *node;
+
+				for (idx = 0; idx < 4; idx++)
+					port_land[idx] = NO_SLOT;
+				node = hex->nodes[hex->facing];
+				for (idx = 0; node != NULL && idx < 3; idx++)
+					add_slot(port_land, 4,
+						 land_slot(slots,
+							   node->hexes[idx]));
+				node = hex->nodes[(hex->facing + 5) % 6];
+				for (idx = 0; node != NULL && idx < 3; idx++)
+					add_slot(port_land, 4,
+						 land_slot(slots,
+							   node->hexes[idx]));
+				t->ports[t->num_ports] = hex;
+				t->port_resource[t->num_ports] =
+				    hex->resource;
+				if (hex->shuffle)
+					t->shuffle_ports
+					    [t->num_shuffle_ports++] =
+					    t->num_ports;
+				t->num_ports++;
+			}
+
+			/* The nodes and edges that this hex owns */
+			for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++) {
+				const Node *node = hex->nodes[idx];
+				NodeSlots node_slots;
+				guint i;
+
+				if (node == NULL || node->x != x
+				    || node->y != y)
+					continue;
+				for (i = 0; i < 3; i++)
+					node_slots[i] =
+					    land_slot(slots,
+						      node->hexes[i]);
+				if (node_slots[0] != NO_SLOT
+				    || node_slots[1] != NO_SLOT
+				    || node_slots[2] != NO_SLOT)
+					g_array_append_val(nodes,
+							   node_slots);
+			}
+			for (idx = 0; idx < G_N_ELEMENTS(hex->edges); idx++) {
+				const Edge *edge = hex->edges[idx];
+				PairSlots pair;
+
+				if (edge == NULL || edge->x != x
+				    || edge->y != y)
+					continue;
+				pair[0] = land_slot(slots, edge->hexes[0]);
+				pair[1] = land_slot(slots, edge->hexes[1]);
+				if (pair[0] != NO_SLOT && pair[1] != NO_SLOT)
+					g_array_append_val(pairs, pair);
+			}
+		}
+
+	/* The same checks as in the layout of the chits */
+	if (t->num_sequence < t->num_chits + num_deserts)
+		goto error;
+
+	t->num_nodes = nodes->len;
+	t->nodes = (NodeSlots *) g_array_free(nodes, FALSE);
+	t->num_pairs = pairs->len;
+	t->pairs = (PairSlots *) g_array_free(pairs, FALSE);
+	return TRUE;
+
+      error:
+	g_array_free(nodes, TRUE);
+	g_array_free(pairs, TRUE);
+	template_free(t);
+	return FALSE;
+}
+
+static void candidate_copy(Candidate * to, const Candidate * from,
+			   const BalanceTemplate * t)
+{
+	memcpy(to->terrain, from->terrain, t->num_land * sizeof(Terrain));
+	memcpy(to->roll, from->roll, t->num_land * sizeof(gint));
+	memcpy(to->port, from->port, t->num_ports * sizeof(Resource));
+	to->score = from->score;
+}
+
+/* Start with the layout of the map */
+static void candidate_init(Candidate * c, const BalanceTemplate * t)
+{
+	c->terrain = g_new(Terrain, t->num_land);
+	c->roll = g_new(gint, t->num_land);
+	c->port = g_new(Resource, t->num_ports);
+	memcpy(c->terrain, t->terrain, t->num_land * sizeof(Terrain));
+	memcpy(c->roll, t->roll, t->num_land * sizeof(gint));
+	memcpy(c->port, t->port_resource, t->num_ports * sizeof(Resource));
+	c->score = G_MAXDOUBLE;
+}
+
+static void candidate_free(Candidate * c)
+{
+	g_free(c->terrain);
+	g_free(c->roll);
+	g_free(c->port);
+}
+
+/* Shuffle the shuffled slots of the previous candidate again */
+static void candidate_shuffle(Candidate * c, const BalanceTemplate * t,
+			      GRand * rand)
+{
+	guint idx;
+
+	for (idx = t->num_shuffle_land; idx > 1; idx--) {
+		guint a = t->shuffle_land[idx - 1];
+		guint b = t->shuffle_land[g_rand_int_range(rand, 0,
+							   (gint32) idx)];
+		Terrain terrain = c->terrain[a];
+		c->terrain[a] = c->terrain[b];
+		c->terrain[b] = terrain;
+	}
+	for (idx = t->num_shuffle_ports; idx > 1; idx--) {
+		guint a = t->shuffle_ports[idx - 1];
+		guint b = t->shuffle_ports[g_rand_int_range(rand, 0,
+							    (gint32) idx)];
+		Resource resource = c->port[a];
+		c->port[a] = c->port[b];
+		c->port[b] = resource;
+	}
+
+	/* Lay out the chits like map_layout_chits */
+	{
+		guint chit_idx = 0;
+
+		for (idx = 0; idx < t->num_sequence; idx++) {
+			gint slot = t->sequence[idx];
+
+			if (slot == G_MININT)
+				continue;
+			if (slot != NO_SLOT
+			    && c->terrain[slot] == DESERT_TERRAIN) {
+				c->roll[slot] = 0;
+				continue;
+			}
+			if (slot != NO_SLOT)
+				c->roll[slot] = t->chits[chit_idx];
+			if (++chit_idx == t->num_chits)
+				chit_idx = 0;
+		}
+	}
+}
+
+static gdouble candidate_score(const Candidate * c,
+			       const BalanceTemplate * t)
+{
+	gint production[MAP_SIZE * MAP_SIZE];
+	gint resource_hexes[NO_RESOURCE];
+	gint resource_pips[NO_RESOURCE];
+	gint total_hexes;
+	gint total_pips;
+	gdouble sum, sum_squares;
+	gdouble node_score, resource_score, port_score;
+	guint hot_pairs, same_rolls, clusters;
+	guint idx;
+
+	memset(resource_hexes, 0, sizeof(resource_hexes));
+	memset(resource_pips, 0, sizeof(resource_pips));
+	total_hexes = total_pips = 0;
+	for (idx = 0; idx < t->num_land; idx++) {
+		Resource resource = terrain_to_resource(c->terrain[idx]);
+		gint roll = c->roll[idx];
+
+		production[idx] = 0;
+		if (resource == NO_RESOURCE || roll < 2 || roll > 12)
+			continue;
+		production[idx] = pips[roll];
+		if (resource < NO_RESOURCE) {
+			resource_hexes[resource]++;
+			resource_pips[resource] += pips[roll];
+			total_hexes++;
+			total_pips += pips[roll];
+		}
+	}
+
+	/* The production of the nodes should be even */
+	sum = sum_squares = 0.0;
+	for (idx = 0; idx < t->num_nodes; idx++) {
+		gint node_pips = 0;
+		guint i;
+
+		for (i = 0; i < 3; i++)
+			if (t->nodes[idx][i] != NO_SLOT)
+				node_pips += production[t->nodes[idx][i]];
+		sum += node_pips;
+		sum_squares += node_pips * node_pips;
+	}
+	node_score = 0.0;
+	if (t->num_nodes > 0) {
+		gdouble mean = sum / t->num_nodes;
+		gdouble variance = sum_squares / t->num_nodes - mean * mean;
+		node_score = sqrt(MAX(variance, 0.0));
+	}
+
+	hot_pairs = same_rolls = clusters = 0;
+	for (idx = 0; idx < t->num_pairs; idx++) {
+		gint a = t->pairs[idx][0];
+		gint b = t->pairs[idx][1];
+
+		if (production[a] == pips[6] && production[b] == pips[6])
+			hot_pairs++;
+		else if (production[a] != 0 && c->roll[a] == c->roll[b])
+			same_rolls++;
+		if (c->terrain[a] == c->terrain[b]
+		    && c->terrain[a] != DESERT_TERRAIN)
+			clusters++;
+	}
+
+	/* Each resource should get its share of the production */
+	resource_score = 0.0;
+	if (total_hexes > 0)
+		for (idx = 0; idx < NO_RESOURCE; idx++) {
+			gdouble expected = (gdouble) total_pips *
+			    resource_hexes[idx] / total_hexes;
+			resource_score += fabs(resource_pips[idx] - expected);
+		}
+
+	/* A 2:1 port next to its own resource is too strong */
+	port_score = 0.0;
+	for (idx = 0; idx < t->num_ports; idx++) {
+		guint i;
+
+		if (c->port[idx] >= NO_RESOURCE)
+			continue;
+		for (i = 0; i < 4 && t->port_land[idx][i] != NO_SLOT; i++) {
+			gint slot = t->port_land[idx][i];
+			if (terrain_to_resource(c->terrain[slot]) ==
+			    c->port[idx])
+				port_score += production[slot];
+		}
+	}
+
+	return WEIGHT_NODE * node_score
+	    + WEIGHT_HOT_PAIR * hot_pairs
+	    + WEIGHT_SAME_ROLL * same_rolls
+	    + WEIGHT_RESOURCE * resource_score
+	    + WEIGHT_CLUSTER * clusters + WEIGHT_PORT * port_score;
+}
+
+static gpointer balance_worker(gpointer data)
+{
+	BalanceWorker *worker = data;
+	const BalanceTemplate *t = worker->template;
+	Candidate candidate;
+	GRand *rand;
+	guint idx;
+
+	rand = g_rand_new_with_seed(worker->seed);
+	candidate_init(&candidate, t);
+	candidate_init(&worker->best, t);
+	for (idx = 0; idx < worker->count; idx++) {
+		candidate_shuffle(&candidate, t, rand);
+		candidate.score = candidate_score(&candidate, t);
+		if (candidate.score < worker->best.score)
+			candidate_copy(&worker->best, &candidate, t);
+	}
+	candidate_free(&candidate);
+	g_rand_free(rand);
+	return worker;
+}
+
+void map_shuffle_balanced(Map * map, guint candidates)
+{
+	BalanceTemplate t;
+	BalanceWorker workers[MAX_WORKERS];
+	const Candidate *best;
+	guint num_workers;
+	guint idx;
+
+	g_return_if_fail(map != NULL);
+
+	if (!template_build(&t, map)) {
+		/* Let the plain shuffle report the problem */
+		map_shuffle_terrain(map);
+		return;
+	}
+
+	candidates = MAX(candidates, 1);
+	num_workers = 1;
+#ifdef BALANCE_THREADS
+	num_workers = MIN(g_get_num_processors(), MAX_WORKERS);
+	num_workers = MIN(num_workers,
+			  candidates / MIN_CANDIDATES_PER_WORKER);
+	num_workers = MAX(num_workers, 1);
+#endif
+
+	/* The seeds come from the game's random numbers, so a game can
+	 * still be reproduced from its seed */
+	for (idx = 0; idx < num_workers; idx++) {
+		workers[idx].template = &t;
+		workers[idx].count = candidates / num_workers
+		    + (idx < candidates % num_workers ? 1 : 0);
+		workers[idx].seed = random_guint(G_MAXINT);
+	}
+#ifdef BALANCE_THREADS
+	{
+		GThread *threads[MAX_WORKERS];
+
+		for (idx = 1; idx < num_workers; idx++)
+			threads[idx] =
+			    g_thread_new("map-balance", balance_worker,
+					 &workers[idx]);
+		balance_worker(&workers[0]);
+		for (idx = 1; idx < num_workers; idx++)
+			g_thread_join(threads[idx]);
+	}
+#else
+	balance_worker(&workers[0]);
+#endif
+
+	best = &workers[0].best;
+	for (idx = 1; idx < num_workers; idx++)
+		if (workers[idx].best.score < best->score)
+			best = &workers[idx].best;
+
+	/* Remove the robber, it is placed again on the desert */
+	if (map->robber_hex) {
+		map->robber_hex->robber = FALSE;
+		map->robber_hex = NULL;
+	}
+	for (idx = 0; idx < t.num_land; idx++)
+		t.land[idx]->terrain = best->terrain[idx];
+	for (idx = 0; idx < t.num_ports; idx++)
+		t.ports[idx]->resource = best->port[idx];
+	map_layout_chits(map);
+
+	for (idx = 0; idx < num_workers; idx++)
+		candidate_free(&workers[idx].best);
+	template_free(&t);
+}
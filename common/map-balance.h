@@ -0,0 +1,44 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Balanced random maps.
+ * Many shuffles of the map are generated and scored for fairness, and
+ * the fairest one is used. A shuffle is less fair when the production
+ * of the nodes differs a lot, when a resource gets much more or less
+ * production than its number of hexes suggests, when good numbers or
+ * equal terrain are next to each other, and when a 2:1 port is next to
+ * the production of its own resource.
+ */
+
+#ifndef __map_balance_h
+#define __map_balance_h
+
+#include "map.h"
+
+/* The default number of shuffles to choose from */
+#define MAP_BALANCE_CANDIDATES 5000
+
+/** Shuffle the terrain and the ports like map_shuffle_terrain, but
+ * choose the fairest of a number of shuffles.
+ * The shuffles are scored in parallel when possible.
+ * @param map The map
+ * @param candidates The number of shuffles to generate
+ */
+void map_shuffle_balanced(Map * map, guint candidates);
+
+#endif
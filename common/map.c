@@ -552,7 +552,7 @@ static gboolean connect_network(Hex * hex, G_GNUC_UNUSED gpointer closure)
  * the new position of the desert.
  * Returns TRUE if the chits could be distributed without errors
  */
-static gboolean layout_chits(Map * map)
+gboolean map_layout_chits(Map * map)
 {
 	Hex **hexes;
 	guint num_chits;
@@ -651,7 +651,7 @@ void map_shuffle_terrain(Map * map)
 	gint num_port;
 
 	/* Remove robber, because the desert will probably move.
-	 * It will be restored by layout_chits.
+	 * It will be restored by map_layout_chits.
 	 */
 	if (map->robber_hex) {
 		map->robber_hex->robber = FALSE;
@@ -722,7 +722,7 @@ void map_shuffle_terrain(Map * map)
 
 	/* Fix the chits - the desert probably moved
 	 */
-	layout_chits(map);
+	map_layout_chits(map);
 }
 
 Hex *map_robber_hex(Map * map)
@@ -1121,7 +1121,7 @@ gboolean map_parse_finish(Map * map)
 	gint y;
 	gboolean success;
 
-	success = layout_chits(map);
+	success = map_layout_chits(map);
 
 	map_traverse(map, build_network, NULL);
 	map_traverse(map, connect_network, NULL);
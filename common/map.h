@@ -195,6 +195,11 @@ typedef gboolean(*ConstHexFunc) (const Hex * hex, gpointer closure);
 gboolean map_traverse_const(const Map * map, ConstHexFunc func,
 			    gpointer closure);
 void map_shuffle_terrain(Map * map);
+/** Lay out the chits in the sequence of the map, skipping the deserts.
+ * The robber is placed on the first desert when it has no place yet.
+ * @return TRUE if the chits could be distributed without errors
+ */
+gboolean map_layout_chits(Map * map);
 Hex *map_robber_hex(Map * map);
 Hex *map_pirate_hex(Map * map);
 void map_move_robber(Map * map, gint x, gint y);
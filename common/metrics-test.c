@@ -0,0 +1,109 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that each exported bucket of a histogram counts the values that
+ * are at most its 'le' bound, also for the values at the bound.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "metrics.h"
+
+/* All values up to 1 << SMALL_BITS, then the values around the powers of
+ * two up to 1 << LARGE_BITS */
+#define SMALL_BITS 12
+#define LARGE_BITS 34
+#define NUM_VALUES ((1 << SMALL_BITS) + 1 + 3 * (LARGE_BITS - SMALL_BITS))
+
+static guint64 values[NUM_VALUES];
+
+static guint64 count_up_to(guint64 bound)
+{
+	guint64 count = 0;
+	guint idx;
+
+	for (idx = 0; idx < NUM_VALUES; idx++)
+		if (values[idx] <= bound)
+			count++;
+	return count;
+}
+
+int main(G_GNUC_UNUSED int argc, G_GNUC_UNUSED char *argv[])
+{
+	MetricsHistogram histogram;
+	GString *str;
+	gchar **lines;
+	guint idx;
+	guint num = 0;
+	guint buckets = 0;
+	gboolean failed = FALSE;
+
+	for (idx = 0; idx <= 1 << SMALL_BITS; idx++)
+		values[num++] = idx;
+	for (idx = SMALL_BITS + 1; idx <= LARGE_BITS; idx++) {
+		guint64 power = G_GUINT64_CONSTANT(1) << idx;
+		values[num++] = power - 1;
+		values[num++] = power;
+		values[num++] = power + 1;
+	}
+	g_assert(num == NUM_VALUES);
+
+	metrics_set_enabled(TRUE);
+	metrics_histogram_reset(&histogram);
+	for (idx = 0; idx < NUM_VALUES; idx++)
+		metrics_histogram_record(&histogram, (gint64) values[idx]);
+
+	str = g_string_new(NULL);
+	metrics_append_histogram(str, "test", NULL, NULL, &histogram);
+	lines = g_strsplit(str->str, "\n", -1);
+	for (idx = 0; lines[idx] != NULL; idx++) {
+		gdouble seconds;
+		guint64 count;
+		guint64 bound;
+
+		if (sscanf(lines[idx], "test_bucket{le=\"+Inf\"} %"
+			   G_GUINT64_FORMAT, &count) == 1) {
+			if (count != NUM_VALUES) {
+				fprintf(stderr, "%s: expected %d\n",
+					lines[idx], NUM_VALUES);
+				failed = TRUE;
+			}
+			continue;
+		}
+		if (sscanf(lines[idx], "test_bucket{le=\"%lf\"} %"
+			   G_GUINT64_FORMAT, &seconds, &count) != 2)
+			continue;
+		buckets++;
+		bound = (guint64) (seconds * G_USEC_PER_SEC + 0.5);
+		if (count != count_up_to(bound)) {
+			fprintf(stderr, "%s: expected %" G_GUINT64_FORMAT
+				"\n", lines[idx], count_up_to(bound));
+			failed = TRUE;
+		}
+	}
+	if (buckets == 0) {
+		fprintf(stderr, "No buckets were exported:\n%s", str->str);
+		failed = TRUE;
+	}
+	g_strfreev(lines);
+	g_string_free(str, TRUE);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
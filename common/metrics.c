@@ -0,0 +1,362 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include <string.h>
+
+#include "metrics.h"
+
+#define METRICS_SUB_MASK ((1 << METRICS_SUB_BITS) - 1)
+
+/* Only bucket boundaries in this range (in bits of microseconds)
+ * are exported, the other buckets are merged into their neighbours */
+#define METRICS_EXPORT_MIN_BITS 4
+#define METRICS_EXPORT_MAX_BITS 32
+
+typedef enum {
+	METRIC_COUNTER,
+	METRIC_GAUGE,
+	METRIC_HISTOGRAM
+} MetricType;
+
+struct _MetricsCounter {
+	guint64 value;
+};
+
+typedef struct {
+	const gchar *name;
+	const gchar *help;
+	MetricType type;
+	MetricsCounter counter;	/* counters and gauges */
+	const gchar *label_name;	/* histograms */
+	GHashTable *histograms;	/* label value -> MetricsHistogram */
+} MetricFamily;
+
+static gboolean enabled;
+static GHashTable *families;	/* name -> MetricFamily */
+static GList *family_order;	/* in order of registration */
+
+void metrics_set_enabled(gboolean enable)
+{
+	enabled = enable;
+}
+
+gboolean metrics_enabled(void)
+{
+	return enabled;
+}
+
+static MetricFamily *family_get(const gchar * name, const gchar * help,
+				MetricType type)
+{
+	MetricFamily *family;
+
+	if (families == NULL)
+		families = g_hash_table_new(g_str_hash, g_str_equal);
+
+	family = g_hash_table_lookup(families, name);
+	if (family != NULL) {
+		g_return_val_if_fail(family->type == type, family);
+		return family;
+	}
+
+	family = g_malloc0(sizeof(*family));
+	family->name = name;
+	family->help = help;
+	family->type = type;
+	g_hash_table_insert(families, (gpointer) name, family);
+	family_order = g_list_append(family_order, family);
+	return family;
+}
+
+MetricsCounter *metrics_counter(const gchar * name, const gchar * help)
+{
+	return &family_get(name, help, METRIC_COUNTER)->counter;
+}
+
+MetricsCounter *metrics_gauge(const gchar * name, const gchar * help)
+{
+	return &family_get(name, help, METRIC_GAUGE)->counter;
+}
+
+void metrics_counter_add(MetricsCounter * counter, guint64 value)
+{
+	if (enabled)
+		counter->value += value;
+}
+
+void metrics_counter_set(MetricsCounter * counter, guint64 value)
+{
+	if (enabled)
+		counter->value = value;
+}
+
+void metrics_counter_max(MetricsCounter * counter, guint64 value)
+{
+	if (enabled && counter->value < value)
+		counter->value = value;
+}
+
+MetricsHistogram *metrics_histogram(const gchar * name,
+				    const gchar * help,
+				    const gchar * label_name,
+				    const gchar * label_value)
+{
+	MetricFamily *family = family_get(name, help, METRIC_HISTOGRAM);
+	MetricsHistogram *histogram;
+
+	if (family->histograms == NULL) {
+		family->label_name = label_name;
+		family->histograms =
+		    g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+					  g_free);
+	}
+	if (label_value == NULL)
+		label_value = "";
+
+	histogram = g_hash_table_lookup(family->histograms, label_value);
+	if (histogram == NULL) {
+		histogram = g_malloc0(sizeof(*histogram));
+		g_hash_table_insert(family->histograms,
+				    g_strdup(label_value), histogram);
+	}
+	return histogram;
+}
+
+/* Position of the most significant bit */
+static guint msb(guint64 value)
+{
+	guint bit = 0;
+
+	if (value >> 32) {
+		value >>= 32;
+		bit += 32;
+	}
+	if (value >> 16) {
+		value >>= 16;
+		bit += 16;
+	}
+	if (value >> 8) {
+		value >>= 8;
+		bit += 8;
+	}
+	if (value >> 4) {
+		value >>= 4;
+		bit += 4;
+	}
+	if (value >> 2) {
+		value >>= 2;
+		bit += 2;
+	}
+	if (value >> 1)
+		bit += 1;
+	return bit;
+}
+
+static guint bucket_index(guint64 value)
+{
+	guint bit;
+
+	if (value >= G_GUINT64_CONSTANT(1) << METRICS_MAX_BITS)
+		value = (G_GUINT64_CONSTANT(1) << METRICS_MAX_BITS) - 1;
+	if (value < 1 << METRICS_SUB_BITS)
+		return (guint) value;
+	bit = msb(value);
+	return ((bit - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS)
+	    + (guint) ((value >> (bit - METRICS_SUB_BITS)) &
+		       METRICS_SUB_MASK);
+}
+
+/* The largest value in a bucket. The values are whole microseconds, so
+ * this is the inclusive upper bound that Prometheus expects as 'le' */
+static guint64 bucket_max(guint idx)
+{
+	guint sub;
+	guint bit;
+
+	if (idx < 1 << METRICS_SUB_BITS)
+		return idx;
+	sub = idx & METRICS_SUB_MASK;
+	bit = (idx >> METRICS_SUB_BITS) + METRICS_SUB_BITS - 1;
+	return (G_GUINT64_CONSTANT(1) << bit)
+	    + ((guint64) (sub + 1) << (bit - METRICS_SUB_BITS)) - 1;
+}
+
+void metrics_histogram_record(MetricsHistogram * histogram, gint64 usec)
+{
+	if (!enabled)
+		return;
+	if (usec < 0)
+		usec = 0;
+	histogram->count++;
+	histogram->sum += (guint64) usec;
+	histogram->buckets[bucket_index((guint64) usec)]++;
+}
+
+gint64 metrics_start(void)
+{
+	return enabled ? g_get_monotonic_time() : 0;
+}
+
+void metrics_histogram_since(MetricsHistogram * histogram, gint64 start)
+{
+	if (start != 0)
+		metrics_histogram_record(histogram,
+					 g_get_monotonic_time() - start);
+}
+
+void metrics_histogram_reset(MetricsHistogram * histogram)
+{
+	memset(histogram, 0, sizeof(*histogram));
+}
+
+void metrics_append_header(GString * str, const gchar * name,
+			   const gchar * help, const gchar * type)
+{
+	g_string_append_printf(str, "# HELP %s %s\n# TYPE %s %s\n", name,
+			       help, name, type);
+}
+
+static void append_seconds(GString * str, guint64 usec)
+{
+	gchar buff[G_ASCII_DTOSTR_BUF_SIZE];
+
+	g_string_append(str,
+			g_ascii_formatd(buff, sizeof(buff), "%.6f",
+					(gdouble) usec / G_USEC_PER_SEC));
+}
+
+/* Append the label and a separator when there are more labels */
+static void append_label(GString * str, const gchar * label_name,
+			 const gchar * label_value, gboolean more)
+{
+	const gchar *c;
+
+	if (label_name == NULL)
+		return;
+	g_string_append_printf(str, "%s=\"", label_name);
+	for (c = label_value; *c != '\0'; c++) {
+		if (*c == '\\' || *c == '"')
+			g_string_append_c(str, '\\');
+		if (*c == '\n')
+			g_string_append(str, "\\n");
+		else
+			g_string_append_c(str, *c);
+	}
+	g_string_append(str, more ? "\"," : "\"");
+}
+
+void metrics_append_histogram(GString * str, const gchar * name,
+			      const gchar * label_name,
+			      const gchar * label_value,
+			      const MetricsHistogram * histogram)
+{
+	guint64 cumulative = 0;
+	guint idx;
+
+	for (idx = 0; idx < METRICS_BUCKETS; idx++) {
+		guint64 max = bucket_max(idx);
+
+		cumulative += histogram->buckets[idx];
+		if (max < (G_GUINT64_CONSTANT(1) << METRICS_EXPORT_MIN_BITS) - 1
+		    || max >= G_GUINT64_CONSTANT(1) << METRICS_EXPORT_MAX_BITS)
+			continue;
+		g_string_append_printf(str, "%s_bucket{", name);
+		append_label(str, label_name, label_value, TRUE);
+		g_string_append(str, "le=\"");
+		append_seconds(str, max);
+		g_string_append_printf(str, "\"} %" G_GUINT64_FORMAT "\n",
+				       cumulative);
+	}
+	g_string_append_printf(str, "%s_bucket{", name);
+	append_label(str, label_name, label_value, TRUE);
+	g_string_append_printf(str, "le=\"+Inf\"} %" G_GUINT64_FORMAT "\n",
+			       histogram->count);
+
+	g_string_append_printf(str, "%s_sum", name);
+	if (label_name != NULL) {
+		g_string_append_c(str, '{');
+		append_label(str, label_name, label_value, FALSE);
+		g_string_append_c(str, '}');
+	}
+	g_string_append_c(str, ' ');
+	append_seconds(str, histogram->sum);
+	g_string_append_printf(str, "\n%s_count", name);
+	if (label_name != NULL) {
+		g_string_append_c(str, '{');
+		append_label(str, label_name, label_value, FALSE);
+		g_string_append_c(str, '}');
+	}
+	g_string_append_printf(str, " %" G_GUINT64_FORMAT "\n",
+			       histogram->count);
+}
+
+static void export_family(MetricFamily * family, GString * str)
+{
+	GList *labels;
+	GList *list;
+
+	switch (family->type) {
+	case METRIC_COUNTER:
+	case METRIC_GAUGE:
+		metrics_append_header(str, family->name, family->help,
+				      family->type ==
+				      METRIC_COUNTER ? "counter" : "gauge");
+		g_string_append_printf(str, "%s %" G_GUINT64_FORMAT "\n",
+				       family->name, family->counter.value);
+		break;
+	case METRIC_HISTOGRAM:
+		metrics_append_header(str, family->name, family->help,
+				      "histogram");
+		labels = g_hash_table_get_keys(family->histograms);
+		labels = g_list_sort(labels, (GCompareFunc) strcmp);
+		for (list = labels; list != NULL; list = g_list_next(list))
+			metrics_append_histogram(str, family->name,
+						 family->label_name,
+						 list->data,
+						 g_hash_table_lookup
+						 (family->histograms,
+						  list->data));
+		g_list_free(labels);
+		break;
+	}
+}
+
+void metrics_export(GString * str)
+{
+	g_list_foreach(family_order, (GFunc) export_family, str);
+}
+
+static void family_free(MetricFamily * family,
+			G_GNUC_UNUSED gpointer user_data)
+{
+	if (family->histograms != NULL)
+		g_hash_table_destroy(family->histograms);
+	g_free(family);
+}
+
+void metrics_finish(void)
+{
+	g_list_foreach(family_order, (GFunc) family_free, NULL);
+	g_list_free(family_order);
+	family_order = NULL;
+	if (families != NULL) {
+		g_hash_table_destroy(families);
+		families = NULL;
+	}
+}
@@ -0,0 +1,146 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Counters and latency histograms, exported in the Prometheus text format.
+ * Nothing is recorded until metrics_set_enabled(TRUE) is called,
+ * recording is a few additions, all formatting is done when the metrics
+ * are exported.
+ */
+
+#ifndef __metrics_h
+#define __metrics_h
+
+#include <glib.h>
+
+/* Histogram buckets are log-linear: each power of two is split in
+ * 1 << METRICS_SUB_BITS buckets, values are in microseconds. */
+#define METRICS_SUB_BITS 1
+#define METRICS_MAX_BITS 40
+#define METRICS_BUCKETS ((METRICS_MAX_BITS - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS)
+
+typedef struct {
+	guint64 count;
+	guint64 sum;		/* in microseconds */
+	guint64 buckets[METRICS_BUCKETS];
+} MetricsHistogram;
+
+typedef struct _MetricsCounter MetricsCounter;
+
+/** Turn recording on or off.
+ * @param enabled TRUE to record
+ */
+void metrics_set_enabled(gboolean enabled);
+
+/** Check whether metrics are recorded */
+gboolean metrics_enabled(void);
+
+/** Get a counter, create it when needed.
+ * @param name The name of the metric, it must be a static string
+ * @param help A static description
+ * @return The counter, valid until metrics_finish
+ */
+MetricsCounter *metrics_counter(const gchar * name, const gchar * help);
+
+/** Add to a counter.
+ * @param counter The counter
+ * @param value The amount to add
+ */
+void metrics_counter_add(MetricsCounter * counter, guint64 value);
+
+/** Get a gauge, create it when needed.
+ * Gauges are counters that are exported with the gauge type.
+ * @param name The name of the metric, it must be a static string
+ * @param help A static description
+ * @return The gauge, valid until metrics_finish
+ */
+MetricsCounter *metrics_gauge(const gchar * name, const gchar * help);
+
+/** Set a gauge.
+ * @param counter The gauge
+ * @param value The new value
+ */
+void metrics_counter_set(MetricsCounter * counter, guint64 value);
+
+/** Raise a gauge to a value, if it is lower.
+ * @param counter The gauge
+ * @param value The new value
+ */
+void metrics_counter_max(MetricsCounter * counter, guint64 value);
+
+/** Get a histogram, create it when needed.
+ * @param name The name of the metric, it must be a static string
+ * @param help A static description
+ * @param label_name The static name of the label, or NULL
+ * @param label_value The value of the label, it is copied
+ * @return The histogram, valid until metrics_finish
+ */
+MetricsHistogram *metrics_histogram(const gchar * name,
+				    const gchar * help,
+				    const gchar * label_name,
+				    const gchar * label_value);
+
+/** Record a value.
+ * @param histogram The histogram
+ * @param usec The value in microseconds
+ */
+void metrics_histogram_record(MetricsHistogram * histogram, gint64 usec);
+
+/** Record the time since a start time.
+ * @param histogram The histogram
+ * @param start The result of metrics_start
+ */
+void metrics_histogram_since(MetricsHistogram * histogram, gint64 start);
+
+/** The start time for metrics_histogram_since.
+ * @return The monotonic time, or 0 when metrics are not recorded
+ */
+gint64 metrics_start(void);
+
+/** Clear a histogram that is not registered */
+void metrics_histogram_reset(MetricsHistogram * histogram);
+
+/** Append the HELP and TYPE lines of a metric.
+ * @param str The string to append to
+ * @param name The name of the metric
+ * @param help The description
+ * @param type counter, gauge or histogram
+ */
+void metrics_append_header(GString * str, const gchar * name,
+			   const gchar * help, const gchar * type);
+
+/** Append a histogram in the Prometheus text format.
+ * @param str The string to append to
+ * @param name The name of the metric
+ * @param label_name The name of the label, or NULL
+ * @param label_value The value of the label, it is escaped
+ * @param histogram The histogram
+ */
+void metrics_append_histogram(GString * str, const gchar * name,
+			      const gchar * label_name,
+			      const gchar * label_value,
+			      const MetricsHistogram * histogram);
+
+/** Export all registered metrics in the Prometheus text format.
+ * @param str The string to append to
+ */
+void metrics_export(GString * str);
+
+/** Free all registered metrics */
+void metrics_finish(void);
+
+#endif
@@ -24,9 +24,24 @@
 #include "config.h"
 #include <stdlib.h>
 #include <gio/gio.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#endif
 
 #include "network.h"
 #include "log.h"
+#include "metrics.h"
+#include "timer-wheel.h"
+
+/* Read buffers start small and grow on demand up to READ_BUFF_MAX.
+ * Sessions without pending input do not hold a buffer, empty buffers of
+ * the initial size are kept in a pool for reuse. */
+#define READ_BUFF_INITIAL 512
+#define READ_BUFF_MAX (16 * 1024)
+#define READ_BUFF_POOL_MAX 1024
 
 struct _Service {
 	GSocketListener *listener;
@@ -40,8 +55,12 @@ struct _Service {
 struct _Session {
 	GSocketConnection *connection;
 	GCancellable *input_cancel;
+#ifdef HAVE_SYS_EPOLL_H
+	gint fd; /**< Socket in the shared epoll set, or -1 */
+#endif
+	gboolean listening; /**< Input of the connection is watched */
 	time_t last_response;	/* used for activity detection.  */
-	guint timer_id;
+	guint timer_id; /**< Keep-alive timer in the timer wheel */
 	gboolean timed_out;
 	gpointer user_data;
 	Service *service; /**< Associated service, when applicable */
@@ -49,26 +68,140 @@ struct _Session {
 	gchar *host;
 	guint16 port;
 
-	char read_buff[16 * 1024];
+	gchar *read_buff; /**< Pending input, or NULL */
+	size_t read_size; /**< Allocated size of read_buff */
 	size_t read_len;
+	GSList *retired_buffs; /**< Buffers replaced while entered */
 	gboolean entered;
+	gboolean free_pending; /**< Freed while entered */
 
 	NetNotifyFunc notify_func;
 	guint period; /**< Period in s for keep-alive checks */
+
+	guint64 bytes_in;
+	guint64 bytes_out;
 };
 
+static MetricsCounter *metric_bytes_in;
+static MetricsCounter *metric_bytes_out;
+
 static void notify(Session * ses, NetEvent event, const gchar * line)
 {
 	if (ses->notify_func != NULL)
 		ses->notify_func(ses, event, line, ses->user_data);
 }
 
+/* Empty read buffers, linked through their first bytes */
+static gchar *read_buff_pool;
+static guint read_buff_pool_size;
+
+static gchar *read_buff_get(void)
+{
+	gchar *buff = read_buff_pool;
+
+	if (buff == NULL)
+		return g_malloc(READ_BUFF_INITIAL);
+	read_buff_pool = *(gchar **) buff;
+	read_buff_pool_size--;
+	return buff;
+}
+
+static void read_buff_put(gchar * buff, size_t size)
+{
+	if (size == READ_BUFF_INITIAL
+	    && read_buff_pool_size < READ_BUFF_POOL_MAX) {
+		*(gchar **) buff = read_buff_pool;
+		read_buff_pool = buff;
+		read_buff_pool_size++;
+	} else {
+		g_free(buff);
+	}
+}
+
+/** Make room in the read buffer of the session.
+ * @return FALSE if the buffer is full and may not grow any more
+ */
+static gboolean read_buff_reserve(Session * ses)
+{
+	gchar *buff;
+	size_t size;
+
+	if (ses->read_buff == NULL) {
+		ses->read_buff = read_buff_get();
+		ses->read_size = READ_BUFF_INITIAL;
+		ses->read_len = 0;
+		return TRUE;
+	}
+	if (ses->read_len < ses->read_size)
+		return TRUE;
+	if (ses->read_size >= READ_BUFF_MAX)
+		return FALSE;
+
+	size = MIN(2 * ses->read_size, READ_BUFF_MAX);
+	buff = g_malloc(size);
+	memcpy(buff, ses->read_buff, ses->read_len);
+	if (ses->entered) {
+		/* The line that is being notified still points
+		 * into the old buffer */
+		ses->retired_buffs =
+		    g_slist_prepend(ses->retired_buffs, ses->read_buff);
+	} else {
+		read_buff_put(ses->read_buff, ses->read_size);
+	}
+	ses->read_buff = buff;
+	ses->read_size = size;
+	return TRUE;
+}
+
+/** Return the read buffer to the pool when it is empty */
+static void read_buff_release(Session * ses)
+{
+	if (ses->entered)
+		return;
+
+	g_slist_free_full(ses->retired_buffs, g_free);
+	ses->retired_buffs = NULL;
+	if (ses->read_buff != NULL && ses->read_len == 0) {
+		read_buff_put(ses->read_buff, ses->read_size);
+		ses->read_buff = NULL;
+		ses->read_size = 0;
+	}
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/* All sessions share one epoll set, which is watched by a single
+ * source in the main loop. */
+#define EPOLL_BATCH 64
+
+static gint epoll_fd = -1;
+static guint epoll_watch;
+static struct epoll_event epoll_events[EPOLL_BATCH];
+static gint epoll_pending;
+
+static void epoll_unregister(Session * ses)
+{
+	gint idx;
+
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, ses->fd, NULL);
+	ses->fd = -1;
+
+	/* Forget the events of this session that are not dispatched yet */
+	for (idx = 0; idx < epoll_pending; idx++)
+		if (epoll_events[idx].data.ptr == ses)
+			epoll_events[idx].data.ptr = NULL;
+}
+#endif
+
 static gboolean net_close_internal(Session * ses)
 {
 	if (ses->timer_id != 0) {
-		g_source_remove(ses->timer_id);
+		timer_wheel_remove(ses->timer_id);
 		ses->timer_id = 0;
 	}
+#ifdef HAVE_SYS_EPOLL_H
+	if (ses->fd >= 0)
+		epoll_unregister(ses);
+#endif
 
 	if (ses->input_cancel != NULL
 	    && !g_cancellable_is_cancelled(ses->input_cancel)) {
@@ -91,6 +224,18 @@ void net_close(Session * ses)
 		notify(ses, NET_CLOSE, NULL);
 }
 
+static gboolean ping_function(gpointer s);
+
+/* The keep-alive timers of a service are listed with the user data of the
+ * service, which is the game for the server */
+static guint ping_timer_add(Session * ses, guint interval)
+{
+	return timer_wheel_add_full(interval, ping_function, ses,
+				    ses->service != NULL ?
+				    ses->service->user_data : NULL,
+				    "keep-alive");
+}
+
 static gboolean ping_function(gpointer s)
 {
 	Session *ses = (Session *) s;
@@ -109,14 +254,12 @@ static gboolean ping_function(gpointer s)
 		/* There was no activity.
 		 * Send a ping (but don't update activity time).  */
 		net_write(ses, "hello\n");
-		ses->timer_id =
-		    g_timeout_add(ses->period * 1000, ping_function, s);
+		if (ses->connection != NULL)
+			ses->timer_id = ping_timer_add(ses, ses->period);
 	} else {
 		/* Everything is fine.  Reschedule this check.  */
-		ses->timer_id = g_timeout_add((guint)
-					      ((ses->period -
-						interval) * 1000),
-					      ping_function, s);
+		ses->timer_id = ping_timer_add(ses, (guint)
+					       (ses->period - interval));
 	}
 	/* Return FALSE to not reschedule this timeout.  If it needed to be
 	 * rescheduled, it has been done explicitly above (with a different
@@ -149,6 +292,8 @@ void net_write(Session * ses, const gchar * data)
 		if (strcmp(data, "yes\n") && strcmp(data, "hello\n")) {
 			debug("(%p) --> %s", ses->connection, data);
 		}
+		ses->bytes_out += (guint64) num;
+		metrics_counter_add(metric_bytes_out, (guint64) num);
 		if ((size_t) num != len) {
 			log_message(MSG_ERROR,
 				    _("Could not send all data\n"));
@@ -182,58 +327,13 @@ static ssize_t find_line(char *buff, size_t len)
 	return -1;
 }
 
-static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
+/** Notify all complete lines in the read buffer */
+static void net_process_input(Session * ses)
 {
-	Session *ses = (Session *) user_data;
-	gssize num;
 	size_t offset;
-	GError *error;
-
-	/* There is data from this connection: record the time.  */
-	ses->last_response = time(NULL);
-
-	if (ses->read_len == sizeof(ses->read_buff)) {
-		/* We are in trouble now - the application has not
-		 * been processing the data we have been
-		 * reading. Assume something has gone wrong and
-		 * disconnect
-		 */
-		log_message(MSG_ERROR,
-			    _("Read buffer overflow - disconnecting\n"));
-		net_close(ses);
-		return FALSE;
-	}
-
-	error = NULL;
-	num =
-	    g_pollable_input_stream_read_nonblocking
-	    (G_POLLABLE_INPUT_STREAM(pollable_stream),
-	     ses->read_buff + ses->read_len,
-	     sizeof(ses->read_buff) - ses->read_len, ses->input_cancel,
-	     &error);
-
-	if (g_cancellable_is_cancelled(ses->input_cancel)) {
-		g_error_free(error);
-		return FALSE;
-	}
-
-	if (num == 0) {
-		net_close(ses);
-		return FALSE;
-	}
-
-	if (num < 0) {
-		log_message(MSG_ERROR, _("Error reading socket: %s\n"),
-			    error->message);
-		g_error_free(error);
-		net_close(ses);
-		return FALSE;
-	}
-
-	ses->read_len += (size_t) num;
 
 	if (ses->entered) {
-		return TRUE;
+		return;
 	}
 	ses->entered = TRUE;
 
@@ -274,12 +374,171 @@ static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
 		ses->read_len = 0;
 
 	ses->entered = FALSE;
+	if (ses->free_pending) {
+		net_free(&ses);
+		return;
+	}
+	read_buff_release(ses);
 	if (ses->connection == NULL) {
 		net_close(ses);
 	}
+}
+
+static void net_read_overflow(Session * ses)
+{
+	/* We are in trouble now - the application has not
+	 * been processing the data we have been
+	 * reading. Assume something has gone wrong and
+	 * disconnect
+	 */
+	log_message(MSG_ERROR, _("Read buffer overflow - disconnecting\n"));
+	net_close(ses);
+}
+
+static gboolean input_ready(GObject * pollable_stream, gpointer user_data)
+{
+	Session *ses = (Session *) user_data;
+	gssize num;
+	GError *error;
+
+	if (ses->input_cancel == NULL
+	    || g_cancellable_is_cancelled(ses->input_cancel)) {
+		return FALSE;
+	}
+
+	/* There is data from this connection: record the time.  */
+	ses->last_response = time(NULL);
+
+	if (!read_buff_reserve(ses)) {
+		net_read_overflow(ses);
+		return FALSE;
+	}
+
+	error = NULL;
+	num =
+	    g_pollable_input_stream_read_nonblocking
+	    (G_POLLABLE_INPUT_STREAM(pollable_stream),
+	     ses->read_buff + ses->read_len,
+	     ses->read_size - ses->read_len, ses->input_cancel, &error);
+
+	if (g_cancellable_is_cancelled(ses->input_cancel)) {
+		g_error_free(error);
+		return FALSE;
+	}
+
+	if (num == 0) {
+		net_close(ses);
+		return FALSE;
+	}
+
+	if (num < 0) {
+		log_message(MSG_ERROR, _("Error reading socket: %s\n"),
+			    error->message);
+		g_error_free(error);
+		net_close(ses);
+		return FALSE;
+	}
+
+	ses->read_len += (size_t) num;
+	ses->bytes_in += (guint64) num;
+	metrics_counter_add(metric_bytes_in, (guint64) num);
+	net_process_input(ses);
 	return TRUE;		/* Keep the source */
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+static void epoll_input_ready(Session * ses)
+{
+	ssize_t num;
+
+	/* There is data from this connection: record the time.  */
+	ses->last_response = time(NULL);
+
+	if (!read_buff_reserve(ses)) {
+		net_read_overflow(ses);
+		return;
+	}
+
+	num = recv(ses->fd, ses->read_buff + ses->read_len,
+		   ses->read_size - ses->read_len, 0);
+	if (num < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK
+		    || errno == EINTR) {
+			read_buff_release(ses);
+			return;
+		}
+		log_message(MSG_ERROR, _("Error reading socket: %s\n"),
+			    g_strerror(errno));
+		net_close(ses);
+		return;
+	}
+	if (num == 0) {
+		net_close(ses);
+		return;
+	}
+
+	ses->read_len += (size_t) num;
+	ses->bytes_in += (guint64) num;
+	metrics_counter_add(metric_bytes_in, (guint64) num);
+	net_process_input(ses);
+}
+
+static gboolean epoll_dispatch(G_GNUC_UNUSED GIOChannel * source,
+			       G_GNUC_UNUSED GIOCondition condition,
+			       G_GNUC_UNUSED gpointer user_data)
+{
+	gint num;
+	gint idx;
+
+	num = epoll_wait(epoll_fd, epoll_events, EPOLL_BATCH, 0);
+	if (num <= 0)
+		return TRUE;
+
+	epoll_pending = num;
+	for (idx = 0; idx < epoll_pending; idx++) {
+		Session *ses = epoll_events[idx].data.ptr;
+
+		/* Sessions closed while dispatching this batch have
+		 * been removed from the array */
+		if (ses != NULL && ses->connection != NULL)
+			epoll_input_ready(ses);
+	}
+	epoll_pending = 0;
+	return TRUE;
+}
+
+/** Add the session to the shared epoll set.
+ * @return FALSE if the default GIO sources must be used
+ */
+static gboolean epoll_register(Session * ses)
+{
+	struct epoll_event event;
+	gint fd;
+
+	if (epoll_fd < 0) {
+		GIOChannel *channel;
+
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_fd < 0)
+			return FALSE;
+		channel = g_io_channel_unix_new(epoll_fd);
+		epoll_watch =
+		    g_io_add_watch(channel, G_IO_IN, epoll_dispatch, NULL);
+		g_io_channel_unref(channel);
+	}
+
+	fd = g_socket_get_fd(g_socket_connection_get_socket
+			     (ses->connection));
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = ses;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+		return FALSE;
+	ses->fd = fd;
+	return TRUE;
+}
+#endif
+
 Session *net_new(NetNotifyFunc notify_func, gpointer user_data)
 {
 	Session *ses;
@@ -289,6 +548,9 @@ Session *net_new(NetNotifyFunc notify_func, gpointer user_data)
 	ses->user_data = user_data;
 	ses->connection = NULL;
 	ses->timed_out = FALSE;
+#ifdef HAVE_SYS_EPOLL_H
+	ses->fd = -1;
+#endif
 
 	return ses;
 }
@@ -315,13 +577,12 @@ void net_set_check_connection_alive(Session * ses, guint period)
 	if (period > 0) {
 		ses->last_response = time(NULL);
 		if (ses->timer_id != 0) {
-			g_source_remove(ses->timer_id);
+			timer_wheel_remove(ses->timer_id);
 		}
-		ses->timer_id =
-		    g_timeout_add(period * 1000, ping_function, ses);
+		ses->timer_id = ping_timer_add(ses, period);
 	} else {
 		if (ses->timer_id != 0) {
-			g_source_remove(ses->timer_id);
+			timer_wheel_remove(ses->timer_id);
 			ses->timer_id = 0;
 		}
 	}
@@ -332,6 +593,13 @@ gboolean net_get_connection_timed_out(Session * ses)
 	return ses->timed_out;
 }
 
+void net_get_traffic(const Session * ses, guint64 * bytes_in,
+		     guint64 * bytes_out)
+{
+	*bytes_in = ses->bytes_in;
+	*bytes_out = ses->bytes_out;
+}
+
 gboolean net_connected(Session * ses)
 {
 	return (ses->connection != NULL);
@@ -344,6 +612,12 @@ static void net_start_listening(Session * ses)
 
 	g_assert(ses->connection != NULL);
 
+	ses->listening = TRUE;
+#ifdef HAVE_SYS_EPOLL_H
+	if (epoll_register(ses))
+		return;
+#endif
+
 	ses->input_cancel = g_cancellable_new();
 	input_source =
 	    g_pollable_input_stream_create_source(G_POLLABLE_INPUT_STREAM
@@ -396,11 +670,12 @@ void net_free(Session ** ses)
 {
 	g_return_if_fail(ses != NULL);
 
-	/* If the sessions is still in use, do not free it */
+	/* If the session is notifying its input, it is freed when the
+	 * notification returns. No more events are sent. */
 	if (!net_close_internal(*ses)) {
-		g_warning("Request to free session %p was denied, this "
-			  "programming error results in a memory leak\n",
-			  *ses);
+		(*ses)->free_pending = TRUE;
+		(*ses)->notify_func = NULL;
+		*ses = NULL;
 		return;
 	}
 	if ((*ses)->service != NULL) {
@@ -413,9 +688,19 @@ void net_free(Session ** ses)
 	}
 
 	g_free((*ses)->host);
+	g_slist_free_full((*ses)->retired_buffs, g_free);
+	(*ses)->retired_buffs = NULL;
+	if ((*ses)->read_buff != NULL) {
+		read_buff_put((*ses)->read_buff, (*ses)->read_size);
+		(*ses)->read_buff = NULL;
+	}
 
 	if ((*ses)->input_cancel != NULL) {
 		g_object_unref((*ses)->input_cancel);
+		(*ses)->input_cancel = NULL;
+	}
+	if ((*ses)->listening) {
+		/* Events for this session can still be dispatched */
 		g_idle_add(net_delayed_free, *ses);
 	} else {
 		g_free(*ses);
@@ -601,10 +886,26 @@ gboolean net_get_peer_name(Session * ses, gchar ** hostname,
 
 void net_init(void)
 {
-	/* Do nothing thanks to GIO */
+	/* Thanks to GIO only the metrics need to be set up,
+	 * the epoll set is created on demand */
+	metric_bytes_in =
+	    metrics_counter("pioneers_network_received_bytes_total",
+			    "Bytes received by all sessions");
+	metric_bytes_out =
+	    metrics_counter("pioneers_network_sent_bytes_total",
+			    "Bytes sent by all sessions");
 }
 
 void net_finish(void)
 {
-	/* Do nothing thanks to GIO */
+#ifdef HAVE_SYS_EPOLL_H
+	if (epoll_fd >= 0) {
+		g_source_remove(epoll_watch);
+		epoll_watch = 0;
+		close(epoll_fd);
+		epoll_fd = -1;
+	}
+#endif
+	while (read_buff_pool != NULL)
+		g_free(read_buff_get());
 }
@@ -66,6 +66,14 @@ void net_set_check_connection_alive(Session * ses, guint period);
  */
 gboolean net_get_connection_timed_out(Session * ses);
 
+/** Get the number of bytes that were transferred.
+ * @param ses The session
+ * @retval bytes_in The number of bytes received
+ * @retval bytes_out The number of bytes sent
+ */
+void net_get_traffic(const Session * ses, guint64 * bytes_in,
+		     guint64 * bytes_out);
+
 /** Create a service that listens on the mentioned port.
  *  @param port The port
  *  @param notify_func The notification function for new Sessions
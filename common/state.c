@@ -30,6 +30,7 @@
 
 #include "game.h"
 #include "log.h"
+#include "metrics.h"
 #include "state.h"
 #include "network.h"
 
@@ -57,6 +58,19 @@ struct StateMachine {
 
 	gboolean use_cache;	/* cache the data that is sent */
 	GList *cache;		/* cache for the delayed data */
+	guint cache_depth;	/* length of the cache */
+
+	const gchar *log_game;	/* context of the log messages */
+	gint log_player;
+
+	StateEnterFunc enter;	/* makes the owner current */
+	gpointer enter_data;
+
+	/* Metrics handles, looked up once instead of for each message */
+	const gchar *duration_state;	/* state of duration_histogram */
+	MetricsHistogram *duration_histogram;
+	MetricsCounter *cached_messages;
+	MetricsCounter *cache_depth_max;
 };
 
 static void route_event(StateMachine * sm, gint event);
@@ -158,10 +172,15 @@ static void net_event(Session * ses, NetEvent event, const gchar * line,
 		      gpointer user_data)
 {
 	StateMachine *sm = (StateMachine *) user_data;
+	const gchar *state = NULL;
+	gint64 start = 0;
 
 	g_assert(ses == sm->ses);
 
 	sm_inc_use_count(sm);
+	log_set_context(sm->log_game, sm->log_player);
+	if (sm->enter != NULL)
+		sm->enter(sm->enter_data);
 
 	switch (event) {
 	case NET_CONNECT:
@@ -180,16 +199,33 @@ static void net_event(Session * ses, NetEvent event, const gchar * line,
 		/* Only handle data if there is a context.  Fixes bug that
 		 * clients starting to send data immediately crash the
 		 * server */
-		if (sm->stack_ptr != -1)
-			route_event(sm, SM_RECV);
-		else {
+		if (sm->stack_ptr == -1) {
+			log_set_context(NULL, -1);
 			sm_dec_use_count(sm);
 			return;
 		}
+		state = sm->current_state;
+		start = metrics_start();
+		route_event(sm, SM_RECV);
 		break;
 	}
 	route_event(sm, SM_INIT);
 
+	if (start != 0) {
+		/* State names are string constants, so comparing the
+		 * pointers is enough to know the histogram is still valid */
+		if (sm->duration_histogram == NULL
+		    || sm->duration_state != state) {
+			sm->duration_state = state;
+			sm->duration_histogram =
+			    metrics_histogram
+			    ("pioneers_message_duration_seconds",
+			     "Time to handle a received line, by state",
+			     "state", state != NULL ? state : "unnamed");
+		}
+		metrics_histogram_since(sm->duration_histogram, start);
+	}
+	log_set_context(NULL, -1);
 	sm_dec_use_count(sm);
 }
 
@@ -219,6 +255,25 @@ void sm_set_session(StateMachine * sm, Session * ses)
 	sm_dec_use_count(sm);
 };
 
+Session *sm_get_session(StateMachine * sm)
+{
+	return sm->ses;
+}
+
+void sm_set_log_context(StateMachine * sm, const gchar * game,
+			gint player_num)
+{
+	sm->log_game = game;
+	sm->log_player = player_num;
+}
+
+void sm_set_enter_func(StateMachine * sm, StateEnterFunc func,
+		       gpointer user_data)
+{
+	sm->enter = func;
+	sm->enter_data = user_data;
+}
+
 gboolean sm_recv(StateMachine * sm, const gchar * fmt, ...)
 {
 	va_list ap;
@@ -251,12 +306,28 @@ void sm_write(StateMachine * sm, const gchar * str)
 {
 	if (sm->use_cache) {
 		/* Protect against strange/slow connects */
-		if (g_list_length(sm->cache) > 1000) {
+		if (sm->cache_depth > 1000) {
 			net_write(sm->ses, "ERR connection too slow\n");
 			net_close(sm->ses);
 		} else {
 			sm->cache =
 			    g_list_append(sm->cache, g_strdup(str));
+			sm->cache_depth++;
+			if (metrics_enabled()) {
+				if (sm->cached_messages == NULL) {
+					sm->cached_messages =
+					    metrics_counter
+					    ("pioneers_sm_cached_messages_total",
+					     "Messages delayed by the send cache");
+					sm->cache_depth_max =
+					    metrics_gauge
+					    ("pioneers_sm_cache_depth_max",
+					     "Highest number of messages in a send cache");
+				}
+				metrics_counter_add(sm->cached_messages, 1);
+				metrics_counter_max(sm->cache_depth_max,
+						    sm->cache_depth);
+			}
 		}
 	} else
 		net_write(sm->ses, str);
@@ -301,6 +372,7 @@ void sm_set_use_cache(StateMachine * sm, gboolean use_cache)
 			g_free(data);
 		}
 		sm->cache = NULL;
+		sm->cache_depth = 0;
 	} else {
 		/* Be sure that the cache is empty */
 		g_assert(!sm->cache);
@@ -479,6 +551,7 @@ StateMachine *sm_new(gpointer user_data)
 
 	sm->user_data = user_data;
 	sm->stack_ptr = -1;
+	sm->log_player = -1;
 
 	return sm;
 }
@@ -503,7 +576,8 @@ void sm_free(StateMachine * sm)
 
 void sm_close(StateMachine * sm)
 {
-	net_free(&(sm->ses));
+	if (sm->ses != NULL)
+		net_free(&(sm->ses));
 	if (sm->use_cache) {
 		/* Purge the cache */
 		GList *list = sm->cache;
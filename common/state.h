@@ -91,6 +91,10 @@ typedef struct StateMachine StateMachine;
  */
 typedef gboolean(*StateFunc) (StateMachine * sm, gint event);
 
+/* Called before the state machine handles a network event
+ */
+typedef void (*StateEnterFunc) (gpointer user_data);
+
 StateMachine *sm_new(gpointer user_data);
 void sm_free(StateMachine * sm);
 void sm_close(StateMachine * sm);
@@ -142,6 +146,24 @@ gboolean sm_is_connected(StateMachine * sm);
 gboolean sm_connect(StateMachine * sm, const gchar * host,
 		    const gchar * port);
 void sm_set_session(StateMachine * sm, Session * ses);
+/** The network session that feeds the state machine, or NULL */
+Session *sm_get_session(StateMachine * sm);
+/** Set the context of the messages that are logged while the state
+ *  machine handles network events.
+ * @param sm The state machine
+ * @param game The identifier of the game, it must outlive sm, or NULL
+ * @param player_num The player number, or -1
+ */
+void sm_set_log_context(StateMachine * sm, const gchar * game,
+			gint player_num);
+/** Set the function that is called before each network event is handled,
+ *  to make the owner of the state machine current.
+ * @param sm The state machine
+ * @param func The function, or NULL
+ * @param user_data The argument of func
+ */
+void sm_set_enter_func(StateMachine * sm, StateEnterFunc func,
+		       gpointer user_data);
 void sm_dec_use_count(StateMachine * sm);
 void sm_inc_use_count(StateMachine * sm);
 /** Dump the stack */
@@ -0,0 +1,103 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Checks that the timers of the timer wheel expire at their due time,
+ * also when they are more than one revolution of the far level away.
+ * The wheel is built into the test with a clock that the test advances.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+
+static gint64 fake_now;
+
+#define g_get_monotonic_time() (fake_now * G_USEC_PER_SEC)
+#include "timer-wheel.c"
+#undef g_get_monotonic_time
+
+typedef struct {
+	guint interval;
+	gint64 start;
+	gint64 fired;		/* the tick of the last expiry, or 0 */
+	gint count;
+} TestTimer;
+
+static gboolean failed;
+
+static gboolean test_expire(gpointer data)
+{
+	TestTimer *test = data;
+	gint64 expected = test->start + test->interval * (test->count + 1);
+
+	if (fake_now != expected) {
+		fprintf(stderr, "Timer of %u s expired at %" G_GINT64_FORMAT
+			", expected %" G_GINT64_FORMAT "\n", test->interval,
+			fake_now - test->start, expected - test->start);
+		failed = TRUE;
+	}
+	test->fired = fake_now;
+	test->count++;
+	return TRUE;
+}
+
+int main(G_GNUC_UNUSED int argc, G_GNUC_UNUSED char *argv[])
+{
+	/* Intervals below, at and above WHEEL_SLOTS * WHEEL_SLOTS */
+	TestTimer tests[] = {
+		{1, 0, 0, 0},
+		{63, 0, 0, 0},
+		{64, 0, 0, 0},
+		{4095, 0, 0, 0},
+		{4096, 0, 0, 0},
+		{5000, 0, 0, 0},
+		{10000, 0, 0, 0}
+	};
+	const gint64 duration = 25000;
+	gint64 end;
+	guint idx;
+
+	/* Do not start at a revolution boundary */
+	fake_now = 1000003;
+	end = fake_now + duration;
+	for (idx = 0; idx < G_N_ELEMENTS(tests); idx++) {
+		tests[idx].start = fake_now;
+		timer_wheel_add(tests[idx].interval, test_expire,
+				&tests[idx]);
+	}
+
+	while (fake_now < end) {
+		fake_now++;
+		timer_wheel_tick(NULL);
+	}
+
+	for (idx = 0; idx < G_N_ELEMENTS(tests); idx++) {
+		gint expected =
+		    (gint) (duration / (gint64) tests[idx].interval);
+		if (tests[idx].count != expected) {
+			fprintf(stderr,
+				"Timer of %u s expired %d times, "
+				"expected %d\n", tests[idx].interval,
+				tests[idx].count, expected);
+			failed = TRUE;
+		}
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,283 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include "timer-wheel.h"
+
+/* The wheel has two levels. The near level has one slot per second,
+ * the far level has one slot per revolution of the near level.
+ * When the near level wraps, the next far slot is cascaded into it.
+ * Timers that are more than WHEEL_SLOTS * WHEEL_SLOTS seconds away
+ * stay in the far level for more than one revolution. */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+typedef struct {
+	GList link;		/* link in a slot, data points to this timer */
+	GQueue *queue;		/* the queue the link is in, or NULL */
+	guint id;
+	gint64 due;		/* the tick at which the timer expires */
+	guint interval;		/* in seconds */
+	GSourceFunc func;
+	gpointer data;
+	gconstpointer owner;
+	const gchar *name;
+	gboolean running;	/* the callback is being called */
+	gboolean removed;	/* removed during its callback */
+} WheelTimer;
+
+static GQueue near_wheel[WHEEL_SLOTS];
+static GQueue far_wheel[WHEEL_SLOTS];
+static GQueue expired;
+static GHashTable *timers;	/* id -> WheelTimer */
+static guint next_id = 1;
+static gint64 current_tick;	/* the last tick that was processed */
+static guint tick_source;
+
+static gint64 now_tick(void)
+{
+	return g_get_monotonic_time() / G_USEC_PER_SEC;
+}
+
+static void timer_unlink(WheelTimer * timer)
+{
+	if (timer->queue != NULL) {
+		g_queue_unlink(timer->queue, &timer->link);
+		timer->queue = NULL;
+	}
+}
+
+/* Put the timer in the slot for its due time */
+static void timer_place(WheelTimer * timer)
+{
+	GQueue *queue;
+
+	if (timer->due <= current_tick)
+		queue = &expired;
+	else if (timer->due - current_tick < WHEEL_SLOTS)
+		queue = &near_wheel[timer->due & WHEEL_MASK];
+	else
+		queue = &far_wheel[(timer->due >> WHEEL_BITS) & WHEEL_MASK];
+	g_queue_push_tail_link(queue, &timer->link);
+	timer->queue = queue;
+}
+
+static void timer_arm(WheelTimer * timer, gint64 now)
+{
+	timer->due = now + MAX(timer->interval, 1);
+	timer_place(timer);
+}
+
+/* Move all timers of the queue to their slot for the current tick.
+ * A timer that is still more than one revolution away goes back to the
+ * same far slot, so the queue is emptied before the timers are placed. */
+static void timer_replace_queue(GQueue * queue)
+{
+	GQueue pending = *queue;
+	GList *link;
+
+	g_queue_init(queue);
+	while ((link = g_queue_pop_head_link(&pending)) != NULL) {
+		WheelTimer *timer = link->data;
+		timer->queue = NULL;
+		timer_place(timer);
+	}
+}
+
+static void timer_advance(gint64 now)
+{
+	if (now - current_tick > WHEEL_SLOTS * WHEEL_SLOTS) {
+		/* Too far behind (e.g. after a suspend),
+		 * place all timers again */
+		GHashTableIter iter;
+		gpointer value;
+
+		current_tick = now;
+		g_hash_table_iter_init(&iter, timers);
+		while (g_hash_table_iter_next(&iter, NULL, &value)) {
+			WheelTimer *timer = value;
+			if (timer->queue != &expired) {
+				timer_unlink(timer);
+				timer_place(timer);
+			}
+		}
+		return;
+	}
+
+	while (current_tick < now) {
+		current_tick++;
+		if ((current_tick & WHEEL_MASK) == 0)
+			timer_replace_queue(&far_wheel
+					    [(current_tick >> WHEEL_BITS) &
+					     WHEEL_MASK]);
+		timer_replace_queue(&near_wheel[current_tick & WHEEL_MASK]);
+	}
+}
+
+static void timer_free(WheelTimer * timer)
+{
+	g_hash_table_remove(timers, GUINT_TO_POINTER(timer->id));
+	g_free(timer);
+}
+
+static gboolean timer_wheel_tick(G_GNUC_UNUSED gpointer user_data)
+{
+	gint64 now = now_tick();
+	GList *link;
+
+	timer_advance(now);
+
+	while ((link = g_queue_pop_head_link(&expired)) != NULL) {
+		WheelTimer *timer = link->data;
+		gboolean again;
+
+		timer->queue = NULL;
+		timer->running = TRUE;
+		again = timer->func(timer->data);
+		timer->running = FALSE;
+
+		if (timer->removed) {
+			g_free(timer);
+		} else if (again) {
+			timer_arm(timer, now);
+		} else {
+			timer_free(timer);
+		}
+	}
+
+	if (g_hash_table_size(timers) == 0) {
+		tick_source = 0;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+guint timer_wheel_add_full(guint interval, GSourceFunc func,
+			   gpointer data, gconstpointer owner,
+			   const gchar * name)
+{
+	WheelTimer *timer;
+
+	g_return_val_if_fail(func != NULL, 0);
+
+	if (timers == NULL)
+		timers = g_hash_table_new(NULL, NULL);
+
+	if (tick_source == 0) {
+		current_tick = now_tick();
+		tick_source =
+		    g_timeout_add_seconds(1, timer_wheel_tick, NULL);
+	}
+
+	timer = g_malloc0(sizeof(*timer));
+	timer->link.data = timer;
+	do {
+		timer->id = next_id++;
+	} while (timer->id == 0
+		 || g_hash_table_lookup(timers,
+					GUINT_TO_POINTER(timer->id)) != NULL);
+	timer->interval = interval;
+	timer->func = func;
+	timer->data = data;
+	timer->owner = owner;
+	timer->name = name;
+	g_hash_table_insert(timers, GUINT_TO_POINTER(timer->id), timer);
+
+	timer_arm(timer, MAX(now_tick(), current_tick));
+	return timer->id;
+}
+
+guint timer_wheel_add(guint interval, GSourceFunc func, gpointer data)
+{
+	return timer_wheel_add_full(interval, func, data, NULL, NULL);
+}
+
+gboolean timer_wheel_remove(guint id)
+{
+	WheelTimer *timer;
+
+	if (id == 0 || timers == NULL)
+		return FALSE;
+
+	timer = g_hash_table_lookup(timers, GUINT_TO_POINTER(id));
+	if (timer == NULL)
+		return FALSE;
+
+	timer_unlink(timer);
+	if (timer->running) {
+		g_hash_table_remove(timers, GUINT_TO_POINTER(id));
+		timer->removed = TRUE;
+	} else {
+		timer_free(timer);
+	}
+	return TRUE;
+}
+
+void timer_wheel_remove_owner(gconstpointer owner)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	if (timers == NULL || owner == NULL)
+		return;
+
+	g_hash_table_iter_init(&iter, timers);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		WheelTimer *timer = value;
+
+		if (timer->owner != owner)
+			continue;
+		timer_unlink(timer);
+		g_hash_table_iter_remove(&iter);
+		if (timer->running)
+			timer->removed = TRUE;
+		else
+			g_free(timer);
+	}
+}
+
+void timer_wheel_foreach(gconstpointer owner, TimerWheelFunc func,
+			 gpointer user_data)
+{
+	GHashTableIter iter;
+	gpointer value;
+	gint64 now;
+
+	if (timers == NULL)
+		return;
+
+	now = now_tick();
+	g_hash_table_iter_init(&iter, timers);
+	while (g_hash_table_iter_next(&iter, NULL, &value)) {
+		WheelTimer *timer = value;
+
+		if (owner != NULL && timer->owner != owner)
+			continue;
+		func(timer->name != NULL ? timer->name : "unnamed",
+		     (guint) MAX(timer->due - now, 0), timer->interval,
+		     user_data);
+	}
+}
+
+guint timer_wheel_size(void)
+{
+	if (timers == NULL)
+		return 0;
+	return g_hash_table_size(timers);
+}
@@ -0,0 +1,78 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* A hierarchical timer wheel with a resolution of one second.
+ * All timers share a single GLib timeout, arming and cancelling a timer
+ * takes constant time and does not touch the main context.
+ */
+
+#ifndef __timer_wheel_h
+#define __timer_wheel_h
+
+#include <glib.h>
+
+/** Add a timer.
+ * @param interval Interval in seconds
+ * @param func Called when the timer expires.
+ *             Return TRUE to rearm the timer with the same interval.
+ * @param data The argument to func
+ * @return The identifier of the timer (never 0)
+ */
+guint timer_wheel_add(guint interval, GSourceFunc func, gpointer data);
+
+/** Add a timer that can be listed.
+ * @param interval Interval in seconds
+ * @param func Called when the timer expires.
+ *             Return TRUE to rearm the timer with the same interval.
+ * @param data The argument to func
+ * @param owner The object the timer belongs to, e.g. the Game, or NULL
+ * @param name A static description of the timer, or NULL
+ * @return The identifier of the timer (never 0)
+ */
+guint timer_wheel_add_full(guint interval, GSourceFunc func,
+			   gpointer data, gconstpointer owner,
+			   const gchar * name);
+
+/** Remove a timer.
+ * It is safe to remove a timer from within its own callback.
+ * @param id The identifier returned by timer_wheel_add
+ * @return TRUE if the timer was pending
+ */
+gboolean timer_wheel_remove(guint id);
+
+/** Remove all timers of an owner.
+ * @param owner The owner that was used in timer_wheel_add_full
+ */
+void timer_wheel_remove_owner(gconstpointer owner);
+
+typedef void (*TimerWheelFunc) (const gchar * name, guint remaining,
+				guint interval, gpointer user_data);
+
+/** Call a function for each pending timer.
+ * @param owner Only list the timers of this owner, or NULL for all timers
+ * @param func Called with the name, the remaining and the interval
+ *             in seconds
+ * @param user_data The last argument to func
+ */
+void timer_wheel_foreach(gconstpointer owner, TimerWheelFunc func,
+			 gpointer user_data);
+
+/** The number of pending timers */
+guint timer_wheel_size(void);
+
+#endif
@@ -44,6 +44,10 @@
 #include "common_gtk.h"
 #include "cards.h"
 #include "network.h"
+#include "map-edit.h"
+#include "map-balance.h"
+#include "random.h"
+#include "polygon.h"
 
 #define MAINICON_FILE "pioneers-editor.png"
 
@@ -53,6 +57,8 @@
 #define BUTTON_HEIGHT 24	/* height of the toolbar buttons */
 #define TERRAIN_BUTTON_WIDTH 27	/* width of the terrain toolbar buttons */
 
+#define MAX_UNDO 100		/* number of edits that can be undone */
+
 static GtkWidget *toplevel;
 static gchar *default_game;
 static gchar *window_title;
@@ -90,6 +96,15 @@ typedef enum {
 static GuiMap *gmap;
 static Hex *current_hex;
 
+static GtkActionGroup *menu_actions;
+static MapHistory *history;
+static MapBlock *clipboard;
+
+/* The selected block of hexes, in grid coordinates */
+static gboolean has_selection;
+static gboolean selecting;
+static gint selection_x1, selection_y1, selection_x2, selection_y2;
+
 typedef enum {
 	TERRAIN_TOOLBAR_BUTTON_TYPE,
 	CHIT_TOOLBAR_BUTTON_TYPE,
@@ -163,6 +178,7 @@ static const gchar *port_direction_names[] = {
 
 static void check_vp_cb(GObject * caller, gpointer main_window);
 static void set_window_title(const gchar * title);
+static void update_resize_buttons(void);
 
 static void error_dialog(const char *fmt, ...)
 {
@@ -252,6 +268,7 @@ static void change_terrain(Hex * hex, Terrain terrain)
 	if (terrain == hex->terrain)
 		return;
 
+	map_history_record_area(history, hex);
 	hex->terrain = terrain;
 	if (terrain_has_chit(terrain)) {
 		if (hex->roll == 0)
@@ -280,6 +297,212 @@ static void change_terrain(Hex * hex, Terrain terrain)
 	return;
 }
 
+static void update_edit_actions(void)
+{
+	if (menu_actions == NULL)
+		return;
+	gtk_action_set_sensitive(gtk_action_group_get_action
+				 (menu_actions, "Undo"),
+				 map_history_can_undo(history));
+	gtk_action_set_sensitive(gtk_action_group_get_action
+				 (menu_actions, "Redo"),
+				 map_history_can_redo(history));
+	gtk_action_set_sensitive(gtk_action_group_get_action
+				 (menu_actions, "Paste"), clipboard != NULL);
+}
+
+/** Starts an edit of the map that can be undone.
+ * The hexes must be recorded before they are changed.
+ */
+static void edit_begin(void)
+{
+	map_history_begin(history);
+}
+
+/** Finishes the edit of the map. */
+static void edit_end(void)
+{
+	map_history_end(history, gmap->map);
+	update_edit_actions();
+}
+
+static void redraw_hex_cb(const Hex * hex,
+			  G_GNUC_UNUSED gpointer user_data)
+{
+	guimap_draw_hex(gmap, hex);
+}
+
+/** Changes the terrain of the connected hexes with the same terrain.
+ * @param start The hex to start at.
+ * @param terrain The terrain to change the hex terrain to.
+ */
+static void fill_region(Hex * start, Terrain terrain)
+{
+	GQueue queue = G_QUEUE_INIT;
+	GHashTable *visited;
+	Terrain old_terrain = start->terrain;
+	Hex *hex;
+
+	if (old_terrain == terrain)
+		return;
+
+	/* Find the region before changing it */
+	visited = g_hash_table_new(NULL, NULL);
+	g_hash_table_insert(visited, start, start);
+	g_queue_push_tail(&queue, start);
+	edit_begin();
+	while ((hex = g_queue_pop_head(&queue)) != NULL) {
+		gint i;
+
+		for (i = 0; i < 6; i++) {
+			Hex *adjacent = hex_in_direction(hex, i);
+			if (adjacent != NULL
+			    && adjacent->terrain == old_terrain
+			    && g_hash_table_lookup(visited,
+						   adjacent) == NULL) {
+				g_hash_table_insert(visited, adjacent,
+						    adjacent);
+				g_queue_push_tail(&queue, adjacent);
+			}
+		}
+		change_terrain(hex, terrain);
+	}
+	edit_end();
+	g_hash_table_destroy(visited);
+}
+
+static void set_selection_end(Hex * hex)
+{
+	if (hex == NULL)
+		return;
+	selection_x2 = hex->x;
+	selection_y2 = hex->y;
+	gtk_widget_queue_draw(gmap->area);
+}
+
+static void clear_selection(void)
+{
+	has_selection = FALSE;
+	selecting = FALSE;
+	if (gmap->area != NULL)
+		gtk_widget_queue_draw(gmap->area);
+}
+
+/** Copies the selected hexes, or the hex under the cursor. */
+static void copy_hexes(void)
+{
+	Hex *hex;
+
+	if (gmap->map == NULL)
+		return;
+	if (clipboard != NULL)
+		map_block_free(clipboard);
+	clipboard = NULL;
+	if (has_selection) {
+		clipboard =
+		    map_block_copy(gmap->map, selection_x1, selection_y1,
+				   selection_x2, selection_y2);
+	} else {
+		hex = guimap_get_current_hex(gmap);
+		if (hex != NULL)
+			clipboard =
+			    map_block_copy(gmap->map, hex->x, hex->y,
+					   hex->x, hex->y);
+	}
+	update_edit_actions();
+}
+
+/** Pastes the copied hexes with their upper left corner under the
+ * cursor. */
+static void paste_hexes(void)
+{
+	Hex *hex;
+
+	if (clipboard == NULL || gmap->map == NULL)
+		return;
+	hex = guimap_get_current_hex(gmap);
+	if (hex == NULL)
+		return;
+	edit_begin();
+	map_block_paste(clipboard, gmap->map, hex->x, hex->y, history,
+			redraw_hex_cb, NULL);
+	edit_end();
+}
+
+/** Shows the result of undo or redo. */
+static void show_edit_result(MapEditResult result)
+{
+	if (result == MAP_EDIT_MAP) {
+		/* The size has changed */
+		current_hex = NULL;
+		clear_selection();
+		update_resize_buttons();
+	}
+	update_edit_actions();
+}
+
+/** Shuffles the terrain, the ports and the chits, and keeps the
+ * fairest of many shuffles. */
+static void shuffle_balanced_cb(void)
+{
+	if (gmap->map == NULL)
+		return;
+	edit_begin();
+	map_history_record_map(history, gmap->map);
+	map_shuffle_balanced(gmap->map, MAP_BALANCE_CANDIDATES);
+	/* The editor does not show the robber */
+	map_move_robber(gmap->map, -1, -1);
+	edit_end();
+	guimap_display(gmap);
+	gtk_widget_queue_draw(gmap->area);
+}
+
+static void undo_cb(void)
+{
+	show_edit_result(map_history_undo(history, &gmap->map,
+					  redraw_hex_cb, NULL));
+}
+
+static void redo_cb(void)
+{
+	show_edit_result(map_history_redo(history, &gmap->map,
+					  redraw_hex_cb, NULL));
+}
+
+/** Draws the selection on top of the map.
+ * @param widget The widget to draw on
+ * @param cr The cairo context
+ * @param user_data Not used
+ * @return FALSE, to draw the rest
+ */
+static gboolean draw_selection_cb(G_GNUC_UNUSED GtkWidget * widget,
+				  cairo_t * cr,
+				  G_GNUC_UNUSED gpointer user_data)
+{
+	GdkPoint points[6];
+	Polygon poly;
+	gint x, y;
+
+	if (!has_selection || gmap->map == NULL)
+		return FALSE;
+
+	cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.35);
+	for (y = MIN(selection_y1, selection_y2);
+	     y <= MAX(selection_y1, selection_y2); y++)
+		for (x = MIN(selection_x1, selection_x2);
+		     x <= MAX(selection_x1, selection_x2); x++) {
+			const Hex *hex = map_hex(gmap->map, x, y);
+
+			if (hex == NULL)
+				continue;
+			poly.points = points;
+			poly.num_points = G_N_ELEMENTS(points);
+			guimap_hex_polygon(gmap, hex, &poly);
+			poly_draw(cr, TRUE, &poly);
+		}
+	return FALSE;
+}
+
 /** Draws the chit in the exposed area.
  * @param widget The widget to draw on
  * @param cr The cairo context
@@ -657,16 +880,39 @@ static gint button_press_map_cb(GtkWidget * area,
 		gint distance_node;
 		gint distance_hex;
 
+		/* Control and drag selects a block of hexes */
+		if (event->state & GDK_CONTROL_MASK) {
+			has_selection = TRUE;
+			selecting = TRUE;
+			selection_x1 = current_hex->x;
+			selection_y1 = current_hex->y;
+			set_selection_end(current_hex);
+			return TRUE;
+		}
+
 		switch (selected_toolbar_button.type) {
 		case TERRAIN_TOOLBAR_BUTTON_TYPE:
+			/* Shift fills the region with the same terrain */
+			if (event->state & GDK_SHIFT_MASK) {
+				fill_region(current_hex,
+					    selected_toolbar_button.
+					    element.terrain);
+				return TRUE;
+			}
+			edit_begin();
 			change_terrain(current_hex,
 				       selected_toolbar_button.
 				       element.terrain);
+			edit_end();
 			return TRUE;
 		case CHIT_TOOLBAR_BUTTON_TYPE:
 			if (terrain_has_chit(current_hex->terrain)) {
+				edit_begin();
+				map_history_record_hex(history,
+						       current_hex);
 				current_hex->roll =
 				    selected_toolbar_button.element.chit;
+				edit_end();
 				guimap_draw_hex(gmap, current_hex);
 			}
 			return TRUE;
@@ -678,8 +924,12 @@ static gint button_press_map_cb(GtkWidget * area,
 				 */
 				if (selected_toolbar_button.element.port ==
 				    NO_RESOURCE) {
+					edit_begin();
+					map_history_record_hex(history,
+							       current_hex);
 					current_hex->resource =
 					    NO_RESOURCE;
+					edit_end();
 					guimap_draw_hex(gmap, current_hex);
 					return TRUE;
 				}
@@ -701,10 +951,14 @@ static gint button_press_map_cb(GtkWidget * area,
 				    && adjacent->terrain != LAST_TERRAIN
 				    && adjacent->terrain != SEA_TERRAIN) {
 					/* change hex resources and direction */
+					edit_begin();
+					map_history_record_hex(history,
+							       current_hex);
 					current_hex->facing = i;
 					current_hex->resource =
 					    selected_toolbar_button.
 					    element.port;
+					edit_end();
 					guimap_draw_hex(gmap, current_hex);
 				}
 			}
@@ -722,7 +976,14 @@ static gint button_press_map_cb(GtkWidget * area,
 		    guimap_distance_cursor(gmap, &element, MAP_HEX);
 
 		if (distance_node < distance_hex) {
+			edit_begin();
+			for (idx = 0;
+			     idx < G_N_ELEMENTS(current_node->hexes); idx++)
+				map_history_record_hex(history,
+						       current_node->hexes
+						       [idx]);
 			current_node->no_setup = !current_node->no_setup;
+			edit_end();
 			for (idx = 0;
 			     idx < G_N_ELEMENTS(current_node->hexes);
 			     idx++) {
@@ -777,6 +1038,40 @@ static gint button_press_map_cb(GtkWidget * area,
 	return TRUE;
 }
 
+static gboolean button_release_map_cb(G_GNUC_UNUSED GtkWidget * area,
+				      GdkEventButton * event,
+				      gpointer user_data)
+{
+	GuiMap *gmap = user_data;
+
+	if (event->button == 1 && selecting) {
+		selecting = FALSE;
+		gmap->last_x = event->x;
+		gmap->last_y = event->y;
+		set_selection_end(guimap_get_current_hex(gmap));
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static gboolean motion_notify_map_cb(G_GNUC_UNUSED GtkWidget * area,
+				     G_GNUC_UNUSED GdkEventMotion * event,
+				     gpointer user_data)
+{
+	GuiMap *gmap = user_data;
+	Hex *hex;
+
+	if (!selecting || gmap->map == NULL)
+		return FALSE;
+
+	/* The GuiMap has already updated the cursor position */
+	hex = guimap_get_current_hex(gmap);
+	if (hex != NULL
+	    && (hex->x != selection_x2 || hex->y != selection_y2))
+		set_selection_end(hex);
+	return FALSE;
+}
+
 static gint key_press_map_cb(GtkWidget * area, GdkEventKey * event,
 			     gpointer user_data)
 {
@@ -790,6 +1085,23 @@ static gint key_press_map_cb(GtkWidget * area, GdkEventKey * event,
 
 	get_mouse_position(area, &gmap->last_x, &gmap->last_y);
 
+	if (event->state & GDK_CONTROL_MASK) {
+		switch (event->keyval) {
+		case GDK_KEY_c:
+			copy_hexes();
+			return TRUE;
+		case GDK_KEY_v:
+			paste_hexes();
+			return TRUE;
+		default:
+			return FALSE;
+		}
+	}
+	if (event->keyval == GDK_KEY_Escape) {
+		clear_selection();
+		return TRUE;
+	}
+
 	last_hex = current_hex;
 	current_hex = guimap_get_current_hex(gmap);
 	if (current_hex == NULL || !terrain_has_chit(current_hex->terrain))
@@ -800,6 +1112,8 @@ static gint key_press_map_cb(GtkWidget * area, GdkEventKey * event,
 	else
 		plus10 = FALSE;
 
+	edit_begin();
+	map_history_record_hex(history, current_hex);
 	if (!plus10 && strcmp(event->string, "2") == 0)
 		current_hex->roll = 2;
 	else if (strcmp(event->string, "3") == 0)
@@ -820,6 +1134,7 @@ static gint key_press_map_cb(GtkWidget * area, GdkEventKey * event,
 		current_hex->roll = 11;
 	else if (plus10 && strcmp(event->string, "2") == 0)
 		current_hex->roll = 12;
+	edit_end();
 	guimap_draw_hex(gmap, current_hex);
 	g_free(last_key);
 	last_key = g_strdup(event->string);
@@ -883,6 +1198,8 @@ static void update_resize_buttons(void)
 static void change_height(G_GNUC_UNUSED GtkWidget * menu,
 			  gpointer user_data)
 {
+	edit_begin();
+	map_history_record_map(history, gmap->map);
 	switch (GPOINTER_TO_INT(user_data)) {
 	case RESIZE_REMOVE_BOTTOM:
 		map_modify_row_count(gmap->map, MAP_MODIFY_REMOVE,
@@ -901,12 +1218,16 @@ static void change_height(G_GNUC_UNUSED GtkWidget * menu,
 				     MAP_MODIFY_ROW_TOP);
 		break;
 	}
+	edit_end();
+	clear_selection();
 	update_resize_buttons();
 }
 
 static void change_width(G_GNUC_UNUSED GtkWidget * menu,
 			 gpointer user_data)
 {
+	edit_begin();
+	map_history_record_map(history, gmap->map);
 	switch (GPOINTER_TO_INT(user_data)) {
 	case RESIZE_REMOVE_RIGHT:
 		map_modify_column_count(gmap->map, MAP_MODIFY_REMOVE,
@@ -925,8 +1246,16 @@ static void change_width(G_GNUC_UNUSED GtkWidget * menu,
 					MAP_MODIFY_COLUMN_LEFT);
 		break;
 	}
+	edit_end();
+	clear_selection();
 	update_resize_buttons();
+}
 
+static void editor_theme_changed(void)
+{
+	/* The tiles have changed, draw the layers again */
+	guimap_discard_layers(gmap);
+	gtk_widget_queue_draw(gmap->area);
 }
 
 static GtkWidget *build_map(void)
@@ -943,13 +1272,20 @@ static GtkWidget *build_map(void)
 	gtk_widget_set_can_focus(area, TRUE);
 	gtk_widget_add_events(gmap->area, GDK_ENTER_NOTIFY_MASK
 			      | GDK_BUTTON_PRESS_MASK
+			      | GDK_BUTTON_RELEASE_MASK
 			      | GDK_KEY_PRESS_MASK);
 	g_signal_connect(G_OBJECT(gmap->area), "enter_notify_event",
 			 G_CALLBACK(enter_notify_map_cb), gmap);
 	g_signal_connect(G_OBJECT(gmap->area), "button_press_event",
 			 G_CALLBACK(button_press_map_cb), gmap);
+	g_signal_connect(G_OBJECT(gmap->area), "button_release_event",
+			 G_CALLBACK(button_release_map_cb), gmap);
+	g_signal_connect(G_OBJECT(gmap->area), "motion_notify_event",
+			 G_CALLBACK(motion_notify_map_cb), gmap);
 	g_signal_connect(G_OBJECT(gmap->area), "key_press_event",
 			 G_CALLBACK(key_press_map_cb), gmap);
+	g_signal_connect_after(G_OBJECT(gmap->area), "draw",
+			       G_CALLBACK(draw_selection_cb), NULL);
 	gtk_grid_attach(GTK_GRID(grid), gmap->area, 0, 1, 1, 1);
 	gtk_widget_set_hexpand(gmap->area, TRUE);
 	gtk_widget_set_vexpand(gmap->area, TRUE);
@@ -960,6 +1296,7 @@ static GtkWidget *build_map(void)
 	build_map_resize(grid, 0, 2, GTK_ORIENTATION_HORIZONTAL,
 			 hresize_buttons, G_CALLBACK(change_width));
 
+	theme_register_callback(G_CALLBACK(editor_theme_changed));
 	return grid;
 }
 
@@ -1032,7 +1369,9 @@ static gint select_terrain_cb(G_GNUC_UNUSED GtkWidget * menu,
 			      gpointer user_data)
 {
 	Terrain terrain = GPOINTER_TO_INT(user_data);
+	edit_begin();
 	change_terrain(current_hex, terrain);
+	edit_end();
 	return TRUE;
 }
 
@@ -1071,11 +1410,7 @@ static GtkWidget *build_terrain_menu(void)
 			width = height * theme->scaledata[i].aspect;
 		}
 
-		pixbuf =
-		    gdk_pixbuf_scale_simple(theme->
-					    scaledata[i].native_image,
-					    width, height,
-					    GDK_INTERP_BILINEAR);
+		pixbuf = theme_scale_tile(theme, i, width, height);
 
 		image = gtk_image_new_from_pixbuf(pixbuf);
 		gtk_image_menu_item_set_image(GTK_IMAGE_MENU_ITEM(item),
@@ -1090,7 +1425,10 @@ static void select_roll_cb(GtkCheckMenuItem * menu_item,
 			   gpointer user_data)
 {
 	if (gtk_check_menu_item_get_active(menu_item)) {
+		edit_begin();
+		map_history_record_hex(history, current_hex);
 		current_hex->roll = GPOINTER_TO_INT(user_data);
+		edit_end();
 		guimap_draw_hex(gmap, current_hex);
 	}
 }
@@ -1098,7 +1436,10 @@ static void select_roll_cb(GtkCheckMenuItem * menu_item,
 static void select_shuffle_cb(GtkCheckMenuItem * menu_item,
 			      G_GNUC_UNUSED gpointer user_data)
 {
+	edit_begin();
+	map_history_record_hex(history, current_hex);
 	current_hex->shuffle = gtk_check_menu_item_get_active(menu_item);
+	edit_end();
 }
 
 static GtkWidget *build_roll_menu(void)
@@ -1171,6 +1512,8 @@ static gint select_port_resource_cb(G_GNUC_UNUSED GtkWidget * menu,
 {
 	gint i;
 
+	edit_begin();
+	map_history_record_hex(history, current_hex);
 	if (current_hex->resource == NO_RESOURCE) {
 		for (i = 0; i < 6; i++) {
 			const Hex *adjacent;
@@ -1185,6 +1528,7 @@ static gint select_port_resource_cb(G_GNUC_UNUSED GtkWidget * menu,
 		}
 	}
 	current_hex->resource = GPOINTER_TO_INT(user_data);
+	edit_end();
 	guimap_draw_hex(gmap, current_hex);
 	return TRUE;
 }
@@ -1193,7 +1537,10 @@ static void select_port_direction_cb(GtkCheckMenuItem * menu_item,
 				     gpointer user_data)
 {
 	if (gtk_check_menu_item_get_active(menu_item)) {
+		edit_begin();
+		map_history_record_hex(history, current_hex);
 		current_hex->facing = GPOINTER_TO_INT(user_data);
+		edit_end();
 		guimap_draw_hex(gmap, current_hex);
 	}
 }
@@ -1487,6 +1834,9 @@ static void load_game(const gchar * file, gboolean is_reload)
 	open_filename = new_filename;
 	map_move_robber(gmap->map, -1, -1);
 	fill_map(gmap->map);
+	map_history_clear(history);
+	clear_selection();
+	update_edit_actions();
 	if (is_reload) {
 		scale_map(gmap);
 		guimap_display(gmap);
@@ -1736,6 +2086,9 @@ static GtkActionEntry entries[] = {
 	{"FileMenu", NULL,
 	 /* Menu entry */
 	 N_("_File"), NULL, NULL, NULL},
+	{"EditMenu", NULL,
+	 /* Menu entry */
+	 N_("_Edit"), NULL, NULL, NULL},
 	{"ViewMenu", NULL,
 	 /* Menu entry */
 	 N_("_View"), NULL, NULL, NULL},
@@ -1780,6 +2133,36 @@ static GtkActionEntry entries[] = {
 	 /* Tooltip for Quit menu entry */
 	 N_("Quit"), exit_cb},
 
+	{"Undo", NULL,
+	 /* Menu entry */
+	 N_("_Undo"), "<control>Z",
+	 /* Tooltip for Undo menu entry */
+	 N_("Undo the last change of the map"), undo_cb},
+	{"Redo", NULL,
+	 /* Menu entry */
+	 N_("_Redo"), "<control>Y",
+	 /* Tooltip for Redo menu entry */
+	 N_("Redo the last undone change of the map"), redo_cb},
+	{"Copy", NULL,
+	 /* Menu entry */
+	 N_("_Copy Hexes"), NULL,
+	 /* Tooltip for Copy Hexes menu entry */
+	 N_("Copy the selected hexes (Control+C on the map, "
+	    "select with Control and drag)"), copy_hexes},
+	{"Paste", NULL,
+	 /* Menu entry */
+	 N_("_Paste Hexes"), NULL,
+	 /* Tooltip for Paste Hexes menu entry */
+	 N_("Paste the hexes at the cursor (Control+V on the map)"),
+	 paste_hexes},
+	{"ShuffleBalanced", NULL,
+	 /* Menu entry */
+	 N_("_Balanced Shuffle"), NULL,
+	 /* Tooltip for Balanced Shuffle menu entry */
+	 N_("Shuffle the hexes, the ports and the numbers, "
+	    "and keep the fairest of many shuffles"),
+	 shuffle_balanced_cb},
+
 	{"Full", NULL,
 	 /* Menu entry */
 	 N_("_Reset"),
@@ -1830,6 +2213,15 @@ static const char *ui_description =
 "      <separator/>"
 "      <menuitem action='Quit'/>"
 "    </menu>"
+"    <menu action='EditMenu'>"
+"      <menuitem action='Undo'/>"
+"      <menuitem action='Redo'/>"
+"      <separator/>"
+"      <menuitem action='Copy'/>"
+"      <menuitem action='Paste'/>"
+"      <separator/>"
+"      <menuitem action='ShuffleBalanced'/>"
+"    </menu>"
 "    <menu action='ViewMenu'>"
 "      <menuitem action='FullScreen'/>"
 "      <menuitem action='Full'/>"
@@ -1928,6 +2320,9 @@ int main(int argc, char *argv[])
 	gtk_action_group_add_toggle_actions(action_group, toggle_entries,
 					    G_N_ELEMENTS(toggle_entries),
 					    toplevel);
+	menu_actions = action_group;
+	history = map_history_new(MAX_UNDO);
+	random_init();
 
 	ui_manager = gtk_ui_manager_new();
 	gtk_ui_manager_insert_action_group(ui_manager, action_group, 0);
@@ -2003,6 +2398,9 @@ int main(int argc, char *argv[])
 
 	config_finish();
 	guimap_delete(gmap);
+	map_history_free(history);
+	if (clipboard != NULL)
+		map_block_free(clipboard);
 	g_free(default_game);
 
 	g_option_context_free(context);
@@ -0,0 +1,417 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "config.h"
+#include "game.h"
+#include "map-edit.h"
+
+/* The part of a hex that can be edited */
+typedef struct {
+	gboolean present;	/* FALSE when there is no hex */
+	Terrain terrain;
+	gint roll;
+	Resource resource;
+	gint facing;
+	gboolean shuffle;
+	guint no_setup;		/* one bit per node */
+} HexState;
+
+typedef struct {
+	gint x;
+	gint y;
+	HexState before;
+	HexState after;
+} HexDelta;
+
+typedef struct {
+	GArray *deltas;		/* HexDelta */
+	Map *before;		/* when the size was changed */
+	Map *after;
+} MapEdit;
+
+struct _MapHistory {
+	GQueue undo;		/* MapEdit, the last edit first */
+	GQueue redo;		/* MapEdit, the last undone edit first */
+	guint max_edits;
+	gboolean recording;
+	GHashTable *recorded;	/* position -> HexState */
+	Map *recorded_map;
+};
+
+struct _MapBlock {
+	gint width;
+	gint height;
+	HexState *cells;	/* width * height, by row */
+};
+
+#define POSITION_KEY(x, y) GINT_TO_POINTER((y) * MAP_SIZE + (x) + 1)
+#define POSITION_X(key) ((GPOINTER_TO_INT(key) - 1) % MAP_SIZE)
+#define POSITION_Y(key) ((GPOINTER_TO_INT(key) - 1) / MAP_SIZE)
+
+static void hex_get_state(const Hex * hex, HexState * state)
+{
+	guint idx;
+
+	if (hex == NULL) {
+		state->present = FALSE;
+		return;
+	}
+	state->present = TRUE;
+	state->terrain = hex->terrain;
+	state->roll = hex->roll;
+	state->resource = hex->resource;
+	state->facing = hex->facing;
+	state->shuffle = hex->shuffle;
+	state->no_setup = 0;
+	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++)
+		if (hex->nodes[idx] != NULL && hex->nodes[idx]->no_setup)
+			state->no_setup |= 1 << idx;
+}
+
+static void hex_set_state(Hex * hex, const HexState * state)
+{
+	guint idx;
+
+	hex->terrain = state->terrain;
+	hex->roll = state->roll;
+	hex->resource = state->resource;
+	hex->facing = state->facing;
+	hex->shuffle = state->shuffle;
+	for (idx = 0; idx < G_N_ELEMENTS(hex->nodes); idx++)
+		if (hex->nodes[idx] != NULL)
+			hex->nodes[idx]->no_setup =
+			    (state->no_setup & (1 << idx)) != 0;
+}
+
+static gboolean hex_state_equal(const HexState * a, const HexState * b)
+{
+	if (a->present != b->present)
+		return FALSE;
+	if (!a->present)
+		return TRUE;
+	return a->terrain == b->terrain && a->roll == b->roll
+	    && a->resource == b->resource && a->facing == b->facing
+	    && a->shuffle == b->shuffle && a->no_setup == b->no_setup;
+}
+
+static void map_edit_free(MapEdit * edit)
+{
+	if (edit->deltas != NULL)
+		g_array_free(edit->deltas, TRUE);
+	if (edit->before != NULL)
+		map_free(edit->before);
+	if (edit->after != NULL)
+		map_free(edit->after);
+	g_free(edit);
+}
+
+static void edit_queue_clear(GQueue * queue)
+{
+	MapEdit *edit;
+
+	while ((edit = g_queue_pop_head(queue)) != NULL)
+		map_edit_free(edit);
+}
+
+MapHistory *map_history_new(guint max_edits)
+{
+	MapHistory *history;
+
+	history = g_malloc0(sizeof(*history));
+	g_queue_init(&history->undo);
+	g_queue_init(&history->redo);
+	history->max_edits = MAX(max_edits, 1);
+	history->recorded =
+	    g_hash_table_new_full(NULL, NULL, NULL, g_free);
+	return history;
+}
+
+void map_history_free(MapHistory * history)
+{
+	map_history_clear(history);
+	g_hash_table_destroy(history->recorded);
+	g_free(history);
+}
+
+void map_history_clear(MapHistory * history)
+{
+	edit_queue_clear(&history->undo);
+	edit_queue_clear(&history->redo);
+	g_hash_table_remove_all(history->recorded);
+	if (history->recorded_map != NULL) {
+		map_free(history->recorded_map);
+		history->recorded_map = NULL;
+	}
+	history->recording = FALSE;
+}
+
+void map_history_begin(MapHistory * history)
+{
+	g_return_if_fail(!history->recording);
+	history->recording = TRUE;
+}
+
+void map_history_record_hex(MapHistory * history, const Hex * hex)
+{
+	HexState *state;
+	gpointer key;
+
+	g_return_if_fail(history->recording);
+	if (hex == NULL || history->recorded_map != NULL)
+		return;
+
+	key = POSITION_KEY(hex->x, hex->y);
+	if (g_hash_table_lookup(history->recorded, key) != NULL)
+		return;
+	state = g_malloc(sizeof(*state));
+	hex_get_state(hex, state);
+	g_hash_table_insert(history->recorded, key, state);
+}
+
+void map_history_record_area(MapHistory * history, const Hex * hex)
+{
+	gint direction;
+
+	if (hex == NULL)
+		return;
+	map_history_record_hex(history, hex);
+	for (direction = 0; direction < 6; direction++)
+		map_history_record_hex(history,
+				       hex_in_direction(hex, direction));
+}
+
+void map_history_record_map(MapHistory * history, const Map * map)
+{
+	g_return_if_fail(history->recording);
+	if (history->recorded_map == NULL)
+		history->recorded_map = map_copy(map);
+}
+
+void map_history_end(MapHistory * history, const Map * map)
+{
+	MapEdit *edit;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	g_return_if_fail(history->recording);
+	history->recording = FALSE;
+
+	edit = g_malloc0(sizeof(*edit));
+	if (history->recorded_map != NULL) {
+		edit->before = history->recorded_map;
+		edit->after = map_copy(map);
+		history->recorded_map = NULL;
+	} else {
+		edit->deltas = g_array_new(FALSE, FALSE, sizeof(HexDelta));
+		g_hash_table_iter_init(&iter, history->recorded);
+		while (g_hash_table_iter_next(&iter, &key, &value)) {
+			HexDelta delta;
+
+			delta.x = POSITION_X(key);
+			delta.y = POSITION_Y(key);
+			delta.before = *(HexState *) value;
+			hex_get_state(map_hex_const(map, delta.x, delta.y),
+				      &delta.after);
+			if (!hex_state_equal(&delta.before, &delta.after))
+				g_array_append_val(edit->deltas, delta);
+		}
+		if (edit->deltas->len == 0) {
+			map_edit_free(edit);
+			edit = NULL;
+		}
+	}
+	g_hash_table_remove_all(history->recorded);
+
+	if (edit == NULL)
+		return;
+	g_queue_push_head(&history->undo, edit);
+	while (g_queue_get_length(&history->undo) > history->max_edits)
+		map_edit_free(g_queue_pop_tail(&history->undo));
+	edit_queue_clear(&history->redo);
+}
+
+gboolean map_history_can_undo(const MapHistory * history)
+{
+	return !g_queue_is_empty(&history->undo);
+}
+
+gboolean map_history_can_redo(const MapHistory * history)
+{
+	return !g_queue_is_empty(&history->redo);
+}
+
+/* Apply one side of an edit */
+static MapEditResult map_edit_apply(const MapEdit * edit, gboolean undo,
+				    Map ** map, MapEditHexFunc func,
+				    gpointer user_data)
+{
+	guint idx;
+
+	if (edit->deltas == NULL) {
+		map_free(*map);
+		*map = map_copy(undo ? edit->before : edit->after);
+		return MAP_EDIT_MAP;
+	}
+
+	for (idx = 0; idx < edit->deltas->len; idx++) {
+		const HexDelta *delta =
+		    &g_array_index(edit->deltas, HexDelta, idx);
+		const HexState *state = undo ? &delta->before : &delta->after;
+		Hex *hex = map_hex(*map, delta->x, delta->y);
+
+		if (hex != NULL && state->present)
+			hex_set_state(hex, state);
+	}
+	/* Report the hexes after all of them are set, nodes are shared */
+	for (idx = 0; idx < edit->deltas->len; idx++) {
+		const HexDelta *delta =
+		    &g_array_index(edit->deltas, HexDelta, idx);
+		Hex *hex = map_hex(*map, delta->x, delta->y);
+
+		if (hex != NULL && func != NULL)
+			func(hex, user_data);
+	}
+	return MAP_EDIT_HEXES;
+}
+
+MapEditResult map_history_undo(MapHistory * history, Map ** map,
+			       MapEditHexFunc func, gpointer user_data)
+{
+	MapEdit *edit;
+	MapEditResult result;
+
+	g_return_val_if_fail(!history->recording, MAP_EDIT_NONE);
+
+	edit = g_queue_pop_head(&history->undo);
+	if (edit == NULL)
+		return MAP_EDIT_NONE;
+	result = map_edit_apply(edit, TRUE, map, func, user_data);
+	g_queue_push_head(&history->redo, edit);
+	return result;
+}
+
+MapEditResult map_history_redo(MapHistory * history, Map ** map,
+			       MapEditHexFunc func, gpointer user_data)
+{
+	MapEdit *edit;
+	MapEditResult result;
+
+	g_return_val_if_fail(!history->recording, MAP_EDIT_NONE);
+
+	edit = g_queue_pop_head(&history->redo);
+	if (edit == NULL)
+		return MAP_EDIT_NONE;
+	result = map_edit_apply(edit, FALSE, map, func, user_data);
+	g_queue_push_head(&history->undo, edit);
+	return result;
+}
+
+MapBlock *map_block_copy(const Map * map, gint x1, gint y1, gint x2,
+			 gint y2)
+{
+	MapBlock *block;
+	gint x;
+	gint y;
+
+	block = g_malloc(sizeof(*block));
+	block->width = ABS(x2 - x1) + 1;
+	block->height = ABS(y2 - y1) + 1;
+	block->cells = g_new(HexState, block->width * block->height);
+	for (y = 0; y < block->height; y++)
+		for (x = 0; x < block->width; x++)
+			hex_get_state(map_hex_const
+				      (map, MIN(x1, x2) + x,
+				       MIN(y1, y2) + y),
+				      &block->cells[y * block->width + x]);
+	return block;
+}
+
+void map_block_free(MapBlock * block)
+{
+	g_free(block->cells);
+	g_free(block);
+}
+
+/* Add the hex to the list, once */
+static void add_changed(GPtrArray * changed, GHashTable * seen, Hex * hex)
+{
+	if (hex == NULL || g_hash_table_lookup(seen, hex) != NULL)
+		return;
+	g_hash_table_insert(seen, hex, hex);
+	g_ptr_array_add(changed, hex);
+}
+
+static gboolean is_land(const Hex * hex)
+{
+	return hex != NULL && hex->terrain != SEA_TERRAIN
+	    && hex->terrain != LAST_TERRAIN;
+}
+
+void map_block_paste(const MapBlock * block, Map * map, gint x, gint y,
+		     MapHistory * history, MapEditHexFunc func,
+		     gpointer user_data)
+{
+	GPtrArray *changed;
+	GHashTable *seen;
+	gint block_x;
+	gint block_y;
+	guint idx;
+
+	changed = g_ptr_array_new();
+	seen = g_hash_table_new(NULL, NULL);
+	for (block_y = 0; block_y < block->height; block_y++)
+		for (block_x = 0; block_x < block->width; block_x++) {
+			const HexState *state =
+			    &block->cells[block_y * block->width +
+					  block_x];
+			Hex *hex = map_hex(map, x + block_x, y + block_y);
+			gint direction;
+
+			if (hex == NULL || !state->present)
+				continue;
+			if (history != NULL)
+				map_history_record_area(history, hex);
+			hex_set_state(hex, state);
+
+			/* The hex and its neighbours can need a redraw */
+			add_changed(changed, seen, hex);
+			for (direction = 0; direction < 6; direction++)
+				add_changed(changed, seen,
+					    hex_in_direction(hex, direction));
+		}
+
+	/* Remove the ports that do not face land anymore */
+	for (idx = 0; idx < changed->len; idx++) {
+		Hex *hex = g_ptr_array_index(changed, idx);
+
+		if (hex->resource != NO_RESOURCE
+		    && (hex->terrain != SEA_TERRAIN
+			|| !is_land(hex_in_direction(hex, hex->facing)))) {
+			hex->resource = NO_RESOURCE;
+			hex->facing = 0;
+		}
+	}
+
+	if (func != NULL)
+		for (idx = 0; idx < changed->len; idx++)
+			func(g_ptr_array_index(changed, idx), user_data);
+
+	g_hash_table_destroy(seen);
+	g_ptr_array_free(changed, TRUE);
+}
@@ -0,0 +1,121 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Undoable edits of the map in the editor.
+ * An edit records the hexes it is about to change. When the edit ends,
+ * only the hexes that really changed are kept, as a before and after
+ * state per hex. Edits that change the size of the map keep a copy of
+ * the map instead, because all coordinates can shift.
+ */
+
+#ifndef __map_edit_h
+#define __map_edit_h
+
+#include "map.h"
+
+typedef struct _MapHistory MapHistory;
+
+/* A rectangular block of hexes, for copy and paste */
+typedef struct _MapBlock MapBlock;
+
+/* Called for each hex that was changed by undo or redo */
+typedef void (*MapEditHexFunc) (const Hex * hex, gpointer user_data);
+
+typedef enum {
+	MAP_EDIT_NONE,		/* nothing was undone or redone */
+	MAP_EDIT_HEXES,		/* some hexes changed */
+	MAP_EDIT_MAP		/* the map was replaced */
+} MapEditResult;
+
+/** Create an empty history.
+ * @param max_edits The maximum number of edits that can be undone
+ */
+MapHistory *map_history_new(guint max_edits);
+void map_history_free(MapHistory * history);
+
+/** Forget all edits, e.g. when another map is loaded */
+void map_history_clear(MapHistory * history);
+
+/** Start an edit. Edits do not nest. */
+void map_history_begin(MapHistory * history);
+
+/** Remember the state of a hex before it is changed.
+ * Recording a hex more than once in the same edit is allowed.
+ * @param history The history
+ * @param hex The hex, or NULL
+ */
+void map_history_record_hex(MapHistory * history, const Hex * hex);
+
+/** Remember a hex and its neighbours before they are changed */
+void map_history_record_area(MapHistory * history, const Hex * hex);
+
+/** Remember the whole map, before its size is changed */
+void map_history_record_map(MapHistory * history, const Map * map);
+
+/** Finish the edit. Edits without changes are not kept.
+ * @param history The history
+ * @param map The changed map
+ */
+void map_history_end(MapHistory * history, const Map * map);
+
+gboolean map_history_can_undo(const MapHistory * history);
+gboolean map_history_can_redo(const MapHistory * history);
+
+/** Undo the last edit.
+ * @param history The history
+ * @param map The map, it is replaced when the edit changed its size
+ * @param func Called for each hex that changed
+ * @param user_data Passed to func
+ * @return What has been changed
+ */
+MapEditResult map_history_undo(MapHistory * history, Map ** map,
+			       MapEditHexFunc func, gpointer user_data);
+
+/** Redo the last undone edit, see map_history_undo */
+MapEditResult map_history_redo(MapHistory * history, Map ** map,
+			       MapEditHexFunc func, gpointer user_data);
+
+/** Copy the hexes in a rectangle of the grid.
+ * @param map The map
+ * @param x1 A column of one corner
+ * @param y1 A row of one corner
+ * @param x2 A column of the opposite corner
+ * @param y2 A row of the opposite corner
+ * @return The block, free it with map_block_free
+ */
+MapBlock *map_block_copy(const Map * map, gint x1, gint y1, gint x2,
+			 gint y2);
+void map_block_free(MapBlock * block);
+
+/** Paste a block with its upper left corner at a hex.
+ * The hexes that are changed are recorded in the history first,
+ * hexes outside the map are skipped. Ports that no longer face land
+ * are removed.
+ * @param block The block
+ * @param map The map
+ * @param x The column of the upper left corner
+ * @param y The row of the upper left corner
+ * @param history The history to record the changes in, or NULL
+ * @param func Called for each hex that changed
+ * @param user_data Passed to func
+ */
+void map_block_paste(const MapBlock * block, Map * map, gint x, gint y,
+		     MapHistory * history, MapEditHexFunc func,
+		     gpointer user_data);
+
+#endif
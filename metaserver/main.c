@@ -87,6 +87,7 @@ static gchar *pidfile = NULL;
 static gchar *port_range = NULL;
 static gboolean enable_debug = FALSE;
 static gboolean enable_syslog_debug = FALSE;
+static gchar *log_format = NULL;
 static gboolean show_version = FALSE;
 
 static void log_to_syslog(gint msg_type, const gchar * text)
@@ -182,20 +183,18 @@ static void client_list_servers(Client * client)
 	}
 }
 
-/** Send the title and free the associated memory. */
+/** Send the title. */
 static void client_send_type(gpointer data, gpointer user_data)
 {
-	GameParams *params = data;
+	const gchar *title = data;
 	Session *ses = user_data;
 
-	if (!params_game_is_unstartable(params)) {
-		net_printf(ses, "title=%s\n", params->title);
-	}
+	net_printf(ses, "title=%s\n", title);
 }
 
 static void client_list_types(Client * client)
 {
-	game_list_foreach(client_send_type, client->session);
+	game_list_foreach_title(client_send_type, TRUE, client->session);
 }
 
 static void client_list_capability(Session * ses)
@@ -632,6 +631,10 @@ static GOptionEntry commandline_entries[] = {
 	{"syslog-debug", '\0', 0, G_OPTION_ARG_NONE, &enable_syslog_debug,
 	 /* Commandline option of metaserver: syslog-debug */
 	 N_("Debug syslog messages"), NULL},
+	{"log-format", '\0', 0, G_OPTION_ARG_STRING, &log_format,
+	 /* Commandline option of metaserver: asynchronous logging */
+	 N_("Write the log from a background thread, as text or json"),
+	 "text|json"},
 	{"version", '\0', 0, G_OPTION_ARG_NONE, &show_version,
 	 /* Commandline option of metaserver: version */
 	 N_("Show version information"), NULL},
@@ -696,6 +699,18 @@ int main(int argc, char *argv[])
 	}
 	log_set_func(log_to_syslog);
 	set_enable_debug(enable_debug);
+	if (log_format != NULL) {
+		LogFormat format;
+
+		if (!log_format_from_name(log_format, &format)) {
+			g_print("Unknown log format: %s\n", log_format);
+			return 1;
+		}
+		if (!log_start_async(format))
+			log_message(MSG_ERROR,
+				    "The log can not be written from a "
+				    "background thread");
+	}
 
 	if (port_range) {
 		gint count;
@@ -761,5 +776,7 @@ int main(int argc, char *argv[])
 	game_list_cleanup();
 
 	net_finish();
+	log_stop_async();
+	g_free(log_format);
 	return 0;
 }
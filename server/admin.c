@@ -66,7 +66,9 @@ typedef enum {
 	GETBANK,
 	SETBANK,
 	GETASSETS,
-	SETASSETS
+	SETASSETS,
+	GETTIMERS,
+	STATS
 } AdminCommandType;
 
 typedef enum {
@@ -109,9 +111,93 @@ static AdminCommand admin_commands[] = {
 	{ SETBANK,             "set-bank",            TRUE,  FALSE, NEEDGAME   },
 	{ GETASSETS,           "get-assets",          TRUE,  FALSE, NEEDGAME   },
 	{ SETASSETS,           "set-assets",          TRUE,  FALSE, NEEDGAME   },
+	{ GETTIMERS,           "get-timers",          FALSE, FALSE, NEEDGAME   },
+	{ STATS,               "stats",               FALSE, FALSE, NONEED     },
 };
 /* *INDENT-ON* */
 
+typedef struct {
+	Session *admin_session;
+	guint count;
+} TimerListing;
+
+static void admin_print_timer(const gchar * name, guint remaining,
+			      guint interval, gpointer user_data)
+{
+	TimerListing *listing = user_data;
+
+	net_printf(listing->admin_session,
+		   "INFO timer %s in %u interval %u\n", name, remaining,
+		   interval);
+	listing->count++;
+}
+
+/* Append the bytes received or sent for each session of the game */
+static void admin_append_traffic(GString * str, Game * game,
+				 gboolean received)
+{
+	const gchar *name =
+	    received ? "pioneers_session_received_bytes_total"
+	    : "pioneers_session_sent_bytes_total";
+	Player *player;
+	guint idx = 0;
+
+	metrics_append_header(str, name,
+			      received ? "Bytes received from a player" :
+			      "Bytes sent to a player", "counter");
+	while ((player = player_iterate(game, &idx)) != NULL) {
+		Session *ses = sm_get_session(player->sm);
+		guint64 bytes_in;
+		guint64 bytes_out;
+
+		if (ses == NULL)
+			continue;
+		net_get_traffic(ses, &bytes_in, &bytes_out);
+		g_string_append_printf(str,
+				       "%s{player=\"%d\"} %" G_GUINT64_FORMAT
+				       "\n", name, player->num,
+				       received ? bytes_in : bytes_out);
+	}
+}
+
+/* Send the metrics in the Prometheus text format */
+static void admin_print_stats(Session * admin_session)
+{
+	GString *str = g_string_new(NULL);
+
+	metrics_export(str);
+	metrics_append_header(str, "pioneers_log_dropped_total",
+			      "Log messages dropped by the background writer",
+			      "counter");
+	g_string_append_printf(str, "pioneers_log_dropped_total %u\n",
+			       log_get_dropped());
+
+	if (*admin_game != NULL) {
+		Player *player;
+
+		admin_append_traffic(str, *admin_game, TRUE);
+		admin_append_traffic(str, *admin_game, FALSE);
+
+		metrics_append_header(str, "pioneers_turn_duration_seconds",
+				      "Duration of the turns of a player",
+				      "histogram");
+		for (player = player_first_real(*admin_game);
+		     player != NULL; player = player_next_real(player)) {
+			gchar *num;
+
+			num = g_strdup_printf("%d", player->num);
+			metrics_append_histogram(str,
+						 "pioneers_turn_duration_seconds",
+						 "player", num,
+						 &player->turn_duration);
+			g_free(num);
+		}
+	}
+
+	net_write(admin_session, str->str);
+	g_string_free(str, TRUE);
+}
+
 /* parse 'line' and run the command requested */
 static void admin_run_command(Session * admin_session, const gchar * line)
 {
@@ -304,7 +390,7 @@ static void admin_run_command(Session * admin_session, const gchar * line)
 					   params->victory_points);
 				net_printf(admin_session,
 					   "INFO random-terrain %d\n",
-					   params->random_terrain);
+					   cfg_get_terrain_type(params));
 				net_printf(admin_session,
 					   "INFO sevens-rule %d\n",
 					   params->sevens_rule);
@@ -315,13 +401,14 @@ static void admin_run_command(Session * admin_session, const gchar * line)
 					net_printf(admin_session, "%s", s);
 					g_free(s);
 
-					playerlist_inc_use_count
-					    (*admin_game);
-					GList *player =
-					    player_first_real(*admin_game);
-					while (player) {
-						Player *p = (Player *)
-						    player->data;
+					Player *p;
+					guint idx = 0;
+					while ((p =
+						player_iterate(*admin_game,
+							       &idx)) !=
+					       NULL) {
+						if (p->num < 0)
+							continue;
 						if (player_is_spectator
 						    (*admin_game,
 						     p->num)) {
@@ -337,12 +424,7 @@ static void admin_run_command(Session * admin_session, const gchar * line)
 						net_printf(admin_session,
 							   "%s", s);
 						g_free(s);
-						player =
-						    player_next_real
-						    (player);
 					}
-					playerlist_dec_use_count
-					    (*admin_game);
 				}
 			} else {
 				net_printf(admin_session,
@@ -438,6 +520,23 @@ static void admin_run_command(Session * admin_session, const gchar * line)
 
 			}
 			break;
+		case GETTIMERS:{
+				TimerListing listing;
+
+				/* Only the timers of the game are counted */
+				listing.admin_session = admin_session;
+				listing.count = 0;
+				timer_wheel_foreach(*admin_game,
+						    admin_print_timer,
+						    &listing);
+				net_printf(admin_session,
+					   "INFO timers pending %u\n",
+					   listing.count);
+				break;
+			}
+		case STATS:
+			admin_print_stats(admin_session);
+			break;
 		}
 	}
 	g_free(command);
@@ -31,8 +31,15 @@ void check_longest_road(Game * game)
 	guint longest_length;
 	gboolean tie;
 	guint i;
+	gint64 start;
 
+	start = metrics_start();
 	map_longest_road(map, road_length, game->params->num_players);
+	if (start != 0)
+		metrics_histogram_since(metrics_histogram
+					("pioneers_longest_road_duration_seconds",
+					 "Time to compute the longest road",
+					 NULL, NULL), start);
 
 	num_have_longest = -1;
 	longest_length = 0;
@@ -286,7 +286,7 @@ gboolean mode_monopoly(Player * player, gint event)
 {
 	StateMachine *sm = player->sm;
 	Game *game = player->game;
-	GList *list;
+	Player *scan;
 	Resource type;
 
 	sm_state_name(sm, "mode_monopoly");
@@ -298,10 +298,8 @@ gboolean mode_monopoly(Player * player, gint event)
 
 	/* Now inform the various parties of the monopoly.
 	 */
-	for (list = player_first_real(game);
-	     list != NULL; list = player_next_real(list)) {
-		Player *scan = list->data;
-
+	for (scan = player_first_real(game);
+	     scan != NULL; scan = player_next_real(scan)) {
 		if (scan == player)
 			continue;
 
@@ -323,14 +321,12 @@ gboolean mode_monopoly(Player * player, gint event)
 
 static void check_largest_army(Game * game)
 {
-	GList *list;
+	Player *player;
 	Player *new_largest;
 
 	new_largest = NULL;
-	for (list = player_first_real(game);
-	     list != NULL; list = player_next_real(list)) {
-		Player *player = list->data;
-
+	for (player = player_first_real(game);
+	     player != NULL; player = player_next_real(player)) {
 		/* Only 3 or more soldiers can earn largest army
 		 */
 		if (player->num_soldiers < 3)
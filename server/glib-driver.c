@@ -55,17 +55,14 @@ void srv_player_removed(G_GNUC_UNUSED void *data)
 void srv_player_change(G_GNUC_UNUSED void *data)
 {
 #ifdef PRINT_INFO
-	GList *current;
+	Player *p;
+	guint idx = 0;
 	Game *game = (Game *) data;
 	g_print("Players connected:\n");
-	playerlist_inc_use_count(game);
-	for (current = game->player_list; current != NULL;
-	     current = g_list_next(current)) {
-		Player *p = (Player *) current->data;
+	while ((p = player_iterate(game, &idx)) != NULL) {
 		g_print("Player %d: %s (at host %s) is %s connected\n",
 			p->num, p->name, p->location,
 			p->disconnected ? "not" : "");
 	}
-	playerlist_dec_use_count(game);
 #endif
 }
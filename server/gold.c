@@ -63,18 +63,19 @@ gboolean gold_limited_bank(const Game * game, int limit,
 /* this function distributes resources until someone who receives gold is
  * found.  It is called again when that person chose his/her gold and
  * continues the distribution */
-static void distribute_next(GList * list)
+static void distribute_next(Player * player)
 {
-	Player *player = list->data;
 	Game *game = player->game;
+	Player *scan;
+	Player *p;
 	gint idx;
 	gboolean in_setup = FALSE;
 
 	/* give resources until someone should choose gold */
-	for (; list != NULL; list = next_player_loop(list, player)) {
+	for (scan = player; scan != NULL;
+	     scan = next_player_loop(scan, player)) {
 		gint resource[NO_RESOURCE], wanted[NO_RESOURCE];
 		gboolean send_message = FALSE;
-		Player *scan = list->data;
 
 		/* calculate what resources to give */
 		for (idx = 0; idx < NO_RESOURCE; ++idx) {
@@ -156,9 +157,8 @@ static void distribute_next(GList * list)
 			 "done-resources\n");
 	/* pop everyone back to the state before we started giving out
 	 * resources */
-	for (list = player_first_real(game); list != NULL;
-	     list = player_next_real(list)) {
-		Player *p = list->data;
+	for (p = player_first_real(game); p != NULL;
+	     p = player_next_real(p)) {
 		/* spectators were not pushed, they should not be popped */
 		if (player_is_spectator(game, p->num))
 			continue;
@@ -180,7 +180,6 @@ gboolean mode_choose_gold(Player * player, gint event)
 	Game *game = player->game;
 	gint resources[NO_RESOURCE];
 	gint idx, num;
-	GList *list;
 
 	sm_state_name(sm, "mode_choose_gold");
 	if (event != SM_RECV)
@@ -216,22 +215,19 @@ gboolean mode_choose_gold(Player * player, gint event)
 			 "receive-gold %R\n", resources);
 	/* pop back to mode_idle */
 	sm_pop(sm);
-	list = next_player_loop(list_from_player(player), player);
-	distribute_next(list);
+	distribute_next(next_player_loop(player, player));
 	return TRUE;
 }
 
 /* this function is called by mode_turn to let resources and gold be
  * distributed */
-void distribute_first(GList * list)
+void distribute_first(Player * player)
 {
-	GList *looper;
-	Player *player = list->data;
+	Player *scan;
 	Game *game = player->game;
 	/* tell everybody who's receiving gold */
-	for (looper = list; looper != NULL;
-	     looper = next_player_loop(looper, player)) {
-		Player *scan = looper->data;
+	for (scan = player; scan != NULL;
+	     scan = next_player_loop(scan, player)) {
 		/* leave the spectators out of this */
 		if (player_is_spectator(game, scan->num))
 			continue;
@@ -250,5 +246,5 @@ void distribute_first(GList * list)
 			(StateFunc) mode_wait_for_gold_choosing_players);
 	}
 	/* start giving out resources */
-	distribute_next(list);
+	distribute_next(player);
 }
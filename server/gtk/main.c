@@ -66,6 +66,7 @@ static gchar *server_port = NULL;	/* port of the game */
 static gboolean register_server = TRUE;	/* Register at the metaserver */
 static gboolean want_ai_chat = TRUE;
 static gboolean random_order = TRUE;	/* random seating order */
+static gboolean balanced_terrain = FALSE;	/* balanced random terrain */
 static gboolean enable_debug = FALSE;
 static gboolean show_version = FALSE;
 
@@ -173,6 +174,16 @@ static void game_settings_change_cb(GameSettings *gs, G_GNUC_UNUSED gpointer use
 }
 */
 
+/** The terrain type of the rules. The rules only show whether the terrain
+ *  is random, a balanced map is kept from the configuration.
+ */
+static gint get_terrain_type(void)
+{
+	if (!game_rules_get_random_terrain(GAMERULES(game_rules)))
+		return TERRAIN_DEFAULT;
+	return balanced_terrain ? TERRAIN_BALANCED : TERRAIN_RANDOM;
+}
+
 static void update_game_settings(const GameParams * params)
 {
 	if (params == NULL) {
@@ -214,6 +225,17 @@ static void game_activate(GtkWidget * widget,
 	const GameParams *params;
 
 	params = select_game_get_active_game(SELECTGAME(widget));
+	if (params == NULL) {
+		/* Only the title is known, load the game now.  Adding the
+		 * details activates the game again. */
+		params =
+		    game_list_find_item(select_game_get_active_title
+					(SELECTGAME(widget)));
+		if (params != NULL)
+			select_game_add_details(SELECTGAME(widget),
+						params);
+		return;
+	}
 	update_game_settings(params);
 }
 
@@ -274,9 +296,9 @@ static void start_clicked_cb(G_GNUC_UNUSED GtkButton * widget,
 		cfg_set_num_removed_dice_cards(params,
 					       game_rules_get_num_removed_dice_cards
 					       (GAMERULES(game_rules)));
-		cfg_set_terrain_type(params,
-				     game_rules_get_random_terrain
-				     (GAMERULES(game_rules)));
+		cfg_set_terrain_type(params, get_terrain_type());
+		/* Random terrain was turned off, or it stays balanced */
+		balanced_terrain = params->balanced_terrain;
 		params->strict_trade =
 		    game_rules_get_strict_trade(GAMERULES(game_rules));
 		params->use_pirate =
@@ -314,7 +336,7 @@ static void start_clicked_cb(G_GNUC_UNUSED GtkButton * widget,
 
 			config_set_string("game/name", params->title);
 			config_set_int("game/random-terrain",
-				       params->random_terrain);
+				       cfg_get_terrain_type(params));
 			config_set_int("game/num-players",
 				       params->num_players);
 			config_set_int("game/victory-points",
@@ -422,15 +444,13 @@ static gboolean everybody_left(gpointer data)
 static void gui_player_change(void *data)
 {
 	Game *game = data;
-	GList *current;
+	Player *p;
+	guint idx = 0;
 	guint number_of_players = 0;
 
 	gtk_list_store_clear(store);
-	playerlist_inc_use_count(game);
-	for (current = game->player_list; current != NULL;
-	     current = g_list_next(current)) {
+	while ((p = player_iterate(game, &idx)) != NULL) {
 		GtkTreeIter iter;
-		Player *p = current->data;
 		gboolean isSpectator;
 
 		isSpectator = player_is_spectator(p->game, p->num);
@@ -447,17 +467,44 @@ static void gui_player_change(void *data)
 				   PLAYER_COLUMN_ISSPECTATOR, isSpectator,
 				   -1);
 	}
-	playerlist_dec_use_count(game);
 	if (number_of_players == 0 && game->is_game_over) {
 		g_timeout_add(100, everybody_left, game);
 	}
 }
 
+static void add_title_to_list(gpointer title,
+			      G_GNUC_UNUSED gpointer user_data)
+{
+	select_game_add(SELECTGAME(select_game), title);
+}
+
 static void add_game_to_list(gpointer name,
 			     G_GNUC_UNUSED gpointer user_data)
 {
 	GameParams *a = (GameParams *) name;
-	select_game_add_details(SELECTGAME(select_game), a);
+
+	/* The active game is already loaded, adding it again would reset
+	 * the settings */
+	if (strcmp(a->title,
+		   select_game_get_active_title(SELECTGAME(select_game))) !=
+	    0)
+		select_game_add_details(SELECTGAME(select_game), a);
+}
+
+/* Load the other games the first time the list is shown, for the
+ * previews */
+static void game_list_shown(GObject * combo_box,
+			    G_GNUC_UNUSED GParamSpec * pspec,
+			    G_GNUC_UNUSED gpointer user_data)
+{
+	static gboolean all_loaded = FALSE;
+	gboolean shown;
+
+	g_object_get(combo_box, "popup-shown", &shown, NULL);
+	if (shown && !all_loaded) {
+		all_loaded = TRUE;
+		game_list_foreach(add_game_to_list, NULL);
+	}
 }
 
 static void overridden_hostname_changed_cb(GtkEntry * widget,
@@ -490,6 +537,9 @@ static GtkWidget *build_game_settings(GtkWindow * main_window)
 	gtk_widget_show(select_game);
 	g_signal_connect(G_OBJECT(select_game), "activate",
 			 G_CALLBACK(game_activate), NULL);
+	g_signal_connect(G_OBJECT(SELECTGAME(select_game)->combo_box),
+			 "notify::popup-shown",
+			 G_CALLBACK(game_list_shown), NULL);
 	gtk_box_pack_start(GTK_BOX(vbox), select_game, FALSE, FALSE, 0);
 
 	game_settings = game_settings_new(TRUE);
@@ -1036,15 +1086,18 @@ static void load_last_game_params(void)
 	if (params == NULL)
 		params = cfg_set_game("Default");
 	select_game_set_default(SELECTGAME(select_game), gamename);
-	game_list_foreach(add_game_to_list, NULL);
+	/* Only the active game is loaded, the others when they are needed */
+	game_list_foreach_title(add_title_to_list, FALSE, NULL);
 	g_free(gamename);
 
 	/* If a setting is not found, don't override the settings that came
 	 * with the game */
 	g_assert(params != NULL);
 	temp = config_get_int("game/random-terrain", &default_returned);
-	if (!default_returned)
+	if (!default_returned) {
 		cfg_set_terrain_type(params, temp);
+		balanced_terrain = params->balanced_terrain;
+	}
 	temp = config_get_int("game/num-players", &default_returned);
 	if (!default_returned)
 		cfg_set_num_players(params, temp);
@@ -1109,9 +1162,7 @@ static void check_vp_cb(G_GNUC_UNUSED GObject * caller,
 	cfg_set_num_removed_dice_cards(params,
 				       game_rules_get_num_removed_dice_cards
 				       (GAMERULES(game_rules)));
-	cfg_set_terrain_type(params, (gint)
-			     game_rules_get_random_terrain(GAMERULES
-							   (game_rules)));
+	cfg_set_terrain_type(params, get_terrain_type());
 	params->strict_trade =
 	    game_rules_get_strict_trade(GAMERULES(game_rules));
 	params->use_pirate =
@@ -0,0 +1,244 @@
+/* Pioneers - Implementation of the excellent Settlers of Catan board game.
+ *   Go buy a copy.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* Load generator: open many idle sessions to a server.
+ * The sessions only answer the keep-alive pings of the server, so they
+ * stay connected without ever joining the game.
+ */
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <glib.h>
+
+#define EVENT_BATCH 256
+#define REPORT_INTERVAL 5
+
+typedef struct {
+	gint fd;
+	gchar partial[8];	/* the tail of an incomplete line */
+	size_t partial_len;
+} IdleSession;
+
+static gchar *server = NULL;
+static gchar *port = NULL;
+static gint num_sessions = 50000;
+static gint connect_rate = 1000;
+
+static GOptionEntry commandline_entries[] = {
+	{"server", 's', 0, G_OPTION_ARG_STRING, &server,
+	 "Server host", PIONEERS_DEFAULT_GAME_HOST},
+	{"port", 'p', 0, G_OPTION_ARG_STRING, &port,
+	 "Server port", PIONEERS_DEFAULT_GAME_PORT},
+	{"sessions", 'n', 0, G_OPTION_ARG_INT, &num_sessions,
+	 "Number of idle sessions to open", "50000"},
+	{"rate", 'r', 0, G_OPTION_ARG_INT, &connect_rate,
+	 "Connections to open per second", "1000"},
+	{NULL, '\0', 0, 0, NULL, NULL, NULL}
+};
+
+static guint num_connected;
+static guint num_failed;
+static guint num_closed;
+static guint num_pings;
+
+static void raise_file_limit(guint wanted)
+{
+	struct rlimit limit;
+
+	if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+		return;
+	if (limit.rlim_cur >= wanted + 16)
+		return;
+	limit.rlim_cur = MIN(limit.rlim_max, (rlim_t) wanted + 16);
+	if (setrlimit(RLIMIT_NOFILE, &limit) != 0
+	    || limit.rlim_cur < wanted + 16)
+		g_printerr("Only %lu file descriptors are available\n",
+			   (unsigned long) limit.rlim_cur);
+}
+
+static gboolean session_open(gint epfd, const struct addrinfo *address,
+			     IdleSession * ses)
+{
+	struct epoll_event event;
+	gint fd;
+
+	fd = socket(address->ai_family, address->ai_socktype,
+		    address->ai_protocol);
+	if (fd < 0)
+		return FALSE;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	if (connect(fd, address->ai_addr, address->ai_addrlen) != 0
+	    && errno != EINPROGRESS) {
+		close(fd);
+		return FALSE;
+	}
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.ptr = ses;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) != 0) {
+		close(fd);
+		return FALSE;
+	}
+	ses->fd = fd;
+	ses->partial_len = 0;
+	return TRUE;
+}
+
+static void session_close(gint epfd, IdleSession * ses)
+{
+	epoll_ctl(epfd, EPOLL_CTL_DEL, ses->fd, NULL);
+	close(ses->fd);
+	ses->fd = -1;
+	num_closed++;
+}
+
+/* Answer the pings, ignore everything else */
+static void session_read(gint epfd, IdleSession * ses)
+{
+	gchar buff[1024];
+	ssize_t num;
+	ssize_t idx;
+
+	num = recv(ses->fd, buff, sizeof(buff), 0);
+	if (num < 0 && (errno == EAGAIN || errno == EINTR))
+		return;
+	if (num <= 0) {
+		session_close(epfd, ses);
+		return;
+	}
+
+	for (idx = 0; idx < num; idx++) {
+		if (buff[idx] != '\n') {
+			if (ses->partial_len < sizeof(ses->partial))
+				ses->partial[ses->partial_len] = buff[idx];
+			ses->partial_len++;
+			continue;
+		}
+		if (ses->partial_len == 5
+		    && memcmp(ses->partial, "hello", 5) == 0) {
+			if (send(ses->fd, "yes\n", 4, MSG_NOSIGNAL) == 4)
+				num_pings++;
+		}
+		ses->partial_len = 0;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	struct addrinfo hints;
+	struct addrinfo *address;
+	struct epoll_event events[EVENT_BATCH];
+	IdleSession *sessions;
+	gint epfd;
+	gint opened;
+	gint64 start;
+	gint64 last_report;
+	gint ret;
+
+	context = g_option_context_new("- Open idle sessions to a server");
+	g_option_context_add_main_entries(context, commandline_entries,
+					  NULL);
+	g_option_context_parse(context, &argc, &argv, &error);
+	g_option_context_free(context);
+	if (error != NULL) {
+		g_printerr("%s\n", error->message);
+		g_error_free(error);
+		return 1;
+	}
+	if (server == NULL)
+		server = g_strdup(PIONEERS_DEFAULT_GAME_HOST);
+	if (port == NULL)
+		port = g_strdup(PIONEERS_DEFAULT_GAME_PORT);
+	num_sessions = MAX(num_sessions, 1);
+	connect_rate = MAX(connect_rate, 1);
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	ret = getaddrinfo(server, port, &hints, &address);
+	if (ret != 0) {
+		g_printerr("%s:%s: %s\n", server, port, gai_strerror(ret));
+		return 1;
+	}
+
+	raise_file_limit((guint) num_sessions);
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd < 0) {
+		g_printerr("epoll: %s\n", g_strerror(errno));
+		return 1;
+	}
+
+	sessions = g_new0(IdleSession, num_sessions);
+	opened = 0;
+	start = g_get_monotonic_time();
+	last_report = start;
+	for (;;) {
+		gint64 now = g_get_monotonic_time();
+		gint allowed;
+		gint num;
+		gint idx;
+
+		/* Open new sessions at the requested rate */
+		allowed = (gint) MIN((gint64) num_sessions,
+				     (now - start) * connect_rate /
+				     G_USEC_PER_SEC + 1);
+		while (opened < allowed) {
+			if (session_open(epfd, address, &sessions[opened]))
+				num_connected++;
+			else {
+				sessions[opened].fd = -1;
+				num_failed++;
+			}
+			opened++;
+		}
+
+		num = epoll_wait(epfd, events, EVENT_BATCH, 100);
+		for (idx = 0; idx < num; idx++) {
+			IdleSession *ses = events[idx].data.ptr;
+			if (events[idx].events & (EPOLLERR | EPOLLHUP)) {
+				session_close(epfd, ses);
+			} else {
+				session_read(epfd, ses);
+			}
+		}
+
+		if (now - last_report >= REPORT_INTERVAL * G_USEC_PER_SEC) {
+			g_print("opened %u, failed %u, closed %u, "
+				"idle %u, pings answered %u\n",
+				num_connected, num_failed, num_closed,
+				num_connected - num_closed, num_pings);
+			last_report = now;
+		}
+	}
+
+	/* Not reached */
+	return 0;
+}
@@ -72,6 +72,7 @@ static gboolean register_server = FALSE;
 static gchar *metaserver_name = NULL;
 static gboolean fixed_seating_order = FALSE;
 static gboolean enable_debug = FALSE;
+static gchar *log_format = NULL;
 static gboolean show_version = FALSE;
 
 static GOptionEntry commandline_game_entries[] = {
@@ -105,7 +106,8 @@ static GOptionEntry commandline_game_entries[] = {
 	 N_("Override num-removed-dice-cards handling"), NULL},
 	{"terrain", 'T', 0, G_OPTION_ARG_INT, &terrain,
 	 /* Commandline server-console: terrain */
-	 N_("Override terrain type, 0=default 1=random"), "0|1"},
+	 N_("Override terrain type, 0=default 1=random "
+	    "2=balanced"), "0|1|2"},
 	{"computer-players", 'c', 0, G_OPTION_ARG_INT, &num_ai_players,
 	 /* Commandline server-console: computer-players */
 	 N_("Add N computer players"), "N"},
@@ -157,6 +159,10 @@ static GOptionEntry commandline_other_entries[] = {
 	{"debug", '\0', 0, G_OPTION_ARG_NONE, &enable_debug,
 	 /* Commandline option of server: enable debug logging */
 	 N_("Enable debug messages"), NULL},
+	{"log-format", '\0', 0, G_OPTION_ARG_STRING, &log_format,
+	 /* Commandline option of server: asynchronous logging */
+	 N_("Write the log from a background thread, as text or json"),
+	 "text|json"},
 	{NULL, '\0', 0, 0, NULL, NULL, NULL}
 };
 
@@ -232,6 +238,21 @@ int main(int argc, char *argv[])
 
 	set_enable_debug(enable_debug);
 
+	if (log_format != NULL) {
+		LogFormat format;
+
+		if (!log_format_from_name(log_format, &format)) {
+			/* server-console commandline error */
+			g_print(_("Unknown log format: %s\n"), log_format);
+			return 1;
+		}
+		if (!log_start_async(format))
+			log_message(MSG_ERROR,
+				    /* Error message */
+				    _("The log can not be written from a "
+				      "background thread\n"));
+	}
+
 	if (server_port == NULL)
 		server_port = g_strdup(PIONEERS_DEFAULT_GAME_PORT);
 	if (game_title && game_file) {
@@ -289,9 +310,14 @@ int main(int argc, char *argv[])
 	cfg_set_quit(params, quit_when_done);
 
 	if (terrain != -1)
-		cfg_set_terrain_type(params, terrain ? 1 : 0);
+		cfg_set_terrain_type(params,
+				     terrain == TERRAIN_BALANCED ?
+				     TERRAIN_BALANCED : terrain ?
+				     TERRAIN_RANDOM : TERRAIN_DEFAULT);
 
 	net_init();
+	/* The metrics are exported by the admin interface */
+	metrics_set_enabled(TRUE);
 
 	if (!disable_game_start) {
 		game =
@@ -336,6 +362,7 @@ int main(int argc, char *argv[])
 	}
 
 	net_finish();
+	log_stop_async();
 
 	g_free(hostname);
 	g_free(server_port);
@@ -38,7 +38,7 @@ static gint metaserver_version_minor;
 static gint num_redirects;
 /** TRUE when the server disconnects, FALSE when the other end disconnects */
 static gboolean disconnect_initiated;
-/** GSource identifier for the reconnect timer */
+/** Timer wheel identifier for the reconnect timer */
 static guint reconnect_timer = 0;
 /** Reconnect interval in seconds */
 static guint reconnect_interval;
@@ -65,13 +65,14 @@ static void start_reconnect_timer(Game * game)
 		     "An attempt to reconnect is scheduled in %u seconds.\n",
 		     reconnect_interval), reconnect_interval);
 	reconnect_timer =
-	    g_timeout_add(reconnect_interval * 1000, timed_out, game);
+	    timer_wheel_add_full(reconnect_interval, timed_out, game, game,
+				 "metaserver-reconnect");
 }
 
 static void stop_reconnect_timer(void)
 {
 	if (reconnect_timer != 0) {
-		g_source_remove(reconnect_timer);
+		timer_wheel_remove(reconnect_timer);
 	}
 	reconnect_timer = 0;
 }
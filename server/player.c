@@ -37,9 +37,12 @@ static gboolean mode_unhandled(Player * player, gint event);
 static void player_setup(Player * player, gint playernum,
 			 const gchar * name, gboolean force_spectator);
 static Player *player_by_name(Game * game, char *name);
+static void player_link(Player * player);
+static void player_unlink(Player * player);
 
-#define tournament_minute 1000 * 60
-#define time_to_wait_for_players 30 * 60 * 1000
+/* In seconds */
+#define tournament_minute 60
+#define time_to_wait_for_players 30 * 60
 
 /** Is the game a tournament game?
  *  @param game The game
@@ -60,22 +63,11 @@ static gint next_free_player_num(Game * game, gboolean force_spectator)
 	gint idx;
 
 	if (!force_spectator) {
-		GList *list;
-		gboolean player_taken[MAX_PLAYERS];
 		guint available = game->params->num_players;
 
-		memset(player_taken, 0, sizeof(player_taken));
-		playerlist_inc_use_count(game);
-		for (list = game->player_list;
-		     list != NULL; list = g_list_next(list)) {
-			Player *player = list->data;
-			if (player->num >= 0
-			    && !player_is_spectator(game, player->num)) {
-				player_taken[player->num] = TRUE;
+		for (idx = 0; idx < (gint) game->params->num_players; idx++)
+			if (game->players[idx] != NULL)
 				--available;
-			}
-		}
-		playerlist_dec_use_count(game);
 		if (available > 0) {
 			guint skip;
 			if (game->random_order) {
@@ -85,7 +77,7 @@ static gint next_free_player_num(Game * game, gboolean force_spectator)
 			}
 			idx = 0;
 			++skip;
-			while (player_taken[idx] || --skip != 0)
+			while (game->players[idx] != NULL || --skip != 0)
 				++idx;
 			return idx;
 		}
@@ -114,12 +106,6 @@ static gboolean mode_global(Player * player, gint event)
 			g_free(player->location);
 		if (player->devel != NULL)
 			deck_free(player->devel, NULL);
-		if (player->num >= 0
-		    && !player_is_spectator(game, player->num)
-		    && !player->disconnected) {
-			game->num_players--;
-			meta_report_num_players(game->num_players);
-		}
 		g_list_free(player->build_list);
 		g_list_free(player->special_points);
 		g_free(player);
@@ -211,10 +197,11 @@ static gboolean tournament_start_cb(gpointer data)
 {
 	guint i;
 	Game *game = (Game *) data;
-	GList *player;
+	Player *player;
+	guint idx;
 	gboolean human_player_present;
 
-	g_source_remove(game->tournament_timer);
+	timer_wheel_remove(game->tournament_timer);
 	game->tournament_timer = 0;
 
 	/* if game already started */
@@ -233,29 +220,22 @@ static gboolean tournament_start_cb(gpointer data)
 	}
 
 	/* remove all disconnected players */
-	playerlist_inc_use_count(game);
-	for (player = game->player_list; player != NULL;
-	     player = g_list_next(player)) {
-		Player *p = player->data;
-		if (p->disconnected && !sm_get_use_cache(p->sm)) {
-			player_free(p);
+	idx = 0;
+	while ((player = player_iterate(game, &idx)) != NULL) {
+		if (player->disconnected && !sm_get_use_cache(player->sm)) {
+			player_free(player);
 		}
 	}
-	playerlist_dec_use_count(game);
 
 	/* if no human players are present, quit */
-	playerlist_inc_use_count(game);
 	human_player_present = FALSE;
-	for (player = game->player_list;
+	for (player = player_first_real(game);
 	     player != NULL && !human_player_present;
-	     player = g_list_next(player)) {
-		Player *p = player->data;
-		if (!player_is_spectator(game, p->num)
-		    && determine_player_type(p->style) == PLAYER_HUMAN) {
+	     player = player_next_real(player)) {
+		if (determine_player_type(player->style) == PLAYER_HUMAN) {
 			human_player_present = TRUE;
 		}
 	}
-	playerlist_dec_use_count(game);
 	if (!human_player_present) {
 		player_broadcast(player_none(game), PB_SILENT,
 				 FIRST_VERSION, LATEST_VERSION,
@@ -300,7 +280,7 @@ static gboolean talk_about_tournament_cb(gpointer data)
 					  "tournament timer is reset."));
 			game->tournament_countdown =
 			    game->params->tournament_time;
-			g_source_remove(game->tournament_timer);
+			timer_wheel_remove(game->tournament_timer);
 			game->tournament_timer = 0;
 		}
 		return FALSE;
@@ -318,8 +298,9 @@ static gboolean talk_about_tournament_cb(gpointer data)
 	game->tournament_countdown--;
 
 	if (game->tournament_countdown > 0)
-		g_timeout_add(tournament_minute,
-			      &talk_about_tournament_cb, game);
+		timer_wheel_add_full(tournament_minute,
+				     &talk_about_tournament_cb, game, game,
+				     "tournament-notice");
 
 	return FALSE;
 }
@@ -415,8 +396,9 @@ Player *player_new(Game * game, const gchar * name)
 	player->game = game;
 	player->location = g_strdup("not connected");
 	player->devel = deck_new();
-	game->player_list = g_list_append(game->player_list, player);
 	player->num = -1;
+	player->slot = -1;
+	player_link(player);
 	player->chapel_played = 0;
 	player->univ_played = 0;
 	player->gov_played = 0;
@@ -544,10 +526,13 @@ static void player_setup(Player * player, gint playernum,
 	StateMachine *sm = player->sm;
 	Player *other;
 
+	player_unlink(player);
 	player->num = playernum;
 	if (player->num < 0) {
 		player->num = next_free_player_num(game, force_spectator);
 	}
+	player_link(player);
+	sm_set_log_context(sm, game->server_port, player->num);
 
 	if (!player_is_spectator(game, player->num)) {
 		game->num_players++;
@@ -615,21 +600,60 @@ static void player_setup(Player * player, gint playernum,
 		sm_goto(sm, (StateFunc) mode_pre_game);
 }
 
+static gboolean reap_cb(gpointer data)
+{
+	Game *game = data;
+
+	game->reap_source = 0;
+	player_reap(game);
+	return FALSE;
+}
+
+/** Remove the player from the game and close its connection.
+ *  The memory is freed from the main loop, because the caller may be
+ *  iterating over the players, or be called from the state machine of the
+ *  player.
+ */
 void player_free(Player * player)
 {
 	Game *game = player->game;
 
-	if (game->player_list_use_count > 0) {
-		game->dead_players =
-		    g_list_append(game->dead_players, player);
-		player->disconnected = TRUE;
+	if (player->dead)
 		return;
-	}
+	player->dead = TRUE;
 
-	game->player_list = g_list_remove(game->player_list, player);
+	player_unlink(player);
+	if (player->num >= 0
+	    && !player_is_spectator(game, player->num)
+	    && !player->disconnected) {
+		game->num_players--;
+		meta_report_num_players(game->num_players);
+	}
+	player->disconnected = TRUE;
 	driver->player_change(game);
 
-	sm_free(player->sm);
+	/* No more events reach the player after this */
+	sm_close(player->sm);
+
+	g_ptr_array_add(game->dead_players, player);
+	if (game->reap_source == 0)
+		game->reap_source = g_idle_add(reap_cb, game);
+}
+
+/** Free the memory of the removed players now */
+void player_reap(Game * game)
+{
+	if (game->reap_source != 0) {
+		g_source_remove(game->reap_source);
+		game->reap_source = 0;
+	}
+	while (game->dead_players->len > 0) {
+		Player *player =
+		    g_ptr_array_remove_index_fast(game->dead_players,
+						  game->dead_players->len -
+						  1);
+		sm_free(player->sm);
+	}
 }
 
 static gboolean timed_out(gpointer data)
@@ -651,7 +675,7 @@ void player_archive(Player * player)
 	StateFunc state;
 	Game *game = player->game;
 	gboolean human_player_present;
-	GList *pl;
+	Player *p;
 
 	/* If this was a spectator, forget about him */
 	if (player_is_spectator(game, player->num)) {
@@ -700,23 +724,19 @@ void player_archive(Player * player)
 	meta_report_num_players(game->num_players);
 
 	/* if no human players are present, start timer */
-	playerlist_inc_use_count(game);
 	human_player_present = FALSE;
-	for (pl = game->player_list;
-	     pl != NULL && !human_player_present; pl = g_list_next(pl)) {
-		Player *p = pl->data;
-		if (!player_is_spectator(game, p->num)
-		    && !p->disconnected
+	for (p = player_first_real(game);
+	     p != NULL && !human_player_present; p = player_next_real(p)) {
+		if (!p->disconnected
 		    && determine_player_type(p->style) == PLAYER_HUMAN) {
 			human_player_present = TRUE;
 		}
 	}
-	playerlist_dec_use_count(game);
 	if (!human_player_present && game->no_humans_timer == 0
 	    && is_tournament_game(game)) {
 		game->no_humans_timer =
-		    g_timeout_add(time_to_wait_for_players, timed_out,
-				  game);
+		    timer_wheel_add_full(time_to_wait_for_players,
+					 timed_out, game, game, "no-humans");
 		player_broadcast(player_none(game), PB_SILENT,
 				 FIRST_VERSION, LATEST_VERSION,
 				 "NOTE %s\n",
@@ -732,13 +752,12 @@ void player_archive(Player * player)
 void player_revive(Player * newp, char *name)
 {
 	Game *game = newp->game;
-	GList *current = NULL;
 	Player *p = NULL;
-	gboolean reviving_player_in_setup;
+	guint idx;
 	gchar *safe_name;
 
 	if (game->no_humans_timer != 0) {
-		g_source_remove(game->no_humans_timer);
+		timer_wheel_remove(game->no_humans_timer);
 		game->no_humans_timer = 0;
 		player_broadcast(player_none(game), PB_SILENT,
 				 FIRST_VERSION, LATEST_VERSION,
@@ -747,20 +766,17 @@ void player_revive(Player * newp, char *name)
 
 	/* first see if a player with the given name exists */
 	if (name) {
-		playerlist_inc_use_count(game);
-		for (current = game->player_list; current != NULL;
-		     current = g_list_next(current)) {
-			p = current->data;
+		idx = 0;
+		while ((p = player_iterate(game, &idx)) != NULL) {
 			if (!strcmp(name, p->name))
 				if (p->disconnected
 				    && !sm_get_use_cache(p->sm)
 				    && p != newp)
 					break;
 		}
-		playerlist_dec_use_count(game);
 	}
 	/* if not, try to find an unused player number */
-	if (current == NULL) {
+	if (p == NULL) {
 		gint num;
 
 		num = next_free_player_num(game, FALSE);
@@ -770,29 +786,23 @@ void player_revive(Player * newp, char *name)
 		}
 	}
 	/* if not, try to take over another disconnected player */
-	if (current == NULL) {
-		playerlist_inc_use_count(game);
-		for (current = game->player_list; current != NULL;
-		     current = g_list_next(current)) {
-			p = current->data;
+	if (p == NULL) {
+		idx = 0;
+		while ((p = player_iterate(game, &idx)) != NULL) {
 			if (p->disconnected && !sm_get_use_cache(p->sm)
 			    && p != newp)
 				break;
 		}
-		playerlist_dec_use_count(game);
 	}
 	/* if still no player is found, do a normal setup */
-	if (current == NULL) {
+	if (p == NULL) {
 		player_setup(newp, -1, name, FALSE);
 		return;
 	}
 
-	/* Reviving the player that is currently in the setup phase */
-	reviving_player_in_setup =
-	    (game->setup_player && game->setup_player->data == p);
-
-	/* remove the disconnected player from the player list, it's memory will be freed at the end of this routine */
-	game->player_list = g_list_remove(game->player_list, p);
+	/* give up the seat of the disconnected player, its memory will be
+	 * freed at the end of this routine */
+	player_unlink(p);
 
 	/* initialize the player */
 	player_setup(newp, p->num, name, FALSE);
@@ -847,16 +857,9 @@ void player_revive(Player * newp, char *name)
 	if (game->largest_army == p)
 		game->largest_army = newp;
 
-	if (reviving_player_in_setup) {
-		/* Restore the pointer */
-		game->setup_player = game->player_list;
-		while (game->setup_player
-		       && game->setup_player->data != newp) {
-			game->setup_player =
-			    g_list_next(game->setup_player);
-		}
-		g_assert(game->setup_player != NULL);
-	}
+	/* Reviving the player that is currently in the setup phase */
+	if (game->setup_player == p)
+		game->setup_player = newp;
 	p->num = -1;		/* prevent the number of players
 				   from getting decremented */
 
@@ -992,12 +995,15 @@ static void start_tournament_mode(Player * player)
 		if (game->num_players == 1) {
 			game->tournament_countdown =
 			    game->params->tournament_time;
+			/* Start one second after the last notice */
 			game->tournament_timer =
-			    g_timeout_add(game->tournament_countdown *
-					  tournament_minute + 500,
-					  &tournament_start_cb, game);
-			g_timeout_add(1000, &talk_about_tournament_cb,
-				      game);
+			    timer_wheel_add_full(game->tournament_countdown
+						 * tournament_minute + 1,
+						 &tournament_start_cb, game,
+						 game, "tournament-start");
+			timer_wheel_add_full(1, &talk_about_tournament_cb,
+					     game, game,
+					     "tournament-notice");
 		} else {
 			if (game->tournament_timer != 0
 			    && game->num_players !=
@@ -1052,89 +1058,127 @@ static gboolean mode_check_status(Player * player, gint event)
 	return FALSE;
 }
 
-/* Returns a GList* to player 0 */
-GList *player_first_real(Game * game)
+/* Returns the seated player with the lowest number */
+Player *player_first_real(Game * game)
 {
-	GList *list;
-	/* search for player 0 */
-	playerlist_inc_use_count(game);
-	for (list = game->player_list;
-	     list != NULL; list = g_list_next(list)) {
-		Player *player = list->data;
-		if (player->num == 0)
-			break;
-	}
-	playerlist_dec_use_count(game);
-	return list;
+	guint idx;
+
+	for (idx = 0; idx < game->params->num_players; idx++)
+		if (game->players[idx] != NULL)
+			return game->players[idx];
+	return NULL;
 }
 
-/* Returns a GList * to a player with a number one higher than last */
-GList *player_next_real(GList * last)
+/* Returns the seated player with the next number after last */
+Player *player_next_real(Player * last)
 {
-	Player *player;
 	Game *game;
-	guint numplayers;
-	gint nextnum;
-	GList *list;
+	guint idx;
 
-	if (!last)
+	if (!last || last->num < 0)
 		return NULL;
 
-	player = last->data;
-	game = player->game;
-	numplayers = game->params->num_players;
-	nextnum = player->num + 1;
+	game = last->game;
+	for (idx = (guint) last->num + 1; idx < game->params->num_players;
+	     idx++)
+		if (game->players[idx] != NULL)
+			return game->players[idx];
+	return NULL;
+}
 
-	if (nextnum >= (gint) numplayers)
-		return NULL;
+/** Iterate over everyone in the game, the seated players first.
+ *  Players can be added and removed while iterating.
+ *  @param game The game
+ *  @param idx Set to 0 before the first call
+ *  @return The next player, or NULL when all have been returned
+ */
+Player *player_iterate(Game * game, guint * idx)
+{
+	while (*idx < MAX_PLAYERS) {
+		Player *player = game->players[(*idx)++];
+		if (player != NULL)
+			return player;
+	}
+	while (*idx - MAX_PLAYERS < game->spectators->len) {
+		Player *player =
+		    g_ptr_array_index(game->spectators, *idx - MAX_PLAYERS);
+		(*idx)++;
+		if (player != NULL)
+			return player;
+	}
+	return NULL;
+}
 
-	playerlist_inc_use_count(game);
-	for (list = game->player_list; list != NULL;
-	     list = g_list_next(list)) {
-		Player *scan = list->data;
-		if (scan->num == nextnum)
+/* Put the player in the seat of its number, or in a free slot for the
+ * spectators and the players that have no number yet */
+static void player_link(Player * player)
+{
+	Game *game = player->game;
+	guint idx;
+
+	if (player->num >= 0 && !player_is_spectator(game, player->num)) {
+		g_assert(game->players[player->num] == NULL);
+		game->players[player->num] = player;
+		return;
+	}
+	for (idx = 0; idx < game->spectators->len; idx++)
+		if (g_ptr_array_index(game->spectators, idx) == NULL)
 			break;
+	if (idx == game->spectators->len)
+		g_ptr_array_add(game->spectators, player);
+	else
+		g_ptr_array_index(game->spectators, idx) = player;
+	player->slot = (gint) idx;
+}
+
+static void player_unlink(Player * player)
+{
+	Game *game = player->game;
+	GPtrArray *spectators = game->spectators;
+
+	if (player->slot >= 0) {
+		g_ptr_array_index(spectators, player->slot) = NULL;
+		player->slot = -1;
+		/* Only shrink at the end, the others keep their slot */
+		while (spectators->len > 0
+		       && g_ptr_array_index(spectators,
+					    spectators->len - 1) == NULL)
+			g_ptr_array_set_size(spectators,
+					     spectators->len - 1);
+	} else if (player->num >= 0
+		   && !player_is_spectator(game, player->num)
+		   && game->players[player->num] == player) {
+		game->players[player->num] = NULL;
 	}
-	playerlist_dec_use_count(game);
-	return list;
 }
 
 static Player *player_by_name(Game * game, char *name)
 {
-	GList *list;
-
-	playerlist_inc_use_count(game);
-	for (list = game->player_list;
-	     list != NULL; list = g_list_next(list)) {
-		Player *player = list->data;
+	Player *player;
+	guint idx = 0;
 
+	while ((player = player_iterate(game, &idx)) != NULL) {
 		if (player->name != NULL
-		    && strcmp(player->name, name) == 0) {
-			playerlist_dec_use_count(game);
+		    && strcmp(player->name, name) == 0)
 			return player;
-		}
 	}
-	playerlist_dec_use_count(game);
-
 	return NULL;
 }
 
 Player *player_by_num(Game * game, gint num)
 {
-	GList *list;
+	guint idx;
 
-	playerlist_inc_use_count(game);
-	for (list = game->player_list;
-	     list != NULL; list = g_list_next(list)) {
-		Player *player = list->data;
+	if (num < 0)
+		return NULL;
+	if (!player_is_spectator(game, num))
+		return game->players[num];
 
-		if (player->num == num) {
-			playerlist_dec_use_count(game);
+	for (idx = 0; idx < game->spectators->len; idx++) {
+		Player *player = g_ptr_array_index(game->spectators, idx);
+		if (player != NULL && player->num == num)
 			return player;
-		}
 	}
-	playerlist_dec_use_count(game);
-
 	return NULL;
 }
 
@@ -1175,12 +1219,10 @@ static void player_broadcast_internal(Player * player, BroadcastType type,
 				      last_supported_version)
 {
 	Game *game = player->game;
-	GList *list;
+	Player *scan;
+	guint idx = 0;
 
-	playerlist_inc_use_count(game);
-	for (list = game->player_list; list != NULL;
-	     list = g_list_next(list)) {
-		Player *scan = list->data;
+	while ((scan = player_iterate(game, &idx)) != NULL) {
 		if ((scan->disconnected && !sm_get_use_cache(scan->sm))
 		    || scan->num < 0
 		    || scan->version < first_supported_version
@@ -1212,7 +1254,6 @@ static void player_broadcast_internal(Player * player, BroadcastType type,
 
 		}
 	}
-	playerlist_dec_use_count(game);
 }
 
 /** As player_broadcast, but will add the 'extension' keyword */
@@ -1305,45 +1346,12 @@ void player_remove(Player * player)
 	driver->player_removed(player);
 }
 
-GList *list_from_player(Player * player)
-{
-	GList *list;
-	for (list = player_first_real(player->game); list != NULL;
-	     list = player_next_real(list))
-		if (list->data == player)
-			break;
-	g_assert(list != NULL);
-	return list;
-}
-
-GList *next_player_loop(GList * current, Player * first)
+Player *next_player_loop(Player * current, Player * first)
 {
 	current = player_next_real(current);
 	if (current == NULL)
 		current = player_first_real(first->game);
-	if (current->data == first)
+	if (current == first)
 		return NULL;
 	return current;
 }
-
-void playerlist_inc_use_count(Game * game)
-{
-	game->player_list_use_count++;
-}
-
-void playerlist_dec_use_count(Game * game)
-{
-	game->player_list_use_count--;
-	if (game->player_list_use_count == 0) {
-		GList *current;
-		GList *all_dead_players;
-		current = game->dead_players;
-		all_dead_players = game->dead_players;	/* Remember this for g_list_free */
-		game->dead_players = NULL;	/* Clear the list */
-		for (; current != NULL; current = g_list_next(current)) {
-			Player *p = current->data;
-			player_free(p);
-		}
-		g_list_free(all_dead_players);
-	}
-}
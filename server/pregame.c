@@ -178,7 +178,7 @@ static void allocate_resources(Player * player, BuildRec * rec)
 		}
 	}
 	/* give out the gold */
-	distribute_first(list_from_player(player));
+	distribute_first(player);
 	return;
 }
 
@@ -235,17 +235,17 @@ void next_setup_player(Game * game)
 	if (game->reverse_setup) {
 		/* Going back for second setup phase
 		 */
-		GList *prev = NULL, *list;
-		for (list = player_first_real(game); list != NULL;
-		     list = player_next_real(list)) {
-			if (list == game->setup_player)
+		Player *prev = NULL, *scan;
+		for (scan = player_first_real(game); scan != NULL;
+		     scan = player_next_real(scan)) {
+			if (scan == game->setup_player)
 				break;
-			prev = list;
+			prev = scan;
 		}
 		game->setup_player = prev;
 		game->double_setup = FALSE;
 		if (game->setup_player != NULL) {
-			start_setup_player(game->setup_player->data);
+			start_setup_player(game->setup_player);
 		} else {
 			/* Start the game!!!
 			 */
@@ -262,7 +262,7 @@ void next_setup_player(Game * game)
 		/* Prepare to go backwards next time
 		 */
 		game->reverse_setup = game->double_setup;
-		start_setup_player(game->setup_player->data);
+		start_setup_player(game->setup_player);
 	}
 }
 
@@ -297,16 +297,14 @@ gboolean mode_setup(Player * player, gint event)
 
 static void try_start_game(Game * game)
 {
-	GList *list;
+	Player *player;
 	guint num;
 	int numturn;
 
 	num = 0;
 	numturn = 0;
-	for (list = player_first_real(game);
-	     list != NULL; list = player_next_real(list)) {
-		Player *player = list->data;
-
+	for (player = player_first_real(game);
+	     player != NULL; player = player_next_real(player)) {
 		if (sm_current(player->sm) == (StateFunc) mode_idle)
 			num++;
 
@@ -344,16 +342,14 @@ static void try_start_game(Game * game)
 	/* All players have connected, and are ready to begin
 	 */
 	if (game->tournament_timer != 0) {
-		g_source_remove(game->tournament_timer);
+		timer_wheel_remove(game->tournament_timer);
 		game->tournament_timer = 0;
 	}
 	meta_start_game();
 	game->setup_player = player_first_real(game);
-	while (((Player *) game->setup_player->data)->num < 0)
-		game->setup_player = game->setup_player->next;
 	game->double_setup = game->reverse_setup = FALSE;
 
-	start_setup_player(game->setup_player->data);
+	start_setup_player(game->setup_player);
 }
 
 /* Send the player list to the client
@@ -361,13 +357,12 @@ static void try_start_game(Game * game)
 static void send_player_list(Player * player)
 {
 	Game *game = player->game;
-	GList *list;
+	Player *scan;
+	guint idx = 0;
 
 	player_send_uncached(player, FIRST_VERSION, LATEST_VERSION,
 			     "players follow\n");
-	for (list = game->player_list; list != NULL;
-	     list = g_list_next(list)) {
-		Player *scan = list->data;
+	while ((scan = player_iterate(game, &idx)) != NULL) {
 		if (player == scan || scan->num < 0)
 			continue;
 		player_send_uncached(player, FIRST_VERSION, LATEST_VERSION,
@@ -492,6 +487,7 @@ gboolean mode_pre_game(Player * player, gint event)
 	const gchar *prevstate;
 	guint i;
 	GList *next;
+	Player *p;
 	gint longestroadpnum = -1;
 	gint largestarmypnum = -1;
 	static gboolean recover_from_plenty = FALSE;
@@ -758,9 +754,8 @@ gboolean mode_pre_game(Player * player, gint event)
 			}
 
 			/* Send info about other players */
-			for (next = player_first_real(game); next != NULL;
-			     next = player_next_real(next)) {
-				Player *p = (Player *) next->data;
+			for (p = player_first_real(game); p != NULL;
+			     p = player_next_real(p)) {
 				gint numassets = 0;
 				if (p->num == player->num)
 					continue;
@@ -823,11 +818,8 @@ gboolean mode_pre_game(Player * player, gint event)
 
 			/* Some player was in the setup phase */
 			if (game->setup_player != NULL
-			    && (Player *) game->setup_player->data !=
-			    player) {
-				gint num =
-				    ((Player *) (game->setup_player->
-						 data))->num;
+			    && game->setup_player != player) {
+				gint num = game->setup_player->num;
 				if (game->double_setup)
 					player_send_uncached(player,
 							     FIRST_VERSION,
@@ -853,9 +845,8 @@ gboolean mode_pre_game(Player * player, gint event)
 			}
 
 			/* send discard and gold info for all players */
-			for (next = player_first_real(game); next != NULL;
-			     next = player_next_real(next)) {
-				Player *p = (Player *) next->data;
+			for (p = player_first_real(game); p != NULL;
+			     p = player_next_real(p)) {
 				if (p->discard_num > 0) {
 					player_send_uncached(player,
 							     FIRST_VERSION,
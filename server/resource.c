@@ -47,12 +47,10 @@ gboolean resource_available(Player * player, gint * resources,
 
 void resource_start(Game * game)
 {
-	GList *list;
-
-	for (list = player_first_real(game);
-	     list != NULL; list = player_next_real(list)) {
-		Player *player = list->data;
+	Player *player;
 
+	for (player = player_first_real(game);
+	     player != NULL; player = player_next_real(player)) {
 		memcpy(player->prev_assets,
 		       player->assets, sizeof(player->assets));
 		player->gold = 0;
@@ -61,11 +59,10 @@ void resource_start(Game * game)
 
 void resource_end(Game * game, const gchar * action, gint mult)
 {
-	GList *list;
+	Player *player;
 
-	for (list = player_first_real(game);
-	     list != NULL; list = player_next_real(list)) {
-		Player *player = list->data;
+	for (player = player_first_real(game);
+	     player != NULL; player = player_next_real(player)) {
 		gint resource[NO_RESOURCE];
 		guint idx;
 		gboolean send_message = FALSE;
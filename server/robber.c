@@ -68,7 +68,8 @@ static void steal_card_from(Player * player, Player * victim)
 	guint idx;
 	gint num;
 	gint steal;
-	GList *list;
+	Player *scan;
+	guint scan_idx = 0;
 
 	/* Work out how many cards the victim has
 	 */
@@ -93,10 +94,7 @@ static void steal_card_from(Player * player, Player * victim)
 	 * interested parties find out which card was stolen, the
 	 * others just hear about the theft.
 	 */
-	for (list = game->player_list; list != NULL;
-	     list = g_list_next(list)) {
-		Player *scan = list->data;
-
+	while ((scan = player_iterate(game, &scan_idx)) != NULL) {
 		if (scan->num >= 0 && !scan->disconnected) {
 			if (scan == player || scan == victim) {
 				player_send(scan, FIRST_VERSION,
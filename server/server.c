@@ -27,9 +27,7 @@
 #include "avahi.h"
 #include "game-list.h"
 #include "random.h"
-
-#define TERRAIN_DEFAULT	0
-#define TERRAIN_RANDOM	1
+#include "map-balance.h"
 
 static gboolean timed_out(gpointer data)
 {
@@ -46,13 +44,14 @@ void start_timeout(Game * game)
 	if (!game->no_player_timeout)
 		return;
 	game->no_player_timer =
-	    g_timeout_add(game->no_player_timeout * 1000, timed_out, game);
+	    timer_wheel_add_full(game->no_player_timeout, timed_out, game,
+				 game, "no-player-timeout");
 }
 
 void stop_timeout(Game * game)
 {
 	if (game->no_player_timer != 0) {
-		g_source_remove(game->no_player_timer);
+		timer_wheel_remove(game->no_player_timer);
 		game->no_player_timer = 0;
 	}
 }
@@ -69,12 +68,17 @@ Game *game_new(const GameParams * params)
 	game->is_game_over = FALSE;
 	game->is_manipulated = FALSE;
 	game->params = params_copy(params);
+	game->spectators = g_ptr_array_new();
+	game->dead_players = g_ptr_array_new();
 	game->curr_player = -1;
 
 	for (idx = 0; idx < G_N_ELEMENTS(game->bank_deck); idx++)
 		game->bank_deck[idx] = game->params->resource_count;
 	develop_shuffle(game);
-	if (params->random_terrain)
+	if (params->random_terrain && params->balanced_terrain)
+		map_shuffle_balanced(game->params->map,
+				     MAP_BALANCE_CANDIDATES);
+	else if (params->random_terrain)
 		map_shuffle_terrain(game->params->map);
 
 	return game;
@@ -87,12 +91,15 @@ void game_free(Game * game)
 
 	server_stop(game);
 
-	g_assert(game->player_list_use_count == 0);
+	player_reap(game);
+	g_ptr_array_free(game->spectators, TRUE);
+	g_ptr_array_free(game->dead_players, TRUE);
 	if (game->server_port != NULL)
 		g_free(game->server_port);
 	params_free(game->params);
 	net_service_free(game->service);
 	game->service = NULL;
+	timer_wheel_remove_owner(game);
 	g_free(game);
 }
 
@@ -242,7 +249,8 @@ Game *server_start(const GameParams * params, const gchar * hostname,
 */
 gboolean server_stop(Game * game)
 {
-	GList *current;
+	Player *player;
+	guint idx;
 
 	if (!server_is_running(game))
 		return FALSE;
@@ -254,17 +262,13 @@ gboolean server_stop(Game * game)
 	net_service_free(game->service);
 	game->service = NULL;
 
-	playerlist_inc_use_count(game);
-	current = game->player_list;
-	while (current != NULL) {
-		Player *player = current->data;
+	idx = 0;
+	while ((player = player_iterate(game, &idx)) != NULL) {
 		if (!player->disconnected) {
 			player_remove(player);
 		}
 		player_free(player);
-		current = g_list_next(current);
 	}
-	playerlist_dec_use_count(game);
 
 	return TRUE;
 }
@@ -363,7 +367,16 @@ void cfg_set_terrain_type(GameParams * params, gint terrain_type)
 	g_print("cfg_set_terrain_type: %d\n", terrain_type);
 #endif
 	g_return_if_fail(params != NULL);
-	params->random_terrain = (terrain_type == TERRAIN_RANDOM) ? 1 : 0;
+	params->random_terrain = (terrain_type == TERRAIN_RANDOM
+				  || terrain_type == TERRAIN_BALANCED) ? 1 : 0;
+	params->balanced_terrain = (terrain_type == TERRAIN_BALANCED);
+}
+
+gint cfg_get_terrain_type(const GameParams * params)
+{
+	if (!params->random_terrain)
+		return TERRAIN_DEFAULT;
+	return params->balanced_terrain ? TERRAIN_BALANCED : TERRAIN_RANDOM;
 }
 
 void cfg_set_tournament_time(GameParams * params, gint tournament_time)
@@ -27,10 +27,13 @@
 #include "map.h"
 #include "quoteinfo.h"
 #include "state.h"
+#include "metrics.h"
 #include "network.h"
+#include "timer-wheel.h"
 
 #define TERRAIN_DEFAULT	0
 #define TERRAIN_RANDOM	1
+#define TERRAIN_BALANCED	2	/* the fairest of many random shuffles */
 
 typedef struct Game Game;
 typedef struct {
@@ -68,6 +71,11 @@ typedef struct {
 	gint market_played;	/* number of Market cards played */
 	guint islands_discovered;	/* number of islands discovered */
 	gboolean disconnected;
+	gboolean dead;		/* removed, waiting in game->dead_players */
+	gint slot;		/* index in game->spectators, or -1 */
+
+	gint64 turn_start;	/* when the current turn started, or 0 */
+	MetricsHistogram turn_duration;	/* duration of the turns */
 } Player;
 
 struct Game {
@@ -76,17 +84,18 @@ struct Game {
 
 	Service *service;	/* network service */
 
-	GList *player_list;	/* all players in the game */
-	GList *dead_players;	/* all players that should be removed when player_list_use_count == 0 */
-	gint player_list_use_count;	/* # functions is in use by */
+	Player *players[MAX_PLAYERS];	/* seated players, by number */
+	GPtrArray *spectators;	/* all others, NULL for a free slot */
+	GPtrArray *dead_players;	/* removed, freed from the main loop */
+	guint reap_source;	/* idle source that frees dead_players */
 	guint num_players;	/* current number of players in the game */
 
 	guint tournament_countdown;	/* number of remaining minutes before AIs are added */
-	guint tournament_timer;	/* timer id */
+	guint tournament_timer;	/* timer wheel id */
 
 	gboolean double_setup;
 	gboolean reverse_setup;
-	GList *setup_player;
+	Player *setup_player;
 
 	gboolean is_game_over;	/* is the game over? */
 	Player *longest_road;	/* who holds longest road */
@@ -116,9 +125,9 @@ struct Game {
 	gboolean is_manipulated;	/* has the game been manipulated by the admin? */
 
 	guint no_player_timeout;	/* time to wait for players */
-	guint no_player_timer;	/* glib timer identifier */
+	guint no_player_timer;	/* timer wheel id */
 
-	guint no_humans_timer;	/* timer id: no human players are present */
+	guint no_humans_timer;	/* timer wheel id: no human players are present */
 };
 
 /**** global variables ****/
@@ -185,13 +194,12 @@ void player_remove(Player * player);
 void player_free(Player * player);
 void player_archive(Player * player);
 void player_revive(Player * newp, char *name);
-GList *player_first_real(Game * game);
-GList *player_next_real(GList * last);
-GList *list_from_player(Player * player);
-GList *next_player_loop(GList * current, Player * first);
+Player *player_first_real(Game * game);
+Player *player_next_real(Player * last);
+Player *next_player_loop(Player * current, Player * first);
+Player *player_iterate(Game * game, guint * idx);
+void player_reap(Game * game);
 gboolean mode_spectator(Player * player, gint event);
-void playerlist_inc_use_count(Game * game);
-void playerlist_dec_use_count(Game * game);
 gboolean player_is_spectator(Game * game, gint player_num);
 
 /* pregame.c */
@@ -242,6 +250,7 @@ void cfg_set_num_removed_dice_cards(GameParams * params,
 				    gint num_removed_dice_cards);
 void cfg_set_victory_points(GameParams * params, gint victory_points);
 void cfg_set_terrain_type(GameParams * params, gint terrain_type);
+gint cfg_get_terrain_type(const GameParams * params);
 void cfg_set_tournament_time(GameParams * params, gint tournament_time);
 void cfg_set_quit(GameParams * params, gboolean quitdone);
 void admin_broadcast(Game * game, const gchar * message);
@@ -277,7 +286,7 @@ gboolean check_victory(Player * player);
 /* gold.c */
 gboolean gold_limited_bank(const Game * game, int limit,
 			   gint * limited_bank);
-void distribute_first(GList * list);
+void distribute_first(Player * player);
 gboolean mode_choose_gold(Player * player, gint event);
 gboolean mode_wait_for_gold_choosing_players(Player * player, gint event);
 
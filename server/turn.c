@@ -396,6 +396,7 @@ gboolean check_victory(Player * player)
 {
 	Game *game = player->game;
 	GList *list;
+	Player *scan;
 	gint points;		/* can be negative, due to island bonuses */
 
 	if (player->num != game->curr_player)
@@ -423,9 +424,8 @@ gboolean check_victory(Player * player)
 		game->is_game_over = TRUE;
 		/* Set all state machines to idle, to make sure nothing
 		 * happens. */
-		for (list = player_first_real(game); list != NULL;
-		     list = player_next_real(list)) {
-			Player *scan = list->data;
+		for (scan = player_first_real(game); scan != NULL;
+		     scan = player_next_real(scan)) {
 			sm_pop_all_and_goto(scan->sm,
 					    (StateFunc) mode_idle);
 		}
@@ -537,7 +537,7 @@ static void roll_dice(Player * player)
 	data.roll = roll;
 	map_traverse_const(map, distribute_resources, &data);
 	/* distribute resources and gold (includes resource_end) */
-	distribute_first(list_from_player(player));
+	distribute_first(player);
 	return;
 
 }
@@ -641,33 +641,34 @@ gboolean mode_idle(Player * player, G_GNUC_UNUSED gint event)
 void turn_next_player(Game * game)
 {
 	Player *player = NULL;
-	GList *list = NULL;
 
 	/* the first time this is called there is no curr_player yet */
 	if (game->curr_player >= 0) {
 		player = player_by_num(game, game->curr_player);
 		game->curr_player = -1;
 		g_assert(player != NULL);
-		list = list_from_player(player);
+		metrics_histogram_since(&player->turn_duration,
+					player->turn_start);
+		player->turn_start = 0;
 	}
 
 	do {
 		/* next player */
-		if (list)
-			list = player_next_real(list);
+		if (player)
+			player = player_next_real(player);
 		/* See if it's the first player's turn again */
-		if (list == NULL) {
-			list = player_first_real(game);
+		if (player == NULL) {
+			player = player_first_real(game);
 			game->curr_turn++;
 		}
 		/* sanity check */
-		g_assert(list != NULL && list->data != NULL);
-		player = list->data;
+		g_assert(player != NULL);
 		/* disconnected players don't take turns */
 	} while (player->disconnected);
 
 	/* reset variables */
 	game->curr_player = player->num;
+	player->turn_start = metrics_start();
 	game->rolled_dice = FALSE;
 	game->bought_develop = FALSE;
 	game->num_playable_cards = deck_count(player->devel);